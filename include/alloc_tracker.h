@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief ヒープ確保の回数とバイト数
+ */
+struct AllocCounts {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * @brief スレッドごとのヒープ確保数を数えるトラッカー
+ *
+ * 計測には operator new/delete を置き換えるフック
+ * （gemini-voice-alloc-hooks ライブラリ）をリンクする必要があります。
+ * リンクしていない場合、カウントは常に0で installed() は false を返します。
+ */
+class AllocTracker {
+public:
+    /**
+     * @brief フックがリンクされているかどうか
+     */
+    static bool installed();
+
+    /**
+     * @brief 呼び出し元スレッドの累積カウントを取得
+     */
+    static AllocCounts thread_counts() noexcept;
+
+    /**
+     * @brief フックから呼び出される記録関数
+     */
+    static void on_allocate(std::size_t bytes) noexcept;
+    static void on_deallocate() noexcept;
+    static void mark_installed() noexcept;
+};
+
+/**
+ * @brief スコープ内で呼び出し元スレッドが行ったヒープ確保を数えるRAIIヘルパー
+ *
+ * 他のスレッドの確保は含みません。
+ */
+class AllocScope {
+public:
+    AllocScope() : start_(AllocTracker::thread_counts()) {}
+
+    /**
+     * @brief スコープ開始からのカウント
+     */
+    AllocCounts counts() const {
+        AllocCounts now = AllocTracker::thread_counts();
+        return {now.allocations - start_.allocations,
+                now.deallocations - start_.deallocations,
+                now.bytes - start_.bytes};
+    }
+
+    /**
+     * @brief スコープ開始からの確保回数
+     */
+    uint64_t allocations() const { return counts().allocations; }
+
+    /**
+     * @brief 計測をやり直す
+     */
+    void reset() { start_ = AllocTracker::thread_counts(); }
+
+private:
+    AllocCounts start_;
+};
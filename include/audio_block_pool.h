@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class AudioBlockPool;
+
+// Sits at the start of every block in the pool's slab; the samples follow on the next cache line
+struct alignas(64) AudioBlockHeader {
+    std::atomic<uint32_t> refs{0};
+    std::atomic<uint32_t> next{0};      // Free-list link (block index)
+    uint32_t index = 0;
+    std::size_t size = 0;
+    std::size_t capacity = 0;
+    AudioBlockPool* pool = nullptr;
+
+    int16_t* samples() { return reinterpret_cast<int16_t*>(this + 1); }
+};
+
+/**
+ * @brief AudioBlockPool から借りた固定長の音声ブロックへの参照（参照カウント付き）
+ *
+ * コピーすると同じブロックを共有し、最後の参照が破棄されたときにプールへ返却されます。
+ * 返却はロックフリーなので、オーディオスレッドから破棄しても構いません。
+ * ブロックを持っている間はプールを破棄しないでください。
+ */
+class AudioBlock {
+public:
+    AudioBlock() noexcept = default;
+    ~AudioBlock() { reset(); }
+
+    AudioBlock(const AudioBlock& other) noexcept : header_(other.header_) {
+        if (header_) {
+            header_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    AudioBlock(AudioBlock&& other) noexcept : header_(other.header_) {
+        other.header_ = nullptr;
+    }
+
+    AudioBlock& operator=(const AudioBlock& other) noexcept {
+        AudioBlock copy(other);
+        std::swap(header_, copy.header_);
+        return *this;
+    }
+
+    AudioBlock& operator=(AudioBlock&& other) noexcept {
+        if (this != &other) {
+            reset();
+            header_ = other.header_;
+            other.header_ = nullptr;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief 参照を手放す（最後の参照ならプールへ返却）
+     */
+    void reset() noexcept;
+
+    explicit operator bool() const { return header_ != nullptr; }
+
+    int16_t* data() { return header_->samples(); }
+    const int16_t* data() const { return header_->samples(); }
+
+    /**
+     * @brief 格納しているサンプル数
+     */
+    std::size_t size() const { return header_->size; }
+
+    /**
+     * @brief 格納できる最大サンプル数
+     */
+    std::size_t capacity() const { return header_->capacity; }
+
+    /**
+     * @brief サンプル数を設定（data() に直接書き込んだ後に呼ぶ。capacity() で切り詰め）
+     */
+    void resize(std::size_t samples) { header_->size = std::min(samples, header_->capacity); }
+
+    /**
+     * @brief サンプルをコピー
+     *
+     * @return std::size_t コピーしたサンプル数（capacity() を超えた分はコピーしない）
+     */
+    std::size_t assign(const int16_t* samples, std::size_t count) {
+        count = std::min(count, header_->capacity);
+        std::memcpy(header_->samples(), samples, count * sizeof(int16_t));
+        header_->size = count;
+        return count;
+    }
+
+    /**
+     * @brief このブロックを共有している参照の数
+     */
+    uint32_t use_count() const { return header_ ? header_->refs.load(std::memory_order_relaxed) : 0; }
+
+private:
+    friend class AudioBlockPool;
+    explicit AudioBlock(AudioBlockHeader* header) noexcept : header_(header) {}
+
+    AudioBlockHeader* header_ = nullptr;
+};
+
+/**
+ * @brief 固定長の音声ブロックを事前に確保して使い回すプール
+ *
+ * すべてのブロックを構築時に1つの領域にまとめて確保し（キャッシュライン境界に整列）、
+ * 以後は malloc を呼びません。空きブロックはタグ付きのロックフリーなスタックで管理するため、
+ * acquire() と返却はどのスレッドからでも待たずに行えます。
+ * 空きがないときは acquire() が空の AudioBlock を返し、gemini_audio_pool_exhausted_total に数えます。
+ */
+class AudioBlockPool {
+public:
+    /**
+     * @brief プールの統計情報
+     */
+    struct Stats {
+        std::size_t blocks = 0;         // ブロックの総数
+        std::size_t available = 0;      // 空きブロック数
+        uint64_t acquired = 0;          // 貸し出した回数
+        uint64_t exhausted = 0;         // 空きがなく貸し出せなかった回数
+    };
+
+    /**
+     * @brief AudioBlockPoolのコンストラクタ（全ブロックをここで確保）
+     *
+     * @param block_samples 1ブロックのサンプル数
+     * @param blocks ブロック数
+     */
+    AudioBlockPool(std::size_t block_samples, std::size_t blocks);
+
+    /**
+     * @brief デストラクタ（すべてのブロックが返却済みであること）
+     */
+    ~AudioBlockPool();
+
+    AudioBlockPool(const AudioBlockPool&) = delete;
+    AudioBlockPool& operator=(const AudioBlockPool&) = delete;
+
+    /**
+     * @brief 空きブロックを1つ借りる（任意のスレッドから呼び出し可能、ロックフリー）
+     *
+     * @return AudioBlock サイズ0のブロック（空きがなければ空の AudioBlock）
+     */
+    AudioBlock acquire();
+
+    /**
+     * @brief 1ブロックのサンプル数
+     */
+    std::size_t block_samples() const { return block_samples_; }
+
+    /**
+     * @brief 空きブロック数
+     */
+    std::size_t available() const { return available_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 統計情報を取得（任意のスレッドから呼び出し可能）
+     */
+    Stats get_stats() const;
+
+private:
+    friend class AudioBlock;
+
+    // Marks the end of the free list
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    AudioBlockHeader* header_at(uint32_t index) const {
+        return reinterpret_cast<AudioBlockHeader*>(slab_ + index * stride_);
+    }
+    void release(AudioBlockHeader* header) noexcept;
+
+    std::size_t block_samples_;
+    std::size_t blocks_;
+    std::size_t stride_;                // Header plus samples, rounded up to whole cache lines
+    std::byte* slab_;
+
+    // Free-list head: block index in the low half, a change counter in the high half against ABA
+    alignas(64) std::atomic<uint64_t> head_;
+    alignas(64) std::atomic<std::size_t> available_;
+    std::atomic<uint64_t> acquired_{0};
+    std::atomic<uint64_t> exhausted_{0};
+};
+
+inline void AudioBlock::reset() noexcept {
+    if (header_) {
+        if (header_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            header_->pool->release(header_);
+        }
+        header_ = nullptr;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief ソフトウェアゲインを適用して出力バッファの末尾に追加
+ *
+ * 16-bitの範囲を超える値は飽和させます。
+ *
+ * @param input 入力サンプル
+ * @param gain ゲイン倍率
+ * @param output 出力先（末尾に追加）
+ */
+inline void apply_gain(const std::vector<int16_t>& input, int32_t gain, std::vector<int16_t>& output) {
+    for (int16_t sample : input) {
+        int32_t amplified = static_cast<int32_t>(sample) * gain;
+        if (amplified > 32767) amplified = 32767;
+        if (amplified < -32768) amplified = -32768;
+        output.push_back(static_cast<int16_t>(amplified));
+    }
+}
+
+/**
+ * @brief 再生待ちサンプルのFIFOバッファ
+ *
+ * スレッドセーフではありません。呼び出し側で排他制御を行ってください。
+ */
+class PlaybackBuffer {
+public:
+    /**
+     * @brief サンプルを末尾に追加
+     */
+    void push(const std::vector<int16_t>& samples) {
+        push(samples.data(), samples.size());
+    }
+
+    /**
+     * @brief count 個のサンプルを末尾に追加
+     */
+    void push(const int16_t* samples, size_t count) {
+        buffer_.insert(buffer_.end(), samples, samples + count);
+    }
+
+    /**
+     * @brief 先頭から最大 frames 個のサンプルを取り出す
+     *
+     * @param output 出力先
+     * @param frames 取り出す最大サンプル数
+     * @return size_t 実際に取り出したサンプル数
+     */
+    size_t pop(int16_t* output, size_t frames) {
+        size_t count = std::min(frames, buffer_.size());
+        if (count > 0) {
+            std::memcpy(output, buffer_.data(), count * sizeof(int16_t));
+            buffer_.erase(buffer_.begin(), buffer_.begin() + count);
+        }
+        return count;
+    }
+
+    /**
+     * @brief 再生待ちのサンプル数
+     */
+    size_t size() const { return buffer_.size(); }
+
+    /**
+     * @brief すべてのサンプルを破棄
+     */
+    void clear() { buffer_.clear(); }
+
+private:
+    std::vector<int16_t> buffer_;
+};
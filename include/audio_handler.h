@@ -1,6 +1,8 @@
 #pragma once
 
 #include "miniaudio.h"
+#include "audio_buffer.h"
+#include "callback_monitor.h"
 #include <functional>
 #include <vector>
 #include <memory>
@@ -14,6 +16,7 @@
 class AudioHandler {
 public:
     using AudioCallback = std::function<void(const std::vector<int16_t>&)>;
+    using PlayoutCallback = std::function<void(uint64_t)>;
 
     /**
      * @brief AudioHandlerのコンストラクタ
@@ -57,6 +60,15 @@ public:
      */
     bool play_audio(const std::vector<int16_t>& audio_data, int sample_rate = 24000);
 
+    /**
+     * @brief 音声を再生（呼び出し側のバッファの一部をそのまま渡す）
+     * 
+     * @param samples 再生するサンプルの先頭
+     * @param count サンプル数
+     * @param sample_rate サンプルレート（デフォルト: 24000Hz）
+     */
+    bool play_audio(const int16_t* samples, size_t count, int sample_rate = 24000);
+
     /**
      * @brief 録音中かどうかを確認
      * 
@@ -65,6 +77,39 @@ public:
      */
     bool is_recording() const;
 
+    /**
+     * @brief 再生デバイスが使用可能かどうかを確認
+     */
+    bool is_playback_ready() const { return playback_initialized_; }
+
+    /**
+     * @brief 再生デバイスがサンプルを消費したときのコールバックを設定
+     * 
+     * オーディオデバイスのスレッドから、これまでに消費した累積サンプル数を
+     * 引数として呼び出されます。initialize() より前に設定してください。
+     * 
+     * @param callback 累積サンプル数を受け取るコールバック
+     */
+    void set_playout_callback(PlayoutCallback callback) { playout_callback_ = std::move(callback); }
+
+    /**
+     * @brief コールバック処理時間の警告しきい値を設定（周期に対する割合）
+     */
+    void set_callback_warn_fraction(double fraction) {
+        capture_monitor_.set_warn_fraction(fraction);
+        playback_monitor_.set_warn_fraction(fraction);
+    }
+
+    /**
+     * @brief 録音コールバックの監視結果
+     */
+    CallbackMonitor& capture_monitor() { return capture_monitor_; }
+
+    /**
+     * @brief 再生コールバックの監視結果
+     */
+    CallbackMonitor& playback_monitor() { return playback_monitor_; }
+
 private:
     // miniaudioのコールバック関数
     static void capture_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount);
@@ -73,6 +118,7 @@ private:
     ma_device_config capture_config_;
     
     AudioCallback audio_callback_;
+    std::vector<int16_t> capture_buffer_;   // 録音コールバック専用の作業バッファ
     std::atomic<bool> recording_;
     std::atomic<bool> initialized_;
     ma_device_id playback_device_id_;
@@ -90,7 +136,14 @@ private:
     ma_device_config playback_config_;
     bool playback_initialized_ = false;
     
-    // 再生用リングバッファ（簡易的な実装としてvectorとmutexを使用）
-    std::vector<int16_t> playback_buffer_;
+    // 再生待ちバッファ（playback_mutex_ で保護）
+    PlaybackBuffer playback_buffer_;
     std::mutex playback_mutex_;
+    uint64_t samples_played_ = 0;
+    bool playing_ = false;             // 直前のコールバックがバッファで満たせたか
+    PlayoutCallback playout_callback_;
+
+    // コールバックの処理時間・ジッタ・xrunの監視
+    CallbackMonitor capture_monitor_;
+    CallbackMonitor playback_monitor_;
 };
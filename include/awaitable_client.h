@@ -0,0 +1,163 @@
+#pragma once
+
+#include "websocket_client.h"
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <optional>
+
+/**
+ * @brief コルーチンで使うWebSocketクライアント
+ *
+ * connect()、send()、next_message() を co_await で呼び出せるため、
+ * セッションをコールバックの連鎖ではなく直線的なコルーチンとして記述できます。
+ * 各操作には期限を指定でき、cancel() で実行中の操作を中断できます。
+ *
+ * コルーチンは必ず get_executor() のstrand上で co_spawn してください。
+ * 送信と受信は別々のコルーチンから同時に待機できますが、
+ * 同じ種類の操作を同時に2つ実行することはできません。
+ *
+ * Boost 1.74 には操作ごとのキャンセルスロットがないため、期限切れと cancel() は
+ * どちらも接続を閉じて実行中の操作をすべて終了させます（以降は再接続が必要です）。
+ */
+class AwaitableClient {
+public:
+    using Executor = net::strand<net::io_context::executor_type>;
+
+    /// 期限なし
+    static constexpr std::chrono::milliseconds no_timeout{0};
+
+    /**
+     * @brief AwaitableClientのコンストラクタ
+     *
+     * @param io_context 使用するIOコンテキスト
+     * @param endpoint 接続先
+     */
+    AwaitableClient(net::io_context& io_context, const WebSocketClient::Endpoint& endpoint);
+
+    /**
+     * @brief デストラクタ（実行中の操作がないこと）
+     */
+    ~AwaitableClient();
+
+    AwaitableClient(const AwaitableClient&) = delete;
+    AwaitableClient& operator=(const AwaitableClient&) = delete;
+
+    /**
+     * @brief 受信メッセージの最大サイズを設定（connect() より前に呼び出すこと、0で無制限）
+     */
+    void set_max_message_size(std::size_t bytes) { max_message_size_ = bytes; }
+
+    /**
+     * @brief 無通信時のキープアライブを設定（connect() より前に呼び出すこと）
+     *
+     * idle の半分の時間受信がなければ ping を送り、idle の間応答がなければ切断します。
+     *
+     * @param idle 無通信と判断するまでの時間（0で無効）
+     */
+    void set_idle_timeout(std::chrono::milliseconds idle) { idle_timeout_ = idle; }
+
+    /**
+     * @brief 名前解決、TCP接続、TLS/WebSocketハンドシェイクを行う
+     *
+     * @param timeout 全体の期限（0で期限なし）
+     * @return true 接続成功
+     * @return false 失敗（理由は last_error()）
+     */
+    net::awaitable<bool> connect(std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+    /**
+     * @brief テキストメッセージを1つ送信
+     *
+     * @param message 送信するメッセージ（完了まで有効であること）
+     * @param timeout 期限（0で期限なし）
+     * @return true 送信成功
+     * @return false 失敗（理由は last_error()）
+     */
+    net::awaitable<bool> send(std::string_view message, std::chrono::milliseconds timeout = no_timeout);
+
+    /**
+     * @brief 次のメッセージを受信
+     *
+     * 返されるビューは受信バッファを参照しており、次の next_message() 呼び出しまで有効です。
+     *
+     * @param timeout 期限（0で期限なし）
+     * @return 受信したメッセージ、失敗時は std::nullopt（理由は last_error()）
+     */
+    net::awaitable<std::optional<std::string_view>> next_message(
+        std::chrono::milliseconds timeout = no_timeout);
+
+    /**
+     * @brief クローズハンドシェイクを行って切断
+     *
+     * @param timeout 期限（0で期限なし）
+     */
+    net::awaitable<void> close(std::chrono::milliseconds timeout = std::chrono::seconds(2));
+
+    /**
+     * @brief 実行中の操作をすべて中断して接続を閉じる（任意のスレッドから呼び出し可能）
+     *
+     * 待機中の操作は net::error::operation_aborted で終了します。
+     */
+    void cancel();
+
+    /**
+     * @brief 接続中かどうか
+     */
+    bool is_connected() const { return connected_; }
+
+    /**
+     * @brief 直近に失敗した操作のエラー（期限切れは beast::error::timeout）
+     */
+    beast::error_code last_error() const { return last_error_; }
+
+    /**
+     * @brief コルーチンを実行するstrandを取得
+     */
+    Executor get_executor() { return strand_; }
+
+private:
+    using TlsStream = websocket::stream<beast::ssl_stream<beast::tcp_stream>>;
+    using PlainStream = websocket::stream<beast::tcp_stream>;
+
+    template <class Stream>
+    net::awaitable<void> handshake(Stream& ws, beast::error_code& ec);
+
+    template <class Stream>
+    net::awaitable<std::optional<std::string_view>> read_from(Stream& ws);
+
+    template <class Stream>
+    net::awaitable<bool> write_to(Stream& ws, std::string_view message);
+
+    template <class Stream>
+    net::awaitable<void> close_stream(Stream& ws);
+
+    // Start a deadline that aborts the connection when it expires
+    void arm(net::steady_timer& timer, std::chrono::milliseconds timeout);
+
+    // Stop the deadline (an expiry already queued is ignored) and record the outcome of an operation
+    bool finish(net::steady_timer& timer, beast::error_code ec);
+
+    void abort(beast::error_code reason);
+
+    Executor strand_;
+    ssl::context ssl_ctx_;
+    tcp::resolver resolver_;
+    std::unique_ptr<TlsStream> tls_ws_;
+    std::unique_ptr<PlainStream> plain_ws_;
+    beast::flat_buffer buffer_;
+    WebSocketClient::Endpoint endpoint_;
+
+    std::size_t max_message_size_ = 0;
+    std::chrono::milliseconds idle_timeout_{0};
+
+    // One deadline per kind of operation so that a read and a write can overlap
+    net::steady_timer connect_timer_;
+    net::steady_timer read_timer_;
+    net::steady_timer write_timer_;
+
+    std::atomic<bool> connected_;
+    beast::error_code abort_reason_;    // Set when a deadline or cancel() closed the connection
+    beast::error_code last_error_;
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "websocket_client.h"
+#include "histogram.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief バッチモードの設定
+ */
+struct BatchOptions {
+    WebSocketClient::Endpoint endpoint;                     // 接続先
+    std::string setup_message;                              // 各セッションで送るセットアップメッセージ
+    std::string output_dir = "batch_out";                   // 応答音声・文字起こし・結果の出力先
+    std::size_t concurrency = 4;                            // 同時に実行するセッション数
+    std::size_t thread_count = 0;                           // スレッドプールのスレッド数（0でCPUコア数）
+    int retries = 1;                                        // 失敗したファイルを再試行する回数
+    int output_sample_rate = 24000;                         // 応答WAVのサンプルレート
+    std::chrono::milliseconds setup_timeout{10000};         // setupComplete を待つ時間
+    std::chrono::milliseconds drain_timeout{10000};         // 入力終了後に応答を待つ時間
+};
+
+/**
+ * @brief WAVファイルを並列にGeminiへ流し、入力ごとに応答を保存するクラス
+ *
+ * 各ファイルは PipeBridge でペース制御なしに（サーバーの受信に合わせて）送られ、
+ * 応答音声は output_dir/<名前>.wav、文字起こしは output_dir/<名前>.jsonl に書き出されます。
+ * 応答音声は書き込み中は .part の名前で、成功時にリネームされるため、
+ * 同じ出力先で再実行すると完了済みのファイルは読み飛ばされます（中断・失敗からの再開）。
+ * ファイルごとの結果は output_dir/batch_results.jsonl に追記されます。
+ * セッションは共有の io_context 上で動き、CPUコア数のスレッドプールで実行されます。
+ */
+class BatchRunner {
+public:
+    class Job;
+
+    /**
+     * @brief バッチ全体の集計値
+     */
+    struct Summary {
+        std::size_t total = 0;          // 入力ファイル数
+        std::size_t skipped = 0;        // 前回までに完了していたファイル数
+        std::size_t succeeded = 0;
+        std::size_t failed = 0;         // 再試行しても失敗したファイル数
+        std::size_t retried = 0;        // 再試行した回数
+        std::size_t active = 0;
+        uint64_t uplink_bytes = 0;
+        uint64_t downlink_bytes = 0;
+        double elapsed_seconds = 0.0;
+        double files_per_minute = 0.0;
+    };
+
+    /**
+     * @brief BatchRunnerのコンストラクタ
+     *
+     * @param options 設定
+     */
+    explicit BatchRunner(const BatchOptions& options);
+
+    /**
+     * @brief デストラクタ（実行中なら停止）
+     */
+    ~BatchRunner();
+
+    BatchRunner(const BatchRunner&) = delete;
+    BatchRunner& operator=(const BatchRunner&) = delete;
+
+    /**
+     * @brief 入力ファイルの一覧を作成
+     *
+     * ディレクトリなら直下の .wav ファイルを名前順に、それ以外はマニフェスト
+     * （1行に1パス。空行と # で始まる行は無視、相対パスはマニフェストの場所から）として読みます。
+     *
+     * @param path ディレクトリまたはマニフェストのパス
+     * @param inputs 入力ファイルのパス（出力）
+     * @return true 読み取り成功
+     * @return false パスが存在しない、または読み取り失敗
+     */
+    static bool collect_inputs(const std::string& path, std::vector<std::string>& inputs);
+
+    /**
+     * @brief すべての入力を処理し終わるか stop() が呼ばれるまでブロック
+     *
+     * @param inputs 入力ファイルのパス
+     * @return true すべてのファイルが成功（または完了済み）
+     * @return false 失敗したファイルがある、または中断された
+     */
+    bool run(const std::vector<std::string>& inputs);
+
+    /**
+     * @brief 実行中のセッションを中止して run() を終了させる（任意のスレッドから呼び出し可能）
+     */
+    void stop();
+
+    /**
+     * @brief 集計値を取得（任意のスレッドから呼び出し可能）
+     */
+    Summary get_summary() const;
+
+    /**
+     * @brief 進捗・スループット・ファイルごとの遅延を出力（任意のスレッドから呼び出し可能）
+     *
+     * @param out 出力先
+     */
+    void print_report(std::ostream& out) const;
+
+private:
+    friend class Job;
+
+    struct Item {
+        std::string input;
+        std::string name;       // 出力ファイル名の基になる名前
+        int attempts = 0;
+    };
+
+    void launch_next();
+    void start_job(Item item);
+    void on_job_finished(const std::shared_ptr<Job>& job);
+    void write_result(const Item& item, bool ok, const std::string& error, double seconds,
+                      double first_audio_seconds, uint64_t uplink_bytes, uint64_t downlink_bytes);
+
+    BatchOptions options_;
+    net::io_context io_context_;
+    std::vector<std::thread> threads_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable done_cv_;
+    std::deque<Item> pending_;
+    std::unordered_set<std::shared_ptr<Job>> jobs_;
+    std::ofstream results_;
+    bool stopping_ = false;
+
+    std::chrono::steady_clock::time_point started_at_;
+    std::size_t total_ = 0;
+    std::size_t skipped_ = 0;
+    std::size_t succeeded_ = 0;
+    std::size_t failed_ = 0;
+    std::size_t retried_ = 0;
+    std::atomic<uint64_t> uplink_bytes_{0};
+    std::atomic<uint64_t> downlink_bytes_{0};
+    Histogram file_ms_;             // Wall time per file
+    Histogram first_audio_ms_;      // setupComplete to the first model audio
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "histogram.h"
+#include "metrics.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief オーディオコールバックの処理時間と呼び出し間隔を監視するクラス
+ *
+ * 各コールバックの実行時間を周期の予算（frameCount / sampleRate）と比較し、
+ * 呼び出し間隔のジッタ、予算超過、周期の欠落（キャプチャの取りこぼし）、
+ * 再生のアンダーラン（ゼロ埋めしたフレーム）を記録します。
+ *
+ * begin()/end() はオーディオスレッドから呼び出され、アトミック操作のみで
+ * 完了します（ウェイトフリー）。警告の出力は report_warnings() で
+ * リアルタイムでないスレッドから行ってください。
+ * 集計値は MetricsRegistry にも登録されます。
+ */
+class CallbackMonitor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief 監視結果の集計値
+     */
+    struct Stats {
+        uint64_t callbacks = 0;
+        uint64_t over_budget = 0;       // 実行時間が周期を超えた回数
+        uint64_t over_warning = 0;      // 実行時間が警告しきい値を超えた回数
+        uint64_t missed_periods = 0;    // 呼び出し間隔から推定した欠落周期数
+        uint64_t underruns = 0;         // ゼロ埋めが発生したコールバック数
+        uint64_t underrun_frames = 0;   // ゼロ埋めしたフレーム数
+    };
+
+    /**
+     * @brief CallbackMonitorのコンストラクタ
+     *
+     * @param name 監視対象の名前（"capture" や "playback"、メトリクス名に使用）
+     * @param sample_rate デバイスのサンプルレート
+     * @param warn_fraction 警告する実行時間（周期の予算に対する割合）
+     */
+    CallbackMonitor(const std::string& name, int sample_rate, double warn_fraction = 0.5);
+
+    /**
+     * @brief 警告しきい値を変更（周期の予算に対する割合）
+     */
+    void set_warn_fraction(double fraction) { warn_fraction_.store(fraction, std::memory_order_relaxed); }
+
+    /**
+     * @brief コールバックの開始を記録
+     *
+     * 前回の呼び出しからの間隔でジッタと欠落周期を計算します。
+     *
+     * @return end() に渡す開始時刻
+     */
+    Clock::time_point begin(uint32_t frame_count) noexcept;
+
+    /**
+     * @brief コールバックの終了を記録
+     *
+     * @param started begin() の戻り値
+     * @param frame_count コールバックのフレーム数
+     * @param zero_filled データ不足でゼロ埋めしたフレーム数
+     */
+    void end(Clock::time_point started, uint32_t frame_count, uint32_t zero_filled = 0) noexcept;
+
+    /**
+     * @brief 集計値を取得
+     */
+    Stats get_stats() const;
+
+    /**
+     * @brief 実行時間（us）のヒストグラム
+     */
+    const Histogram& duration_us() const { return duration_us_; }
+
+    /**
+     * @brief 呼び出し間隔と周期の差（us）のヒストグラム
+     */
+    const Histogram& jitter_us() const { return jitter_us_; }
+
+    /**
+     * @brief 前回の呼び出し以降に警告しきい値を超えたコールバックがあれば出力
+     */
+    void report_warnings(std::ostream& out);
+
+    /**
+     * @brief 集計結果を出力
+     */
+    void print_summary(std::ostream& out) const;
+
+private:
+    static int64_t now_ns(Clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    const std::string name_;
+    const int sample_rate_;
+    std::atomic<double> warn_fraction_;
+
+    // Written only by the audio thread
+    std::atomic<int64_t> last_begin_ns_{0};
+    std::atomic<uint32_t> last_frames_{0};
+
+    Histogram& duration_us_;
+    Histogram& jitter_us_;
+    Histogram load_permille_;           // Duration as a fraction of the budget
+    Counter& callbacks_;
+    Counter& over_budget_;
+    Counter& over_warning_;
+    Counter& missed_periods_;
+    Counter& underruns_;
+    Counter& underrun_frames_;
+
+    // Pending warning state, drained by report_warnings()
+    std::atomic<uint64_t> pending_warnings_{0};
+    std::atomic<uint64_t> worst_pending_us_{0};
+    std::atomic<uint64_t> worst_pending_budget_us_{0};
+};
@@ -1,8 +1,19 @@
 #pragma once
 
+#include "thread_placement.h"
 #include <string>
 #include <vector>
 
+/**
+ * @brief セッション中に変更できる音声パイプラインの設定
+ */
+struct AudioTuning {
+    int gain_factor = 5;            // 録音音声のソフトウェアゲイン
+    size_t chunk_size = 16000;      // 1回の送信サンプル数
+    size_t buffer_size = 24000;     // 再生に回すサンプル数
+    size_t min_buffer_size = 7200;  // 受信が途切れたときに再生する最小サンプル数
+};
+
 /**
  * @brief アプリケーション設定を管理するクラス
  */
@@ -44,6 +55,31 @@ public:
     int getMinBufferSize() const { return min_buffer_size_; }
     int getGainFactor() const { return gain_factor_; }
 
+    // スレッド配置
+    const ThreadPlacementConfig& getThreadPlacement() const { return thread_placement_; }
+
+    /**
+     * @brief セッション中に変更できる音声設定を取得
+     */
+    AudioTuning getAudioTuning() const;
+
+    /**
+     * @brief 設定値の範囲を検証
+     * 
+     * @param error 不正な場合のエラーメッセージ（出力）
+     * @return true 有効
+     * @return false 不正な値がある
+     */
+    bool validate(std::string& error) const;
+
+    /**
+     * @brief 新しいセッションでしか反映できない項目の差分を取得
+     * 
+     * @param other 比較対象（現在のセッションの設定）
+     * @return std::vector<std::string> 変更された項目名（例: "model.name"）
+     */
+    std::vector<std::string> sessionChangesFrom(const Config& other) const;
+
     /**
      * @brief 設定をコンソールに出力
      */
@@ -73,6 +109,9 @@ private:
     int min_buffer_size_;
     int gain_factor_;
 
+    // スレッド配置
+    ThreadPlacementConfig thread_placement_;
+
     /**
      * @brief デフォルト設定を初期化
      */
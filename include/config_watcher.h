@@ -0,0 +1,125 @@
+#pragma once
+
+// Boost 1.74 awaitable.hpp uses std::exchange without including <utility>
+#include <utility>
+#include <boost/asio.hpp>
+#include "config.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace net = boost::asio;
+
+/**
+ * @brief 読み取り側がロックを取らずに最新版を参照できる設定スナップショット
+ *
+ * publish() は新しい版を作って差し替えるだけで、古い版は破棄しません。
+ * 読み取り側はいつ取得した参照でも安全に使い続けられます
+ * （設定の再読み込みは稀なので、保持するメモリはわずかです）。
+ */
+template <typename T>
+class RcuSnapshot {
+public:
+    explicit RcuSnapshot(T initial) {
+        publish(std::move(initial));
+    }
+
+    /**
+     * @brief 最新版を取得（ウェイトフリー、任意のスレッドから呼び出し可能）
+     */
+    const T& get() const noexcept {
+        return *current_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief 新しい版を公開
+     */
+    void publish(T value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        versions_.push_back(std::make_unique<const T>(std::move(value)));
+        current_.store(versions_.back().get(), std::memory_order_release);
+    }
+
+private:
+    std::atomic<const T*> current_{nullptr};
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<const T>> versions_;
+};
+
+/**
+ * @brief 設定ファイルを監視し、変更を稼働中のパイプラインに反映するクラス
+ *
+ * inotify で設定ファイルのあるディレクトリを監視し（エディタによる
+ * 置き換え保存にも対応）、変更されると再読み込みして検証します。
+ * 音声パイプラインの設定（AudioTuning）は即座に差し替え、
+ * モデル設定など新しいセッションが必要な項目は報告します。
+ * 不正な設定は拒否され、現在の設定が維持されます。
+ */
+class ConfigWatcher {
+public:
+    using ReloadCallback = std::function<void(const AudioTuning& tuning,
+                                              const std::vector<std::string>& session_fields)>;
+
+    /**
+     * @brief ConfigWatcherのコンストラクタ
+     *
+     * @param io_context 使用するIOコンテキスト（呼び出し側で run() すること）
+     * @param config_path 監視する設定ファイル
+     * @param session_config 現在のセッションで使用中の設定
+     */
+    ConfigWatcher(net::io_context& io_context, const std::string& config_path, const Config& session_config);
+
+    /**
+     * @brief デストラクタ
+     */
+    ~ConfigWatcher();
+
+    /**
+     * @brief 監視を開始
+     *
+     * @return true 開始成功
+     * @return false inotifyを使用できない
+     */
+    bool start();
+
+    /**
+     * @brief 監視を停止
+     *
+     * 戻った後は、まだキューにあるハンドラもこのオブジェクトに触れません（任意のスレッドから呼び出し可能）。
+     * inotify の記述子は strand 上で閉じます。
+     */
+    void stop();
+
+    /**
+     * @brief 現在の音声パイプライン設定（任意のスレッドから呼び出し可能）
+     */
+    const AudioTuning& tuning() const noexcept { return tuning_.get(); }
+
+    /**
+     * @brief 設定を反映したときのコールバックを設定
+     */
+    void set_reload_callback(ReloadCallback callback) { reload_callback_ = std::move(callback); }
+
+    /**
+     * @brief 設定ファイルを今すぐ再読み込み
+     *
+     * @return true 検証に通り反映した
+     * @return false 読み込みまたは検証に失敗（現在の設定を維持）
+     */
+    bool reload();
+
+private:
+    struct Watch;
+
+    static void do_read(const std::shared_ptr<Watch>& watch);
+    static void schedule_reload(const std::shared_ptr<Watch>& watch);
+
+    std::shared_ptr<Watch> watch_;      // inotify state, shared with handlers that may outlive the watcher
+    std::string config_path_;
+    Config session_config_;
+    RcuSnapshot<AudioTuning> tuning_;
+    ReloadCallback reload_callback_;
+};
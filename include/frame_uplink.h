@@ -0,0 +1,109 @@
+#pragma once
+
+#include "image_frame.h"
+#include "websocket_client.h"
+#include "histogram.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 画像フレーム送信の設定
+ */
+struct FrameUplinkOptions {
+    double fps = 1.0;                   // 送信する最大フレームレート
+    int max_width = 768;                // 縮小後の最大幅
+    int max_height = 768;               // 縮小後の最大高さ
+    int jpeg_quality = 70;              // JPEGの品質（1-100）
+    double min_change = 0.01;           // 変化したブロックの割合がこれ未満なら送らない（0で重複除去なし）
+    int block_threshold = 6;            // ブロックを変化ありとみなす1バイトあたりの平均差分
+};
+
+/**
+ * @brief 画面やカメラのフレームを realtimeInput として送る段
+ *
+ * submit() に渡したフレームを、(1) fps の上限、(2) 前のフレームがまだ送信キューにあるか、
+ * (3) 縮小後に前回送ったフレームとほぼ同じか、の順に確認し、残ったものだけを
+ * JPEG にエンコードして WebSocketClient::send_bulk() で送ります。
+ * 音声は低優先度のフレームを追い越すため、フレームの後ろで待たされることはありません。
+ * submit() は1つのスレッドから呼び出してください。
+ */
+class FrameUplink {
+public:
+    /**
+     * @brief 送信の統計情報
+     */
+    struct Stats {
+        uint64_t offered = 0;           // submit() されたフレーム数
+        uint64_t sent = 0;              // 送信したフレーム数
+        uint64_t rate_limited = 0;      // fps の上限で捨てたフレーム数
+        uint64_t congested = 0;         // 前のフレームが送信待ちで捨てたフレーム数
+        uint64_t duplicates = 0;        // 前回とほぼ同じで捨てたフレーム数
+        uint64_t bytes_sent = 0;        // 送信したJPEGのバイト数（base64前）
+    };
+
+    /**
+     * @brief FrameUplinkのコンストラクタ
+     *
+     * @param client 送信先（接続済みであること）
+     * @param options 設定
+     */
+    FrameUplink(WebSocketClient& client, const FrameUplinkOptions& options);
+
+    /**
+     * @brief フレームを1枚渡す
+     *
+     * @param frame RGB24のフレーム
+     * @param now 現在時刻（fps の判定に使用）
+     * @return true 送信キューに積んだ
+     * @return false 間引いた
+     */
+    bool submit(const ImageFrame& frame, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    /**
+     * @brief 統計情報を取得（任意のスレッドから呼び出し可能）
+     */
+    Stats get_stats() const;
+
+    /**
+     * @brief 縮小・比較・エンコードにかかった時間の分布（マイクロ秒、送ったフレームのみ）
+     */
+    const Histogram& encode_latency() const { return encode_us_; }
+
+    const FrameUplinkOptions& options() const { return options_; }
+
+private:
+    WebSocketClient& client_;
+    FrameUplinkOptions options_;
+    std::chrono::steady_clock::duration interval_;
+    std::chrono::steady_clock::time_point next_send_;
+
+    ImageFrame scaled_;                 // Downscaled current frame
+    ImageFrame last_sent_;              // Downscaled frame most recently sent
+    std::vector<uint8_t> jpeg_;
+
+    std::atomic<uint64_t> offered_{0};
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> rate_limited_{0};
+    std::atomic<uint64_t> congested_{0};
+    std::atomic<uint64_t> duplicates_{0};
+    std::atomic<uint64_t> bytes_sent_{0};
+    Histogram encode_us_;
+};
+
+/**
+ * @brief フレームの入力元から読み取って FrameUplink に渡す（入力が尽きるまでブロック）
+ *
+ * source がディレクトリなら中の *.ppm を名前順に fps の間隔で1枚ずつ渡します。
+ * それ以外（"-" で標準入力、FIFO、ファイル）は連結したPPMのストリームとして、
+ * 届いた順にすべて渡します（間引きは FrameUplink が行います）。
+ *
+ * @param source 入力元
+ * @param uplink 送信段
+ * @param keep_running false を返すと途中で終了
+ * @return std::size_t 読み取ったフレーム数
+ */
+std::size_t stream_frames(const std::string& source, FrameUplink& uplink, const std::function<bool()>& keep_running);
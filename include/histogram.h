@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief 対数線形バケットによる固定サイズのヒストグラム
+ *
+ * 2のべき乗ごとに16個のサブバケットを持ち、相対誤差は約6%です。
+ * record() はアトミック加算のみで完了する（ウェイトフリー）ため、
+ * 音声コールバックやIOスレッドのホットパスから呼び出せます。
+ */
+class Histogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    Histogram();
+
+    /**
+     * @brief 値を1件記録
+     *
+     * @param value 記録する値（単位は呼び出し側で統一すること）
+     */
+    void record(uint64_t value) noexcept {
+        counts_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 記録件数を取得
+     */
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 記録値の合計を取得
+     */
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 平均値を取得（記録がない場合は0）
+     */
+    double mean() const;
+
+    /**
+     * @brief 最小値を取得（バケット精度）
+     */
+    uint64_t min() const;
+
+    /**
+     * @brief 最大値を取得（バケット精度）
+     */
+    uint64_t max() const;
+
+    /**
+     * @brief パーセンタイル値を取得
+     *
+     * @param percentile 0.0 ～ 100.0
+     * @return uint64_t 該当バケットの上限値（記録がない場合は0）
+     */
+    uint64_t percentile(double percentile) const;
+
+    /**
+     * @brief 別のヒストグラムの内容を加算
+     */
+    void merge(const Histogram& other);
+
+    /**
+     * @brief すべての記録を破棄
+     */
+    void reset();
+
+    /**
+     * @brief 1行の要約文字列を生成
+     *
+     * @param unit 値の単位（例: "us"）
+     * @return std::string "n=... min=... p50=... p99=... p999=... max=..." 形式
+     */
+    std::string summary(const std::string& unit) const;
+
+    /**
+     * @brief バケットごとの件数を取得
+     */
+    uint64_t bucket_count(int index) const {
+        return counts_[index].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 値が属するバケットのインデックスを計算
+     */
+    static constexpr int bucket_index(uint64_t value) noexcept {
+        if (value < SUB_BUCKETS) {
+            return static_cast<int>(value);
+        }
+        int msb = 63 - std::countl_zero(value);
+        int shift = msb - SUB_BUCKET_BITS;
+        return (shift + 1) * SUB_BUCKETS + static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    /**
+     * @brief バケットに含まれる最小値
+     */
+    static uint64_t bucket_lower_bound(int index);
+
+    /**
+     * @brief バケットに含まれる最大値
+     */
+    static uint64_t bucket_upper_bound(int index);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> counts_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief RGB24の画像フレーム（行の間に詰め物なし）
+ */
+struct ImageFrame {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> rgb;   // width * height * 3 バイト
+
+    bool empty() const { return width <= 0 || height <= 0; }
+};
+
+/**
+ * @brief バイナリPPM（P6、最大値255）を1枚読み取る
+ *
+ * 連結したPPMのストリーム（ffmpeg の -f image2pipe -vcodec ppm など）から
+ * 続けて呼び出すと、1回に1フレームずつ読み取ります。
+ * 幅・高さが 8192 を超えるフレームは確保せずにエラーにします。
+ *
+ * @param input 入力ストリーム（バイナリモード）
+ * @param frame 読み取ったフレーム（出力、確保済みの容量は再利用）
+ * @param error 失敗時の理由（出力、ストリームの終端なら空）
+ * @return true 読み取り成功
+ * @return false 形式の誤り、またはストリームの終端
+ */
+bool read_ppm(std::istream& input, ImageFrame& frame, std::string& error);
+
+/**
+ * @brief 縦横比を保って max_width x max_height に収まるよう縮小（拡大はしない）
+ *
+ * 各出力画素は対応する入力画素の平均（ボックスフィルタ）です。
+ *
+ * @param input 入力フレーム
+ * @param max_width 出力の最大幅
+ * @param max_height 出力の最大高さ
+ * @param output 出力フレーム（確保済みの容量は再利用）
+ */
+void downscale_frame(const ImageFrame& input, int max_width, int max_height, ImageFrame& output);
+
+/**
+ * @brief 2枚のフレームで変化した16x16ブロックの割合を求める
+ *
+ * ブロックごとの差分絶対値の和をSIMD（SSE2/NEON、なければスカラー）で計算し、
+ * 1バイトあたりの平均差分が threshold を超えたブロックを変化ありとします。
+ *
+ * @param previous 前のフレーム
+ * @param current 今のフレーム
+ * @param threshold 1バイトあたりの平均差分のしきい値（0-255）
+ * @return double 変化したブロックの割合（0.0-1.0、サイズが違えば 1.0）
+ */
+double changed_block_fraction(const ImageFrame& previous, const ImageFrame& current, int threshold);
+
+/**
+ * @brief 差分絶対値の和（SIMD版、changed_block_fraction の内部でも使用）
+ */
+uint64_t sum_abs_diff(const uint8_t* a, const uint8_t* b, std::size_t size);
+
+/**
+ * @brief ベースラインJPEG（YCbCr 4:2:0、標準ハフマン表）にエンコード
+ *
+ * @param frame 入力フレーム
+ * @param quality 品質（1-100、IJGと同じ量子化表の倍率）
+ * @param output JPEGのバイト列（出力、確保済みの容量は再利用）
+ */
+void encode_jpeg(const ImageFrame& frame, int quality, std::vector<uint8_t>& output);
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief メッセージ1件分のJSON処理に使うスレッドごとのモノトニックアリーナ
+ *
+ * JsonArena::Scope の間、arena_json（ArenaAllocator を使う basic_json）の
+ * オブジェクト・配列・文字列はすべてこのアリーナから確保され、解放は何もしません。
+ * 最も外側の Scope を抜けるとアリーナ全体をまとめて巻き戻します。
+ * 初期バッファに収まらなかった分はヒープから確保し、次のメッセージからは
+ * バッファをその大きさまで広げるため、定常状態ではヒープ確保が発生しません。
+ *
+ * 注意: arena_json の値を Scope の外に持ち出してはいけません。
+ */
+class JsonArena {
+public:
+    /**
+     * @brief 呼び出し元スレッドのアリーナを有効にするRAIIヘルパー（入れ子可）
+     */
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        JsonArena& arena_;
+    };
+
+    /**
+     * @brief JsonArenaのコンストラクタ
+     *
+     * @param initial_size 初期バッファのバイト数
+     * @param max_size 広げるバッファの上限（これを超えるメッセージは毎回ヒープを使う）
+     */
+    explicit JsonArena(std::size_t initial_size = 64 * 1024, std::size_t max_size = 4 * 1024 * 1024);
+
+    /**
+     * @brief 呼び出し元スレッドのアリーナを取得
+     */
+    static JsonArena& thread_arena();
+
+    /**
+     * @brief 現在の確保先（Scope の中ならアリーナ、外なら new/delete）
+     */
+    static std::pmr::memory_resource* current() noexcept;
+
+    /**
+     * @brief 現在のバッファのバイト数
+     */
+    std::size_t capacity() const { return size_; }
+
+    /**
+     * @brief バッファに収まらずヒープから確保した回数（累積）
+     */
+    uint64_t overflows() const { return overflows_; }
+
+private:
+    // Upstream of the monotonic resource; records how far a message overflowed the buffer
+    class OverflowResource : public std::pmr::memory_resource {
+    public:
+        std::size_t bytes = 0;
+        uint64_t count = 0;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    void reset();
+
+    std::size_t size_;
+    std::size_t max_size_;
+    std::unique_ptr<std::byte[]> buffer_;
+    OverflowResource overflow_;
+    std::optional<std::pmr::monotonic_buffer_resource> resource_;
+    int depth_ = 0;
+    uint64_t overflows_ = 0;
+};
+
+/**
+ * @brief JsonArena::current() から確保するステートレスなアロケータ
+ *
+ * nlohmann::basic_json はアロケータを既定構築するため、確保先はスレッドの状態で切り替えます。
+ */
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    ArenaAllocator() noexcept = default;
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(JsonArena::current()->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        JsonArena::current()->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>&) const noexcept { return true; }
+};
+
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+/**
+ * @brief ノードと文字列を JsonArena から確保する basic_json
+ */
+using arena_json = nlohmann::basic_json<std::map, std::vector, ArenaString, bool, std::int64_t, std::uint64_t,
+                                        double, ArenaAllocator>;
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "histogram.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+
+/**
+ * @brief 音声パイプラインのエンドツーエンド遅延を計測するクラス
+ *
+ * 上り（キャプチャ → チャンク送信）と下り（受信 → デコード → 再生バッファ投入 →
+ * playback_callback での最初のサンプル消費）の各段階に単調時刻を記録し、
+ * チャンクごとの段階別遅延とターンごとの最初の音声までの時間（TTFA）を
+ * ヒストグラムに集計します。
+ *
+ * 下りのチャンクは受信順の累積サンプル位置で追跡するため、
+ * デコードしたすべての音声を順番どおりに on_enqueue() へ渡す必要があります。
+ * 各フックは異なるスレッド（キャプチャ、IO、再生、オーディオデバイス）から呼び出せます。
+ */
+class LatencyTracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief LatencyTracerのコンストラクタ
+     *
+     * @param voice_threshold 発話とみなすキャプチャ区間のピーク振幅
+     */
+    explicit LatencyTracer(int voice_threshold = 1000);
+
+    /**
+     * @brief 再生デバイスの有無を設定（false の場合はバッファ投入で計測を完了）
+     */
+    void set_playout_enabled(bool enabled) { playout_enabled_ = enabled; }
+
+    /**
+     * @brief キャプチャ区間を記録（キャプチャスレッド）
+     *
+     * 閾値を超える音声を含む区間を発話の終わりの候補として記録します。
+     */
+    void on_capture(const int16_t* samples, std::size_t count, Clock::time_point captured);
+
+    /**
+     * @brief 上りチャンクの送信を記録
+     *
+     * @param first_captured チャンクの先頭サンプルをキャプチャした時刻
+     * @param sent 送信キューへ渡した時刻
+     */
+    void on_uplink_send(Clock::time_point first_captured, Clock::time_point sent);
+
+    /**
+     * @brief キャプチャを伴わない上りチャンク（合成音声など）の送信を記録
+     */
+    void on_uplink_send(Clock::time_point sent);
+
+    /**
+     * @brief 受信した音声チャンクを記録（IOスレッド）
+     *
+     * @param samples デコード後のサンプル数
+     * @param received メッセージを受信した時刻
+     * @param decoded デコードが完了した時刻
+     */
+    void on_downlink_audio(std::size_t samples, Clock::time_point received, Clock::time_point decoded);
+
+    /**
+     * @brief 再生バッファへの投入を記録（play_audio() の直前に呼び出すこと）
+     */
+    void on_enqueue(std::size_t samples, Clock::time_point enqueued);
+
+    /**
+     * @brief 再生デバイスが消費した累積サンプル数を記録（オーディオデバイスのスレッド）
+     *
+     * ロックを取らずにキューへ渡すだけで、集計は他のフックが次に呼ばれたときに行います。
+     */
+    void on_playout(uint64_t played_total, Clock::time_point played);
+
+    /**
+     * @brief ターンの終了（turnComplete または interrupted）を記録し、ターンの要約を出力
+     */
+    void on_turn_end(bool interrupted, std::ostream& out);
+
+    /**
+     * @brief 全体の要約を出力
+     */
+    void print_summary(std::ostream& out) const;
+
+private:
+    struct ChunkTrace {
+        uint64_t start = 0;             // 累積サンプル位置
+        Clock::time_point received;
+        Clock::time_point decoded;
+        Clock::time_point enqueued;
+        bool is_enqueued = false;
+        bool first_of_turn = false;
+        Clock::time_point speech_end;   // first_of_turn の場合の基準時刻
+    };
+
+    // Playout progress published by the audio device thread
+    struct PlayoutMark {
+        uint64_t played_total = 0;
+        Clock::time_point played;
+    };
+
+    void drain_playout();
+    void complete_front(Clock::time_point played);
+
+    const int voice_threshold_;
+    std::atomic<bool> playout_enabled_{true};
+
+    // Uplink reference points, written by the capture thread
+    std::atomic<int64_t> last_voice_ns_{0};
+    std::atomic<int64_t> last_send_ns_{0};
+
+    // Written lock-free by on_playout(); consumed under mutex_, which keeps a single consumer
+    SpscQueue<PlayoutMark> playout_marks_{1024};
+    uint64_t last_played_total_ = 0;    // Audio device thread only
+
+    // Downlink chunks in flight and turn state
+    mutable std::mutex mutex_;
+    std::deque<ChunkTrace> chunks_;
+    uint64_t decoded_total_ = 0;
+    uint64_t enqueued_total_ = 0;
+    bool in_turn_ = false;
+    int turn_index_ = 0;
+    int64_t turn_ttfa_us_ = -1;
+    int64_t turn_response_us_ = -1;
+
+    // Per-chunk stage latencies (us)
+    Histogram capture_to_send_us_;
+    Histogram receive_to_decode_us_;
+    Histogram decode_to_enqueue_us_;
+    Histogram enqueue_to_playout_us_;
+    Histogram receive_to_playout_us_;
+    Histogram turn_chunk_us_;           // receive_to_playout for the current turn
+
+    // Per-turn latencies (us)
+    Histogram response_us_;             // speech end to first audio received
+    Histogram ttfa_us_;                 // speech end to first sample played
+};
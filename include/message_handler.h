@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 
@@ -41,6 +42,42 @@ public:
         const std::string& mime_type = "audio/pcm;rate=16000"
     );
 
+    /**
+     * @brief PCMのバイト列から音声入力メッセージを構築（中間バッファを作らない）
+     * 
+     * 出力は create_audio_input_message() と同じJSONです。
+     * 
+     * @param pcm 16-bit PCM（リトルエンディアン）のバイト列
+     * @param size バイト数
+     * @param mime_type MIMEタイプ（JSONのエスケープが不要な文字列）
+     * @param message 出力先（上書きし、確保済みの容量は再利用）
+     */
+    static void build_audio_input_message(
+        const uint8_t* pcm,
+        std::size_t size,
+        const std::string& mime_type,
+        std::string& message
+    );
+
+    /**
+     * @brief リアルタイム画像入力メッセージを構築（音声と同じ mediaChunks 形式）
+     * 
+     * @param image エンコード済みの画像（JPEGなど）
+     * @param mime_type MIMEタイプ（デフォルト: "image/jpeg"）
+     * @return std::string JSON形式の画像入力メッセージ
+     */
+    static std::string create_image_input_message(
+        const std::vector<uint8_t>& image,
+        const std::string& mime_type = "image/jpeg"
+    );
+
+    /**
+     * @brief 音声入力の終了を伝えるメッセージを構築
+     * 
+     * @return std::string JSON形式のメッセージ（realtimeInput.audioStreamEnd）
+     */
+    static std::string create_audio_stream_end_message();
+
     /**
      * @brief base64エンコード
      * 
@@ -66,7 +103,7 @@ public:
      * @return false 音声データが見つからなかった
      */
     static bool extract_audio_from_response(
-        const std::string& json_response,
+        std::string_view json_response,
         std::vector<int16_t>& audio_data
     );
 
@@ -79,7 +116,7 @@ public:
      * @return false 文字起こしが見つからなかった
      */
     static bool extract_transcription_from_response(
-        const std::string& json_response,
+        std::string_view json_response,
         std::string& transcription
     );
 
@@ -90,7 +127,7 @@ public:
      * @return true ユーザー入力の文字起こし
      * @return false その他のメッセージ
      */
-    static bool is_user_input_transcription(const std::string& json_response);
+    static bool is_user_input_transcription(std::string_view json_response);
 
     /**
      * @brief レスポンスがターン完了を示しているか確認
@@ -99,7 +136,25 @@ public:
      * @return true ターン完了
      * @return false ターン未完了
      */
-    static bool is_turn_complete(const std::string& json_response);
+    static bool is_turn_complete(std::string_view json_response);
+
+    /**
+     * @brief レスポンスがモデル応答の中断（interrupted）を示しているか確認
+     * 
+     * @param json_response JSON形式のサーバーレスポンス
+     * @return true 中断された
+     * @return false 中断されていない
+     */
+    static bool is_interrupted(std::string_view json_response);
+
+    /**
+     * @brief レスポンスがセットアップ完了通知（setupComplete）か確認
+     * 
+     * @param json_response JSON形式のサーバーレスポンス
+     * @return true セットアップ完了
+     * @return false その他のメッセージ
+     */
+    static bool is_setup_complete(std::string_view json_response);
 
     /**
      * @brief int16のベクトルをuint8のベクトルに変換
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "histogram.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief スレッドごとに分割したカウンタ
+ *
+ * 加算は呼び出しスレッドに割り当てられたシャード（キャッシュライン単位）への
+ * relaxed なアトミック加算のみで、スレッド間で競合しません。
+ * 値の読み出し時に全シャードを合計します。
+ */
+class Counter {
+public:
+    static constexpr std::size_t SHARDS = 32;
+
+    void inc(uint64_t n = 1) noexcept {
+        shards_[shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const noexcept;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+
+    static std::size_t shard_index() noexcept;
+
+    std::array<Shard, SHARDS> shards_;
+};
+
+/**
+ * @brief 現在値を保持するゲージ
+ */
+class Gauge {
+public:
+    void set(int64_t value) noexcept { value_.store(value, std::memory_order_relaxed); }
+    void add(int64_t delta) noexcept { value_.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+/**
+ * @brief アプリケーション全体のメトリクスを保持するレジストリ
+ *
+ * 登録（起動時やホットパスの初回呼び出し時）だけがロックを取り、
+ * 返された参照への更新はロックフリーです。登録したメトリクスは
+ * プロセス終了まで破棄されないため、参照を static 変数に保持できます。
+ * ヒストグラムは既存の Histogram（ウェイトフリー）を使い、
+ * 出力時に固定の境界値へ集約します。
+ */
+class MetricsRegistry {
+public:
+    /**
+     * @brief プロセス共通のレジストリを取得
+     */
+    static MetricsRegistry& instance();
+
+    /**
+     * @brief カウンタを取得（未登録なら登録）
+     *
+     * 各取得関数は、同じ名前が別の種類で登録済みなら std::logic_error を投げます。
+     *
+     * @param name メトリクス名（Prometheusの命名規則に従うこと）
+     * @param help 説明文
+     */
+    Counter& counter(const std::string& name, const std::string& help);
+
+    /**
+     * @brief ゲージを取得（未登録なら登録）
+     */
+    Gauge& gauge(const std::string& name, const std::string& help);
+
+    /**
+     * @brief ヒストグラムを取得（未登録なら登録）
+     *
+     * @param name メトリクス名
+     * @param help 説明文
+     * @param bounds 出力するバケットの上限値（記録値と同じ単位、昇順）
+     * @param scale 出力時に値へ掛ける係数（例: us で記録して秒で出力するなら 1e-6）
+     */
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         std::vector<uint64_t> bounds, double scale = 1.0);
+
+    /**
+     * @brief Prometheusのテキスト形式で全メトリクスを出力
+     */
+    std::string render_prometheus() const;
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Entry {
+        std::string name;
+        std::string help;
+        Type type;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+        std::vector<uint64_t> bounds;
+        double scale = 1.0;
+    };
+
+    Entry* find(const std::string& name, Type type);
+
+    mutable std::mutex mutex_;
+    std::deque<Entry> entries_;
+};
+
+/**
+ * @brief プロセス共通のレジストリを取得する短縮形
+ */
+inline MetricsRegistry& metrics() {
+    return MetricsRegistry::instance();
+}
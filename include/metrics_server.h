@@ -0,0 +1,55 @@
+#pragma once
+
+#include "websocket_client.h"
+#include <boost/beast/http.hpp>
+#include <string>
+
+/**
+ * @brief メトリクスをPrometheusのテキスト形式で公開する小さなHTTPサーバー
+ *
+ * GET /metrics に MetricsRegistry の内容を返します。
+ * それ以外のパスには 404 を返します。既定ではローカルホストでのみ待ち受けます。
+ */
+class MetricsServer {
+public:
+    /**
+     * @brief MetricsServerのコンストラクタ
+     *
+     * @param io_context 使用するIOコンテキスト（呼び出し側で run() すること）
+     * @param port 待ち受けポート（0で自動割り当て）
+     * @param address 待ち受けアドレス
+     */
+    MetricsServer(net::io_context& io_context, unsigned short port,
+                  const std::string& address = "127.0.0.1");
+
+    /**
+     * @brief デストラクタ
+     */
+    ~MetricsServer();
+
+    /**
+     * @brief 待ち受けを開始
+     *
+     * @return true 開始成功
+     * @return false バインド失敗
+     */
+    bool start();
+
+    /**
+     * @brief 待ち受けを停止
+     */
+    void stop();
+
+    /**
+     * @brief 実際に待ち受けているポート番号
+     */
+    unsigned short port() const;
+
+private:
+    void do_accept();
+
+    net::io_context& io_context_;
+    tcp::acceptor acceptor_;
+    std::string address_;
+    unsigned short port_;
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "websocket_client.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief モックサーバーの動作設定
+ */
+struct MockServerOptions {
+    std::string address = "127.0.0.1";                      // 待ち受けアドレス
+    unsigned short port = 0;                                // 待ち受けポート（0で自動割り当て）
+    int sample_rate = 24000;                                // 送信音声のサンプルレート
+    std::chrono::milliseconds chunk_duration{40};           // 1メッセージあたりの音声長
+    double rate = 1.0;                                      // 送信速度（1.0で実時間、0で最大速度）
+    int burst = 1;                                          // 1回にまとめて送るチャンク数
+    int turn_trigger_chunks = 10;                           // ターン開始までに受け取る音声チャンク数（0でセットアップ直後）
+    std::chrono::milliseconds response_delay{200};          // ユーザー入力から応答開始までの遅延
+    std::chrono::milliseconds turn_duration{2000};          // 1ターンの応答音声の長さ
+    std::string input_transcript = "Hello.";                // ユーザー入力の文字起こし
+    std::string output_transcript = "This is a synthetic response from the mock server.";
+    int interrupt_every = 0;                                // Nターンごとに途中で interrupted を送る（0で無効）
+    int goaway_after_turns = 0;                             // Nターン後に goAway を送って切断（0で無効）
+    std::vector<int16_t> script_audio;                      // 空でなければ正弦波の代わりにこのPCMを送信
+};
+
+/**
+ * @brief BidiGenerateContentプロトコルを話すローカルのモックサーバー
+ * 
+ * setup を受け取ると setupComplete を返し、音声入力を受け取るたびに
+ * 合成（またはスクリプト指定）のPCM音声と文字起こしを設定した速度で返します。
+ * interrupted、turnComplete、goAway にも対応しています。
+ * 平文の ws:// のみをサポートします。
+ */
+class MockGeminiServer {
+public:
+    /**
+     * @brief サーバーの統計情報
+     */
+    struct Stats {
+        uint64_t connections = 0;
+        uint64_t messages_received = 0;
+        uint64_t messages_sent = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t turns_completed = 0;
+    };
+
+    /**
+     * @brief MockGeminiServerのコンストラクタ
+     * 
+     * @param io_context 使用するIOコンテキスト（呼び出し側で run() すること）
+     * @param options 動作設定
+     */
+    MockGeminiServer(net::io_context& io_context, const MockServerOptions& options);
+
+    /**
+     * @brief デストラクタ
+     */
+    ~MockGeminiServer();
+
+    /**
+     * @brief 待ち受けを開始
+     * 
+     * @return true 開始成功
+     * @return false バインド失敗
+     */
+    bool start();
+
+    /**
+     * @brief 待ち受けを停止
+     */
+    void stop();
+
+    /**
+     * @brief 実際に待ち受けているポート番号
+     */
+    unsigned short port() const;
+
+    /**
+     * @brief このサーバーへ接続するためのエンドポイント
+     */
+    WebSocketClient::Endpoint endpoint() const;
+
+    /**
+     * @brief 統計情報を取得（任意のスレッドから呼び出し可能）
+     */
+    Stats get_stats() const;
+
+    /**
+     * @brief 接続ごとの処理と共有するカウンタ
+     */
+    struct Counters {
+        std::atomic<uint64_t> connections{0};
+        std::atomic<uint64_t> messages_received{0};
+        std::atomic<uint64_t> messages_sent{0};
+        std::atomic<uint64_t> bytes_sent{0};
+        std::atomic<uint64_t> turns_completed{0};
+    };
+
+private:
+    void do_accept();
+
+    net::io_context& io_context_;
+    std::shared_ptr<const MockServerOptions> options_;
+    tcp::acceptor acceptor_;
+    std::shared_ptr<Counters> counters_;
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "websocket_client.h"
+#include "session_pool.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+/**
+ * @brief PCMゲートウェイのワイヤーフォーマット
+ *
+ * 接続直後にクライアントは16バイトのヘッダー（リトルエンディアン）を送ります。
+ *   0: "GPCM"  4: バージョン (1)  5: フラグ (bit0: Google検索)  6-7: 予約
+ *   8: 入力サンプルレート (u32)  12: 続くセッション設定JSONのバイト数 (u32, 0で省略)
+ * セッション設定JSONでは "model", "systemInstruction", "temperature", "topP",
+ * "topK", "enableSearch" を上書きできます。
+ * ゲートウェイは setupComplete を受け取るかエラーになった時点で16バイトの応答を返します。
+ *   0: "GPCM"  4: バージョン  5: ステータス (GatewayStatus)  6-7: 予約
+ *   8: 出力サンプルレート (u32)  12: 予約 (u32)
+ * 以降、クライアントからは入力レートの、ゲートウェイからは出力レートの
+ * s16le モノラルPCMがそのまま流れます。
+ */
+namespace gateway_protocol {
+
+constexpr char MAGIC[4] = {'G', 'P', 'C', 'M'};
+constexpr uint8_t VERSION = 1;
+constexpr std::size_t HEADER_SIZE = 16;
+constexpr uint8_t FLAG_ENABLE_SEARCH = 0x01;
+constexpr uint32_t MAX_CONFIG_SIZE = 64 * 1024;
+
+enum class Status : uint8_t {
+    Ok = 0,
+    BadHeader = 1,          // マジック・バージョン・サンプルレートが不正
+    BadConfig = 2,          // セッション設定JSONが不正
+    UpstreamFailed = 3,     // Geminiへの接続に失敗
+    SetupTimeout = 4,       // setupComplete が届かない
+    Busy = 5                // 同時接続数の上限
+};
+
+}  // namespace gateway_protocol
+
+/**
+ * @brief PCMゲートウェイの設定
+ */
+struct PcmGatewayOptions {
+    std::string socket_path;                                // Unixドメインソケットのパス
+    WebSocketClient::Endpoint endpoint;                     // Geminiの接続先
+    std::string model_name = "gemini-2.5-flash-native-audio-preview-09-2025";
+    std::string system_instruction;
+    double temperature = 1.0;
+    double top_p = 0.95;
+    int top_k = 40;
+    bool enable_search = false;
+    std::chrono::milliseconds chunk_duration{100};          // 1回に送信する音声の長さ
+    std::chrono::milliseconds setup_timeout{10000};         // 接続から setupComplete までを待つ時間
+    std::chrono::milliseconds drain_timeout{10000};         // 入力終了後に応答を待つ時間
+    std::size_t max_calls = 0;                              // 同時接続数の上限（0で無制限）
+    std::size_t max_pending_chunks = 256;                   // 書き込み待ちの受信音声の上限
+    std::size_t warm_sessions = 0;                          // 待機させておくセッション数（0でプールなし）
+    std::chrono::milliseconds warm_max_idle{std::chrono::minutes(5)};   // 待機セッションを作り直すまでの時間
+    int output_sample_rate = 24000;
+};
+
+/**
+ * @brief Unixドメインソケットの各接続を1つのGeminiセッションに中継するゲートウェイ
+ *
+ * 音声デバイスを使わずに、電話のメディアサーバーなどから生のPCMを受け取り、
+ * モデルのPCMを返します。受信したPCMは送信用バッファに直接読み込んでそのまま
+ * エンコードし、受信音声はデコードしたバッファから直接ソケットに書き込みます。
+ * 接続ごとの処理は WebSocketClient の strand 上で行われるため、
+ * 複数スレッドで回る io_context を共有できます。
+ * Geminiへの接続（ハンドシェイク）は非同期で行い、スレッドをブロックしません。
+ * warm_sessions を指定すると、既定のセッション設定の着信には
+ * SessionPool で待機させておいたセッションを渡し、接続とセットアップを省きます。
+ */
+class PcmGateway {
+public:
+    class Call;
+
+    /**
+     * @brief ゲートウェイの統計情報
+     */
+    struct Stats {
+        uint64_t calls_accepted = 0;
+        uint64_t calls_rejected = 0;
+        uint64_t active_calls = 0;
+        uint64_t uplink_bytes = 0;
+        uint64_t downlink_bytes = 0;
+        uint64_t downlink_dropped_chunks = 0;
+        SessionPool::Stats pool;                // warm_sessions > 0 の場合のみ
+    };
+
+    /**
+     * @brief PcmGatewayのコンストラクタ
+     *
+     * @param io_context 使用するIOコンテキスト（呼び出し側で run() すること）
+     * @param options 設定
+     */
+    PcmGateway(net::io_context& io_context, const PcmGatewayOptions& options);
+
+    /**
+     * @brief デストラクタ
+     */
+    ~PcmGateway();
+
+    /**
+     * @brief ソケットを作成して待ち受けを開始（残っている古いソケットファイルは削除）
+     *
+     * @return true 開始成功
+     * @return false バインド失敗
+     */
+    bool start();
+
+    /**
+     * @brief 待ち受けを停止し、すべての通話を終了
+     *
+     * 通話は送信待ちの音声を書き終えてから閉じます。完了は wait_for_calls() で待てます。
+     */
+    void stop();
+
+    /**
+     * @brief すべての通話のハンドラが完了するまで待つ（io_context のスレッド以外から呼び出すこと）
+     *
+     * stop() の後、io_context を止める前に呼び出します。timeout までに終わらない通話は
+     * 書き込み途中でも切断し、その完了も待ちます。
+     *
+     * @param timeout 通話が自然に終わるのを待つ時間
+     * @return true timeout までにすべて終了した
+     * @return false 切断した通話がある
+     */
+    bool wait_for_calls(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief 統計情報を取得（任意のスレッドから呼び出し可能）
+     */
+    Stats get_stats() const;
+
+    /**
+     * @brief 待機セッションのプール（warm_sessions が0なら nullptr）
+     */
+    const SessionPool* pool() const { return pool_.get(); }
+
+private:
+    friend class Call;
+
+    void do_accept();
+    void on_call_finished(const std::shared_ptr<Call>& call);
+
+    net::io_context& io_context_;
+    PcmGatewayOptions options_;
+    net::local::stream_protocol::acceptor acceptor_;
+    std::unique_ptr<SessionPool> pool_;
+
+    mutable std::mutex calls_mutex_;
+    std::unordered_set<std::shared_ptr<Call>> calls_;
+    std::size_t live_calls_ = 0;                // Call objects not yet destroyed, released or not
+    std::condition_variable calls_done_;        // Notified when live_calls_ drops to zero
+
+    std::atomic<uint64_t> calls_accepted_{0};
+    std::atomic<uint64_t> calls_rejected_{0};
+    std::atomic<uint64_t> uplink_bytes_{0};
+    std::atomic<uint64_t> downlink_bytes_{0};
+    std::atomic<uint64_t> downlink_dropped_chunks_{0};
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "websocket_client.h"
+#include "transcript_sink.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief パイプモードの設定
+ */
+struct PipeOptions {
+    WebSocketClient::Endpoint endpoint;                     // 接続先
+    std::string setup_message;                              // 接続直後に送るセットアップメッセージ
+    int input_fd = STDIN_FILENO;                            // s16le PCM の入力
+    int output_fd = STDOUT_FILENO;                          // モデルの s16le PCM の出力
+    int input_sample_rate = 16000;
+    uint64_t input_limit = 0;                               // 入力から読むバイト数（0でEOFまで）
+    double speed = 1.0;                                     // 送信速度（1.0で実時間、0でペース制御なし）
+    std::chrono::milliseconds chunk_duration{100};          // 1回に送信する音声の長さ
+    std::chrono::milliseconds setup_timeout{10000};         // setupComplete を待つ時間
+    std::chrono::milliseconds drain_timeout{10000};         // 入力終了後に応答を待つ時間
+    std::size_t max_pending_writes = 32;                    // 送信待ちがこれ以上なら入力の読み込みを待つ
+};
+
+/**
+ * @brief 標準入力のPCMをGeminiに送り、モデルのPCMを標準出力に書き出すクラス
+ *
+ * AudioHandler を使わずに sox や ffmpeg のパイプラインに組み込めます。
+ * 入出力は asio の posix::stream_descriptor によるノンブロッキングI/Oで、
+ * 通常ファイル（epoll 非対応）の場合は同期読み書きに切り替えます。
+ * 入力が終わると audioStreamEnd を送り、次のターン完了（または drain_timeout）で終了します。
+ * すべての処理は WebSocketClient の strand 上で行われます。
+ * 非同期処理のハンドラが所有権を共有するため、std::make_shared で生成してください。
+ */
+class PipeBridge : public std::enable_shared_from_this<PipeBridge> {
+public:
+    /**
+     * @brief 転送の統計情報
+     */
+    struct Stats {
+        uint64_t uplink_bytes = 0;
+        uint64_t downlink_bytes = 0;
+        uint64_t turns = 0;
+        double elapsed_seconds = 0.0;   // setupComplete から終了まで
+        double first_audio_seconds = 0.0;   // setupComplete から最初のモデル音声まで（受信なしで0）
+    };
+
+    /**
+     * @brief PipeBridgeのコンストラクタ
+     *
+     * @param io_context 使用するIOコンテキスト（呼び出し側で run() すること）
+     * @param options 設定
+     * @param transcripts 文字起こしの出力先（nullptrで出力しない）
+     */
+    PipeBridge(net::io_context& io_context, const PipeOptions& options, TranscriptSink* transcripts);
+
+    /**
+     * @brief デストラクタ
+     */
+    ~PipeBridge();
+
+    /**
+     * @brief 接続してセットアップを送信（ブロックしない）
+     *
+     * 接続は strand 上で非同期に行い、失敗や setup_timeout 以内に setupComplete が
+     * 届かない場合は失敗として終了します（succeeded() が false）。
+     */
+    void start();
+
+    /**
+     * @brief 転送を中止（任意のスレッドから呼び出し可能）
+     */
+    void stop();
+
+    /**
+     * @brief 終了時（出力の書き込み完了後）に strand 上で呼ばれるコールバックを設定（start() より前に呼ぶこと）
+     */
+    void set_finished_callback(std::function<void()> callback) { finished_callback_ = std::move(callback); }
+
+    /**
+     * @brief 終了したかどうか（終了すると io_context の処理がなくなる）
+     */
+    bool finished() const { return finished_.load(); }
+
+    /**
+     * @brief セットアップが完了し、エラーなく終了したか
+     */
+    bool succeeded() const { return succeeded_.load(); }
+
+    /**
+     * @brief 統計情報を取得（任意のスレッドから呼び出し可能）
+     */
+    Stats get_stats() const;
+
+private:
+    void on_message(std::string_view message);
+    void read_input();
+    void on_input(beast::error_code ec, std::size_t bytes);
+    void send_chunk();
+    void on_input_closed();
+    void write_output();
+    void finish(bool ok);
+    void complete();
+    void restore_flags();
+
+    PipeOptions options_;
+    TranscriptSink* transcripts_;
+    std::shared_ptr<WebSocketClient> client_;
+    net::posix::stream_descriptor input_;
+    net::posix::stream_descriptor output_;
+    bool input_is_file_ = false;        // Regular files cannot be polled; read them synchronously
+    bool output_is_file_ = false;
+    int input_flags_ = -1;              // File status flags of input_fd/output_fd before asio made them
+    int output_flags_ = -1;             // non-blocking; restored when the bridge completes (-1 when done)
+    net::steady_timer timer_;           // Setup timeout, pacing and the drain timeout
+
+    std::vector<int16_t> chunk_;        // The input is read straight into this
+    std::size_t chunk_fill_ = 0;        // Bytes of chunk_ filled so far
+    uint64_t input_read_ = 0;           // Bytes consumed from the input (for input_limit)
+    std::vector<int16_t> downlink_;
+    std::deque<std::vector<int16_t>> write_queue_;
+    std::size_t write_offset_ = 0;      // Bytes of the front buffer already written
+
+    bool ready_ = false;
+    bool writing_ = false;
+    bool input_closed_ = false;
+    bool stopping_ = false;             // finish() ran; waiting for the output to flush
+    std::atomic<bool> finished_{false};
+    std::atomic<bool> succeeded_{false};
+    std::chrono::steady_clock::time_point started_;
+    uint64_t samples_sent_ = 0;
+
+    std::atomic<uint64_t> uplink_bytes_{0};
+    std::atomic<uint64_t> downlink_bytes_{0};
+    std::atomic<uint64_t> turns_{0};
+    std::atomic<int64_t> elapsed_us_{0};
+    std::atomic<int64_t> first_audio_us_{0};
+    std::function<void()> finished_callback_;
+};
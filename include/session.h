@@ -0,0 +1,175 @@
+#pragma once
+
+#include "websocket_client.h"
+#include "histogram.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief セッションの設定
+ */
+struct SessionOptions {
+    WebSocketClient::Endpoint endpoint;                     // 接続先
+    std::string setup_message;                              // 接続直後に送るセットアップメッセージ
+    std::size_t chunk_samples = 1600;                       // 1回の送信サンプル数
+    std::chrono::milliseconds chunk_interval{100};          // 送信間隔
+    std::string mime_type = "audio/pcm;rate=16000";         // 送信音声のMIMEタイプ
+    std::size_t turn_chunks = 0;                            // 1回の発話のチャンク数（0で区切らずに送り続ける）
+    std::chrono::milliseconds response_timeout{10000};      // 発話後にモデルのターン完了を待つ最大時間
+};
+
+/**
+ * @brief Gemini Live APIとの1つの会話セッション
+ * 
+ * WebSocketClient、送受信バッファ、音声の入出力をセッションごとに持ち、
+ * グローバル状態を共有しません。すべての処理はクライアントのstrand上で
+ * 実行されるため、複数スレッドで回る io_context を共有できます。
+ * ハンドラは weak_ptr で参照するため、std::make_shared で生成してください。
+ */
+class Session : public std::enable_shared_from_this<Session> {
+public:
+    using AudioSource = std::function<void(std::vector<int16_t>&)>;
+    using AudioSink = std::function<void(const std::vector<int16_t>&)>;
+
+    /**
+     * @brief セッションの統計情報
+     */
+    struct Stats {
+        int id = 0;
+        bool connected = false;
+        bool ready = false;                 // setupComplete受信済み
+        uint64_t messages_sent = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t messages_received = 0;
+        uint64_t bytes_received = 0;
+        uint64_t audio_samples_received = 0;
+        uint64_t errors = 0;
+        uint64_t turns_completed = 0;
+        double elapsed_seconds = 0.0;       // start() からの経過時間
+        double connect_ms = -1.0;           // start() から接続完了まで（未完了は負値）
+        double setup_ms = -1.0;             // start() から setupComplete まで
+        double first_audio_ms = -1.0;       // 送信開始から最初の受信音声まで
+    };
+
+    /**
+     * @brief Sessionのコンストラクタ
+     * 
+     * @param io_context 共有するIOコンテキスト
+     * @param id セッション識別子
+     * @param options セッションの設定
+     */
+    Session(net::io_context& io_context, int id, const SessionOptions& options);
+
+    /**
+     * @brief デストラクタ
+     */
+    ~Session();
+
+    /**
+     * @brief 送信音声の供給元を設定（start() より前に呼び出すこと）
+     * 
+     * @param source chunk_samples 個のサンプルで満たすコールバック（未設定時は無音）
+     */
+    void set_audio_source(AudioSource source);
+
+    /**
+     * @brief 受信音声の出力先を設定（start() より前に呼び出すこと）
+     * 
+     * @param sink デコード済みの音声を受け取るコールバック（未設定時は破棄）
+     */
+    void set_audio_sink(AudioSink sink);
+
+    /**
+     * @brief 接続してセッションを開始
+     * 
+     * 接続は strand 上で非同期に行われ、呼び出し元スレッドをブロックしません。
+     * 接続するとセットアップを送信し、setupComplete を受信すると音声の送信を開始します。
+     * 接続の失敗はエラー数に数えられます。
+     */
+    void start();
+
+    /**
+     * @brief セッションを停止
+     * 
+     * 送信を止めてクローズハンドシェイクを開始し、完了は待ちません。
+     * 
+     * @return std::future<void> 切断が完了すると準備完了になる future
+     */
+    std::future<void> stop();
+
+    /**
+     * @brief セッション識別子を取得
+     */
+    int id() const { return id_; }
+
+    /**
+     * @brief 統計情報を取得（任意のスレッドから呼び出し可能）
+     */
+    Stats get_stats() const;
+
+    /**
+     * @brief ターンごとの応答遅延（発話の最後のチャンクの送信から最初の受信音声まで, us）
+     * 
+     * turn_chunks が0の場合は発話の終わりがないため記録しません。
+     */
+    const Histogram& turn_latency_us() const { return turn_latency_us_; }
+
+    /**
+     * @brief ターン中の受信音声メッセージの到着間隔（us）
+     */
+    const Histogram& downlink_gap_us() const { return downlink_gap_us_; }
+
+    /**
+     * @brief 内部のWebSocketクライアントを取得
+     */
+    WebSocketClient& client() { return *client_; }
+
+private:
+    void on_message(std::string_view message);
+    void start_user_turn();
+    void schedule_uplink();
+    void on_uplink_timer(beast::error_code ec);
+
+    int id_;
+    SessionOptions options_;
+    std::shared_ptr<WebSocketClient> client_;     // Released on destruction so queued handlers can drain
+    net::steady_timer uplink_timer_;
+    std::chrono::steady_clock::time_point next_uplink_;
+
+    AudioSource audio_source_;
+    AudioSink audio_sink_;
+    std::vector<int16_t> uplink_chunk_;
+    std::vector<int16_t> downlink_audio_;
+
+    std::atomic<bool> ready_;
+    std::atomic<bool> stopped_;
+    std::atomic<uint64_t> messages_sent_;
+    std::atomic<uint64_t> bytes_sent_;
+    std::atomic<uint64_t> messages_received_;
+    std::atomic<uint64_t> bytes_received_;
+    std::atomic<uint64_t> audio_samples_received_;
+    std::atomic<uint64_t> errors_;
+    std::atomic<uint64_t> turns_completed_;
+    std::chrono::steady_clock::time_point started_at_;
+
+    // Timings in microseconds since started_at_ (negative until reached)
+    std::atomic<int64_t> connected_us_;
+    std::atomic<int64_t> ready_us_;
+    std::atomic<int64_t> first_audio_us_;
+
+    // Turn tracking (accessed only on the strand)
+    bool in_turn_ = false;
+    std::size_t turn_chunks_sent_ = 0;              // Chunks of the current user turn
+    bool awaiting_response_ = false;                // User turn ended; uplink paused until the model answers
+    std::chrono::steady_clock::time_point user_turn_end_;   // When the last chunk of the user turn was sent
+    std::chrono::steady_clock::time_point last_audio_received_;
+    Histogram turn_latency_us_;
+    Histogram downlink_gap_us_;
+};
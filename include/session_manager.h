@@ -0,0 +1,102 @@
+#pragma once
+
+#include "session.h"
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 複数の独立したセッションを1つのio_context上で実行するクラス
+ * 
+ * io_context はCPUコア数に合わせたスレッドプールで実行され、
+ * 各セッションは自分のstrandで直列化されます。
+ */
+class SessionManager {
+public:
+    /**
+     * @brief セッション全体の集計値
+     */
+    struct Totals {
+        std::size_t sessions = 0;
+        std::size_t connected = 0;
+        std::size_t ready = 0;
+        uint64_t messages_sent = 0;
+        uint64_t bytes_sent = 0;
+        uint64_t messages_received = 0;
+        uint64_t bytes_received = 0;
+        uint64_t audio_samples_received = 0;
+        uint64_t errors = 0;
+    };
+
+    /**
+     * @brief SessionManagerのコンストラクタ
+     * 
+     * @param thread_count ワーカースレッド数（0でCPUコア数）
+     */
+    explicit SessionManager(std::size_t thread_count = 0);
+
+    /**
+     * @brief デストラクタ（実行中なら停止）
+     */
+    ~SessionManager();
+
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    /**
+     * @brief セッションを追加（start() より前に呼び出すこと）
+     * 
+     * @param options セッションの設定
+     * @return Session& 追加したセッション（音声の入出力設定に使用）
+     */
+    Session& add_session(const SessionOptions& options);
+
+    /**
+     * @brief スレッドプールを起動し、全セッションの接続を開始
+     */
+    void start();
+
+    /**
+     * @brief 全セッションを閉じてスレッドプールを停止
+     */
+    void stop();
+
+    /**
+     * @brief 共有しているIOコンテキストを取得
+     */
+    net::io_context& io_context() { return io_context_; }
+
+    /**
+     * @brief ワーカースレッド数を取得
+     */
+    std::size_t thread_count() const { return thread_count_; }
+
+    /**
+     * @brief セッション一覧を取得
+     */
+    const std::vector<std::shared_ptr<Session>>& sessions() const { return sessions_; }
+
+    /**
+     * @brief 全セッションの集計値を取得
+     */
+    Totals get_totals() const;
+
+    /**
+     * @brief セッションごとと全体のスループットを出力
+     * 
+     * @param out 出力先
+     * @param per_session true の場合はセッションごとの行も出力
+     */
+    void print_report(std::ostream& out, bool per_session = true) const;
+
+private:
+    net::io_context io_context_;
+    net::executor_work_guard<net::io_context::executor_type> work_guard_;
+    std::size_t thread_count_;
+    std::vector<std::shared_ptr<Session>> sessions_;
+    std::vector<std::thread> threads_;
+    std::chrono::steady_clock::time_point started_at_;
+    bool running_ = false;
+};
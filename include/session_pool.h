@@ -0,0 +1,136 @@
+#pragma once
+
+#include "websocket_client.h"
+#include "histogram.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief ウォームスタンバイのセッションプールの設定
+ */
+struct SessionPoolOptions {
+    WebSocketClient::Endpoint endpoint;                     // 接続先
+    std::string setup_message;                              // 待機セッションに送っておくセットアップメッセージ
+    std::size_t size = 4;                                   // 待機させておくセッション数
+    std::chrono::milliseconds max_idle{std::chrono::minutes(5)};    // これより長く待機したセッションは作り直す
+    std::chrono::milliseconds setup_timeout{10000};         // setupComplete を待つ時間
+    std::chrono::milliseconds retry_delay{1000};            // 接続失敗後、補充を再開するまでの時間
+};
+
+/**
+ * @brief 接続とセットアップを済ませたセッションを待機させておくプール
+ *
+ * DNS・TCP・TLS・WebSocketのアップグレード・セットアップの往復を事前に済ませ、
+ * 着信時には acquire() で待機中のクライアントをすぐに渡します（ロックとキューの操作のみ）。
+ * 渡した分や失敗・期限切れで減った分はバックグラウンドで補充します。
+ * 待機中もクライアントのキープアライブ（ping）で接続を維持し、サーバー側の
+ * 接続時間の上限より前に max_idle で作り直します。
+ * 接続（ハンドシェイク）は非同期で行い、io_context のスレッドをブロックしません。
+ */
+class SessionPool {
+public:
+    /**
+     * @brief プールの統計情報
+     */
+    struct Stats {
+        std::size_t idle = 0;           // 待機中のセッション数
+        std::size_t connecting = 0;     // 接続・セットアップ中のセッション数
+        uint64_t hits = 0;              // 待機中のセッションを渡せた回数
+        uint64_t misses = 0;            // 待機中のセッションがなかった回数
+        uint64_t opened = 0;            // セットアップまで完了したセッション数
+        uint64_t failed = 0;            // 接続またはセットアップに失敗した数
+        uint64_t retired = 0;           // 待機中に期限切れ・切断で破棄した数
+        double hit_rate = 0.0;          // hits / (hits + misses)
+    };
+
+    /**
+     * @brief SessionPoolのコンストラクタ
+     *
+     * @param io_context 使用するIOコンテキスト（呼び出し側で run() すること）
+     * @param options 設定
+     */
+    SessionPool(net::io_context& io_context, const SessionPoolOptions& options);
+
+    /**
+     * @brief デストラクタ（待機中のセッションを閉じる）
+     */
+    ~SessionPool();
+
+    SessionPool(const SessionPool&) = delete;
+    SessionPool& operator=(const SessionPool&) = delete;
+
+    /**
+     * @brief プールの補充を開始（ブロックしない）
+     */
+    void start();
+
+    /**
+     * @brief 補充を止め、待機中のセッションを閉じる
+     *
+     * 戻った時点で、待機中のクライアントからこのプールへのコールバックは呼ばれなくなります。
+     */
+    void stop();
+
+    /**
+     * @brief 待機中のセッションを1つ取り出す（任意のスレッドから呼び出し可能）
+     *
+     * プールのコールバックは渡す前に strand 上で外します（io_context のスレッドからは
+     * strand に投げるだけで待ちません）。受け取った側は、クライアントの strand 上で
+     * コールバックを設定してから使うこと。それまでに届いたメッセージは破棄されます。
+     *
+     * @return std::shared_ptr<WebSocketClient> セットアップ済みのクライアント（待機中がなければ nullptr）
+     */
+    std::shared_ptr<WebSocketClient> acquire();
+
+    /**
+     * @brief 待機セッションに送ってあるセットアップメッセージ（一致する着信にのみ使えます）
+     */
+    const std::string& setup_message() const { return options_.setup_message; }
+
+    /**
+     * @brief 統計情報を取得（任意のスレッドから呼び出し可能）
+     */
+    Stats get_stats() const;
+
+    /**
+     * @brief acquire() にかかった時間の分布（ナノ秒）
+     */
+    const Histogram& pickup_latency() const { return pickup_ns_; }
+
+private:
+    struct Warm {
+        std::shared_ptr<WebSocketClient> client;
+        std::chrono::steady_clock::time_point ready_at;
+    };
+
+    void refill();
+    void open_one();
+    void on_ready(WebSocketClient* client);
+    void on_failed(WebSocketClient* client);
+    void schedule_sweep();
+
+    net::io_context& io_context_;
+    SessionPoolOptions options_;
+    WebSocketClient::Executor sweep_strand_;
+    net::steady_timer sweep_timer_;     // Retires idle sessions and retries the refill
+
+    mutable std::mutex mutex_;
+    std::deque<Warm> idle_;             // Oldest first, so sessions are used before they expire
+    std::unordered_map<std::shared_ptr<WebSocketClient>, std::chrono::steady_clock::time_point> connecting_;
+    std::size_t launching_ = 0;         // Posted open_one() calls that have not created their client yet
+    std::chrono::steady_clock::time_point retry_after_;
+    bool running_ = false;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> opened_{0};
+    std::atomic<uint64_t> failed_{0};
+    std::atomic<uint64_t> retired_{0};
+    Histogram pickup_ns_;
+};
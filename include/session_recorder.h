@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief 記録された1フレーム
+ */
+struct RecordedFrame {
+    enum class Direction : uint8_t {
+        Inbound = 0,    // サーバー → クライアント
+        Outbound = 1    // クライアント → サーバー
+    };
+
+    uint64_t timestamp_ns = 0;      // 記録開始からの経過時間
+    Direction direction = Direction::Inbound;
+    std::string payload;
+};
+
+/**
+ * @brief WebSocketの送受信フレームをバイナリログに記録するクラス
+ *
+ * ファイル形式（リトルエンディアン）:
+ *   ヘッダ: "GVREC" + バージョン(1) + 予約(2バイト)
+ *   フレーム: 経過時間ns(u64) + 方向(u8) + 長さ(u32) + ペイロード
+ *
+ * 任意のスレッドから record() を呼び出せます。
+ */
+class SessionRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief ログファイルを作成して記録を開始
+     *
+     * @return true 開始成功
+     * @return false ファイルを作成できなかった
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief フレームを1件記録
+     */
+    void record(RecordedFrame::Direction direction, std::string_view payload);
+
+    /**
+     * @brief バッファをフラッシュしてファイルを閉じる
+     */
+    void close();
+
+    /**
+     * @brief 記録したフレーム数
+     */
+    uint64_t frame_count() const { return frames_.load(std::memory_order_relaxed); }
+
+private:
+    std::mutex mutex_;
+    std::ofstream out_;
+    Clock::time_point started_;
+    std::atomic<uint64_t> frames_{0};
+};
+
+/**
+ * @brief 記録したセッションをネットワークなしで再生するクラス
+ *
+ * 受信フレームを記録時のタイミング（または倍速・最大速度）で
+ * コールバックに渡します。
+ */
+class SessionReplayer {
+public:
+    using Clock = std::chrono::steady_clock;
+    using FrameCallback = std::function<void(std::string_view)>;
+
+    /**
+     * @brief ログファイルを読み込む
+     *
+     * @return true 読み込み成功
+     * @return false ファイルが開けない、または形式が不正
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief 読み込んだフレーム
+     */
+    const std::vector<RecordedFrame>& frames() const { return frames_; }
+
+    /**
+     * @brief 受信フレームを呼び出し元スレッドで再生
+     *
+     * @param speed 再生速度（1.0で記録時と同じ、0以下で待ち時間なし）
+     * @param on_inbound 受信フレームを受け取るコールバック
+     * @param keep_running false を返すと再生を中断（nullptrで中断しない）
+     * @return std::size_t 再生した受信フレーム数
+     */
+    std::size_t replay(double speed, const FrameCallback& on_inbound,
+                       const std::function<bool()>& keep_running = nullptr) const;
+
+private:
+    std::vector<RecordedFrame> frames_;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief 単一プロデューサー・単一コンシューマーのロックフリーな固定長キュー
+ *
+ * try_push() は1つのスレッドから、try_pop() は別の1つのスレッドから
+ * 呼び出してください。満杯や空のときは待たずに false を返します。
+ */
+template <typename T>
+class SpscQueue {
+public:
+    /**
+     * @brief SpscQueueのコンストラクタ
+     *
+     * @param capacity 最大要素数（2の累乗に切り上げ）
+     */
+    explicit SpscQueue(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    /**
+     * @brief 要素を追加（プロデューサー側）
+     *
+     * @return false キューが満杯
+     */
+    bool try_push(T&& value) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == slots_.size()) {
+            return false;
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 要素を取り出す（コンシューマー側）
+     *
+     * @return false キューが空
+     */
+    bool try_pop(T& value) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief キュー内の要素数（両端以外のスレッドからは概算）
+     */
+    std::size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief 最大要素数
+     */
+    std::size_t capacity() const { return slots_.size(); }
+
+private:
+    std::vector<T> slots_;
+    std::size_t mask_ = 0;
+    // Separate cache lines so the two threads do not false-share
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+};
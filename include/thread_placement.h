@@ -0,0 +1,202 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <sched.h>
+
+/**
+ * @brief スレッドのスケジューリングポリシー
+ */
+enum class SchedPolicy {
+    Other,          // SCHED_OTHER（通常のタイムシェアリング）
+    Fifo,           // SCHED_FIFO
+    RoundRobin      // SCHED_RR
+};
+
+/**
+ * @brief 1つの役割のスレッドに適用する配置とスケジューリングの設定
+ */
+struct ThreadRule {
+    std::vector<int> cpus;                  // 実行するCPU番号（空なら固定しない）
+    SchedPolicy policy = SchedPolicy::Other;
+    int priority = 0;                       // SCHED_FIFO/RR の優先度（1-99）
+    int nice = 0;                           // SCHED_OTHER のnice値（リアルタイムが拒否されたときにも使用）
+};
+
+/**
+ * @brief スレッド配置の設定（設定ファイルの "threads"）
+ */
+struct ThreadPlacementConfig {
+    std::map<std::string, ThreadRule> roles;    // 役割名 → 設定（thread_roles() のいずれか）
+    bool lock_memory = false;                   // mlockall でメモリをロックする
+
+    bool empty() const { return roles.empty() && !lock_memory; }
+};
+
+/**
+ * @brief 設定できるスレッドの役割名
+ *
+ * io（WebSocket の io_context を回すスレッド）、audio（miniaudio のコールバック）、
+ * playback（再生スレッド）、video（フレームのエンコード）、transcript（文字起こしの書き込み）
+ */
+const std::vector<std::string>& thread_roles();
+
+/**
+ * @brief 設定値の範囲を検証
+ *
+ * @param config 検証する設定
+ * @param error 不正な場合のエラーメッセージ（出力）
+ * @return true 有効
+ * @return false 不正な値がある
+ */
+bool validate_thread_placement(const ThreadPlacementConfig& config, std::string& error);
+
+/**
+ * @brief スレッドに実際に適用されたスケジューリングの状態
+ */
+struct AppliedPlacement {
+    std::string role;
+    long tid = 0;
+    std::vector<int> cpus;          // 実行が許可されているCPU（カーネルから読み戻した値）
+    int policy = 0;                 // SCHED_OTHER / SCHED_FIFO / SCHED_RR
+    int priority = 0;               // リアルタイム優先度
+    int nice = 0;                   // nice値
+    std::string note;               // 要求どおりにならなかった理由（要求どおりなら空）
+
+    /**
+     * @brief ログ用の1行の説明（例: "audio (tid 1234): cpus 2-3, SCHED_FIFO 80"）
+     */
+    std::string describe() const;
+};
+
+/**
+ * @brief 役割ごとのCPU固定・リアルタイム優先度・メモリロックを適用するクラス
+ *
+ * 各スレッドは開始時に apply()（オーディオコールバックは毎回 apply_in_callback()）を
+ * 呼び出し、自分の役割の設定を適用します。権限がなくリアルタイム優先度が拒否された場合は
+ * RLIMIT_RTPRIO の範囲の優先度、それも無理なら nice 値にフォールバックし、
+ * 実際に適用された状態をカーネルから読み戻してログに出力します。
+ */
+class ThreadPlacement {
+public:
+    /**
+     * @brief シングルトンインスタンスを取得
+     */
+    static ThreadPlacement& instance();
+
+    /**
+     * @brief 設定を保存（スレッドを開始する前に呼び出す）
+     */
+    void configure(const ThreadPlacementConfig& config);
+
+    /**
+     * @brief 呼び出し元スレッドに role の設定を適用
+     *
+     * 同じスレッドでの2回目以降の呼び出しと、設定のない役割では何もしません
+     * （スレッドローカル変数の読み込み1回）。
+     *
+     * @param role 役割名（文字列リテラル）
+     */
+    void apply(const char* role) {
+        thread_local bool applied = false;
+        if (!applied && configured_.load(std::memory_order_acquire)) {
+            applied = true;
+            apply_configured(role);
+        }
+    }
+
+    /**
+     * @brief オーディオコールバック用の apply()（毎回呼び出せます）
+     *
+     * 初回もロック・メモリ確保・ログ出力をせず、スケジューリングのシステムコールだけを行います。
+     * 適用した状態は記録しておき、report_applied() がリアルタイムでないスレッドから出力します。
+     *
+     * @param role 役割名（文字列リテラル）
+     */
+    void apply_in_callback(const char* role) {
+        thread_local bool applied = false;
+        if (!applied && configured_.load(std::memory_order_acquire)) {
+            applied = true;
+            record_configured(role);
+        }
+    }
+
+    /**
+     * @brief apply_in_callback() で適用した状態をログに出力し、applied() に加える
+     *
+     * @param out 出力先
+     */
+    void report_applied(std::ostream& out);
+
+    /**
+     * @brief 呼び出し元スレッドに rule を適用し、実際の状態を返す（ログ出力なし）
+     */
+    AppliedPlacement apply_rule(const std::string& role, const ThreadRule& rule) const;
+
+    /**
+     * @brief プロセスのメモリをロック（mlockall）
+     *
+     * 起動時に確保してページを触れたバッファ（音声ブロックプールなど）が
+     * スワップやページフォールトで止まらないよう、現在と今後のページをロックします。
+     * 解放したヒープをOSに返さない設定にし、以後 apply() するリアルタイムスレッドの
+     * スタックも事前にページを確保します。失敗した場合はロックせずに続行します。
+     *
+     * @return true ロックできた
+     * @return false 失敗した（理由はログに出力）
+     */
+    bool lock_memory();
+
+    /**
+     * @brief これまでに apply() で適用した状態の一覧
+     */
+    std::vector<AppliedPlacement> applied() const;
+
+private:
+    // What the kernel reports after applying a rule; filled without allocating
+    struct KernelPlacement {
+        long tid = 0;
+        cpu_set_t cpus;
+        int policy = 0;
+        int priority = 0;
+        int nice = 0;
+        int affinity_error = 0;         // pthread_setaffinity_np result
+        int sched_error = 0;            // pthread_setschedparam result
+        int capped_priority = 0;        // Priority lowered to RLIMIT_RTPRIO (0 if not)
+        int nice_error = 0;             // errno of setpriority
+    };
+
+    // Applied in an audio callback, waiting for report_applied()
+    struct PendingPlacement {
+        std::atomic<bool> ready{false};
+        const char* role = nullptr;
+        const ThreadRule* rule = nullptr;
+        KernelPlacement state;
+    };
+    static constexpr std::size_t MAX_PENDING = 8;   // Callback threads reported per process; later ones are only applied
+
+    ThreadPlacement() = default;
+
+    void apply_configured(const char* role);
+    void record_configured(const char* role);
+    void apply_kernel(const ThreadRule& rule, KernelPlacement& state, bool prefault) const;
+    static AppliedPlacement describe_kernel(const std::string& role, const ThreadRule& rule, const KernelPlacement& state);
+
+    std::atomic<bool> configured_{false};
+    std::atomic<bool> memory_locked_{false};
+    ThreadPlacementConfig config_;
+    mutable std::mutex mutex_;
+    std::vector<AppliedPlacement> applied_;
+
+    std::array<PendingPlacement, MAX_PENDING> pending_;
+    std::atomic<std::size_t> pending_claimed_{0};
+    std::size_t pending_reported_ = 0;              // Guarded by mutex_
+};
+
+inline ThreadPlacement& thread_placement() {
+    return ThreadPlacement::instance();
+}
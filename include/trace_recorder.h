@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief スレッドごとのリングバッファにイベントを記録するトレースレコーダー
+ *
+ * 各スレッドは固定サイズのバイナリイベント（スコープの開始/終了、カウンタ、
+ * フローID）を自分専用のリングに書き込みます。書き込みはロックを取らず、
+ * 無効時のコストはアトミック変数の読み込み1回です。
+ * dump_chrome_json() で直近N秒分を Chrome/Perfetto の JSON 形式で出力できます。
+ *
+ * イベント名には文字列リテラルなど、プログラム終了まで有効な文字列を渡してください。
+ */
+class TraceRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class EventType : uint32_t {
+        Begin,
+        End,
+        Counter,
+        Instant,
+        FlowStart,
+        FlowStep,
+        FlowEnd
+    };
+
+    /**
+     * @brief シングルトンインスタンスを取得
+     */
+    static TraceRecorder& instance();
+
+    /**
+     * @brief 記録を開始
+     *
+     * @param events_per_thread スレッドごとのリングの容量（イベント数）
+     */
+    void enable(std::size_t events_per_thread = 1 << 16);
+
+    /**
+     * @brief 記録を停止（記録済みのイベントは保持）
+     */
+    void disable() { enabled_.store(false, std::memory_order_relaxed); }
+
+    /**
+     * @brief 記録中かどうか
+     */
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 呼び出し元スレッドの表示名を設定
+     */
+    void set_thread_name(const char* name);
+
+    /**
+     * @brief スコープの開始/終了を記録（通常は TraceScope を使用）
+     */
+    void begin(const char* name, uint64_t arg = 0) { if (enabled()) record(EventType::Begin, name, arg); }
+    void end(const char* name) { if (enabled()) record(EventType::End, name, 0); }
+
+    /**
+     * @brief カウンタ値を記録
+     */
+    void counter(const char* name, int64_t value) {
+        if (enabled()) record(EventType::Counter, name, static_cast<uint64_t>(value));
+    }
+
+    /**
+     * @brief 瞬間イベントを記録
+     */
+    void instant(const char* name, uint64_t arg = 0) { if (enabled()) record(EventType::Instant, name, arg); }
+
+    /**
+     * @brief フローの開始・途中・終了を記録
+     *
+     * 同じ名前とIDのフローイベントが矢印で結ばれます
+     * （例: キャプチャしたチャンク → 送信 → 応答）。
+     */
+    void flow_start(const char* name, uint64_t id) { if (enabled()) record(EventType::FlowStart, name, id); }
+    void flow_step(const char* name, uint64_t id) { if (enabled()) record(EventType::FlowStep, name, id); }
+    void flow_end(const char* name, uint64_t id) { if (enabled()) record(EventType::FlowEnd, name, id); }
+
+    /**
+     * @brief 直近のイベントを Chrome/Perfetto のトレースJSONとして出力
+     *
+     * @param out 出力先
+     * @param last_seconds 出力する期間（秒、0以下なら全件）
+     * @return std::size_t 出力したイベント数
+     */
+    std::size_t dump_chrome_json(std::ostream& out, double last_seconds = 10.0) const;
+
+    /**
+     * @brief トレースJSONをファイルに書き出す
+     *
+     * @return true 書き込み成功
+     * @return false ファイルを開けなかった
+     */
+    bool dump_to_file(const std::string& path, double last_seconds = 10.0) const;
+
+private:
+    struct Event {
+        std::atomic<int64_t> timestamp_ns{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> arg{0};
+        std::atomic<EventType> type{EventType::Instant};
+    };
+
+    // One producer (the owning thread); readers discard slots that may have been overwritten
+    struct ThreadBuffer {
+        explicit ThreadBuffer(std::size_t capacity, uint32_t tid)
+            : events(capacity), mask(capacity - 1), tid(tid) {}
+        std::vector<Event> events;
+        const std::size_t mask;
+        const uint32_t tid;
+        std::atomic<uint64_t> head{0};
+        std::atomic<const char*> name{nullptr};
+    };
+
+    friend class TraceScope;
+
+    TraceRecorder() = default;
+
+    void record(EventType type, const char* name, uint64_t arg) noexcept {
+        ThreadBuffer* buffer = local_buffer();
+        if (!buffer) {
+            return;
+        }
+        uint64_t index = buffer->head.load(std::memory_order_relaxed);
+        Event& event = buffer->events[index & buffer->mask];
+        event.timestamp_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+        event.name.store(name, std::memory_order_relaxed);
+        event.arg.store(arg, std::memory_order_relaxed);
+        event.type.store(type, std::memory_order_relaxed);
+        buffer->head.store(index + 1, std::memory_order_release);
+    }
+
+    ThreadBuffer* local_buffer() noexcept;
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<std::size_t> capacity_{1 << 16};
+
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;   // Kept after threads exit
+};
+
+/**
+ * @brief TraceRecorderのインスタンスを取得
+ */
+inline TraceRecorder& trace_recorder() {
+    return TraceRecorder::instance();
+}
+
+/**
+ * @brief スコープの開始と終了を記録するRAIIヘルパー
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, uint64_t arg = 0)
+        : name_(trace_recorder().enabled() ? name : nullptr) {
+        if (name_) {
+            trace_recorder().begin(name_, arg);
+        }
+    }
+
+    ~TraceScope() {
+        // Close the slice even if recording was disabled inside the scope
+        if (name_) {
+            trace_recorder().record(TraceRecorder::EventType::End, name_, 0);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+};
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "spsc_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 文字起こしの1文
+ */
+struct TranscriptEntry {
+    enum class Speaker : uint8_t { User, Model };
+
+    Speaker speaker = Speaker::Model;
+    uint64_t turn = 0;           // 1から始まるターン番号
+    int64_t timestamp_ms = 0;    // 文が確定した時刻（UNIXエポックからのミリ秒）
+    std::string text;
+};
+
+/**
+ * @brief ストリーミングで届く文字起こしを文単位に区切るクラス
+ *
+ * 追加されたバイトだけを走査します。文末記号は . ! ? と全角の 。！？ で、
+ * 直後に続く記号や閉じ括弧（」』）など）も同じ文に含めるため、
+ * 文末記号がテキストの末尾にある文は次のテキスト、release()、flush() のいずれかまで確定しません。
+ * マルチバイト文字が途中で分割されて届いても正しく扱います。
+ */
+class SentenceSegmenter {
+public:
+    /**
+     * @brief テキストを追加し、確定した文を取り出す
+     *
+     * @param text 追加するテキスト（UTF-8）
+     * @param sentences 確定した文の追加先（前後の空白は除去）
+     */
+    void append(std::string_view text, std::vector<std::string>& sentences);
+
+    /**
+     * @brief 閉じ括弧を待っているだけの文を確定させる
+     *
+     * @param sentences 確定した文の追加先
+     */
+    void release(std::vector<std::string>& sentences);
+
+    /**
+     * @brief 未確定のテキストを取り出してリセット（ターン終了時）
+     */
+    std::string flush();
+
+    /**
+     * @brief 未確定のテキスト
+     */
+    const std::string& pending() const { return buffer_; }
+
+private:
+    std::string buffer_;
+    std::size_t scanned_ = 0;  // Bytes of buffer_ already checked for a terminator
+    bool held_ = false;        // buffer_ ends with a terminator run that may still grow
+};
+
+/**
+ * @brief 文字起こしの出力先
+ *
+ * 書き込みはすべてライタースレッドから行われます。
+ */
+class TranscriptOutput {
+public:
+    virtual ~TranscriptOutput() = default;
+
+    /**
+     * @brief 1文を書き込む
+     */
+    virtual void write(const TranscriptEntry& entry) = 0;
+
+    /**
+     * @brief キューが空になったときに呼ばれる（バッチの区切り）
+     */
+    virtual void flush() {}
+};
+
+/**
+ * @brief 「You: ...」「AI: ...」の形式でストリームに表示する出力先
+ */
+class ConsoleTranscriptOutput : public TranscriptOutput {
+public:
+    explicit ConsoleTranscriptOutput(std::ostream& out) : out_(out) {}
+
+    void write(const TranscriptEntry& entry) override;
+    void flush() override;
+
+private:
+    std::ostream& out_;
+};
+
+/**
+ * @brief 1行1文のJSON (JSONL) でファイルに書き込む出力先
+ *
+ * 各行は {"timestamp_ms", "turn", "speaker", "text"} を持ちます。
+ * 行はまとめてから書き込み、キューが空になるたびにファイルへ反映します。
+ */
+class JsonlTranscriptOutput : public TranscriptOutput {
+public:
+    /**
+     * @brief ファイルを作成
+     *
+     * @return true 成功
+     * @return false ファイルを作成できない
+     */
+    bool open(const std::string& path);
+
+    void write(const TranscriptEntry& entry) override;
+    void flush() override;
+
+private:
+    std::ofstream out_;
+    std::string batch_;
+};
+
+/**
+ * @brief 文字起こしを文単位に区切り、バックグラウンドで出力するクラス
+ *
+ * append() と end_turn() はメッセージを処理するスレッド（1つ）から呼び出します。
+ * 確定した文はロックフリーキューを通してライタースレッドに渡されるため、
+ * 端末やファイルへの書き込みが遅くても受信処理は止まりません。
+ * キューが満杯の場合、その文は破棄されて dropped() に数えられます。
+ */
+class TranscriptSink {
+public:
+    /**
+     * @brief TranscriptSinkのコンストラクタ
+     *
+     * @param queue_capacity ライタースレッドに渡す文の最大数
+     */
+    explicit TranscriptSink(std::size_t queue_capacity = 1024);
+
+    /**
+     * @brief デストラクタ（残りを書き出してから停止）
+     */
+    ~TranscriptSink();
+
+    /**
+     * @brief 出力先を追加（start() より前に呼び出すこと）
+     */
+    void add_output(std::unique_ptr<TranscriptOutput> output);
+
+    /**
+     * @brief ライタースレッドを開始
+     */
+    void start();
+
+    /**
+     * @brief 未確定の文とキューに残った文を書き出してライタースレッドを停止
+     *
+     * append() を呼び出すスレッドが止まってから呼び出してください。
+     */
+    void stop();
+
+    /**
+     * @brief 文字起こしの断片を追加
+     *
+     * 話者が替わると、相手側で閉じ括弧を待っていた文は確定します。
+     *
+     * @param speaker 話者
+     * @param text サーバーから届いたテキスト
+     */
+    void append(TranscriptEntry::Speaker speaker, std::string_view text);
+
+    /**
+     * @brief ターンを終了（未確定の文を出力し、ターン番号を進める）
+     */
+    void end_turn();
+
+    /**
+     * @brief 現在のターン番号
+     */
+    uint64_t turn() const { return turn_; }
+
+    /**
+     * @brief キューが満杯で破棄した文の数
+     */
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    void publish(TranscriptEntry::Speaker speaker, std::string text);
+    void flush_pending();
+    void run();
+    void drain();
+
+    SpscQueue<TranscriptEntry> queue_;
+    std::atomic<uint32_t> published_{0};  // Bumped on every push; the writer waits on it
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> dropped_{0};
+    SentenceSegmenter user_segmenter_;
+    SentenceSegmenter model_segmenter_;
+    std::vector<std::string> sentences_;
+    uint64_t turn_ = 1;
+    std::vector<std::unique_ptr<TranscriptOutput>> outputs_;
+    std::thread writer_;
+};
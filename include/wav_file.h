@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief WAVファイルのフォーマット情報
+ */
+struct WavInfo {
+    int sample_rate = 0;
+    int channels = 0;
+    int bits_per_sample = 0;
+    uint64_t data_offset = 0;   // data チャンク本体の先頭位置
+    uint64_t data_bytes = 0;    // data チャンク本体のバイト数
+};
+
+/**
+ * @brief WAVファイルのヘッダーを読み取り、ファイル位置を data チャンクの先頭に移動
+ *
+ * 16bit リニアPCM のモノラルのみ受け付けます。data より前の
+ * LIST などのチャンクは読み飛ばします。
+ *
+ * @param fd 読み込み用に開いたファイル記述子
+ * @param info 読み取ったフォーマット（出力）
+ * @param error 失敗時の理由（出力）
+ * @return true 読み取り成功
+ * @return false 対応していない形式または読み取り失敗
+ */
+bool read_wav_header(int fd, WavInfo& info, std::string& error);
+
+/**
+ * @brief 16bit モノラルPCM のWAVヘッダー（44バイト）をファイルの先頭に書き込む
+ *
+ * 本体を書く前に data_bytes = 0 で書き、書き終えてから実際のサイズで書き直します。
+ * ファイル位置は変更しません。
+ *
+ * @param fd 書き込み用に開いたファイル記述子
+ * @param sample_rate サンプルレート
+ * @param data_bytes PCM本体のバイト数
+ * @return true 書き込み成功
+ * @return false 書き込み失敗
+ */
+bool write_wav_header(int fd, int sample_rate, uint64_t data_bytes);
+
+/**
+ * @brief WAVヘッダーのサイズ（write_wav_header が書くバイト数）
+ */
+constexpr std::size_t WAV_HEADER_SIZE = 44;
@@ -1,14 +1,27 @@
 #pragma once
 
+// Boost 1.74 awaitable.hpp uses std::exchange without including <utility>
+#include <utility>
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/ssl.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/websocket/ssl.hpp>
+#include "histogram.h"
+#include "session_recorder.h"
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace beast = boost::beast;
 namespace http = beast::http;
@@ -21,11 +34,41 @@ using tcp = boost::asio::ip::tcp;
  * @brief WebSocketクライアントクラス
  * 
  * Gemini Live APIとのWebSocket通信を管理します。
+ * 
+ * すべての非同期処理とコールバックはクライアントごとのstrand上で実行されるため、
+ * 複数スレッドで run() される io_context を複数のクライアントで共有できます。
+ * コールバックは connect() より前に設定してください。
  */
 class WebSocketClient {
 public:
+    /**
+     * @brief 接続先の設定
+     */
+    struct Endpoint {
+        std::string host = "generativelanguage.googleapis.com";
+        std::string port = "443";
+        std::string target;         // パスとクエリ文字列
+        bool use_tls = true;        // false で平文の ws:// 接続
+    };
+
+    /**
+     * @brief ping/pongで測定した往復遅延（RTT）の統計
+     */
+    struct RttStats {
+        uint64_t samples = 0;       // 受信したpongの数
+        double last_ms = 0.0;       // 直近のRTT
+        double min_ms = 0.0;        // 最小RTT
+        double smoothed_ms = 0.0;   // 平滑化RTT（RFC 6298と同じ係数 1/8）
+        double p99_ms = 0.0;        // 99パーセンタイル
+        int missed_pongs = 0;       // 連続して応答のなかったping数
+    };
+
     using MessageCallback = std::function<void(const std::string&)>;
+    using MessageViewCallback = std::function<void(std::string_view)>;
     using ErrorCallback = std::function<void(const std::string&)>;
+    using CloseCallback = std::function<void()>;
+    using ConnectCallback = std::function<void(bool connected)>;
+    using Executor = net::strand<net::io_context::executor_type>;
 
     /**
      * @brief WebSocketClientのコンストラクタ
@@ -35,11 +78,37 @@ public:
      */
     WebSocketClient(net::io_context& io_context, const std::string& api_key);
 
+    /**
+     * @brief 接続先を指定するコンストラクタ
+     * 
+     * @param io_context Boost.Asio IOコンテキスト
+     * @param endpoint 接続先
+     */
+    WebSocketClient(net::io_context& io_context, const Endpoint& endpoint);
+
     /**
      * @brief デストラクタ
      */
     ~WebSocketClient();
 
+    /**
+     * @brief Gemini Live APIの接続先を生成
+     * 
+     * @param api_key Gemini APIキー
+     * @return Endpoint BidiGenerateContentエンドポイント
+     */
+    static Endpoint gemini_endpoint(const std::string& api_key);
+
+    /**
+     * @brief ws:// または wss:// のURLを接続先に変換
+     * 
+     * @param url 例: "ws://127.0.0.1:8765/ws"
+     * @param endpoint 変換結果（出力）
+     * @return true 変換成功
+     * @return false URLの形式が不正
+     */
+    static bool parse_url(const std::string& url, Endpoint& endpoint);
+
     /**
      * @brief メッセージ受信時のコールバックを設定
      * 
@@ -47,6 +116,27 @@ public:
      */
     void set_message_callback(MessageCallback callback);
 
+    /**
+     * @brief メッセージ受信時のコールバックを設定（コピーなし）
+     * 
+     * 受信バッファを直接参照するビューを渡します。ビューはコールバック
+     * 実行中のみ有効で、バッファの容量は次の受信で再利用されます。
+     * 設定した場合は set_message_callback() のコールバックより優先されます。
+     * 
+     * @param callback メッセージのビューを受け取るコールバック関数
+     */
+    void set_message_view_callback(MessageViewCallback callback);
+
+    /**
+     * @brief 受信メッセージの最大サイズを設定
+     * 
+     * connect() より前に呼び出してください。超過したメッセージを受信すると
+     * 読み込みエラーとして扱われます。
+     * 
+     * @param max_bytes 最大バイト数（0でBeastの既定値を使用）
+     */
+    void set_max_message_size(std::size_t max_bytes);
+
     /**
      * @brief エラー発生時のコールバックを設定
      * 
@@ -54,21 +144,92 @@ public:
      */
     void set_error_callback(ErrorCallback callback);
 
+    /**
+     * @brief サーバーが接続を閉じたときのコールバックを設定
+     * 
+     * close() による切断やエラー（エラーコールバックで通知）では呼び出されません。
+     * 
+     * @param callback 切断を受け取るコールバック関数
+     */
+    void set_close_callback(CloseCallback callback);
+
+    /**
+     * @brief async_connect() の結果を受け取るコールバックを差し替え
+     * 
+     * 接続中に nullptr を設定すると、結果は通知されなくなります（strand 上で呼び出すこと）。
+     * 
+     * @param callback 接続結果を受け取るコールバック関数
+     */
+    void set_connect_callback(ConnectCallback callback);
+
+    /**
+     * @brief キープアライブ（定期ping）の設定
+     * 
+     * connect() より前に呼び出してください。
+     * 
+     * @param interval pingの送信間隔（0でキープアライブ無効）
+     * @param max_missed_pongs 接続断とみなすまでに許容する連続pong欠落数
+     */
+    void set_keepalive(std::chrono::milliseconds interval, int max_missed_pongs);
+
+    /**
+     * @brief 送受信フレームの記録先を設定
+     * 
+     * connect() より前に呼び出してください。nullptrで記録を停止します。
+     * 
+     * @param recorder 記録先（複数のクライアントで共有可能）
+     */
+    void set_recorder(std::shared_ptr<SessionRecorder> recorder) { recorder_ = std::move(recorder); }
+
     /**
      * @brief Gemini Live APIに接続
      * 
+     * 名前解決とハンドシェイクを呼び出し元スレッドでブロッキング実行します。
+     * 
      * @return true 接続成功
      * @return false 接続失敗
      */
     bool connect();
 
+    /**
+     * @brief Gemini Live APIに非同期で接続
+     * 
+     * 名前解決・TCP接続・TLSとWebSocketのハンドシェイクをstrand上の非同期処理で行い、
+     * 呼び出し元スレッドをブロックしません。完了するとstrand上で callback を呼び出します。
+     * 失敗はエラーコールバックではなく callback(false) で通知されます。
+     * 接続中に close() すると中断され、callback(false) が呼ばれます。
+     * 
+     * @param callback 接続結果を受け取るコールバック関数
+     */
+    void async_connect(ConnectCallback callback);
+
     /**
      * @brief メッセージを送信
      * 
+     * 任意のスレッドから呼び出せます。メッセージは送信キューに積まれ、
+     * strand上で順番に非同期送信されます。
+     * 
      * @param message 送信するJSON文字列
      */
     void send(const std::string& message);
 
+    /**
+     * @brief メッセージを送信（ムーブ版）
+     * 
+     * @param message 送信するJSON文字列
+     */
+    void send(std::string&& message);
+
+    /**
+     * @brief 低優先度でメッセージを送信（画像フレームなどの大きなメッセージ用）
+     * 
+     * send() で積まれたメッセージが残っている間は送らず、後から積まれた send() の
+     * メッセージにも追い越されます。送信中の1件は追い越せないため、1件は小さく保ってください。
+     * 
+     * @param message 送信するJSON文字列
+     */
+    void send_bulk(std::string&& message);
+
     /**
      * @brief メッセージを非同期で受信
      */
@@ -79,6 +240,27 @@ public:
      */
     void close();
 
+    /**
+     * @brief クローズハンドシェイクを開始し、完了を待たずに戻る（任意のスレッドから呼び出し可能）
+     * 
+     * 多数のクライアントを閉じるときに、すべて開始してからまとめて待つことで
+     * ハンドシェイクを並行させます。
+     * 
+     * @return std::future<void> 切断が完了すると準備完了になる future
+     */
+    std::future<void> begin_close();
+
+    /**
+     * @brief 共有しているクライアントを閉じて手放す（任意のスレッドから呼び出し可能）
+     * 
+     * strand 上でコールバックを外して close() し、保留中の非同期処理がすべて完了するまで
+     * クライアントを生かしておきます。他の所有者がいなければその時点で破棄されます。
+     * 呼び出し後はこのクライアントを使わないでください。
+     * 
+     * @param client 手放すクライアント（nullptrなら何もしない）
+     */
+    static void release(std::shared_ptr<WebSocketClient> client);
+
     /**
      * @brief 接続状態を確認
      * 
@@ -87,24 +269,121 @@ public:
      */
     bool is_connected() const;
 
+    /**
+     * @brief RTT統計を取得（任意のスレッドから呼び出し可能）
+     * 
+     * @return RttStats 現在のRTT統計
+     */
+    RttStats get_rtt_stats() const;
+
+    /**
+     * @brief このクライアントのstrandを取得
+     * 
+     * 同じstrandに投げた処理はコールバックと並行実行されません。
+     */
+    Executor get_executor() const { return strand_; }
+
+    /**
+     * @brief 送信キューに残っているメッセージ数
+     */
+    std::size_t pending_writes() const { return pending_writes_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 送信キューに残っている低優先度メッセージ数（pending_writes() に含まれる）
+     */
+    std::size_t pending_bulk_writes() const { return pending_bulk_writes_.load(std::memory_order_relaxed); }
+
 private:
-    void do_ssl_handshake();
-    void do_websocket_handshake();
+    using TlsStream = websocket::stream<beast::ssl_stream<beast::tcp_stream>>;
+    using PlainStream = websocket::stream<beast::tcp_stream>;
+
+    // Invoke f with whichever stream is active
+    template <class Function>
+    void with_stream(Function&& f) {
+        if (tls_ws_) {
+            f(*tls_ws_);
+        } else if (plain_ws_) {
+            f(*plain_ws_);
+        }
+    }
+
+    bool has_stream() const { return tls_ws_ || plain_ws_; }
+
+    // Wrap a completion handler so the client knows when none of its handlers are pending
+    template <class Handler>
+    auto tracked(Handler&& handler) {
+        outstanding_.fetch_add(1, std::memory_order_relaxed);
+        return [this, handler = std::forward<Handler>(handler)]<class... Args>(Args&&... args) mutable
+            requires std::invocable<std::decay_t<Handler>&, Args...> {
+            handler(std::forward<Args>(args)...);
+            handler_done();
+        };
+    }
+
+    void handler_done();
+
+    template <class Stream>
+    void configure_stream(Stream& ws);
+
+    bool set_server_name(beast::error_code& ec);
+    void on_resolve(beast::error_code ec, const tcp::resolver::results_type& results);
+    void on_tcp_connect(beast::error_code ec);
+    void start_ws_handshake();
+    void finish_connect(beast::error_code ec, const char* step);
     void do_read();
+    void enqueue(std::string&& message, bool bulk);
+    void do_write();
+    void on_write(beast::error_code ec);
+    void start_close(std::shared_ptr<std::promise<void>> done);
+    void close_socket();
+    void schedule_ping();
+    void on_ping_timer(beast::error_code ec);
+    void on_pong(beast::string_view payload);
 
     net::io_context& io_context_;
+    Executor strand_;
     ssl::context ssl_ctx_;
-    std::unique_ptr<websocket::stream<beast::ssl_stream<tcp::socket>>> ws_;
+    std::unique_ptr<TlsStream> tls_ws_;
+    std::unique_ptr<PlainStream> plain_ws_;
     tcp::resolver resolver_;
     beast::flat_buffer buffer_;
-    
-    std::string api_key_;
-    std::string host_;
-    std::string port_;
-    std::string target_;
-    
+
+    Endpoint endpoint_;
+
     MessageCallback message_callback_;
+    MessageViewCallback message_view_callback_;
     ErrorCallback error_callback_;
-    
-    bool connected_;
+    CloseCallback close_callback_;
+    std::size_t max_message_size_ = 0;
+    std::shared_ptr<SessionRecorder> recorder_;
+
+    std::atomic<bool> connected_;
+    std::atomic<bool> connecting_{false};   // async_connect() in progress
+    ConnectCallback connect_callback_;      // Accessed only on the strand
+
+    // Outgoing messages (accessed only on the strand)
+    std::deque<std::string> write_queue_;
+    std::deque<std::string> bulk_queue_;    // Written only when write_queue_ is empty
+    bool writing_ = false;
+    bool writing_bulk_ = false;             // The message in flight came from bulk_queue_
+    std::atomic<std::size_t> pending_writes_{0};
+    std::atomic<std::size_t> pending_bulk_writes_{0};
+
+    // Keepalive (accessed only on the strand)
+    net::steady_timer ping_timer_;
+    std::chrono::milliseconds ping_interval_;
+    int max_missed_pongs_;
+    uint64_t ping_sequence_ = 0;
+    bool ping_outstanding_ = false;
+    bool ping_in_flight_ = false;
+    std::chrono::steady_clock::time_point ping_sent_at_;
+
+    // Lifetime: completion handlers capture this, so a released client waits for them
+    std::atomic<std::size_t> outstanding_{0};
+    std::shared_ptr<WebSocketClient> self_;     // Set by release(); dropped with the last handler (strand only)
+
+    // RTT statistics (read from other threads)
+    mutable std::mutex rtt_mutex_;
+    RttStats rtt_stats_;
+    Histogram rtt_histogram_us_;
 };
@@ -0,0 +1,71 @@
+// Global operator new/delete replacements that feed AllocTracker.
+// Linked only into binaries that opt in (tests, tools, GEMINI_ALLOC_TRACKING builds).
+#include "alloc_tracker.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+void* allocate(std::size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    AllocTracker::on_allocate(size);
+    return p;
+}
+
+void* allocate_aligned(std::size_t size, std::align_val_t alignment) {
+    std::size_t align = static_cast<std::size_t>(alignment);
+    // aligned_alloc requires the size to be a multiple of the alignment
+    std::size_t rounded = (size + align - 1) / align * align;
+    void* p = std::aligned_alloc(align, rounded ? rounded : align);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    AllocTracker::on_allocate(size);
+    return p;
+}
+
+void deallocate(void* p) noexcept {
+    if (p) {
+        AllocTracker::on_deallocate();
+        std::free(p);
+    }
+}
+
+[[maybe_unused]] const bool registered = (AllocTracker::mark_installed(), true);
+
+}  // namespace
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept { deallocate(p); }
+void operator delete[](void* p) noexcept { deallocate(p); }
+void operator delete(void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept { deallocate(p); }
+void operator delete(void* p, std::align_val_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { deallocate(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { deallocate(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { deallocate(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { deallocate(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { deallocate(p); }
@@ -0,0 +1,32 @@
+#include "alloc_tracker.h"
+#include <atomic>
+
+namespace {
+
+// Trivially constructible so operator new can touch it during thread start-up
+thread_local AllocCounts t_counts;
+
+std::atomic<bool> g_installed{false};
+
+}  // namespace
+
+bool AllocTracker::installed() {
+    return g_installed.load(std::memory_order_relaxed);
+}
+
+AllocCounts AllocTracker::thread_counts() noexcept {
+    return t_counts;
+}
+
+void AllocTracker::on_allocate(std::size_t bytes) noexcept {
+    t_counts.allocations++;
+    t_counts.bytes += bytes;
+}
+
+void AllocTracker::on_deallocate() noexcept {
+    t_counts.deallocations++;
+}
+
+void AllocTracker::mark_installed() noexcept {
+    g_installed.store(true, std::memory_order_relaxed);
+}
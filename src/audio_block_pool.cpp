@@ -0,0 +1,96 @@
+#include "audio_block_pool.h"
+#include "metrics.h"
+#include <new>
+
+namespace {
+
+constexpr std::size_t CACHE_LINE = 64;
+
+// Process-wide pool metrics, shared by every pool
+struct BlockPoolMetrics {
+    Gauge& available = metrics().gauge("gemini_audio_pool_free_blocks", "Audio blocks free in the preallocated pools");
+    Counter& exhausted = metrics().counter("gemini_audio_pool_exhausted_total",
+        "Audio blocks requested while every block was in use");
+};
+
+BlockPoolMetrics& block_pool_metrics() {
+    static BlockPoolMetrics instance;
+    return instance;
+}
+
+}  // namespace
+
+AudioBlockPool::AudioBlockPool(std::size_t block_samples, std::size_t blocks)
+    : block_samples_(block_samples)
+    , blocks_(std::min<std::size_t>(blocks, NONE))
+    , stride_(sizeof(AudioBlockHeader) +
+              (block_samples * sizeof(int16_t) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE)
+    , slab_(static_cast<std::byte*>(::operator new(stride_ * blocks_, std::align_val_t(CACHE_LINE))))
+    , head_(NONE)
+    , available_(blocks_) {
+    // Touch every page now so the first audio does not fault them in
+    std::memset(slab_, 0, stride_ * blocks_);
+
+    // Chain the blocks in order so the first acquires walk the slab sequentially
+    for (std::size_t i = 0; i < blocks_; i++) {
+        AudioBlockHeader* header = new (slab_ + i * stride_) AudioBlockHeader;
+        header->index = static_cast<uint32_t>(i);
+        header->capacity = block_samples_;
+        header->pool = this;
+        header->next.store(i + 1 < blocks_ ? static_cast<uint32_t>(i + 1) : NONE, std::memory_order_relaxed);
+    }
+    head_.store(blocks_ > 0 ? 0 : NONE, std::memory_order_release);
+    block_pool_metrics().available.add(static_cast<int64_t>(blocks_));
+}
+
+AudioBlockPool::~AudioBlockPool() {
+    block_pool_metrics().available.add(-static_cast<int64_t>(available()));
+    for (std::size_t i = 0; i < blocks_; i++) {
+        header_at(static_cast<uint32_t>(i))->~AudioBlockHeader();
+    }
+    ::operator delete(slab_, std::align_val_t(CACHE_LINE));
+}
+
+AudioBlock AudioBlockPool::acquire() {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    while (true) {
+        uint32_t index = static_cast<uint32_t>(head);
+        if (index == NONE) {
+            exhausted_.fetch_add(1, std::memory_order_relaxed);
+            block_pool_metrics().exhausted.inc();
+            return AudioBlock();
+        }
+        // The link may be stale if another thread wins the race; the counter makes the CAS fail then
+        AudioBlockHeader* header = header_at(index);
+        uint64_t next = header->next.load(std::memory_order_relaxed);
+        uint64_t replacement = (((head >> 32) + 1) << 32) | next;
+        if (head_.compare_exchange_weak(head, replacement, std::memory_order_acquire, std::memory_order_acquire)) {
+            header->refs.store(1, std::memory_order_relaxed);
+            header->size = 0;
+            available_.fetch_sub(1, std::memory_order_relaxed);
+            acquired_.fetch_add(1, std::memory_order_relaxed);
+            block_pool_metrics().available.add(-1);
+            return AudioBlock(header);
+        }
+    }
+}
+
+void AudioBlockPool::release(AudioBlockHeader* header) noexcept {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t replacement;
+    do {
+        header->next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+        replacement = (((head >> 32) + 1) << 32) | header->index;
+    } while (!head_.compare_exchange_weak(head, replacement, std::memory_order_release, std::memory_order_relaxed));
+    available_.fetch_add(1, std::memory_order_relaxed);
+    block_pool_metrics().available.add(1);
+}
+
+AudioBlockPool::Stats AudioBlockPool::get_stats() const {
+    Stats stats;
+    stats.blocks = blocks_;
+    stats.available = available();
+    stats.acquired = acquired_.load(std::memory_order_relaxed);
+    stats.exhausted = exhausted_.load(std::memory_order_relaxed);
+    return stats;
+}
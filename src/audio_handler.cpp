@@ -1,10 +1,30 @@
 #define MINIAUDIO_IMPLEMENTATION
 #include "audio_handler.h"
+#include "metrics.h"
+#include "trace_recorder.h"
+#include "thread_placement.h"
 #include <cstring>
 #include <iostream>
 
+namespace {
+
+struct AudioMetrics {
+    Counter& capture_periods = metrics().counter("gemini_audio_capture_periods_total", "Capture callbacks delivered");
+    Counter& played_samples = metrics().counter("gemini_audio_played_samples_total", "Samples consumed by the playback device");
+    Gauge& playback_buffer = metrics().gauge("gemini_audio_playback_buffer_samples", "Samples waiting in the playback buffer");
+};
+
+AudioMetrics& audio_metrics() {
+    static AudioMetrics instance;
+    return instance;
+}
+
+}  // namespace
+
 AudioHandler::AudioHandler()
-    : recording_(false), initialized_(false), playback_initialized_(false) {
+    : recording_(false), initialized_(false), playback_initialized_(false)
+    , capture_monitor_("capture", SAMPLE_RATE)
+    , playback_monitor_("playback", SAMPLE_RATE_OUTPUT) {
     memset(&capture_device_, 0, sizeof(capture_device_));
     memset(&playback_device_, 0, sizeof(playback_device_));
 }
@@ -93,13 +113,25 @@ bool AudioHandler::initialize() {
 void AudioHandler::capture_callback(ma_device *pDevice, void *pOutput,
                                     const void *pInput, ma_uint32 frameCount) {
     AudioHandler *handler = static_cast<AudioHandler *>(pDevice->pUserData);
+    if (!handler) {
+        return;
+    }
+    auto started = handler->capture_monitor_.begin(frameCount);
+    trace_recorder().set_thread_name("audio capture");
+    thread_placement().apply_in_callback("audio");
+    TraceScope trace_scope("capture_callback", frameCount);
 
-    if (pInput && handler && handler->audio_callback_) {
+    audio_metrics().capture_periods.inc();
+    
+    if (pInput && handler->audio_callback_) {
+        // Reuse one buffer; assign() only allocates if a period is larger than any before
         const int16_t *input = static_cast<const int16_t *>(pInput);
-        std::vector<int16_t> audio_data(input, input + frameCount);
-        handler->audio_callback_(audio_data);
+        handler->capture_buffer_.assign(input, input + frameCount);
+        handler->audio_callback_(handler->capture_buffer_);
     }
     
+    handler->capture_monitor_.end(started, frameCount);
+    
     (void)pOutput; // Unused
 }
 
@@ -157,15 +189,20 @@ void AudioHandler::stop_recording() {
 }
 
 bool AudioHandler::play_audio(const std::vector<int16_t> &audio_data,
+                              int sample_rate) {
+    return play_audio(audio_data.data(), audio_data.size(), sample_rate);
+}
+
+bool AudioHandler::play_audio(const int16_t *samples, size_t count,
                               int /* sample_rate */) {
-    if (audio_data.empty() || !playback_initialized_) {
+    if (count == 0 || !playback_initialized_) {
         return false;
     }
     
     // Add data to buffer
     std::lock_guard<std::mutex> lock(playback_mutex_);
-    playback_buffer_.insert(playback_buffer_.end(), audio_data.begin(),
-                            audio_data.end());
+    playback_buffer_.push(samples, count);
+    audio_metrics().playback_buffer.set(static_cast<int64_t>(playback_buffer_.size()));
     
     return true;
 }
@@ -174,28 +211,40 @@ void AudioHandler::playback_callback(ma_device *pDevice, void *pOutput,
                                      const void *pInput, ma_uint32 frameCount) {
     AudioHandler *handler = static_cast<AudioHandler *>(pDevice->pUserData);
     int16_t *output = static_cast<int16_t *>(pOutput);
+    auto started = handler->playback_monitor_.begin(frameCount);
+    uint32_t underrun_frames = 0;
+    trace_recorder().set_thread_name("audio playback");
+    thread_placement().apply_in_callback("audio");
+    TraceScope trace_scope("playback_callback", frameCount);
 
-    std::lock_guard<std::mutex> lock(handler->playback_mutex_);
+    std::unique_lock<std::mutex> lock(handler->playback_mutex_);
     
-    size_t frames_available = handler->playback_buffer_.size();
-    size_t frames_to_copy = std::min((size_t)frameCount, frames_available);
+    size_t frames_to_copy = handler->playback_buffer_.pop(output, frameCount);
 
     if (frames_to_copy > 0) {
-        memcpy(output, handler->playback_buffer_.data(),
-               frames_to_copy * sizeof(int16_t));
-
-        // Remove played data (inefficient but using vector for simplicity)
-        handler->playback_buffer_.erase(handler->playback_buffer_.begin(),
-                                        handler->playback_buffer_.begin() +
-                                            frames_to_copy);
+        handler->samples_played_ += frames_to_copy;
+        audio_metrics().played_samples.inc(frames_to_copy);
+        audio_metrics().playback_buffer.set(static_cast<int64_t>(handler->playback_buffer_.size()));
+        if (handler->playout_callback_) {
+            handler->playout_callback_(handler->samples_played_);
+        }
     }
 
     // Fill remaining with zeros
     if (frames_to_copy < frameCount) {
+        if (frames_to_copy > 0 || handler->playing_) {
+            underrun_frames = static_cast<uint32_t>(frameCount - frames_to_copy);
+        }
         memset(output + frames_to_copy, 0,
             (frameCount - frames_to_copy) * sizeof(int16_t));
     }
     
+    handler->playing_ = frames_to_copy == frameCount;
+    trace_recorder().counter("playback_buffer", static_cast<int64_t>(handler->playback_buffer_.size()));
+    lock.unlock();
+    
+    handler->playback_monitor_.end(started, frameCount, underrun_frames);
+    
     (void)pInput;
 }
 
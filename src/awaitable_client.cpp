@@ -0,0 +1,217 @@
+#include "awaitable_client.h"
+#include <boost/asio/ssl/error.hpp>
+
+AwaitableClient::AwaitableClient(net::io_context& io_context, const WebSocketClient::Endpoint& endpoint)
+    : strand_(net::make_strand(io_context))
+    , ssl_ctx_(ssl::context::tlsv12_client)
+    , resolver_(strand_)
+    , endpoint_(endpoint)
+    , connect_timer_(strand_)
+    , read_timer_(strand_)
+    , write_timer_(strand_)
+    , connected_(false) {
+
+    // SSL certificate verification settings
+    ssl_ctx_.set_default_verify_paths();
+    ssl_ctx_.set_verify_mode(ssl::verify_peer);
+}
+
+AwaitableClient::~AwaitableClient() {
+    beast::error_code ignored;
+    if (tls_ws_) {
+        beast::get_lowest_layer(*tls_ws_).socket().close(ignored);
+    }
+    if (plain_ws_) {
+        beast::get_lowest_layer(*plain_ws_).socket().close(ignored);
+    }
+}
+
+void AwaitableClient::arm(net::steady_timer& timer, std::chrono::milliseconds timeout) {
+    if (timeout <= no_timeout) {
+        return;
+    }
+    timer.expires_after(timeout);
+    timer.async_wait([this, &timer](beast::error_code ec) {
+        // An expiry already queued when finish() ran is not cancelled; finish() moved the
+        // deadline out instead, so a stale wake-up finds it in the future and leaves the connection alone
+        if (!ec && timer.expiry() <= net::steady_timer::clock_type::now()) {
+            abort(beast::error::timeout);
+        }
+    });
+}
+
+bool AwaitableClient::finish(net::steady_timer& timer, beast::error_code ec) {
+    timer.expires_at(net::steady_timer::time_point::max());
+    if (!ec) {
+        return true;
+    }
+    // Report why the connection was torn down rather than the resulting socket error
+    last_error_ = abort_reason_ ? abort_reason_ : ec;
+    connected_ = false;
+    return false;
+}
+
+void AwaitableClient::abort(beast::error_code reason) {
+    if (!abort_reason_) {
+        abort_reason_ = reason;
+    }
+    connected_ = false;
+    resolver_.cancel();
+
+    // Closing the socket completes every pending operation on the stream
+    if (tls_ws_) {
+        beast::get_lowest_layer(*tls_ws_).close();
+    }
+    if (plain_ws_) {
+        beast::get_lowest_layer(*plain_ws_).close();
+    }
+}
+
+void AwaitableClient::cancel() {
+    net::post(strand_, [this]() {
+        abort(net::error::operation_aborted);
+    });
+}
+
+template <class Stream>
+net::awaitable<void> AwaitableClient::handshake(Stream& ws, beast::error_code& ec) {
+    beast::get_lowest_layer(ws).socket().set_option(tcp::no_delay(true), ec);
+
+    ws.set_option(websocket::stream_base::decorator(
+        [](websocket::request_type& req) {
+            req.set(http::field::user_agent, "Gemini-CPP-Client/1.0");
+        }));
+
+    if (max_message_size_ > 0) {
+        ws.read_message_max(max_message_size_);
+        buffer_.max_size(max_message_size_);
+    }
+
+    if (idle_timeout_ > no_timeout) {
+        websocket::stream_base::timeout timeouts{};
+        timeouts.handshake_timeout = websocket::stream_base::none();
+        timeouts.idle_timeout = idle_timeout_;
+        timeouts.keep_alive_pings = true;
+        ws.set_option(timeouts);
+    }
+
+    co_await ws.async_handshake(endpoint_.host, endpoint_.target,
+                                net::redirect_error(net::use_awaitable, ec));
+}
+
+net::awaitable<bool> AwaitableClient::connect(std::chrono::milliseconds timeout) {
+    abort_reason_ = {};
+    last_error_ = {};
+    buffer_.consume(buffer_.size());
+    arm(connect_timer_, timeout);
+
+    beast::error_code ec;
+    auto results = co_await resolver_.async_resolve(endpoint_.host, endpoint_.port,
+                                                    net::redirect_error(net::use_awaitable, ec));
+
+    if (!ec && !abort_reason_) {
+        if (endpoint_.use_tls) {
+            plain_ws_.reset();
+            tls_ws_ = std::make_unique<TlsStream>(strand_, ssl_ctx_);
+            co_await beast::get_lowest_layer(*tls_ws_).async_connect(
+                results, net::redirect_error(net::use_awaitable, ec));
+
+            // Set SNI (Server Name Indication)
+            if (!ec && !SSL_set_tlsext_host_name(tls_ws_->next_layer().native_handle(), endpoint_.host.c_str())) {
+                ec = beast::error_code{static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()};
+            }
+            if (!ec) {
+                co_await tls_ws_->next_layer().async_handshake(
+                    ssl::stream_base::client, net::redirect_error(net::use_awaitable, ec));
+            }
+            if (!ec) {
+                co_await handshake(*tls_ws_, ec);
+            }
+        } else {
+            tls_ws_.reset();
+            plain_ws_ = std::make_unique<PlainStream>(strand_);
+            co_await beast::get_lowest_layer(*plain_ws_).async_connect(
+                results, net::redirect_error(net::use_awaitable, ec));
+            if (!ec) {
+                co_await handshake(*plain_ws_, ec);
+            }
+        }
+    } else if (!ec) {
+        ec = net::error::operation_aborted;
+    }
+
+    if (!finish(connect_timer_, ec)) {
+        co_return false;
+    }
+    connected_ = true;
+    co_return true;
+}
+
+template <class Stream>
+net::awaitable<bool> AwaitableClient::write_to(Stream& ws, std::string_view message) {
+    beast::error_code ec;
+    ws.text(true);
+    co_await ws.async_write(net::buffer(message.data(), message.size()),
+                            net::redirect_error(net::use_awaitable, ec));
+    co_return finish(write_timer_, ec);
+}
+
+net::awaitable<bool> AwaitableClient::send(std::string_view message, std::chrono::milliseconds timeout) {
+    if (!connected_) {
+        last_error_ = net::error::not_connected;
+        co_return false;
+    }
+    arm(write_timer_, timeout);
+    if (tls_ws_) {
+        co_return co_await write_to(*tls_ws_, message);
+    }
+    co_return co_await write_to(*plain_ws_, message);
+}
+
+template <class Stream>
+net::awaitable<std::optional<std::string_view>> AwaitableClient::read_from(Stream& ws) {
+    beast::error_code ec;
+    co_await ws.async_read(buffer_, net::redirect_error(net::use_awaitable, ec));
+    if (!finish(read_timer_, ec)) {
+        co_return std::nullopt;
+    }
+    auto data = buffer_.cdata();
+    co_return std::string_view(static_cast<const char*>(data.data()), data.size());
+}
+
+net::awaitable<std::optional<std::string_view>> AwaitableClient::next_message(std::chrono::milliseconds timeout) {
+    // The previous view is released here
+    buffer_.consume(buffer_.size());
+
+    if (!connected_) {
+        last_error_ = abort_reason_ ? abort_reason_ : beast::error_code(net::error::not_connected);
+        co_return std::nullopt;
+    }
+    arm(read_timer_, timeout);
+    if (tls_ws_) {
+        co_return co_await read_from(*tls_ws_);
+    }
+    co_return co_await read_from(*plain_ws_);
+}
+
+template <class Stream>
+net::awaitable<void> AwaitableClient::close_stream(Stream& ws) {
+    beast::error_code ec;
+    co_await ws.async_close(websocket::close_code::normal, net::redirect_error(net::use_awaitable, ec));
+    connect_timer_.expires_at(net::steady_timer::time_point::max());
+
+    // Close the socket even if the handshake failed
+    beast::get_lowest_layer(ws).close();
+}
+
+net::awaitable<void> AwaitableClient::close(std::chrono::milliseconds timeout) {
+    if (!connected_.exchange(false)) {
+        co_return;
+    }
+    arm(connect_timer_, timeout);
+    if (tls_ws_) {
+        co_await close_stream(*tls_ws_);
+    } else {
+        co_await close_stream(*plain_ws_);
+    }
+}
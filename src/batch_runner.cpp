@@ -0,0 +1,400 @@
+#include "batch_runner.h"
+#include "pipe_bridge.h"
+#include "thread_placement.h"
+#include "transcript_sink.h"
+#include "wav_file.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point from) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - from).count();
+}
+
+}  // namespace
+
+class BatchRunner::Job : public std::enable_shared_from_this<Job> {
+public:
+    Job(BatchRunner& runner, Item item)
+        : runner_(runner)
+        , item_(std::move(item)) {
+    }
+
+    ~Job() {
+        close_files();
+    }
+
+    // Open the files and connect; blocks the calling pool thread for the handshake.
+    // Returns false only for failures before the bridge exists; later ones arrive through on_job_finished
+    bool start() {
+        started_at_ = std::chrono::steady_clock::now();
+        const BatchOptions& options = runner_.options_;
+
+        input_fd_ = ::open(item_.input.c_str(), O_RDONLY);
+        if (input_fd_ < 0) {
+            error_ = std::strerror(errno);
+            return false;
+        }
+        WavInfo info;
+        if (!read_wav_header(input_fd_, info, error_)) {
+            return false;
+        }
+
+        fs::path output = fs::path(options.output_dir) / item_.name;
+        audio_path_ = output.string() + ".wav";
+        part_path_ = audio_path_ + ".part";
+        output_fd_ = ::open(part_path_.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        if (output_fd_ < 0 || !write_wav_header(output_fd_, options.output_sample_rate, 0) ||
+            ::lseek(output_fd_, static_cast<off_t>(WAV_HEADER_SIZE), SEEK_SET) < 0) {
+            error_ = "cannot create " + part_path_;
+            return false;
+        }
+
+        auto jsonl = std::make_unique<JsonlTranscriptOutput>();
+        if (!jsonl->open(output.string() + ".jsonl")) {
+            error_ = "cannot create transcript";
+            return false;
+        }
+        transcripts_.add_output(std::move(jsonl));
+        transcripts_.start();
+
+        PipeOptions pipe_options;
+        pipe_options.endpoint = options.endpoint;
+        pipe_options.setup_message = options.setup_message;
+        pipe_options.input_fd = input_fd_;
+        pipe_options.output_fd = output_fd_;
+        pipe_options.input_sample_rate = info.sample_rate;
+        pipe_options.input_limit = info.data_bytes;
+        pipe_options.speed = 0;
+        pipe_options.setup_timeout = options.setup_timeout;
+        pipe_options.drain_timeout = options.drain_timeout;
+
+        {
+            std::lock_guard<std::mutex> lock(bridge_mutex_);
+            if (stopped_) {
+                error_ = "stopped";
+                return false;
+            }
+            bridge_ = std::make_shared<PipeBridge>(runner_.io_context_, pipe_options, &transcripts_);
+            bridge_->set_finished_callback([this]() {
+                runner_.on_job_finished(shared_from_this());
+            });
+            // Connects on the bridge's strand; a stop() from here on aborts the handshake
+            bridge_->start();
+        }
+        return true;
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(bridge_mutex_);
+        stopped_ = true;
+        if (bridge_ && !bridge_->finished()) {
+            bridge_->stop();
+        }
+    }
+
+    // True for the first caller only; a job is reported exactly once
+    bool mark_finished() {
+        return !finished_.exchange(true);
+    }
+
+    // Finalize the outputs; a file only gets its final name once it succeeded
+    bool complete() {
+        if (bridge_) {
+            stats_ = bridge_->get_stats();
+        }
+        bool stopped;
+        {
+            std::lock_guard<std::mutex> lock(bridge_mutex_);
+            stopped = stopped_;
+        }
+        bool ok = error_.empty() && bridge_ && bridge_->succeeded() && !stopped;
+        if (ok && stats_.turns == 0) {
+            error_ = "no turnComplete within the drain timeout";
+            ok = false;
+        } else if (!ok && error_.empty()) {
+            error_ = stopped ? "stopped" : "session failed";
+        }
+
+        transcripts_.stop();
+        if (output_fd_ >= 0 && !write_wav_header(output_fd_, runner_.options_.output_sample_rate,
+                                                 stats_.downlink_bytes)) {
+            error_ = "cannot finalize " + part_path_;
+            ok = false;
+        }
+        close_files();
+        if (ok) {
+            std::error_code ec;
+            fs::rename(part_path_, audio_path_, ec);
+            if (ec) {
+                error_ = ec.message();
+                ok = false;
+            }
+        }
+        seconds_ = seconds_since(started_at_);
+        return ok;
+    }
+
+    const Item& item() const { return item_; }
+    const std::string& error() const { return error_; }
+    const PipeBridge::Stats& stats() const { return stats_; }
+    double seconds() const { return seconds_; }
+    const std::string& audio_path() const { return audio_path_; }
+
+private:
+    void close_files() {
+        if (input_fd_ >= 0) {
+            ::close(input_fd_);
+            input_fd_ = -1;
+        }
+        if (output_fd_ >= 0) {
+            ::close(output_fd_);
+            output_fd_ = -1;
+        }
+    }
+
+    BatchRunner& runner_;
+    Item item_;
+    int input_fd_ = -1;
+    int output_fd_ = -1;
+    std::string audio_path_;
+    std::string part_path_;
+    TranscriptSink transcripts_;
+
+    std::mutex bridge_mutex_;
+    std::shared_ptr<PipeBridge> bridge_;     // Outlives the job while its handlers drain
+    bool stopped_ = false;
+    std::atomic<bool> finished_{false};
+
+    std::chrono::steady_clock::time_point started_at_;
+    std::string error_;
+    PipeBridge::Stats stats_;
+    double seconds_ = 0.0;
+};
+
+BatchRunner::BatchRunner(const BatchOptions& options)
+    : options_(options) {
+    if (options_.thread_count == 0) {
+        options_.thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    options_.concurrency = std::max<std::size_t>(1, options_.concurrency);
+}
+
+BatchRunner::~BatchRunner() {
+    stop();
+    io_context_.stop();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+bool BatchRunner::collect_inputs(const std::string& path, std::vector<std::string>& inputs) {
+    std::error_code ec;
+    if (fs::is_directory(path, ec)) {
+        for (const auto& entry : fs::directory_iterator(path, ec)) {
+            std::string extension = entry.path().extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+            if (entry.is_regular_file() && extension == ".wav") {
+                inputs.push_back(entry.path().string());
+            }
+        }
+        if (ec) {
+            std::cerr << "[Batch] Cannot read " << path << ": " << ec.message() << std::endl;
+            return false;
+        }
+        std::sort(inputs.begin(), inputs.end());
+        return true;
+    }
+
+    std::ifstream manifest(path);
+    if (!manifest.is_open()) {
+        std::cerr << "[Batch] Cannot open " << path << std::endl;
+        return false;
+    }
+    fs::path base = fs::path(path).parent_path();
+    std::string line;
+    while (std::getline(manifest, line)) {
+        line.erase(0, line.find_first_not_of(" \t"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        fs::path input(line);
+        inputs.push_back((input.is_absolute() ? input : base / input).string());
+    }
+    return true;
+}
+
+bool BatchRunner::run(const std::vector<std::string>& inputs) {
+    std::error_code ec;
+    fs::create_directories(options_.output_dir, ec);
+    results_.open(fs::path(options_.output_dir) / "batch_results.jsonl", std::ios::app);
+    if (!results_.is_open()) {
+        std::cerr << "[Batch] Cannot write to " << options_.output_dir << std::endl;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Outputs are named after the input; repeated names get a numeric suffix
+        std::unordered_map<std::string, int> seen;
+        for (const std::string& input : inputs) {
+            std::string name = fs::path(input).stem().string();
+            int count = seen[name]++;
+            if (count > 0) {
+                name += "_" + std::to_string(count + 1);
+            }
+            if (fs::exists(fs::path(options_.output_dir) / (name + ".wav"), ec)) {
+                skipped_++;
+                continue;
+            }
+            pending_.push_back(Item{input, name, 0});
+        }
+        total_ = inputs.size();
+        started_at_ = std::chrono::steady_clock::now();
+    }
+
+    auto work = net::make_work_guard(io_context_);
+    for (std::size_t i = 0; i < options_.thread_count; i++) {
+        threads_.emplace_back([this]() {
+            thread_placement().apply("io");
+            io_context_.run();
+        });
+    }
+    launch_next();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this]() {
+        return jobs_.empty() && (pending_.empty() || stopping_);
+    });
+    bool ok = failed_ == 0 && pending_.empty() && !stopping_;
+    lock.unlock();
+
+    // Let the last close handshakes finish; the pool threads return once no handler is left
+    work.reset();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+    results_.close();
+    return ok;
+}
+
+void BatchRunner::stop() {
+    std::vector<std::shared_ptr<Job>> jobs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        jobs.assign(jobs_.begin(), jobs_.end());
+    }
+    for (auto& job : jobs) {
+        job->stop();
+    }
+    done_cv_.notify_all();
+}
+
+void BatchRunner::launch_next() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!stopping_ && jobs_.size() < options_.concurrency && !pending_.empty()) {
+        auto job = std::make_shared<Job>(*this, std::move(pending_.front()));
+        pending_.pop_front();
+        jobs_.insert(job);
+        // Connect on the pool so the handshakes of concurrent files overlap
+        net::post(io_context_, [this, job]() {
+            if (!job->start()) {
+                on_job_finished(job);
+            }
+        });
+    }
+}
+
+void BatchRunner::on_job_finished(const std::shared_ptr<Job>& job) {
+    if (!job->mark_finished()) {
+        return;
+    }
+    bool ok = job->complete();
+    const PipeBridge::Stats& stats = job->stats();
+    uplink_bytes_.fetch_add(stats.uplink_bytes, std::memory_order_relaxed);
+    downlink_bytes_.fetch_add(stats.downlink_bytes, std::memory_order_relaxed);
+    if (ok) {
+        file_ms_.record(static_cast<uint64_t>(job->seconds() * 1000.0));
+        first_audio_ms_.record(static_cast<uint64_t>(stats.first_audio_seconds * 1000.0));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Item item = job->item();
+        item.attempts++;
+        if (ok) {
+            succeeded_++;
+        } else if (item.attempts <= options_.retries && !stopping_) {
+            retried_++;
+            pending_.push_back(item);
+        } else {
+            failed_++;
+            std::cerr << "[Batch] " << item.input << ": " << job->error() << std::endl;
+        }
+
+        nlohmann::json line = {
+            {"input", item.input},
+            {"output", ok ? job->audio_path() : ""},
+            {"ok", ok},
+            {"attempt", item.attempts},
+            {"error", job->error()},
+            {"seconds", job->seconds()},
+            {"first_audio_seconds", stats.first_audio_seconds},
+            {"uplink_bytes", stats.uplink_bytes},
+            {"downlink_bytes", stats.downlink_bytes}
+        };
+        results_ << line.dump() << '\n';
+        results_.flush();
+        jobs_.erase(job);
+    }
+
+    launch_next();
+    done_cv_.notify_all();
+}
+
+BatchRunner::Summary BatchRunner::get_summary() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Summary summary;
+    summary.total = total_;
+    summary.skipped = skipped_;
+    summary.succeeded = succeeded_;
+    summary.failed = failed_;
+    summary.retried = retried_;
+    summary.active = jobs_.size();
+    summary.uplink_bytes = uplink_bytes_.load(std::memory_order_relaxed);
+    summary.downlink_bytes = downlink_bytes_.load(std::memory_order_relaxed);
+    summary.elapsed_seconds = total_ > 0 ? seconds_since(started_at_) : 0.0;
+    if (summary.elapsed_seconds > 0.0) {
+        summary.files_per_minute = summary.succeeded * 60.0 / summary.elapsed_seconds;
+    }
+    return summary;
+}
+
+void BatchRunner::print_report(std::ostream& out) const {
+    Summary summary = get_summary();
+    std::ios_base::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(1);
+    out << "[Batch] " << summary.succeeded + summary.failed + summary.skipped << "/" << summary.total
+        << " done (ok " << summary.succeeded << ", failed " << summary.failed << ", skipped "
+        << summary.skipped << ", retried " << summary.retried << ", active " << summary.active << "), "
+        << summary.files_per_minute << " files/min, " << summary.elapsed_seconds << " s" << std::endl;
+    out << "  Per file: " << file_ms_.summary("ms") << std::endl;
+    out << "  First audio: " << first_audio_ms_.summary("ms") << std::endl;
+    out.flags(flags);
+}
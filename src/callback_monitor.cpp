@@ -0,0 +1,137 @@
+#include "callback_monitor.h"
+#include <cmath>
+#include <iomanip>
+
+namespace {
+
+// Exposition bounds for callback durations and jitter, in microseconds
+const std::vector<uint64_t> CALLBACK_BOUNDS_US = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 20000, 50000, 100000
+};
+
+// An interval this much longer than the previous period counts as a missed period
+constexpr double MISSED_PERIOD_FACTOR = 1.5;
+
+void update_max(std::atomic<uint64_t>& target, uint64_t value) noexcept {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+}  // namespace
+
+CallbackMonitor::CallbackMonitor(const std::string& name, int sample_rate, double warn_fraction)
+    : name_(name)
+    , sample_rate_(sample_rate)
+    , warn_fraction_(warn_fraction)
+    , duration_us_(metrics().histogram("gemini_audio_" + name + "_callback_seconds",
+          "Time spent inside the " + name + " callback", CALLBACK_BOUNDS_US, 1e-6))
+    , jitter_us_(metrics().histogram("gemini_audio_" + name + "_callback_jitter_seconds",
+          "Deviation of the " + name + " callback interval from its period", CALLBACK_BOUNDS_US, 1e-6))
+    , callbacks_(metrics().counter("gemini_audio_" + name + "_callbacks_total",
+          "Number of " + name + " callbacks"))
+    , over_budget_(metrics().counter("gemini_audio_" + name + "_callback_over_budget_total",
+          "Callbacks that ran longer than their period (xrun risk)"))
+    , over_warning_(metrics().counter("gemini_audio_" + name + "_callback_slow_total",
+          "Callbacks that ran longer than the warning fraction of their period"))
+    , missed_periods_(metrics().counter("gemini_audio_" + name + "_missed_periods_total",
+          "Device periods skipped between callbacks (dropped capture / late playback)"))
+    , underruns_(metrics().counter("gemini_audio_" + name + "_underruns_total",
+          "Callbacks that ran out of buffered audio (includes the end of each response)"))
+    , underrun_frames_(metrics().counter("gemini_audio_" + name + "_underrun_frames_total",
+          "Frames zero-filled because of underruns")) {
+}
+
+CallbackMonitor::Clock::time_point CallbackMonitor::begin(uint32_t frame_count) noexcept {
+    auto now = Clock::now();
+    int64_t now_value = now_ns(now);
+    int64_t last = last_begin_ns_.exchange(now_value, std::memory_order_relaxed);
+    uint32_t last_frames = last_frames_.exchange(frame_count, std::memory_order_relaxed);
+
+    if (last != 0 && last_frames > 0 && sample_rate_ > 0) {
+        // The previous callback's period is when this one was due
+        double period_ns = last_frames * 1e9 / sample_rate_;
+        double interval_ns = static_cast<double>(now_value - last);
+        jitter_us_.record(static_cast<uint64_t>(std::fabs(interval_ns - period_ns) / 1000.0));
+
+        if (interval_ns > period_ns * MISSED_PERIOD_FACTOR) {
+            missed_periods_.inc(static_cast<uint64_t>(std::llround(interval_ns / period_ns)) - 1);
+        }
+    }
+    return now;
+}
+
+void CallbackMonitor::end(Clock::time_point started, uint32_t frame_count, uint32_t zero_filled) noexcept {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - started).count();
+    uint64_t elapsed_us = elapsed > 0 ? static_cast<uint64_t>(elapsed) : 0;
+    uint64_t budget_us = sample_rate_ > 0 ? static_cast<uint64_t>(frame_count) * 1000000 / sample_rate_ : 0;
+
+    callbacks_.inc();
+    duration_us_.record(elapsed_us);
+    if (budget_us > 0) {
+        load_permille_.record(elapsed_us * 1000 / budget_us);
+        if (elapsed_us > budget_us) {
+            over_budget_.inc();
+        }
+        if (elapsed_us > budget_us * warn_fraction_.load(std::memory_order_relaxed)) {
+            over_warning_.inc();
+            pending_warnings_.fetch_add(1, std::memory_order_relaxed);
+            if (elapsed_us > worst_pending_us_.load(std::memory_order_relaxed)) {
+                update_max(worst_pending_us_, elapsed_us);
+                worst_pending_budget_us_.store(budget_us, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    if (zero_filled > 0) {
+        underruns_.inc();
+        underrun_frames_.inc(zero_filled);
+    }
+}
+
+CallbackMonitor::Stats CallbackMonitor::get_stats() const {
+    Stats stats;
+    stats.callbacks = callbacks_.value();
+    stats.over_budget = over_budget_.value();
+    stats.over_warning = over_warning_.value();
+    stats.missed_periods = missed_periods_.value();
+    stats.underruns = underruns_.value();
+    stats.underrun_frames = underrun_frames_.value();
+    return stats;
+}
+
+void CallbackMonitor::report_warnings(std::ostream& out) {
+    uint64_t pending = pending_warnings_.exchange(0, std::memory_order_relaxed);
+    if (pending == 0) {
+        return;
+    }
+    uint64_t worst = worst_pending_us_.exchange(0, std::memory_order_relaxed);
+    uint64_t budget = worst_pending_budget_us_.load(std::memory_order_relaxed);
+
+    out << "Warning: " << pending << " " << name_ << " callback(s) exceeded "
+        << static_cast<int>(warn_fraction_.load(std::memory_order_relaxed) * 100)
+        << "% of the period (worst " << worst << " us of " << budget << " us)" << std::endl;
+}
+
+void CallbackMonitor::print_summary(std::ostream& out) const {
+    Stats stats = get_stats();
+    if (stats.callbacks == 0) {
+        return;
+    }
+
+    out << "Audio " << name_ << " callbacks: " << stats.callbacks
+        << " (over budget " << stats.over_budget
+        << ", slow " << stats.over_warning
+        << ", missed periods " << stats.missed_periods;
+    if (stats.underruns > 0) {
+        out << ", underruns " << stats.underruns << " / " << stats.underrun_frames << " frames";
+    }
+    out << ")" << std::endl;
+    out << "  duration  " << duration_us_.summary("us") << std::endl;
+    out << "  jitter    " << jitter_us_.summary("us") << std::endl;
+    out << "  load      p50=" << std::fixed << std::setprecision(1)
+        << load_permille_.percentile(50) / 10.0 << "% p99="
+        << load_permille_.percentile(99) / 10.0 << "% max="
+        << load_permille_.max() / 10.0 << "%" << std::defaultfloat << std::endl;
+}
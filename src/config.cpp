@@ -38,6 +38,9 @@ void Config::setDefaults() {
     buffer_size_ = 24000;
     min_buffer_size_ = 7200;
     gain_factor_ = 5;
+
+    // Default thread placement: leave every thread to the kernel
+    thread_placement_ = ThreadPlacementConfig();
 }
 
 void Config::loadFromFile(const std::string& config_path) {
@@ -115,6 +118,38 @@ void Config::loadFromFile(const std::string& config_path) {
             }
         }
 
+        // Thread placement
+        if (config_json.contains("threads")) {
+            nlohmann::json& threads = config_json["threads"];
+            for (auto& [key, value] : threads.items()) {
+                if (key == "lockMemory") {
+                    thread_placement_.lock_memory = value.get<bool>();
+                    continue;
+                }
+                ThreadRule rule;
+                if (value.contains("cpus")) {
+                    rule.cpus = value["cpus"].get<std::vector<int>>();
+                }
+                if (value.contains("policy")) {
+                    std::string policy = value["policy"].get<std::string>();
+                    if (policy == "fifo") {
+                        rule.policy = SchedPolicy::Fifo;
+                    } else if (policy == "rr") {
+                        rule.policy = SchedPolicy::RoundRobin;
+                    } else if (policy != "other") {
+                        throw std::runtime_error("threads." + key + ".policy must be other, fifo or rr");
+                    }
+                }
+                if (value.contains("priority")) {
+                    rule.priority = value["priority"].get<int>();
+                }
+                if (value.contains("nice")) {
+                    rule.nice = value["nice"].get<int>();
+                }
+                thread_placement_.roles[key] = rule;
+            }
+        }
+
     } catch (const json::exception& e) {
         throw std::runtime_error("JSON Parse Error: " + std::string(e.what()));
     } catch (const std::exception& e) {
@@ -122,6 +157,53 @@ void Config::loadFromFile(const std::string& config_path) {
     }
 }
 
+AudioTuning Config::getAudioTuning() const {
+    AudioTuning tuning;
+    tuning.gain_factor = gain_factor_;
+    tuning.chunk_size = static_cast<size_t>(chunk_size_);
+    tuning.buffer_size = static_cast<size_t>(buffer_size_);
+    tuning.min_buffer_size = static_cast<size_t>(min_buffer_size_);
+    return tuning;
+}
+
+bool Config::validate(std::string& error) const {
+    if (input_sample_rate_ <= 0 || output_sample_rate_ <= 0) {
+        error = "audio sample rates must be positive";
+    } else if (chunk_size_ <= 0) {
+        error = "audio.chunkSize must be positive";
+    } else if (buffer_size_ <= 0 || min_buffer_size_ <= 0) {
+        error = "audio.bufferSize and audio.minBufferSize must be positive";
+    } else if (min_buffer_size_ > buffer_size_) {
+        error = "audio.minBufferSize must not exceed audio.bufferSize";
+    } else if (gain_factor_ < 0 || gain_factor_ > 100) {
+        error = "audio.gainFactor must be between 0 and 100";
+    } else if (temperature_ < 0.0 || top_p_ < 0.0 || top_p_ > 1.0 || top_k_ <= 0) {
+        error = "model.temperature, model.topP or model.topK is out of range";
+    } else if (!validate_thread_placement(thread_placement_, error)) {
+        return false;
+    } else {
+        return true;
+    }
+    return false;
+}
+
+std::vector<std::string> Config::sessionChangesFrom(const Config& other) const {
+    // Everything sent in the setup message or fixed when the audio devices open
+    std::vector<std::string> changes;
+    if (model_name_ != other.model_name_) changes.push_back("model.name");
+    if (temperature_ != other.temperature_) changes.push_back("model.temperature");
+    if (top_p_ != other.top_p_) changes.push_back("model.topP");
+    if (top_k_ != other.top_k_) changes.push_back("model.topK");
+    if (response_modalities_ != other.response_modalities_) changes.push_back("model.responseModalities");
+    if (enable_search_ != other.enable_search_) changes.push_back("features.enableSearch");
+    if (input_audio_transcription_ != other.input_audio_transcription_) changes.push_back("features.inputAudioTranscription");
+    if (output_audio_transcription_ != other.output_audio_transcription_) changes.push_back("features.outputAudioTranscription");
+    if (system_instruction_text_ != other.system_instruction_text_) changes.push_back("systemInstruction.text");
+    if (input_sample_rate_ != other.input_sample_rate_) changes.push_back("audio.inputSampleRate");
+    if (output_sample_rate_ != other.output_sample_rate_) changes.push_back("audio.outputSampleRate");
+    return changes;
+}
+
 void Config::print() const {
     std::cout << "=== Configuration ===" << std::endl;
     std::cout << "Model Name: " << model_name_ << std::endl;
@@ -134,5 +216,12 @@ void Config::print() const {
     if (!system_instruction_text_.empty()) {
         std::cout << "System Instruction: " << system_instruction_text_ << std::endl;
     }
+    if (!thread_placement_.empty()) {
+        std::cout << "Thread Placement:";
+        for (const auto& [role, rule] : thread_placement_.roles) {
+            std::cout << " " << role;
+        }
+        std::cout << (thread_placement_.lock_memory ? " (memory locked)" : "") << std::endl;
+    }
     std::cout << "==================" << std::endl;
 }
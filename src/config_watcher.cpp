@@ -0,0 +1,188 @@
+#include "config_watcher.h"
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+// Editors often write a file in several steps; wait for them to settle
+constexpr auto RELOAD_DEBOUNCE = std::chrono::milliseconds(100);
+
+constexpr uint32_t WATCH_EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+void print_tuning_change(const char* name, size_t before, size_t after, bool& first) {
+    if (before == after) {
+        return;
+    }
+    std::cout << (first ? " " : ", ") << name << " " << before << " -> " << after;
+    first = false;
+}
+
+}  // namespace
+
+// The read and debounce handlers run on io threads; they own this state and reach the
+// watcher only through owner, which stop() clears under the mutex
+struct ConfigWatcher::Watch {
+    Watch(net::io_context& io_context, ConfigWatcher* watcher, const std::string& config_path)
+        : strand(net::make_strand(io_context)),
+          descriptor(strand),
+          debounce_timer(strand),
+          file_name(std::filesystem::path(config_path).filename().string()),
+          read_buffer(4096),
+          owner(watcher) {
+    }
+
+    net::strand<net::io_context::executor_type> strand;
+    net::posix::stream_descriptor descriptor;   // Strand only, after start()
+    net::steady_timer debounce_timer;           // Strand only
+    std::string file_name;
+    std::vector<char> read_buffer;
+
+    std::mutex mutex;
+    ConfigWatcher* owner;                       // Guarded by mutex; null once stopped
+};
+
+ConfigWatcher::ConfigWatcher(net::io_context& io_context, const std::string& config_path,
+                             const Config& session_config)
+    : watch_(std::make_shared<Watch>(io_context, this, config_path)),
+      config_path_(config_path),
+      session_config_(session_config),
+      tuning_(session_config.getAudioTuning()) {
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    stop();
+}
+
+bool ConfigWatcher::start() {
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Config watcher: inotify unavailable" << std::endl;
+        return false;
+    }
+
+    // Watch the directory so files replaced by rename (atomic saves) are still seen
+    std::filesystem::path directory = std::filesystem::path(config_path_).parent_path();
+    if (directory.empty()) {
+        directory = ".";
+    }
+    if (inotify_add_watch(fd, directory.c_str(), WATCH_EVENTS) < 0) {
+        std::cerr << "Config watcher: cannot watch " << directory.string() << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    // No handler is pending yet, so the descriptor may be assigned from this thread
+    watch_->descriptor.assign(fd);
+    net::dispatch(watch_->strand, [watch = watch_]() {
+        do_read(watch);
+    });
+    return true;
+}
+
+void ConfigWatcher::stop() {
+    {
+        // Waits for a reload in progress; later handlers find no owner
+        std::lock_guard<std::mutex> lock(watch_->mutex);
+        watch_->owner = nullptr;
+    }
+    net::dispatch(watch_->strand, [watch = watch_]() {
+        boost::system::error_code ec;
+        watch->debounce_timer.cancel();
+        if (watch->descriptor.is_open()) {
+            watch->descriptor.cancel(ec);
+            watch->descriptor.close(ec);
+        }
+    });
+}
+
+void ConfigWatcher::do_read(const std::shared_ptr<Watch>& watch) {
+    watch->descriptor.async_read_some(
+        net::buffer(watch->read_buffer),
+        [watch](const boost::system::error_code& ec, std::size_t bytes) {
+            if (ec) {
+                return;
+            }
+
+            bool changed = false;
+            std::size_t offset = 0;
+            while (offset + sizeof(inotify_event) <= bytes) {
+                inotify_event event;
+                std::memcpy(&event, watch->read_buffer.data() + offset, sizeof(event));
+                const char* name = watch->read_buffer.data() + offset + sizeof(inotify_event);
+                if (event.len > 0 && watch->file_name == name) {
+                    changed = true;
+                }
+                offset += sizeof(inotify_event) + event.len;
+            }
+
+            if (changed) {
+                schedule_reload(watch);
+            }
+            do_read(watch);
+        });
+}
+
+void ConfigWatcher::schedule_reload(const std::shared_ptr<Watch>& watch) {
+    watch->debounce_timer.expires_after(RELOAD_DEBOUNCE);
+    watch->debounce_timer.async_wait([watch](const boost::system::error_code& ec) {
+        if (ec) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(watch->mutex);
+        if (watch->owner) {
+            watch->owner->reload();
+        }
+    });
+}
+
+bool ConfigWatcher::reload() {
+    Config next;
+    try {
+        next = Config(config_path_);
+    } catch (const std::exception& e) {
+        std::cerr << "Config reload failed: " << e.what() << " (keeping current settings)" << std::endl;
+        return false;
+    }
+
+    std::string error;
+    if (!next.validate(error)) {
+        std::cerr << "Config reload rejected: " << error << " (keeping current settings)" << std::endl;
+        return false;
+    }
+
+    AudioTuning before = tuning_.get();
+    AudioTuning after = next.getAudioTuning();
+    tuning_.publish(after);
+
+    std::cout << "[Config] Reloaded " << config_path_ << ":";
+    bool first = true;
+    if (before.gain_factor != after.gain_factor) {
+        std::cout << " gainFactor " << before.gain_factor << " -> " << after.gain_factor;
+        first = false;
+    }
+    print_tuning_change("chunkSize", before.chunk_size, after.chunk_size, first);
+    print_tuning_change("bufferSize", before.buffer_size, after.buffer_size, first);
+    print_tuning_change("minBufferSize", before.min_buffer_size, after.min_buffer_size, first);
+    if (first) {
+        std::cout << " no audio changes";
+    }
+    std::cout << std::endl;
+
+    // Compared with the running session, so pending fields are repeated until reconnecting
+    std::vector<std::string> session_fields = next.sessionChangesFrom(session_config_);
+    if (!session_fields.empty()) {
+        std::cout << "[Config] Takes effect in a new session:";
+        for (const std::string& field : session_fields) {
+            std::cout << " " << field;
+        }
+        std::cout << std::endl;
+    }
+
+    if (reload_callback_) {
+        reload_callback_(after, session_fields);
+    }
+    return true;
+}
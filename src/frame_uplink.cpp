@@ -0,0 +1,199 @@
+#include "frame_uplink.h"
+#include "message_handler.h"
+#include "metrics.h"
+#include "trace_recorder.h"
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+
+// Process-wide frame uplink metrics
+struct FrameMetrics {
+    Counter& sent = metrics().counter("gemini_video_frames_sent_total", "Image frames sent to the model");
+    Counter& dropped = metrics().counter("gemini_video_frames_dropped_total",
+        "Image frames dropped by the fps limit or because the previous frame was still queued");
+    Counter& duplicates = metrics().counter("gemini_video_frames_duplicate_total",
+        "Image frames skipped as nearly identical to the last one sent");
+    Counter& bytes = metrics().counter("gemini_video_bytes_sent_total", "Encoded image bytes sent");
+    Histogram& encode_us = metrics().histogram("gemini_video_encode_seconds", "Downscale, compare and encode time per sent frame",
+        {1000, 2500, 5000, 10000, 25000, 50000, 100000}, 1e-6);
+};
+
+FrameMetrics& frame_metrics() {
+    static FrameMetrics instance;
+    return instance;
+}
+
+// Reads a file descriptor for an istream, waking every 200 ms so a stalled pipe cannot block shutdown
+class PollingStreamBuf : public std::streambuf {
+public:
+    PollingStreamBuf(int fd, const std::function<bool()>& keep_running) : fd_(fd), keep_running_(keep_running) {}
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        while (keep_running_()) {
+            pollfd pfd{fd_, POLLIN, 0};
+            int ready = ::poll(&pfd, 1, 200);
+            if (ready < 0 && errno != EINTR) {
+                return traits_type::eof();
+            }
+            if (ready <= 0) {
+                continue;
+            }
+            ssize_t n = ::read(fd_, buffer_, sizeof(buffer_));
+            if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+                continue;
+            }
+            if (n <= 0) {
+                return traits_type::eof();
+            }
+            setg(buffer_, buffer_, buffer_ + n);
+            return traits_type::to_int_type(*gptr());
+        }
+        return traits_type::eof();
+    }
+
+private:
+    int fd_;
+    const std::function<bool()>& keep_running_;
+    char buffer_[64 * 1024];
+};
+
+}  // namespace
+
+FrameUplink::FrameUplink(WebSocketClient& client, const FrameUplinkOptions& options)
+    : client_(client)
+    , options_(options)
+    , interval_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(options.fps > 0.0 ? 1.0 / options.fps : 0.0))) {
+}
+
+bool FrameUplink::submit(const ImageFrame& frame, std::chrono::steady_clock::time_point now) {
+    offered_.fetch_add(1, std::memory_order_relaxed);
+    if (frame.empty()) {
+        return false;
+    }
+    if (now < next_send_) {
+        rate_limited_.fetch_add(1, std::memory_order_relaxed);
+        frame_metrics().dropped.inc();
+        return false;
+    }
+    // Never queue a second frame behind one the socket has not taken yet; newer frames are worth more
+    if (client_.pending_bulk_writes() > 0) {
+        congested_.fetch_add(1, std::memory_order_relaxed);
+        frame_metrics().dropped.inc();
+        return false;
+    }
+
+    TraceScope trace_scope("encode_frame", frame.rgb.size());
+    auto begin = std::chrono::steady_clock::now();
+    downscale_frame(frame, options_.max_width, options_.max_height, scaled_);
+    if (options_.min_change > 0.0 && !last_sent_.empty() &&
+        changed_block_fraction(last_sent_, scaled_, options_.block_threshold) < options_.min_change) {
+        // Not rate-limited: the next frame that does change goes out without waiting a whole interval
+        duplicates_.fetch_add(1, std::memory_order_relaxed);
+        frame_metrics().duplicates.inc();
+        return false;
+    }
+    encode_jpeg(scaled_, options_.jpeg_quality, jpeg_);
+    std::string message = MessageHandler::create_image_input_message(jpeg_);
+    auto encode_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - begin).count());
+
+    client_.send_bulk(std::move(message));
+    std::swap(last_sent_, scaled_);
+    // Keep to the schedule so frames paced at exactly the fps are not dropped for arriving a little early
+    next_send_ = now - next_send_ < interval_ ? next_send_ + interval_ : now + interval_;
+
+    sent_.fetch_add(1, std::memory_order_relaxed);
+    bytes_sent_.fetch_add(jpeg_.size(), std::memory_order_relaxed);
+    encode_us_.record(encode_us);
+    frame_metrics().sent.inc();
+    frame_metrics().bytes.inc(jpeg_.size());
+    frame_metrics().encode_us.record(encode_us);
+    return true;
+}
+
+FrameUplink::Stats FrameUplink::get_stats() const {
+    Stats stats;
+    stats.offered = offered_.load(std::memory_order_relaxed);
+    stats.sent = sent_.load(std::memory_order_relaxed);
+    stats.rate_limited = rate_limited_.load(std::memory_order_relaxed);
+    stats.congested = congested_.load(std::memory_order_relaxed);
+    stats.duplicates = duplicates_.load(std::memory_order_relaxed);
+    stats.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::size_t stream_frames(const std::string& source, FrameUplink& uplink, const std::function<bool()>& keep_running) {
+    ImageFrame frame;
+    std::string error;
+    std::size_t frames = 0;
+
+    std::error_code ec;
+    if (std::filesystem::is_directory(source, ec)) {
+        std::vector<std::filesystem::path> paths;
+        for (const auto& entry : std::filesystem::directory_iterator(source, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".ppm") {
+                paths.push_back(entry.path());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(uplink.options().fps > 0.0 ? 1.0 / uplink.options().fps : 0.0));
+        auto next = std::chrono::steady_clock::now();
+        for (const auto& path : paths) {
+            // Short naps so a low fps does not hold up shutdown
+            while (keep_running() && std::chrono::steady_clock::now() < next) {
+                std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                    next - std::chrono::steady_clock::now(), std::chrono::milliseconds(200)));
+            }
+            if (!keep_running()) {
+                break;
+            }
+            std::ifstream input(path, std::ios::binary);
+            if (!read_ppm(input, frame, error)) {
+                std::cerr << "[Video] Skipping " << path.string() << ": " << (error.empty() ? "empty file" : error) << std::endl;
+                continue;
+            }
+            frames++;
+            // Submit at the scheduled time so file read jitter cannot push a frame past the fps gate
+            uplink.submit(frame, next);
+            next = std::max(next + interval, std::chrono::steady_clock::now());
+        }
+        return frames;
+    }
+
+    int fd = STDIN_FILENO;
+    if (source != "-") {
+        // O_NONBLOCK so opening a FIFO does not wait for a writer; reads are gated by poll()
+        fd = ::open(source.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            std::cerr << "[Video] Cannot open " << source << std::endl;
+            return 0;
+        }
+    }
+    PollingStreamBuf buffer(fd, keep_running);
+    std::istream input(&buffer);
+    while (keep_running() && read_ppm(input, frame, error)) {
+        frames++;
+        uplink.submit(frame);
+    }
+    if (!error.empty()) {
+        std::cerr << "[Video] Frame stream stopped: " << error << std::endl;
+    }
+    if (fd != STDIN_FILENO) {
+        ::close(fd);
+    }
+    return frames;
+}
@@ -0,0 +1,107 @@
+#include "histogram.h"
+#include <limits>
+#include <sstream>
+
+Histogram::Histogram() : count_(0), sum_(0) {
+    for (auto& bucket : counts_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t Histogram::bucket_lower_bound(int index) {
+    if (index < SUB_BUCKETS) {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = index / SUB_BUCKETS - 1;
+    uint64_t sub = static_cast<uint64_t>(index % SUB_BUCKETS + SUB_BUCKETS);
+    return sub << shift;
+}
+
+uint64_t Histogram::bucket_upper_bound(int index) {
+    if (index < SUB_BUCKETS) {
+        return static_cast<uint64_t>(index);
+    }
+    if (index == BUCKET_COUNT - 1) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    return bucket_lower_bound(index + 1) - 1;
+}
+
+double Histogram::mean() const {
+    uint64_t n = count();
+    return n == 0 ? 0.0 : static_cast<double>(sum()) / static_cast<double>(n);
+}
+
+uint64_t Histogram::min() const {
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        if (bucket_count(i) > 0) {
+            return bucket_lower_bound(i);
+        }
+    }
+    return 0;
+}
+
+uint64_t Histogram::max() const {
+    for (int i = BUCKET_COUNT - 1; i >= 0; i--) {
+        if (bucket_count(i) > 0) {
+            return bucket_upper_bound(i);
+        }
+    }
+    return 0;
+}
+
+uint64_t Histogram::percentile(double percentile) const {
+    // Sum the buckets rather than trusting count_, which may be ahead of
+    // the buckets while a concurrent record() is in flight
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        total += bucket_count(i);
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    if (percentile < 0.0) percentile = 0.0;
+    if (percentile > 100.0) percentile = 100.0;
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += bucket_count(i);
+        if (seen >= rank) {
+            return bucket_upper_bound(i);
+        }
+    }
+    return max();
+}
+
+void Histogram::merge(const Histogram& other) {
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        uint64_t n = other.bucket_count(i);
+        if (n > 0) {
+            counts_[i].fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+    count_.fetch_add(other.count(), std::memory_order_relaxed);
+    sum_.fetch_add(other.sum(), std::memory_order_relaxed);
+}
+
+void Histogram::reset() {
+    for (auto& bucket : counts_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+}
+
+std::string Histogram::summary(const std::string& unit) const {
+    std::ostringstream oss;
+    oss << "n=" << count()
+        << " min=" << min() << unit
+        << " p50=" << percentile(50.0) << unit
+        << " p99=" << percentile(99.0) << unit
+        << " p999=" << percentile(99.9) << unit
+        << " max=" << max() << unit;
+    return oss.str();
+}
@@ -0,0 +1,477 @@
+#include "image_frame.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// --- PPM ---
+
+// Largest accepted frame side; a corrupt header must not allocate gigabytes (8192^2 RGB is 192 MiB)
+constexpr int MAX_PPM_DIMENSION = 8192;
+
+// Skips whitespace and '#' comments, then reads one decimal header field
+bool read_ppm_field(std::istream& input, int& value) {
+    int c = input.get();
+    while (c != EOF) {
+        if (c == '#') {
+            while (c != EOF && c != '\n') {
+                c = input.get();
+            }
+        } else if (!std::isspace(c)) {
+            break;
+        }
+        c = input.get();
+    }
+    if (c == EOF || !std::isdigit(c)) {
+        return false;
+    }
+    value = 0;
+    while (c != EOF && std::isdigit(c)) {
+        value = value * 10 + (c - '0');
+        if (value > 1 << 20) {
+            return false;
+        }
+        c = input.get();
+    }
+    // Exactly one whitespace byte ends the field (it separates maxval from the pixels)
+    return c != EOF && std::isspace(c);
+}
+
+// --- JPEG tables (ITU-T T.81 Annex K) ---
+
+constexpr uint8_t ZIGZAG[64] = {
+    0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+constexpr uint8_t LUMA_QUANT[64] = {
+    16, 11, 10, 16, 24, 40, 51, 61,
+    12, 12, 14, 19, 26, 58, 60, 55,
+    14, 13, 16, 24, 40, 57, 69, 56,
+    14, 17, 22, 29, 51, 87, 80, 62,
+    18, 22, 37, 56, 68, 109, 103, 77,
+    24, 35, 55, 64, 81, 104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101,
+    72, 92, 95, 98, 112, 100, 103, 99,
+};
+
+constexpr uint8_t CHROMA_QUANT[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99,
+    18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,
+    47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+};
+
+constexpr uint8_t DC_LUMA_BITS[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+constexpr uint8_t DC_CHROMA_BITS[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+constexpr uint8_t DC_VALUES[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+constexpr uint8_t AC_LUMA_BITS[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+constexpr uint8_t AC_LUMA_VALUES[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa,
+};
+
+constexpr uint8_t AC_CHROMA_BITS[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+constexpr uint8_t AC_CHROMA_VALUES[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa,
+};
+
+// Canonical Huffman codes indexed by symbol
+struct HuffmanTable {
+    std::array<uint16_t, 256> code{};
+    std::array<uint8_t, 256> length{};
+
+    HuffmanTable(const uint8_t* bits, const uint8_t* values) {
+        uint16_t next = 0;
+        std::size_t k = 0;
+        for (int len = 1; len <= 16; len++) {
+            for (int i = 0; i < bits[len - 1]; i++) {
+                code[values[k]] = next++;
+                length[values[k]] = static_cast<uint8_t>(len);
+                k++;
+            }
+            next <<= 1;
+        }
+    }
+};
+
+// Orthonormal 8-point DCT-II basis: DCT_BASIS[u][x] = C(u)/2 * cos((2x+1)u*pi/16)
+struct DctBasis {
+    float value[8][8];
+
+    DctBasis() {
+        for (int u = 0; u < 8; u++) {
+            float scale = u == 0 ? std::sqrt(0.125f) : 0.5f;
+            for (int x = 0; x < 8; x++) {
+                value[u][x] = scale * std::cos((2 * x + 1) * u * static_cast<float>(M_PI) / 16.0f);
+            }
+        }
+    }
+};
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& output) : output_(output) {}
+
+    void write(uint32_t bits, int count) {
+        buffer_ = (buffer_ << count) | (bits & ((1u << count) - 1));
+        count_ += count;
+        while (count_ >= 8) {
+            uint8_t byte = static_cast<uint8_t>(buffer_ >> (count_ - 8));
+            output_.push_back(byte);
+            if (byte == 0xFF) {
+                output_.push_back(0x00);    // Byte stuffing
+            }
+            count_ -= 8;
+        }
+    }
+
+    // Pad the last byte with 1 bits
+    void flush() {
+        if (count_ > 0) {
+            write(0x7F, 8 - count_);
+        }
+    }
+
+private:
+    std::vector<uint8_t>& output_;
+    uint64_t buffer_ = 0;
+    int count_ = 0;
+};
+
+void put_u16(std::vector<uint8_t>& out, int value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void make_quant_table(const uint8_t* base, int quality, uint8_t* table) {
+    quality = std::clamp(quality, 1, 100);
+    int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+    for (int i = 0; i < 64; i++) {
+        table[i] = static_cast<uint8_t>(std::clamp((base[i] * scale + 50) / 100, 1, 255));
+    }
+}
+
+void write_huffman_table(std::vector<uint8_t>& out, int table_class_id, const uint8_t* bits, const uint8_t* values) {
+    int count = 0;
+    for (int i = 0; i < 16; i++) {
+        count += bits[i];
+    }
+    out.push_back(static_cast<uint8_t>(table_class_id));
+    out.insert(out.end(), bits, bits + 16);
+    out.insert(out.end(), values, values + count);
+}
+
+// Forward DCT, quantization and entropy coding of one level-shifted 8x8 block
+void encode_block(BitWriter& writer, const float* block, const uint8_t* quant, const HuffmanTable& dc,
+                  const HuffmanTable& ac, int& previous_dc) {
+    static const DctBasis basis;
+
+    float rows[64];
+    for (int y = 0; y < 8; y++) {
+        for (int u = 0; u < 8; u++) {
+            float sum = 0.0f;
+            for (int x = 0; x < 8; x++) {
+                sum += basis.value[u][x] * block[y * 8 + x];
+            }
+            rows[y * 8 + u] = sum;
+        }
+    }
+    int coefficients[64];
+    for (int u = 0; u < 8; u++) {
+        for (int v = 0; v < 8; v++) {
+            float sum = 0.0f;
+            for (int y = 0; y < 8; y++) {
+                sum += basis.value[v][y] * rows[y * 8 + u];
+            }
+            coefficients[v * 8 + u] = static_cast<int>(std::lround(sum / quant[v * 8 + u]));
+        }
+    }
+
+    auto magnitude = [](int value, int& bits) {
+        int absolute = std::abs(value);
+        int count = 0;
+        while (absolute) {
+            count++;
+            absolute >>= 1;
+        }
+        bits = value < 0 ? value + (1 << count) - 1 : value;
+        return count;
+    };
+
+    int bits = 0;
+    int diff = coefficients[0] - previous_dc;
+    previous_dc = coefficients[0];
+    int category = magnitude(diff, bits);
+    writer.write(dc.code[category], dc.length[category]);
+    if (category > 0) {
+        writer.write(static_cast<uint32_t>(bits), category);
+    }
+
+    int zeros = 0;
+    for (int k = 1; k < 64; k++) {
+        int value = coefficients[ZIGZAG[k]];
+        if (value == 0) {
+            zeros++;
+            continue;
+        }
+        while (zeros >= 16) {
+            writer.write(ac.code[0xF0], ac.length[0xF0]);
+            zeros -= 16;
+        }
+        category = magnitude(value, bits);
+        int symbol = (zeros << 4) | category;
+        writer.write(ac.code[symbol], ac.length[symbol]);
+        writer.write(static_cast<uint32_t>(bits), category);
+        zeros = 0;
+    }
+    if (zeros > 0) {
+        writer.write(ac.code[0x00], ac.length[0x00]);
+    }
+}
+
+}  // namespace
+
+bool read_ppm(std::istream& input, ImageFrame& frame, std::string& error) {
+    error.clear();
+    char magic[2];
+    if (!input.read(magic, 2)) {
+        return false;   // End of stream
+    }
+    if (magic[0] != 'P' || magic[1] != '6') {
+        error = "not a binary PPM (P6)";
+        return false;
+    }
+    int width = 0, height = 0, max_value = 0;
+    if (!read_ppm_field(input, width) || !read_ppm_field(input, height) || !read_ppm_field(input, max_value)) {
+        error = "malformed PPM header";
+        return false;
+    }
+    if (width <= 0 || height <= 0 || max_value != 255) {
+        error = "unsupported PPM (only 8-bit with maxval 255)";
+        return false;
+    }
+    if (width > MAX_PPM_DIMENSION || height > MAX_PPM_DIMENSION) {
+        error = "PPM frame " + std::to_string(width) + "x" + std::to_string(height) + " exceeds " +
+                std::to_string(MAX_PPM_DIMENSION) + "x" + std::to_string(MAX_PPM_DIMENSION);
+        return false;
+    }
+    frame.width = width;
+    frame.height = height;
+    frame.rgb.resize(static_cast<std::size_t>(width) * height * 3);
+    if (!input.read(reinterpret_cast<char*>(frame.rgb.data()), static_cast<std::streamsize>(frame.rgb.size()))) {
+        error = "truncated PPM pixel data";
+        return false;
+    }
+    return true;
+}
+
+void downscale_frame(const ImageFrame& input, int max_width, int max_height, ImageFrame& output) {
+    double scale = std::min({1.0, static_cast<double>(max_width) / input.width,
+                             static_cast<double>(max_height) / input.height});
+    int width = std::max(1, static_cast<int>(std::lround(input.width * scale)));
+    int height = std::max(1, static_cast<int>(std::lround(input.height * scale)));
+    output.width = width;
+    output.height = height;
+    output.rgb.resize(static_cast<std::size_t>(width) * height * 3);
+    if (width == input.width && height == input.height) {
+        std::memcpy(output.rgb.data(), input.rgb.data(), output.rgb.size());
+        return;
+    }
+
+    // Each output pixel averages the input rectangle it covers
+    const std::size_t stride = static_cast<std::size_t>(input.width) * 3;
+    uint8_t* out = output.rgb.data();
+    for (int y = 0; y < height; y++) {
+        int y0 = static_cast<int>(static_cast<int64_t>(y) * input.height / height);
+        int y1 = std::max(y0 + 1, static_cast<int>(static_cast<int64_t>(y + 1) * input.height / height));
+        for (int x = 0; x < width; x++) {
+            int x0 = static_cast<int>(static_cast<int64_t>(x) * input.width / width);
+            int x1 = std::max(x0 + 1, static_cast<int>(static_cast<int64_t>(x + 1) * input.width / width));
+            uint32_t sum[3] = {0, 0, 0};
+            for (int sy = y0; sy < y1; sy++) {
+                const uint8_t* row = input.rgb.data() + sy * stride;
+                for (int sx = x0; sx < x1; sx++) {
+                    sum[0] += row[sx * 3];
+                    sum[1] += row[sx * 3 + 1];
+                    sum[2] += row[sx * 3 + 2];
+                }
+            }
+            uint32_t count = static_cast<uint32_t>((y1 - y0) * (x1 - x0));
+            for (int c = 0; c < 3; c++) {
+                *out++ = static_cast<uint8_t>((sum[c] + count / 2) / count);
+            }
+        }
+    }
+}
+
+uint64_t sum_abs_diff(const uint8_t* a, const uint8_t* b, std::size_t size) {
+    uint64_t sum = 0;
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    // psadbw: 16 absolute differences summed into two 64-bit lanes per instruction
+    __m128i total = _mm_setzero_si128();
+    for (; i + 16 <= size; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        total = _mm_add_epi64(total, _mm_sad_epu8(x, y));
+    }
+    sum = static_cast<uint64_t>(_mm_cvtsi128_si64(total)) +
+          static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(total, total)));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    uint32x4_t total = vdupq_n_u32(0);
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t diff = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+        total = vpadalq_u16(total, vpaddlq_u8(diff));
+    }
+    sum = vaddvq_u32(total);
+#endif
+    for (; i < size; i++) {
+        sum += static_cast<uint64_t>(std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])));
+    }
+    return sum;
+}
+
+double changed_block_fraction(const ImageFrame& previous, const ImageFrame& current, int threshold) {
+    constexpr int BLOCK = 16;
+    if (previous.width != current.width || previous.height != current.height || current.empty()) {
+        return 1.0;
+    }
+    const std::size_t stride = static_cast<std::size_t>(current.width) * 3;
+    std::size_t blocks = 0, changed = 0;
+    for (int by = 0; by < current.height; by += BLOCK) {
+        int rows = std::min(BLOCK, current.height - by);
+        for (int bx = 0; bx < current.width; bx += BLOCK) {
+            int columns = std::min(BLOCK, current.width - bx);
+            std::size_t offset = by * stride + static_cast<std::size_t>(bx) * 3;
+            uint64_t sad = 0;
+            for (int r = 0; r < rows; r++) {
+                sad += sum_abs_diff(previous.rgb.data() + offset + r * stride,
+                                    current.rgb.data() + offset + r * stride, static_cast<std::size_t>(columns) * 3);
+            }
+            blocks++;
+            if (sad > static_cast<uint64_t>(threshold) * rows * columns * 3) {
+                changed++;
+            }
+        }
+    }
+    return static_cast<double>(changed) / blocks;
+}
+
+void encode_jpeg(const ImageFrame& frame, int quality, std::vector<uint8_t>& output) {
+    static const HuffmanTable dc_luma(DC_LUMA_BITS, DC_VALUES);
+    static const HuffmanTable ac_luma(AC_LUMA_BITS, AC_LUMA_VALUES);
+    static const HuffmanTable dc_chroma(DC_CHROMA_BITS, DC_VALUES);
+    static const HuffmanTable ac_chroma(AC_CHROMA_BITS, AC_CHROMA_VALUES);
+
+    uint8_t luma_quant[64], chroma_quant[64];
+    make_quant_table(LUMA_QUANT, quality, luma_quant);
+    make_quant_table(CHROMA_QUANT, quality, chroma_quant);
+
+    output.clear();
+    // SOI + APP0 (JFIF 1.1, no thumbnail)
+    static const uint8_t HEADER[] = {0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00,
+                                     0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00};
+    output.insert(output.end(), std::begin(HEADER), std::end(HEADER));
+
+    // DQT: both tables, stored in zigzag order
+    output.insert(output.end(), {0xFF, 0xDB});
+    put_u16(output, 2 + 2 * 65);
+    for (int table = 0; table < 2; table++) {
+        const uint8_t* quant = table == 0 ? luma_quant : chroma_quant;
+        output.push_back(static_cast<uint8_t>(table));
+        for (int k = 0; k < 64; k++) {
+            output.push_back(quant[ZIGZAG[k]]);
+        }
+    }
+
+    // SOF0: 8-bit baseline, Y sampled 2x2, Cb and Cr 1x1
+    output.insert(output.end(), {0xFF, 0xC0});
+    put_u16(output, 17);
+    output.push_back(8);
+    put_u16(output, frame.height);
+    put_u16(output, frame.width);
+    output.insert(output.end(), {3, 1, 0x22, 0, 2, 0x11, 1, 3, 0x11, 1});
+
+    // DHT: the standard tables
+    output.insert(output.end(), {0xFF, 0xC4});
+    put_u16(output, 2 + 4 * 17 + 12 + 12 + 162 + 162);
+    write_huffman_table(output, 0x00, DC_LUMA_BITS, DC_VALUES);
+    write_huffman_table(output, 0x10, AC_LUMA_BITS, AC_LUMA_VALUES);
+    write_huffman_table(output, 0x01, DC_CHROMA_BITS, DC_VALUES);
+    write_huffman_table(output, 0x11, AC_CHROMA_BITS, AC_CHROMA_VALUES);
+
+    // SOS: all three components in one interleaved scan
+    output.insert(output.end(), {0xFF, 0xDA});
+    put_u16(output, 12);
+    output.insert(output.end(), {3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0});
+
+    BitWriter writer(output);
+    int dc_y = 0, dc_cb = 0, dc_cr = 0;
+    float y_block[4][64], cb_block[64], cr_block[64];
+    const std::size_t stride = static_cast<std::size_t>(frame.width) * 3;
+    for (int my = 0; my < frame.height; my += 16) {
+        for (int mx = 0; mx < frame.width; mx += 16) {
+            std::fill(std::begin(cb_block), std::end(cb_block), 0.0f);
+            std::fill(std::begin(cr_block), std::end(cr_block), 0.0f);
+            for (int py = 0; py < 16; py++) {
+                // Edge MCUs repeat the last row and column
+                int sy = std::min(my + py, frame.height - 1);
+                const uint8_t* row = frame.rgb.data() + sy * stride;
+                for (int px = 0; px < 16; px++) {
+                    int sx = std::min(mx + px, frame.width - 1);
+                    float r = row[sx * 3], g = row[sx * 3 + 1], b = row[sx * 3 + 2];
+                    int block = (py / 8) * 2 + px / 8;
+                    y_block[block][(py % 8) * 8 + px % 8] = 0.299f * r + 0.587f * g + 0.114f * b - 128.0f;
+                    int chroma = (py / 2) * 8 + px / 2;
+                    cb_block[chroma] += 0.25f * (-0.168736f * r - 0.331264f * g + 0.5f * b);
+                    cr_block[chroma] += 0.25f * (0.5f * r - 0.418688f * g - 0.081312f * b);
+                }
+            }
+            for (int block = 0; block < 4; block++) {
+                encode_block(writer, y_block[block], luma_quant, dc_luma, ac_luma, dc_y);
+            }
+            encode_block(writer, cb_block, chroma_quant, dc_chroma, ac_chroma, dc_cb);
+            encode_block(writer, cr_block, chroma_quant, dc_chroma, ac_chroma, dc_cr);
+        }
+    }
+    writer.flush();
+    output.insert(output.end(), {0xFF, 0xD9});
+}
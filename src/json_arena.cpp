@@ -0,0 +1,68 @@
+#include "json_arena.h"
+#include <algorithm>
+#include <bit>
+
+JsonArena::Scope::Scope()
+    : arena_(thread_arena()) {
+    arena_.depth_++;
+}
+
+JsonArena::Scope::~Scope() {
+    if (--arena_.depth_ == 0) {
+        arena_.reset();
+    }
+}
+
+JsonArena::JsonArena(std::size_t initial_size, std::size_t max_size)
+    : size_(initial_size)
+    , max_size_(std::max(initial_size, max_size))
+    , buffer_(std::make_unique<std::byte[]>(initial_size)) {
+    resource_.emplace(buffer_.get(), size_, &overflow_);
+}
+
+JsonArena& JsonArena::thread_arena() {
+    thread_local JsonArena arena;
+    return arena;
+}
+
+std::pmr::memory_resource* JsonArena::current() noexcept {
+    JsonArena& arena = thread_arena();
+    if (arena.depth_ > 0) {
+        return &*arena.resource_;
+    }
+    return std::pmr::new_delete_resource();
+}
+
+void JsonArena::reset() {
+    if (overflow_.count == 0) {
+        // Rewinds to the start of the buffer; nothing to free
+        resource_->release();
+        return;
+    }
+
+    // The last message did not fit: grow so the next one like it stays in the buffer
+    overflows_ += overflow_.count;
+    std::size_t wanted = std::bit_ceil(size_ + overflow_.bytes);
+    resource_.reset();
+    overflow_.bytes = 0;
+    overflow_.count = 0;
+    if (wanted > size_ && size_ < max_size_) {
+        size_ = std::min(wanted, max_size_);
+        buffer_ = std::make_unique<std::byte[]>(size_);
+    }
+    resource_.emplace(buffer_.get(), size_, &overflow_);
+}
+
+void* JsonArena::OverflowResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+    this->bytes += bytes;
+    count++;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void JsonArena::OverflowResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool JsonArena::OverflowResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
@@ -0,0 +1,210 @@
+#include "latency_tracer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <string>
+
+namespace {
+
+// Keep the tracker bounded if playout stalls
+constexpr std::size_t MAX_CHUNKS_IN_FLIGHT = 4096;
+
+int64_t to_ns(LatencyTracer::Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+uint64_t elapsed_us(LatencyTracer::Clock::time_point from, LatencyTracer::Clock::time_point to) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+    return us > 0 ? static_cast<uint64_t>(us) : 0;
+}
+
+// p50/p99/max of a microsecond histogram, in milliseconds
+void print_ms(std::ostream& out, const std::string& name, const Histogram& histogram) {
+    out << "  " << std::left << std::setw(24) << name << std::right
+        << " n=" << histogram.count()
+        << " p50=" << histogram.percentile(50.0) / 1000.0 << "ms"
+        << " p99=" << histogram.percentile(99.0) / 1000.0 << "ms"
+        << " p999=" << histogram.percentile(99.9) / 1000.0 << "ms"
+        << " max=" << histogram.max() / 1000.0 << "ms" << std::endl;
+}
+
+}  // namespace
+
+LatencyTracer::LatencyTracer(int voice_threshold)
+    : voice_threshold_(voice_threshold) {
+}
+
+void LatencyTracer::on_capture(const int16_t* samples, std::size_t count, Clock::time_point captured) {
+    for (std::size_t i = 0; i < count; i++) {
+        if (std::abs(static_cast<int>(samples[i])) >= voice_threshold_) {
+            last_voice_ns_.store(to_ns(captured), std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+void LatencyTracer::on_uplink_send(Clock::time_point first_captured, Clock::time_point sent) {
+    capture_to_send_us_.record(elapsed_us(first_captured, sent));
+    last_send_ns_.store(to_ns(sent), std::memory_order_relaxed);
+}
+
+void LatencyTracer::on_uplink_send(Clock::time_point sent) {
+    last_send_ns_.store(to_ns(sent), std::memory_order_relaxed);
+}
+
+void LatencyTracer::on_downlink_audio(std::size_t samples, Clock::time_point received, Clock::time_point decoded) {
+    receive_to_decode_us_.record(elapsed_us(received, decoded));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    drain_playout();
+    ChunkTrace chunk;
+    chunk.start = decoded_total_;
+    chunk.received = received;
+    chunk.decoded = decoded;
+    decoded_total_ += samples;
+
+    if (!in_turn_) {
+        // The user's last voiced capture ends the utterance; fall back to the last
+        // uplink chunk when there was no voice (e.g. silence in dummy mode)
+        in_turn_ = true;
+        turn_index_++;
+        turn_ttfa_us_ = -1;
+        int64_t voice = last_voice_ns_.load(std::memory_order_relaxed);
+        int64_t send = last_send_ns_.load(std::memory_order_relaxed);
+        int64_t reference = voice > 0 ? voice : send;
+        chunk.first_of_turn = reference > 0;
+        chunk.speech_end = Clock::time_point(std::chrono::nanoseconds(reference));
+        if (chunk.first_of_turn) {
+            turn_response_us_ = static_cast<int64_t>(elapsed_us(chunk.speech_end, received));
+            response_us_.record(static_cast<uint64_t>(turn_response_us_));
+        }
+        // Voice from this turn must not be reused as the reference for the next one
+        last_voice_ns_.store(0, std::memory_order_relaxed);
+    }
+
+    chunks_.push_back(chunk);
+    if (chunks_.size() > MAX_CHUNKS_IN_FLIGHT) {
+        chunks_.pop_front();
+    }
+}
+
+void LatencyTracer::on_enqueue(std::size_t samples, Clock::time_point enqueued) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    drain_playout();
+    enqueued_total_ += samples;
+
+    for (ChunkTrace& chunk : chunks_) {
+        if (chunk.start >= enqueued_total_) {
+            break;
+        }
+        if (!chunk.is_enqueued) {
+            chunk.is_enqueued = true;
+            chunk.enqueued = enqueued;
+            decode_to_enqueue_us_.record(elapsed_us(chunk.decoded, enqueued));
+        }
+    }
+
+    // Without a playback device the pipeline ends at the buffer
+    if (!playout_enabled_) {
+        while (!chunks_.empty() && chunks_.front().is_enqueued) {
+            complete_front(enqueued);
+        }
+    }
+}
+
+void LatencyTracer::on_playout(uint64_t played_total, Clock::time_point played) {
+    // Runs in the realtime callback: no lock, and nothing to publish while the device plays silence.
+    // A full queue drops the mark; a later one completes the same chunks
+    if (played_total == last_played_total_) {
+        return;
+    }
+    last_played_total_ = played_total;
+    playout_marks_.try_push(PlayoutMark{played_total, played});
+}
+
+void LatencyTracer::drain_playout() {
+    PlayoutMark mark;
+    while (playout_marks_.try_pop(mark)) {
+        while (!chunks_.empty() && chunks_.front().is_enqueued && chunks_.front().start < mark.played_total) {
+            complete_front(mark.played);
+        }
+    }
+}
+
+void LatencyTracer::complete_front(Clock::time_point played) {
+    const ChunkTrace& chunk = chunks_.front();
+    if (playout_enabled_) {
+        enqueue_to_playout_us_.record(elapsed_us(chunk.enqueued, played));
+    }
+    uint64_t total = elapsed_us(chunk.received, played);
+    receive_to_playout_us_.record(total);
+    turn_chunk_us_.record(total);
+
+    if (chunk.first_of_turn) {
+        turn_ttfa_us_ = static_cast<int64_t>(elapsed_us(chunk.speech_end, played));
+        ttfa_us_.record(static_cast<uint64_t>(turn_ttfa_us_));
+    }
+    chunks_.pop_front();
+}
+
+void LatencyTracer::on_turn_end(bool interrupted, std::ostream& out) {
+    // Copied under the lock and written after it, so a slow terminal never blocks the other hooks
+    int turn_index;
+    int64_t response_us;
+    int64_t ttfa_us;
+    uint64_t chunk_count;
+    uint64_t chunk_p50_us;
+    uint64_t chunk_p99_us;
+    uint64_t chunk_max_us;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        drain_playout();
+        if (!in_turn_) {
+            return;
+        }
+        in_turn_ = false;
+
+        turn_index = turn_index_;
+        response_us = turn_response_us_;
+        ttfa_us = turn_ttfa_us_;
+        chunk_count = turn_chunk_us_.count();
+        chunk_p50_us = turn_chunk_us_.percentile(50.0);
+        chunk_p99_us = turn_chunk_us_.percentile(99.0);
+        chunk_max_us = turn_chunk_us_.max();
+
+        turn_chunk_us_.reset();
+        turn_response_us_ = -1;
+    }
+
+    out << std::fixed << std::setprecision(1);
+    out << "[Latency] Turn " << turn_index << (interrupted ? " (interrupted)" : "") << ":";
+    if (response_us >= 0) {
+        out << " first audio received " << response_us / 1000.0 << "ms";
+    }
+    if (ttfa_us >= 0) {
+        out << ", TTFA " << ttfa_us / 1000.0 << "ms";
+    } else {
+        out << ", TTFA pending";
+    }
+    out << " | chunk receive->playout n=" << chunk_count
+        << " p50=" << chunk_p50_us / 1000.0 << "ms"
+        << " p99=" << chunk_p99_us / 1000.0 << "ms"
+        << " max=" << chunk_max_us / 1000.0 << "ms" << std::endl;
+    out << std::defaultfloat;
+}
+
+void LatencyTracer::print_summary(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out << "=== Latency Summary (" << turn_index_ << " turns) ===" << std::endl;
+    out << std::fixed << std::setprecision(1);
+    print_ms(out, "speech end -> received", response_us_);
+    print_ms(out, "TTFA (speech end -> out)", ttfa_us_);
+    print_ms(out, "capture -> send", capture_to_send_us_);
+    print_ms(out, "receive -> decode", receive_to_decode_us_);
+    print_ms(out, "decode -> enqueue", decode_to_enqueue_us_);
+    if (playout_enabled_) {
+        print_ms(out, "enqueue -> playout", enqueue_to_playout_us_);
+    }
+    print_ms(out, "receive -> playout", receive_to_playout_us_);
+    out << std::defaultfloat;
+}
@@ -1,30 +1,75 @@
 #include "websocket_client.h"
 #include "audio_handler.h"
+#include "audio_buffer.h"
+#include "audio_block_pool.h"
+#include "spsc_queue.h"
 #include "message_handler.h"
 #include "config.h"
+#include "config_watcher.h"
+#include "pcm_gateway.h"
+#include "pipe_bridge.h"
+#include "batch_runner.h"
+#include "frame_uplink.h"
+#include "transcript_sink.h"
+#include "session_manager.h"
+#include "latency_tracer.h"
+#include "trace_recorder.h"
+#include "thread_placement.h"
+#include "session_recorder.h"
+#include "alloc_tracker.h"
+#include "metrics.h"
+#include "metrics_server.h"
 #include <iostream>
 #include <fstream>
+#include <iomanip>
 #include <thread>
 #include <chrono>
-#include <csignal>
+#include <condition_variable>
+#include <deque>
 #include <atomic>
-#include <queue>
 #include <mutex>
 #include <functional>
+#include <future>
+#include <csignal>
+#include <filesystem>
 
 // Global exit flag
 std::atomic<bool> g_running(true);
 
-// Queue to store received audio data
-std::queue<std::vector<int16_t>> g_audio_queue;
+// Received audio travels to the playback thread in pooled blocks: 128 x 2048 samples
+// (about 11 s at 24 kHz) in flight at most, allocated once at startup
+constexpr std::size_t AUDIO_BLOCK_SAMPLES = 2048;
+constexpr std::size_t AUDIO_POOL_BLOCKS = 128;
+AudioBlockPool g_audio_pool(AUDIO_BLOCK_SAMPLES, AUDIO_POOL_BLOCKS);
+
+// Queue to store received audio data (message thread -> playback thread); never fuller than the pool
+SpscQueue<AudioBlock> g_audio_queue(AUDIO_POOL_BLOCKS);
 std::mutex g_audio_mutex;
+Gauge& g_audio_queue_depth = metrics().gauge("gemini_audio_queue_depth", "Received audio chunks waiting for the playback thread");
+// Allocations per received message; only recorded when the allocation hooks are linked in
+Histogram& message_allocations() {
+    static Histogram& histogram = metrics().histogram("gemini_message_allocations",
+        "Heap allocations while handling one server message (GEMINI_ALLOC_TRACKING builds)",
+        {0, 8, 16, 32, 64, 128, 256}, 1.0);
+    return histogram;
+}
+std::condition_variable g_audio_cv;     // Signalled when audio is queued or on shutdown
+std::condition_variable g_exit_cv;      // Signalled on shutdown
 
-// Signal handler
-void signal_handler(int signal) {
-    if (signal == SIGINT) {
-        std::cout << "\nReceived termination signal..." << std::endl;
+// Stop the application and wake every waiting thread
+void request_shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(g_audio_mutex);
         g_running = false;
     }
+    g_audio_cv.notify_all();
+    g_exit_cv.notify_all();
+}
+
+// Block until request_shutdown() is called
+void wait_for_shutdown() {
+    std::unique_lock<std::mutex> lock(g_audio_mutex);
+    g_exit_cv.wait(lock, []() { return !g_running; });
 }
 
 // Show help message
@@ -35,6 +80,32 @@ void print_help() {
     std::cout << "  --config PATH, -c PATH   Path to config file (default: ./config.json)" << std::endl;
     std::cout << "  --dummy-audio            Dummy audio mode (no audio device required)" << std::endl;
     std::cout << "  --enable-search          Enable Google Search (overrides config file)" << std::endl;
+    std::cout << "  --sessions N             Run N headless sessions on a shared thread pool" << std::endl;
+    std::cout << "  --gateway PATH           Bridge raw PCM calls on Unix socket PATH to Gemini sessions" << std::endl;
+    std::cout << "  --gateway-max-calls N    Refuse calls beyond N concurrent ones (default: unlimited)" << std::endl;
+    std::cout << "  --gateway-warm N         Keep N sessions connected and set up for instant call pickup" << std::endl;
+    std::cout << "  --pipe                   Stream s16le PCM from stdin to Gemini and model PCM to stdout" << std::endl;
+    std::cout << "  --pipe-speed X           Pipe uplink speed: 1 = realtime, 0 = as fast as possible (default: 1)" << std::endl;
+    std::cout << "  --pipe-rate HZ           Sample rate of the piped input (default: config inputSampleRate)" << std::endl;
+    std::cout << "  --batch PATH             Run every WAV in directory (or manifest) PATH through Gemini" << std::endl;
+    std::cout << "  --batch-out DIR          Batch output directory; finished files are skipped on rerun (default: batch_out)" << std::endl;
+    std::cout << "  --batch-concurrency N    Concurrent batch sessions (default: 4)" << std::endl;
+    std::cout << "  --batch-retries N        Retries per failed batch file (default: 1)" << std::endl;
+    std::cout << "  --video SOURCE           Send image frames from a directory of .ppm files, a PPM stream (FIFO) or - for stdin" << std::endl;
+    std::cout << "  --video-fps X            Maximum frames per second to send (default: 1)" << std::endl;
+    std::cout << "  --video-max-size N       Downscale frames to fit N x N pixels before encoding (default: 768)" << std::endl;
+    std::cout << "  --video-quality Q        JPEG quality 1-100 (default: 70)" << std::endl;
+    std::cout << "  --endpoint URL           Connect to URL (ws:// or wss://) instead of the Gemini API" << std::endl;
+    std::cout << "  --metrics-port N         Serve Prometheus metrics on http://127.0.0.1:N/metrics" << std::endl;
+    std::cout << "  --latency-trace          Log per-turn end-to-end latency and print a summary at exit" << std::endl;
+    std::cout << "  --record PATH            Record every WebSocket frame to PATH" << std::endl;
+    std::cout << "  --replay PATH            Replay a recording instead of connecting (no network)" << std::endl;
+    std::cout << "  --replay-speed X         Replay speed: 1 = original timing, 0 = as fast as possible (default: 1)" << std::endl;
+    std::cout << "  --trace PATH             Record a thread trace; write the last seconds to PATH on SIGUSR1 and at exit" << std::endl;
+    std::cout << "  --trace-seconds S        Seconds of trace to write (default: 10)" << std::endl;
+    std::cout << "  --transcript-jsonl PATH  Also write transcripts to PATH as JSON lines" << std::endl;
+    std::cout << "  --no-console-transcript  Do not print transcripts to the console" << std::endl;
+    std::cout << "  --callback-warn F        Warn when an audio callback uses more than F of its period (default: 0.5)" << std::endl;
     std::cout << "  --help, -h               Show this help message" << std::endl;
     std::cout << "\nEnvironment Variables:" << std::endl;
     std::cout << "  GEMINI_API_KEY           API Key (lower priority than command line argument)" << std::endl;
@@ -44,6 +115,7 @@ void print_help() {
     std::cout << "  ./gemini-voice" << std::endl;
     std::cout << "  ./gemini-voice --config my_config.json" << std::endl;
     std::cout << "  ./gemini-voice --api-key your_key --dummy-audio --enable-search" << std::endl;
+    std::cout << "  ./gemini-voice --endpoint ws://127.0.0.1:8765/ws --dummy-audio" << std::endl;
 }
 
 // Check command line arguments
@@ -87,6 +159,291 @@ std::string get_config_path(int argc, char* argv[]) {
     return "config.json";  // Default path
 }
 
+// Get string option value (returns default_value if not specified)
+std::string get_option(int argc, char* argv[], const std::string& flag, const std::string& default_value) {
+    for (int i = 1; i < argc - 1; i++) {
+        if (argv[i] == flag) {
+            return argv[i + 1];
+        }
+    }
+    return default_value;
+}
+
+// Get integer option value (returns default_value if not specified)
+int get_int_option(int argc, char* argv[], const std::string& flag, int default_value) {
+    for (int i = 1; i < argc - 1; i++) {
+        if (argv[i] == flag) {
+            return std::atoi(argv[i + 1]);
+        }
+    }
+    return default_value;
+}
+
+// Run many independent headless sessions (silence uplink, discarded downlink)
+int run_multi_session(const Config& config, const WebSocketClient::Endpoint& endpoint, bool enable_search,
+                      int session_count, int metrics_port) {
+    SessionOptions options;
+    options.endpoint = endpoint;
+    options.setup_message = MessageHandler::create_setup_message(
+        config.getModelName(),
+        enable_search,
+        config.getTemperature(),
+        config.getTopP(),
+        config.getTopK(),
+        config.getSystemInstructionText()
+    );
+    options.chunk_samples = config.getChunkSize();
+    options.chunk_interval = std::chrono::milliseconds(
+        1000LL * config.getChunkSize() / config.getInputSampleRate());
+    
+    SessionManager manager;
+    for (int i = 0; i < session_count; i++) {
+        manager.add_session(options);
+    }
+    
+    std::unique_ptr<MetricsServer> metrics_server;
+    if (metrics_port > 0) {
+        metrics_server = std::make_unique<MetricsServer>(manager.io_context(), static_cast<unsigned short>(metrics_port));
+        if (metrics_server->start()) {
+            std::cout << "[Metrics] http://127.0.0.1:" << metrics_server->port() << "/metrics" << std::endl;
+        }
+    }
+    
+    net::signal_set signals(manager.io_context(), SIGINT, SIGTERM);
+    signals.async_wait([](beast::error_code ec, int) {
+        if (!ec) {
+            std::cout << "\nReceived termination signal..." << std::endl;
+            request_shutdown();
+        }
+    });
+    
+    std::cout << "[Multi-Session] Starting " << session_count << " sessions on "
+              << manager.thread_count() << " threads" << std::endl;
+    manager.start();
+    
+    // Report throughput every 10 seconds until Ctrl+C
+    auto next_report = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    std::unique_lock<std::mutex> lock(g_audio_mutex);
+    while (!g_exit_cv.wait_until(lock, next_report, []() { return !g_running; })) {
+        manager.print_report(std::cout, false);
+        next_report += std::chrono::seconds(10);
+    }
+    lock.unlock();
+    
+    std::cout << "\nCleaning up..." << std::endl;
+    manager.print_report(std::cout);
+    manager.stop();
+    
+    std::cout << "Application exited" << std::endl;
+    return 0;
+}
+
+// Bridge Unix socket connections carrying raw PCM to Gemini sessions (no audio device)
+int run_gateway(const Config& config, const WebSocketClient::Endpoint& endpoint, bool enable_search,
+                const std::string& socket_path, int max_calls, int warm_sessions, int metrics_port) {
+    PcmGatewayOptions options;
+    options.socket_path = socket_path;
+    options.endpoint = endpoint;
+    options.model_name = config.getModelName();
+    options.system_instruction = config.getSystemInstructionText();
+    options.temperature = config.getTemperature();
+    options.top_p = config.getTopP();
+    options.top_k = config.getTopK();
+    options.enable_search = enable_search;
+    options.max_calls = static_cast<std::size_t>(std::max(0, max_calls));
+    options.warm_sessions = static_cast<std::size_t>(std::max(0, warm_sessions));
+    options.output_sample_rate = config.getOutputSampleRate();
+    
+    // One io_context for every call, run by a pool sized to the cores
+    std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+    net::io_context io_context(static_cast<int>(thread_count));
+    PcmGateway gateway(io_context, options);
+    if (!gateway.start()) {
+        return 1;
+    }
+    
+    std::unique_ptr<MetricsServer> metrics_server;
+    if (metrics_port > 0) {
+        metrics_server = std::make_unique<MetricsServer>(io_context, static_cast<unsigned short>(metrics_port));
+        if (metrics_server->start()) {
+            std::cout << "[Metrics] http://127.0.0.1:" << metrics_server->port() << "/metrics" << std::endl;
+        }
+    }
+    
+    net::signal_set signals(io_context, SIGINT, SIGTERM);
+    signals.async_wait([](beast::error_code ec, int) {
+        if (!ec) {
+            std::cout << "\nReceived termination signal..." << std::endl;
+            request_shutdown();
+        }
+    });
+    
+    auto work = net::make_work_guard(io_context);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < thread_count; i++) {
+        threads.emplace_back([&io_context]() {
+            thread_placement().apply("io");
+            io_context.run();
+        });
+    }
+    std::cout << "[Gateway] Listening on " << socket_path << " with " << thread_count << " threads" << std::endl;
+    
+    auto print_stats = [&gateway]() {
+        PcmGateway::Stats stats = gateway.get_stats();
+        std::cout << "[Gateway] active " << stats.active_calls << ", accepted " << stats.calls_accepted
+                  << ", rejected " << stats.calls_rejected << ", uplink " << stats.uplink_bytes
+                  << " B, downlink " << stats.downlink_bytes << " B, dropped chunks "
+                  << stats.downlink_dropped_chunks << std::endl;
+        if (const SessionPool* pool = gateway.pool()) {
+            std::cout << "[Pool] idle " << stats.pool.idle << ", connecting " << stats.pool.connecting
+                      << ", hits " << stats.pool.hits << ", misses " << stats.pool.misses << " (hit rate "
+                      << std::fixed << std::setprecision(1) << stats.pool.hit_rate * 100.0 << "%)"
+                      << std::defaultfloat << ", retired " << stats.pool.retired << ", failed " << stats.pool.failed
+                      << ", pickup " << pool->pickup_latency().summary("ns") << std::endl;
+        }
+    };
+    
+    // Report every 10 seconds until Ctrl+C
+    auto next_report = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    std::unique_lock<std::mutex> lock(g_audio_mutex);
+    while (!g_exit_cv.wait_until(lock, next_report, []() { return !g_running; })) {
+        print_stats();
+        next_report += std::chrono::seconds(10);
+    }
+    lock.unlock();
+    
+    std::cout << "\nCleaning up..." << std::endl;
+    gateway.stop();
+    // Calls write their queued audio on the io threads; keep them running until every call is gone
+    gateway.wait_for_calls(options.drain_timeout);
+    print_stats();
+    work.reset();
+    io_context.stop();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    std::cout << "Application exited" << std::endl;
+    return 0;
+}
+
+// Run a directory or manifest of WAV files through concurrent sessions (no audio device)
+int run_batch(const Config& config, const WebSocketClient::Endpoint& endpoint, bool enable_search,
+              const std::string& input_path, const std::string& output_dir, int concurrency, int retries) {
+    std::vector<std::string> inputs;
+    if (!BatchRunner::collect_inputs(input_path, inputs)) {
+        return 1;
+    }
+    
+    BatchOptions options;
+    options.endpoint = endpoint;
+    options.setup_message = MessageHandler::create_setup_message(
+        config.getModelName(),
+        enable_search,
+        config.getTemperature(),
+        config.getTopP(),
+        config.getTopK(),
+        config.getSystemInstructionText()
+    );
+    options.output_dir = output_dir;
+    options.concurrency = static_cast<std::size_t>(std::max(1, concurrency));
+    options.retries = std::max(0, retries);
+    options.output_sample_rate = config.getOutputSampleRate();
+    
+    BatchRunner batch(options);
+    std::cout << "[Batch] " << inputs.size() << " files, " << options.concurrency
+              << " concurrent sessions, output to " << output_dir << std::endl;
+    
+    net::io_context signal_io;
+    net::signal_set signals(signal_io, SIGINT, SIGTERM);
+    signals.async_wait([&batch](beast::error_code ec, int) {
+        if (!ec) {
+            std::cout << "\nReceived termination signal..." << std::endl;
+            batch.stop();
+        }
+    });
+    
+    // Report every 10 seconds until every file is done
+    std::future<bool> done = std::async(std::launch::async, [&batch, &inputs]() {
+        return batch.run(inputs);
+    });
+    auto next_report = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (done.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
+        signal_io.poll();
+        if (std::chrono::steady_clock::now() >= next_report) {
+            batch.print_report(std::cout);
+            next_report += std::chrono::seconds(10);
+        }
+    }
+    bool ok = done.get();
+    
+    batch.print_report(std::cout);
+    std::cout << "Results: " << (std::filesystem::path(output_dir) / "batch_results.jsonl").string() << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Stream raw PCM between stdin/stdout and one Gemini session (no audio device)
+int run_pipe(const Config& config, const WebSocketClient::Endpoint& endpoint, bool enable_search,
+             double speed, int input_rate, bool console_transcript, const std::string& transcript_path) {
+    // A closed downstream reader must surface as a write error, not kill the process
+    std::signal(SIGPIPE, SIG_IGN);
+    
+    PipeOptions options;
+    options.endpoint = endpoint;
+    options.setup_message = MessageHandler::create_setup_message(
+        config.getModelName(),
+        enable_search,
+        config.getTemperature(),
+        config.getTopP(),
+        config.getTopK(),
+        config.getSystemInstructionText()
+    );
+    options.input_sample_rate = input_rate;
+    options.speed = speed;
+    
+    // Transcripts go to stderr, since stdout carries the model audio
+    TranscriptSink transcripts;
+    if (console_transcript) {
+        transcripts.add_output(std::make_unique<ConsoleTranscriptOutput>(std::cerr));
+    }
+    if (!transcript_path.empty()) {
+        auto jsonl = std::make_unique<JsonlTranscriptOutput>();
+        if (!jsonl->open(transcript_path)) {
+            return 1;
+        }
+        transcripts.add_output(std::move(jsonl));
+    }
+    transcripts.start();
+    
+    net::io_context io_context;
+    auto bridge = std::make_shared<PipeBridge>(io_context, options, &transcripts);
+    bridge->start();
+    std::cerr << "[Pipe] Streaming " << input_rate << " Hz s16le from stdin, model audio "
+              << config.getOutputSampleRate() << " Hz s16le to stdout" << std::endl;
+    
+    net::signal_set signals(io_context, SIGINT, SIGTERM);
+    signals.async_wait([bridge](beast::error_code ec, int) {
+        if (!ec) {
+            std::cerr << "\nReceived termination signal..." << std::endl;
+            bridge->stop();
+        }
+    });
+    
+    // Run until the bridge is done, then let the close handshake complete
+    thread_placement().apply("io");
+    while (!bridge->finished() && io_context.run_one()) {
+    }
+    signals.cancel();
+    io_context.run();
+    transcripts.stop();
+    
+    PipeBridge::Stats stats = bridge->get_stats();
+    std::cerr << "[Pipe] uplink " << stats.uplink_bytes << " B, downlink " << stats.downlink_bytes
+              << " B, turns " << stats.turns << ", " << std::fixed << std::setprecision(2)
+              << stats.elapsed_seconds << " s" << std::endl;
+    return bridge->succeeded() ? 0 : 1;
+}
+
 int main(int argc, char* argv[]) {
     // Check help option
     if (has_flag(argc, argv, "--help", "-h")) {
@@ -94,8 +451,11 @@ int main(int argc, char* argv[]) {
         return 0;
     }
     
-    // Set signal handler
-    std::signal(SIGINT, signal_handler);
+    // In pipe mode stdout carries raw PCM; every log line goes to stderr instead
+    bool pipe_mode = has_flag(argc, argv, "--pipe");
+    if (pipe_mode) {
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
     
     std::cout << "=== Gemini Live API Voice Application ===" << std::endl;
     
@@ -118,9 +478,22 @@ int main(int argc, char* argv[]) {
     }
     config_file.close();
     
+    std::string config_error;
+    if (!config.validate(config_error)) {
+        std::cerr << "Config validation error: " << config_error << std::endl;
+        std::cerr << "Using default configuration" << std::endl;
+        config = Config();
+    }
+    
     // Print config info
     config.print();
     
+    // Pin threads and lock memory as the "threads" section asks; each thread applies its role as it starts
+    thread_placement().configure(config.getThreadPlacement());
+    if (config.getThreadPlacement().lock_memory) {
+        thread_placement().lock_memory();
+    }
+    
     // Check dummy audio mode
     bool dummy_audio = has_flag(argc, argv, "--dummy-audio");
     if (dummy_audio) {
@@ -133,9 +506,35 @@ int main(int argc, char* argv[]) {
         std::cout << "[Google Search] Enabled" << std::endl;
     }
     
-    // Get API key
+    // Custom endpoint (e.g. the local mock server)
+    WebSocketClient::Endpoint endpoint;
+    std::string endpoint_url = get_option(argc, argv, "--endpoint", "");
+    if (!endpoint_url.empty()) {
+        if (!WebSocketClient::parse_url(endpoint_url, endpoint)) {
+            std::cerr << "Error: Invalid endpoint URL: " << endpoint_url << std::endl;
+            return 1;
+        }
+        std::cout << "[Endpoint] " << endpoint_url << std::endl;
+    }
+    
+    // Recorded session to replay instead of the network
+    std::string replay_path = get_option(argc, argv, "--replay", "");
+    double replay_speed = std::atof(get_option(argc, argv, "--replay-speed", "1").c_str());
+    bool replaying = !replay_path.empty();
+    SessionReplayer replayer;
+    if (replaying) {
+        if (!replayer.load(replay_path)) {
+            return 1;
+        }
+        std::cout << "[Replay] " << replayer.frames().size() << " frames from " << replay_path << std::endl;
+    }
+    
+    // Get API key (not required for a custom endpoint or a replay)
     std::string api_key = get_api_key(argc, argv);
-    if (api_key.empty()) {
+    if (endpoint_url.empty()) {
+        endpoint = WebSocketClient::gemini_endpoint(api_key);
+    }
+    if (api_key.empty() && endpoint_url.empty() && !replaying) {
         std::cerr << "Error: API key is not set" << std::endl;
         std::cerr << "Usage:" << std::endl;
         std::cerr << "  Env: export GEMINI_API_KEY=your_api_key" << std::endl;
@@ -144,91 +543,260 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    // Initialize audio handler (only if not in dummy mode)
+    // Multi-session mode does not use the audio device
+    int metrics_port = get_int_option(argc, argv, "--metrics-port", 0);
+    int session_count = get_int_option(argc, argv, "--sessions", 0);
+    if (session_count > 0) {
+        return run_multi_session(config, endpoint, enable_search, session_count, metrics_port);
+    }
+    
+    // Gateway mode does not use the audio device either
+    std::string gateway_path = get_option(argc, argv, "--gateway", "");
+    if (!gateway_path.empty()) {
+        return run_gateway(config, endpoint, enable_search, gateway_path,
+                           get_int_option(argc, argv, "--gateway-max-calls", 0),
+                           get_int_option(argc, argv, "--gateway-warm", 0), metrics_port);
+    }
+    
+    // Batch mode streams WAV files instead of the audio device
+    std::string batch_path = get_option(argc, argv, "--batch", "");
+    if (!batch_path.empty()) {
+        return run_batch(config, endpoint, enable_search, batch_path,
+                         get_option(argc, argv, "--batch-out", "batch_out"),
+                         get_int_option(argc, argv, "--batch-concurrency", 4),
+                         get_int_option(argc, argv, "--batch-retries", 1));
+    }
+    
+    // Pipe mode streams stdin/stdout instead of the audio device
+    if (pipe_mode) {
+        int pipe_rate = get_int_option(argc, argv, "--pipe-rate", config.getInputSampleRate());
+        return run_pipe(config, endpoint, enable_search,
+                        std::atof(get_option(argc, argv, "--pipe-speed", "1").c_str()), pipe_rate,
+                        !has_flag(argc, argv, "--no-console-transcript"),
+                        get_option(argc, argv, "--transcript-jsonl", ""));
+    }
+    
+    auto startup_begin = std::chrono::steady_clock::now();
+    auto ms_since = [](std::chrono::steady_clock::time_point from) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - from).count();
+    };
+    
+    // End-to-end latency tracing (optional)
+    using Clock = LatencyTracer::Clock;
+    std::unique_ptr<LatencyTracer> tracer;
+    if (has_flag(argc, argv, "--latency-trace")) {
+        tracer = std::make_unique<LatencyTracer>();
+    }
+    
+    // Hot-path trace recorder (optional); opened in Perfetto or chrome://tracing
+    std::string trace_path = get_option(argc, argv, "--trace", "");
+    double trace_seconds = std::atof(get_option(argc, argv, "--trace-seconds", "10").c_str());
+    if (!trace_path.empty()) {
+        trace_recorder().enable();
+        trace_recorder().set_thread_name("main");
+        std::cout << "[Trace] Recording; send SIGUSR1 to write " << trace_path << std::endl;
+    }
+    
+    // Initialize audio handler (only if not in dummy mode) while the network connects
     AudioHandler audio_handler;
-    if (!dummy_audio) {
-        if (!audio_handler.initialize()) {
-            std::cerr << "Failed to initialize audio handler" << std::endl;
-            std::cerr << "Hint: Use --dummy-audio option to run without audio" << std::endl;
-            return 1;
-        }
-    } else {
+    audio_handler.set_callback_warn_fraction(std::atof(get_option(argc, argv, "--callback-warn", "0.5").c_str()));
+    if (tracer) {
+        audio_handler.set_playout_callback([&tracer](uint64_t played_total) {
+            tracer->on_playout(played_total, Clock::now());
+        });
+    }
+    double audio_init_ms = 0.0;
+    if (dummy_audio) {
         std::cout << "Audio handler: Skipped (Dummy Mode)" << std::endl;
     }
+    std::future<bool> audio_ready = std::async(std::launch::async, [&]() {
+        if (dummy_audio) {
+            return true;
+        }
+        auto begin = std::chrono::steady_clock::now();
+        bool ok = audio_handler.initialize();
+        audio_init_ms = ms_since(begin);
+        return ok;
+    });
     
     // Create IO context
     boost::asio::io_context io_context;
     
     // Create WebSocket client
-    WebSocketClient ws_client(io_context, api_key);
+    WebSocketClient ws_client(io_context, endpoint);
+    
+    // Transcripts are segmented here and written by a background thread
+    TranscriptSink transcripts;
+    if (!has_flag(argc, argv, "--no-console-transcript")) {
+        transcripts.add_output(std::make_unique<ConsoleTranscriptOutput>(std::cout));
+    }
+    std::string transcript_path = get_option(argc, argv, "--transcript-jsonl", "");
+    if (!transcript_path.empty()) {
+        auto jsonl = std::make_unique<JsonlTranscriptOutput>();
+        if (!jsonl->open(transcript_path)) {
+            audio_ready.wait();
+            return 1;
+        }
+        transcripts.add_output(std::move(jsonl));
+        std::cout << "[Transcript] Writing JSONL to " << transcript_path << std::endl;
+    }
+    transcripts.start();
     
-    // Buffer for AI transcription
-    std::string user_transcript_buffer;
-    std::string ai_transcript_buffer;
+    // Resolved once by setupComplete (true) or a connection error (false)
+    std::promise<bool> setup_promise;
+    std::future<bool> setup_result = setup_promise.get_future();
+    std::atomic<bool> setup_signalled(false);
+    auto signal_setup = [&](bool ok) {
+        if (!setup_signalled.exchange(true)) {
+            setup_promise.set_value(ok);
+        }
+    };
     
     // Set message receive callback
-    ws_client.set_message_callback([&](const std::string& message) {
+    std::atomic<uint64_t> last_sent_chunk(0);   // Trace flow id of the newest uplink chunk
+    std::vector<int16_t> audio_data;            // Decode target reused by every message
+    auto on_message = [&](std::string_view message) {
         // std::cout << "受信: " << message.substr(0, 200) << "..." << std::endl;
+        TraceScope trace_scope("handle_message", message.size());
+        AllocScope alloc_scope;
+        Clock::time_point received = tracer ? Clock::now() : Clock::time_point{};
+        
+        if (!setup_signalled && MessageHandler::is_setup_complete(message)) {
+            signal_setup(true);
+            return;
+        }
         
         // Extract transcription
         std::string transcription;
         if (MessageHandler::extract_transcription_from_response(message, transcription)) {
-            // Determine if it is user input or AI output
-            if (MessageHandler::is_user_input_transcription(message)) {
-                user_transcript_buffer += transcription;
-                // Display at punctuation marks
-                if (user_transcript_buffer.find("。") != std::string::npos ||
-                    user_transcript_buffer.find("！") != std::string::npos ||
-                    user_transcript_buffer.find("？") != std::string::npos ||
-                    user_transcript_buffer.find(".") != std::string::npos ||
-                    user_transcript_buffer.find("!") != std::string::npos ||
-                    user_transcript_buffer.find("?") != std::string::npos) {
-                    std::cout << "\n You: " << user_transcript_buffer << "\n" << std::endl;
-                    user_transcript_buffer.clear();
-                }
-            } else {
-                ai_transcript_buffer += transcription;
-                // Display at punctuation marks
-                if (ai_transcript_buffer.find("。") != std::string::npos ||
-                    ai_transcript_buffer.find("！") != std::string::npos ||
-                    ai_transcript_buffer.find("？") != std::string::npos ||
-                    ai_transcript_buffer.find(".") != std::string::npos ||
-                    ai_transcript_buffer.find("!") != std::string::npos ||
-                    ai_transcript_buffer.find("?") != std::string::npos) {
-                    std::cout << " AI: " << ai_transcript_buffer << std::endl;
-                    ai_transcript_buffer.clear();
-                }
-            }
+            // Determine if it is user input or AI output; complete sentences are displayed
+            transcripts.append(MessageHandler::is_user_input_transcription(message)
+                                   ? TranscriptEntry::Speaker::User
+                                   : TranscriptEntry::Speaker::Model,
+                               transcription);
         }
         
         // Extract audio data
-        std::vector<int16_t> audio_data;
         if (MessageHandler::extract_audio_from_response(message, audio_data)) {
             // std::cout << "音声データを受信しました (" << audio_data.size() << " サンプル)" << std::endl;
+            if (tracer) {
+                tracer->on_downlink_audio(audio_data.size(), received, Clock::now());
+            }
+            // Link the first reply audio to the chunk that preceded it
+            if (uint64_t chunk = last_sent_chunk.exchange(0)) {
+                trace_recorder().flow_end("audio_chunk", chunk);
+            }
             
-            // Add to queue
-            std::lock_guard<std::mutex> lock(g_audio_mutex);
-            g_audio_queue.push(audio_data);
+            // Add to queue, split into pool blocks. This runs on the receive path, which must not
+            // wait for playback: when the pool is exhausted (about 11 s already waiting to play),
+            // the rest of the chunk is dropped and counted in gemini_audio_pool_exhausted_total
+            {
+                std::lock_guard<std::mutex> lock(g_audio_mutex);
+                for (std::size_t offset = 0; offset < audio_data.size(); offset += AUDIO_BLOCK_SAMPLES) {
+                    AudioBlock block = g_audio_pool.acquire();
+                    if (!block) {
+                        break;
+                    }
+                    block.assign(audio_data.data() + offset, audio_data.size() - offset);
+                    g_audio_queue.try_push(std::move(block));
+                }
+                g_audio_queue_depth.set(static_cast<int64_t>(g_audio_queue.size()));
+            }
+            g_audio_cv.notify_one();
         }
         
         // Check turn completion
         if (MessageHandler::is_turn_complete(message)) {
             // std::cout << "ターン完了" << std::endl;
+            transcripts.end_turn();
+            if (tracer) {
+                tracer->on_turn_end(false, std::cout);
+            }
+        } else if (tracer && MessageHandler::is_interrupted(message)) {
+            tracer->on_turn_end(true, std::cout);
         }
-    });
+        
+        if (AllocTracker::installed()) {
+            message_allocations().record(alloc_scope.allocations());
+        }
+    };
+    ws_client.set_message_view_callback(on_message);
+    
+    // Record every frame for later replay (optional)
+    std::string record_path = get_option(argc, argv, "--record", "");
+    std::shared_ptr<SessionRecorder> session_recorder;
+    if (!record_path.empty() && !replaying) {
+        session_recorder = std::make_shared<SessionRecorder>();
+        if (!session_recorder->open(record_path)) {
+            return 1;
+        }
+        ws_client.set_recorder(session_recorder);
+        std::cout << "[Record] Writing frames to " << record_path << std::endl;
+    }
     
     // Set error callback (stop app on error)
-    ws_client.set_error_callback([](const std::string& error) {
+    ws_client.set_error_callback([&](const std::string& error) {
         std::cerr << "WebSocket Error: " << error << std::endl;
-        g_running = false;  // Exit on error
+        request_shutdown();  // Exit on error
+        signal_setup(false);
+    });
+    
+    // Server closed the connection (e.g. after goAway)
+    ws_client.set_close_callback([]() {
+        std::cerr << "Connection closed by server" << std::endl;
+        request_shutdown();
+    });
+    
+    // Handle Ctrl+C on the IO thread
+    std::unique_ptr<MetricsServer> metrics_server;
+    if (metrics_port > 0) {
+        metrics_server = std::make_unique<MetricsServer>(io_context, static_cast<unsigned short>(metrics_port));
+        if (metrics_server->start()) {
+            std::cout << "[Metrics] http://127.0.0.1:" << metrics_server->port() << "/metrics" << std::endl;
+        }
+    }
+    
+    net::signal_set signals(io_context, SIGINT, SIGTERM);
+    signals.async_wait([&](beast::error_code ec, int) {
+        if (!ec) {
+            std::cout << "\nReceived termination signal..." << std::endl;
+            request_shutdown();
+            signal_setup(false);
+        }
     });
     
+    // SIGUSR1 writes the trace without stopping
+    net::signal_set trace_signals(io_context);
+    std::function<void(beast::error_code, int)> on_trace_signal = [&](beast::error_code ec, int) {
+        if (ec) {
+            return;
+        }
+        trace_recorder().dump_to_file(trace_path, trace_seconds);
+        trace_signals.async_wait(on_trace_signal);
+    };
+    if (!trace_path.empty()) {
+        trace_signals.add(SIGUSR1);
+        trace_signals.async_wait(on_trace_signal);
+    }
+    
+    // Audio tuning follows config file edits; the playback thread re-checks its wait on change
+    ConfigWatcher config_watcher(io_context, config_path, config);
+    config_watcher.set_reload_callback([](const AudioTuning&, const std::vector<std::string>&) {
+        g_audio_cv.notify_all();
+    });
+    if (config_watcher.start()) {
+        std::cout << "[Config] Watching " << config_path << " for changes" << std::endl;
+    }
+    
     // Connect to WebSocket
     // std::cout << "Gemini Live APIに接続中..." << std::endl;
-    if (!ws_client.connect()) {
+    auto connect_begin = std::chrono::steady_clock::now();
+    if (!replaying && !ws_client.connect()) {
         std::cerr << "Failed to connect" << std::endl;
+        audio_ready.wait();
         return 1;
     }
+    double connect_ms = ms_since(connect_begin);
     
     // Send setup message
     std::string setup_message = MessageHandler::create_setup_message(
@@ -240,143 +808,313 @@ int main(int argc, char* argv[]) {
         config.getSystemInstructionText()
     );
     // std::cout << "セットアップメッセージを送信" << std::endl;
-    ws_client.send(setup_message);
+    auto setup_begin = std::chrono::steady_clock::now();
+    if (!replaying) {
+        ws_client.send(setup_message);
+        
+        // Start async receive
+        ws_client.async_receive();
+    }
+    
+    // Run IO context in a separate thread
+    std::thread io_thread([&io_context]() {
+        trace_recorder().set_thread_name("io");
+        thread_placement().apply("io");
+        io_context.run();
+    });
     
-    // Start async receive
-    ws_client.async_receive();
+    // A replay has no handshake; its recorded setupComplete is just another frame
+    if (replaying) {
+        signal_setup(true);
+    }
     
     // Wait for setup response from server
-    // std::cout << "サーバーからの応答を待機中..." << std::endl;
-    std::this_thread::sleep_for(std::chrono::seconds(2));
+    const auto SETUP_TIMEOUT = std::chrono::seconds(10);
+    bool setup_ok = setup_result.wait_for(SETUP_TIMEOUT) == std::future_status::ready && setup_result.get();
+    double setup_ms = ms_since(setup_begin);
+    if (!setup_ok && !setup_signalled) {
+        std::cerr << "Error: No setupComplete from server within "
+                  << SETUP_TIMEOUT.count() << "s" << std::endl;
+    }
+    
+    bool audio_ok = audio_ready.get();
+    if (!audio_ok) {
+        std::cerr << "Failed to initialize audio handler" << std::endl;
+        std::cerr << "Hint: Use --dummy-audio option to run without audio" << std::endl;
+    }
     
     // Check connection status
-    if (!g_running || !ws_client.is_connected()) {
-        std::cerr << "Error: Connection lost with server" << std::endl;
+    if (!setup_ok || !audio_ok || !g_running || (!replaying && !ws_client.is_connected())) {
+        if (setup_ok && audio_ok) {
+            std::cerr << "Error: Connection lost with server" << std::endl;
+        }
         ws_client.close();
         io_context.stop();
+        io_thread.join();
         return 1;
     }
     
-    // Run IO context in a separate thread
-    std::thread io_thread([&io_context]() {
-        io_context.run();
-    });
+    std::cout << std::fixed << std::setprecision(1)
+              << "Startup: ready in " << ms_since(startup_begin) << " ms"
+              << " (connect " << connect_ms << " ms, setupComplete " << setup_ms << " ms"
+              << ", audio init " << audio_init_ms << " ms in parallel)" << std::endl;
+    std::cout << std::defaultfloat;
+    
+    if (tracer) {
+        tracer->set_playout_enabled(!dummy_audio && audio_handler.is_playback_ready());
+    }
     
     // Audio playback thread
-    std::thread playback_thread([&audio_handler, &config, dummy_audio]() {
-        std::vector<int16_t> audio_buffer;
-        const size_t BUFFER_SIZE = config.getBufferSize();
-        const size_t MIN_BUFFER_SIZE = config.getMinBufferSize();
+    std::thread playback_thread([&audio_handler, &config, &config_watcher, &tracer, dummy_audio]() {
+        trace_recorder().set_thread_name("playback");
+        thread_placement().apply("playback");
+        // Received blocks wait here and are played straight from the pool; the pool bounds how
+        // much can pile up. front_offset samples of the first block are already played
+        std::deque<AudioBlock> pending;
+        std::size_t front_offset = 0;
+        std::size_t pending_samples = 0;
+        
+        // Hand the first count pending samples to the device, returning finished blocks to the pool
+        auto play_pending = [&](std::size_t count) {
+            while (count > 0) {
+                AudioBlock& front = pending.front();
+                std::size_t n = std::min(count, front.size() - front_offset);
+                audio_handler.play_audio(front.data() + front_offset, n, config.getOutputSampleRate());
+                front_offset += n;
+                pending_samples -= n;
+                count -= n;
+                if (front_offset == front.size()) {
+                    pending.pop_front();
+                    front_offset = 0;
+                }
+            }
+        };
         
-        while (g_running) {
-            // Retrieve audio data from queue and add to buffer
+        while (true) {
+            // Sleep until audio arrives, a pending partial buffer can be played, or shutdown
             {
-                std::lock_guard<std::mutex> lock(g_audio_mutex);
-                while (!g_audio_queue.empty()) {
-                    std::vector<int16_t>& data = g_audio_queue.front();
-                    audio_buffer.insert(audio_buffer.end(), data.begin(), data.end());
-                    g_audio_queue.pop();
+                std::unique_lock<std::mutex> lock(g_audio_mutex);
+                g_audio_cv.wait(lock, [&]() {
+                    return !g_running || g_audio_queue.size() > 0 ||
+                           (!dummy_audio && pending_samples >= config_watcher.tuning().min_buffer_size);
+                });
+                if (!g_running) {
+                    break;
+                }
+                
+                // Take the queued blocks without copying their samples
+                AudioBlock block;
+                while (g_audio_queue.try_pop(block)) {
+                    pending_samples += block.size();
+                    pending.push_back(std::move(block));
                 }
+                g_audio_queue_depth.set(0);
             }
             
+            // One snapshot per pass so a reload never mixes old and new sizes
+            const AudioTuning& tuning = config_watcher.tuning();
+            const size_t BUFFER_SIZE = tuning.buffer_size;
+            const size_t MIN_BUFFER_SIZE = tuning.min_buffer_size;
+            
             // Play if buffer has enough data
-            if (audio_buffer.size() >= BUFFER_SIZE) {
+            if (pending_samples >= BUFFER_SIZE) {
                 if (!dummy_audio) {
                     // Play only buffer size
-                    std::vector<int16_t> to_play(audio_buffer.begin(), audio_buffer.begin() + BUFFER_SIZE);
-                    audio_handler.play_audio(to_play, config.getOutputSampleRate());
-                    audio_buffer.erase(audio_buffer.begin(), audio_buffer.begin() + BUFFER_SIZE);
+                    TraceScope trace_scope("playback_enqueue", BUFFER_SIZE);
+                    if (tracer) {
+                        tracer->on_enqueue(BUFFER_SIZE, Clock::now());
+                    }
+                    play_pending(BUFFER_SIZE);
                 } else {
-                    std::cout << "[Dummy] Discarding audio data (" << audio_buffer.size() << " samples)" << std::endl;
-                    audio_buffer.clear();
+                    std::cout << "[Dummy] Discarding audio data (" << pending_samples << " samples)" << std::endl;
+                    if (tracer) {
+                        tracer->on_enqueue(pending_samples, Clock::now());
+                    }
+                    pending.clear();
+                    front_offset = 0;
+                    pending_samples = 0;
                 }
             }
             // Play if minimum buffer exists and no new data coming
-            else if (audio_buffer.size() >= MIN_BUFFER_SIZE) {
+            else if (pending_samples >= MIN_BUFFER_SIZE) {
                 bool queue_empty;
                 {
                     std::lock_guard<std::mutex> lock(g_audio_mutex);
-                    queue_empty = g_audio_queue.empty();
+                    queue_empty = g_audio_queue.size() == 0;
                 }
                 
                 if (queue_empty && !dummy_audio) {
-                    audio_handler.play_audio(audio_buffer, config.getOutputSampleRate());
-                    audio_buffer.clear();
+                    TraceScope trace_scope("playback_enqueue", pending_samples);
+                    if (tracer) {
+                        tracer->on_enqueue(pending_samples, Clock::now());
+                    }
+                    play_pending(pending_samples);
                 }
             }
-            
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
     });
     
     // Recording callback
     std::vector<int16_t> accumulated_audio;
-    const size_t CHUNK_SIZE = config.getChunkSize();
+    Clock::time_point chunk_captured_at;
+    uint64_t chunk_id = 0;
     
     std::function<void(const std::vector<int16_t>&)> recording_callback = [&](const std::vector<int16_t>& audio_chunk) {
-        // Accumulate audio data (apply software gain)
-        const int32_t GAIN_FACTOR = config.getGainFactor();
-        
-        for (int16_t sample : audio_chunk) {
-            int32_t amplified = static_cast<int32_t>(sample) * GAIN_FACTOR;
-            if (amplified > 32767) amplified = 32767;
-            if (amplified < -32768) amplified = -32768;
-            accumulated_audio.push_back(static_cast<int16_t>(amplified));
+        if (accumulated_audio.empty()) {
+            trace_recorder().flow_start("audio_chunk", ++chunk_id);
+        }
+        if (tracer) {
+            Clock::time_point now = Clock::now();
+            tracer->on_capture(audio_chunk.data(), audio_chunk.size(), now);
+            if (accumulated_audio.empty()) {
+                chunk_captured_at = now;
+            }
         }
         
+        // Accumulate audio data (apply software gain)
+        const AudioTuning& tuning = config_watcher.tuning();
+        apply_gain(audio_chunk, tuning.gain_factor, accumulated_audio);
+        
         // Send when accumulated enough
-        if (accumulated_audio.size() >= CHUNK_SIZE) {
+        if (accumulated_audio.size() >= tuning.chunk_size) {
+            TraceScope trace_scope("encode_and_send", accumulated_audio.size());
+            trace_recorder().flow_step("audio_chunk", chunk_id);
+            last_sent_chunk.store(chunk_id);
             std::string audio_message = MessageHandler::create_audio_input_message(accumulated_audio);
             // std::cout << "音声データを送信中 (" << accumulated_audio.size() << " サンプル)" << std::endl;
             ws_client.send(audio_message);
+            if (tracer) {
+                tracer->on_uplink_send(chunk_captured_at, Clock::now());
+            }
             accumulated_audio.clear();
         }
     };
     
+    // Silence sender for dummy mode; runs on the IO thread and lives until it is joined
+    net::steady_timer silence_timer(io_context);
+    std::function<void(beast::error_code)> send_silence = [&](beast::error_code ec) {
+        if (ec || !g_running || !ws_client.is_connected()) {
+            return;
+        }
+        size_t chunk_size = config_watcher.tuning().chunk_size;
+        TraceScope trace_scope("send_silence", chunk_size);
+        std::vector<int16_t> silent_audio(chunk_size, 0);  // Silence data
+        std::string audio_message = MessageHandler::create_audio_input_message(silent_audio);
+        std::cout << "[Dummy] Sending silence (" << silent_audio.size() << " samples)" << std::endl;
+        ws_client.send(std::move(audio_message));
+        if (tracer) {
+            tracer->on_uplink_send(Clock::now());
+        }
+        silence_timer.expires_after(std::chrono::seconds(2));
+        silence_timer.async_wait(send_silence);
+    };
+    
+    // Report slow audio callbacks and their thread placement from the IO thread; the callbacks only record them
+    net::steady_timer callback_report_timer(io_context);
+    std::function<void(beast::error_code)> report_callbacks = [&](beast::error_code ec) {
+        if (ec || !g_running) {
+            return;
+        }
+        audio_handler.capture_monitor().report_warnings(std::cerr);
+        audio_handler.playback_monitor().report_warnings(std::cerr);
+        thread_placement().report_applied(std::cout);
+        callback_report_timer.expires_after(std::chrono::seconds(1));
+        callback_report_timer.async_wait(report_callbacks);
+    };
+    
+    // Image frames go out as low-priority writes, so audio chunks overtake any queued frame
+    std::string video_source = get_option(argc, argv, "--video", "");
+    std::unique_ptr<FrameUplink> frame_uplink;
+    std::thread video_thread;
+    if (!video_source.empty() && !replaying) {
+        FrameUplinkOptions video_options;
+        video_options.fps = std::atof(get_option(argc, argv, "--video-fps", "1").c_str());
+        video_options.max_width = video_options.max_height = get_int_option(argc, argv, "--video-max-size", 768);
+        video_options.jpeg_quality = get_int_option(argc, argv, "--video-quality", 70);
+        frame_uplink = std::make_unique<FrameUplink>(ws_client, video_options);
+        video_thread = std::thread([&]() {
+            trace_recorder().set_thread_name("video");
+            thread_placement().apply("video");
+            std::size_t frames = stream_frames(video_source, *frame_uplink, []() { return g_running.load(); });
+            std::cout << "[Video] Source finished after " << frames << " frames" << std::endl;
+        });
+        std::cout << "[Video] Streaming frames from " << video_source << " at up to " << video_options.fps
+                  << " fps" << std::endl;
+    }
+    
+    // Replay feeds the recorded server frames into the same message callback
+    std::thread replay_thread;
+    if (replaying) {
+        replay_thread = std::thread([&]() {
+            trace_recorder().set_thread_name("replay");
+            thread_placement().apply("io");
+            auto begin = std::chrono::steady_clock::now();
+            std::size_t replayed = replayer.replay(replay_speed, on_message, []() { return g_running.load(); });
+            std::cout << std::fixed << std::setprecision(1)
+                      << "[Replay] " << replayed << " frames in " << ms_since(begin) << " ms"
+                      << std::defaultfloat << std::endl;
+            request_shutdown();
+        });
+    }
+    
     // Start recording (send silent data in dummy mode)
-    if (dummy_audio) {
+    if (replaying) {
+        std::cout << "\n[Replay] Playing back recorded server frames; press Ctrl+C to stop\n" << std::endl;
+        if (!dummy_audio) {
+            net::post(io_context, [&]() { report_callbacks({}); });
+        }
+        wait_for_shutdown();
+    } else if (dummy_audio) {
         std::cout << "\n[Dummy Mode] Waiting for text input..." << std::endl;
         std::cout << "Press Ctrl+C to exit\n" << std::endl;
         
         // Dummy mode: Periodically send silent data
-        std::thread dummy_thread([&]() {
-            while (g_running && ws_client.is_connected()) {
-                std::vector<int16_t> silent_audio(CHUNK_SIZE, 0);  // Silence data
-                std::string audio_message = MessageHandler::create_audio_input_message(silent_audio);
-                std::cout << "[Dummy] Sending silence (" << silent_audio.size() << " samples)" << std::endl;
-                ws_client.send(audio_message);
-                std::this_thread::sleep_for(std::chrono::seconds(2));
-            }
-        });
+        net::post(io_context, [&]() { send_silence({}); });
         
         // Main loop
-        while (g_running && ws_client.is_connected()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
-        
-        if (dummy_thread.joinable()) {
-            dummy_thread.join();
-        }
+        wait_for_shutdown();
     } else {
         std::cout << "Starting recording. Please speak...\n" << std::endl;
+        net::post(io_context, [&]() { report_callbacks({}); });
         // std::cout << "終了するには Ctrl+C を押してください\n" << std::endl;
         
         if (!audio_handler.start_recording(recording_callback)) {
             std::cerr << "Failed to start recording" << std::endl;
             std::cerr << "Hint: Use --dummy-audio option to run without audio" << std::endl;
-            g_running = false;
+            request_shutdown();
         }
         
         // Main loop
-        while (g_running && ws_client.is_connected()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
+        wait_for_shutdown();
         
         audio_handler.stop_recording();
     }
     
     // Cleanup
     std::cout << "\nCleaning up..." << std::endl;
+    
+    WebSocketClient::RttStats rtt = ws_client.get_rtt_stats();
+    if (rtt.samples > 0) {
+        std::cout << "Network RTT: min=" << rtt.min_ms << "ms"
+                  << " smoothed=" << rtt.smoothed_ms << "ms"
+                  << " p99=" << rtt.p99_ms << "ms"
+                  << " (" << rtt.samples << " pings)" << std::endl;
+    }
+    
+    if (video_thread.joinable()) {
+        video_thread.join();
+    }
+    if (frame_uplink) {
+        FrameUplink::Stats video = frame_uplink->get_stats();
+        std::cout << "[Video] " << video.sent << " of " << video.offered << " frames sent ("
+                  << video.bytes_sent / 1024 << " KiB), " << video.duplicates << " unchanged, "
+                  << video.rate_limited << " over the fps limit, " << video.congested << " dropped behind a queued frame";
+        if (video.sent > 0) {
+            std::cout << ", encode " << frame_uplink->encode_latency().summary("us");
+        }
+        std::cout << std::endl;
+    }
+    
     ws_client.close();
     io_context.stop();
     
@@ -384,10 +1122,38 @@ int main(int argc, char* argv[]) {
         io_thread.join();
     }
     
+    if (replay_thread.joinable()) {
+        replay_thread.join();
+    }
+    
+    transcripts.stop();
+    if (transcripts.dropped() > 0) {
+        std::cerr << "[Transcript] " << transcripts.dropped() << " sentences dropped (writer fell behind)" << std::endl;
+    }
+    
+    if (session_recorder) {
+        session_recorder->close();
+        std::cout << "[Record] " << session_recorder->frame_count() << " frames written to "
+                  << record_path << std::endl;
+    }
+    
     if (playback_thread.joinable()) {
         playback_thread.join();
     }
     
+    if (tracer) {
+        tracer->print_summary(std::cout);
+    }
+    
+    if (!trace_path.empty()) {
+        trace_recorder().dump_to_file(trace_path, trace_seconds);
+    }
+    
+    if (!dummy_audio) {
+        audio_handler.capture_monitor().print_summary(std::cout);
+        audio_handler.playback_monitor().print_summary(std::cout);
+    }
+    
     std::cout << "Application exited" << std::endl;
     
     return 0;
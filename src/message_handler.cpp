@@ -1,16 +1,71 @@
 #include "message_handler.h"
+#include "metrics.h"
+#include "json_arena.h"
 #include <nlohmann/json.hpp>
+#include <array>
+#include <bit>
 #include <sstream>
 #include <iostream>
 
 using json = nlohmann::json;
 
+// Count a message that MessageHandler could not parse
+static void count_parse_error() {
+    static Counter& parse_errors = metrics().counter(
+        "gemini_json_parse_errors_total", "JSON parse failures while handling server messages");
+    parse_errors.inc();
+}
+
 // Table for Base64 encoding
 static const std::string base64_chars =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
     "abcdefghijklmnopqrstuvwxyz"
     "0123456789+/";
 
+// Reverse of base64_chars; 0xFF marks bytes outside the alphabet
+static const std::array<uint8_t, 256> base64_values = []() {
+    std::array<uint8_t, 256> values;
+    values.fill(0xFF);
+    for (std::size_t i = 0; i < base64_chars.size(); i++) {
+        values[static_cast<uint8_t>(base64_chars[i])] = static_cast<uint8_t>(i);
+    }
+    return values;
+}();
+
+// Decode little-endian 16-bit PCM without an intermediate byte vector. Like base64_decode(),
+// stops at the first '=' or byte outside the alphabet; an odd trailing byte is dropped.
+static void decode_base64_pcm(std::string_view encoded, std::vector<int16_t>& samples) {
+    samples.clear();
+    samples.reserve(encoded.size() / 4 * 3 / 2);
+    uint32_t bits = 0;
+    int bit_count = 0;
+    int pending = -1;   // Low byte waiting for its high byte
+    for (char c : encoded) {
+        uint8_t value = base64_values[static_cast<uint8_t>(c)];
+        if (value == 0xFF) {
+            break;
+        }
+        bits = (bits << 6) | value;
+        bit_count += 6;
+        if (bit_count >= 8) {
+            bit_count -= 8;
+            uint8_t byte = static_cast<uint8_t>(bits >> bit_count);
+            if (pending < 0) {
+                pending = byte;
+            } else {
+                samples.push_back(static_cast<int16_t>(pending | (byte << 8)));
+                pending = -1;
+            }
+        }
+    }
+}
+
+// Copy a JSON string out of the arena (throws type_error like get<std::string>())
+static void assign_string(const arena_json& value, std::string& out) {
+    const ArenaString& text = value.get_ref<const ArenaString&>();
+    out.assign(text.data(), text.size());
+}
+
 std::string MessageHandler::base64_encode(const std::vector<uint8_t>& data) {
     std::string ret;
     int i = 0;
@@ -148,68 +203,100 @@ std::string MessageHandler::create_audio_input_message(
     const std::vector<int16_t>& audio_data,
     const std::string& mime_type) {
     
-    // Convert int16 array to uint8 array
-    std::vector<uint8_t> byte_data = int16_to_uint8(audio_data);
+    // Encoded straight from the samples (little-endian bytes), without a json tree
+    static_assert(std::endian::native == std::endian::little, "PCM bytes are sent in host order");
+    std::string message;
+    build_audio_input_message(reinterpret_cast<const uint8_t*>(audio_data.data()),
+                              audio_data.size() * sizeof(int16_t), mime_type, message);
+    return message;
+}
+
+void MessageHandler::build_audio_input_message(
+    const uint8_t* pcm,
+    std::size_t size,
+    const std::string& mime_type,
+    std::string& message) {
     
-    // Base64 encode
-    std::string encoded_audio = base64_encode(byte_data);
+    static const char PREFIX[] = R"({"realtimeInput":{"mediaChunks":[{"data":")";
+    static const char MIDDLE[] = R"(","mimeType":")";
+    static const char SUFFIX[] = R"("}]}})";
     
-    json message = {
-        {"realtimeInput", {
-            {"mediaChunks", {{
-                {"data", encoded_audio},
-                {"mimeType", mime_type}
-            }}}
-        }}
-    };
+    // Same bytes as json::dump() of {"realtimeInput":{"mediaChunks":[{"data":...,"mimeType":...}]}}
+    message.clear();
+    message.reserve(sizeof(PREFIX) + (size + 2) / 3 * 4 + sizeof(MIDDLE) + mime_type.size() + sizeof(SUFFIX));
+    message.append(PREFIX);
+    
+    std::size_t full = size - size % 3;
+    for (std::size_t i = 0; i < full; i += 3) {
+        uint32_t triple = (static_cast<uint32_t>(pcm[i]) << 16) | (static_cast<uint32_t>(pcm[i + 1]) << 8) | pcm[i + 2];
+        message += base64_chars[(triple >> 18) & 0x3f];
+        message += base64_chars[(triple >> 12) & 0x3f];
+        message += base64_chars[(triple >> 6) & 0x3f];
+        message += base64_chars[triple & 0x3f];
+    }
+    if (size % 3 != 0) {
+        uint32_t triple = static_cast<uint32_t>(pcm[full]) << 16;
+        if (size % 3 == 2) {
+            triple |= static_cast<uint32_t>(pcm[full + 1]) << 8;
+        }
+        message += base64_chars[(triple >> 18) & 0x3f];
+        message += base64_chars[(triple >> 12) & 0x3f];
+        message += size % 3 == 2 ? base64_chars[(triple >> 6) & 0x3f] : '=';
+        message += '=';
+    }
     
-    return message.dump();
+    message.append(MIDDLE);
+    message.append(mime_type);
+    message.append(SUFFIX);
+}
+
+std::string MessageHandler::create_image_input_message(
+    const std::vector<uint8_t>& image,
+    const std::string& mime_type) {
+    
+    // Same envelope as audio; only the payload and MIME type differ
+    std::string message;
+    build_audio_input_message(image.data(), image.size(), mime_type, message);
+    return message;
+}
+
+std::string MessageHandler::create_audio_stream_end_message() {
+    return R"({"realtimeInput":{"audioStreamEnd":true}})";
 }
 
 bool MessageHandler::extract_audio_from_response(
-    const std::string& json_response,
+    std::string_view json_response,
     std::vector<int16_t>& audio_data) {
     
     try {
-        json response = json::parse(json_response);
+        JsonArena::Scope arena;
+        arena_json response = arena_json::parse(json_response);
         
         // Extract data from serverContent
         if (response.contains("serverContent")) {
-            nlohmann::json& server_content = response["serverContent"];
+            arena_json& server_content = response["serverContent"];
             
             // Check modelTurn
             if (server_content.contains("modelTurn")) {
-                nlohmann::json& model_turn = server_content["modelTurn"];
+                arena_json& model_turn = server_content["modelTurn"];
                 
                 // Check parts
                 if (model_turn.contains("parts")) {
-                    for (nlohmann::json& part : model_turn["parts"]) {
+                    for (arena_json& part : model_turn["parts"]) {
                         // Check inlineData
                         if (part.contains("inlineData")) {
-                            nlohmann::json& inline_data = part["inlineData"];
+                            arena_json& inline_data = part["inlineData"];
                             
                             // Check if audio data exists
                             if (inline_data.contains("mimeType") && inline_data.contains("data")) {
-                                std::string mime_type = inline_data["mimeType"];
+                                const ArenaString& mime_type = inline_data["mimeType"].get_ref<const ArenaString&>();
                                 
                                 // If it is audio data
-                                if (mime_type.find("audio") != std::string::npos) {
-                                    std::string encoded_data = inline_data["data"];
-                                    
-                                    // Base64 decode
-                                    std::vector<uint8_t> decoded = base64_decode(encoded_data);
-                                    
-                                    // Convert uint8 array to int16 array (Little-endian)
-                                    audio_data.clear();
-                                    audio_data.reserve(decoded.size() / 2);
-                                    
-                                    for (size_t i = 0; i + 1 < decoded.size(); i += 2) {
-                                        int16_t sample = static_cast<int16_t>(
-                                            decoded[i] | (decoded[i + 1] << 8)
-                                        );
-                                        audio_data.push_back(sample);
-                                    }
+                                if (mime_type.find("audio") != ArenaString::npos) {
+                                    const ArenaString& encoded_data = inline_data["data"].get_ref<const ArenaString&>();
                                     
+                                    // Base64 decode straight into the samples (Little-endian)
+                                    decode_base64_pcm(std::string_view(encoded_data.data(), encoded_data.size()), audio_data);
                                     return true;
                                 }
                             }
@@ -221,6 +308,7 @@ bool MessageHandler::extract_audio_from_response(
         
     } catch (const json::exception& e) {
         std::cerr << "JSON Parse Error: " << e.what() << std::endl;
+        count_parse_error();
         return false;
     }
     
@@ -228,53 +316,54 @@ bool MessageHandler::extract_audio_from_response(
 }
 
 bool MessageHandler::extract_transcription_from_response(
-    const std::string& json_response,
+    std::string_view json_response,
     std::string& transcription) {
     
     try {
-        json response = json::parse(json_response);
+        JsonArena::Scope arena;
+        arena_json response = arena_json::parse(json_response);
         
         // Check toolCallTranscription (Transcription of output audio)
         if (response.contains("toolCallTranscription")) {
-            nlohmann::json& tool_call_transcription = response["toolCallTranscription"];
+            arena_json& tool_call_transcription = response["toolCallTranscription"];
             
             if (tool_call_transcription.contains("text")) {
-                transcription = tool_call_transcription["text"].get<std::string>();
+                assign_string(tool_call_transcription["text"], transcription);
                 return true;
             }
         }
         
         // Extract transcription from serverContent
         if (response.contains("serverContent")) {
-            nlohmann::json& server_content = response["serverContent"];
+            arena_json& server_content = response["serverContent"];
             
             // User input transcription (inputTranscription)
             if (server_content.contains("inputTranscription")) {
-                nlohmann::json& input_trans = server_content["inputTranscription"];
+                arena_json& input_trans = server_content["inputTranscription"];
                 if (input_trans.contains("text")) {
-                    transcription = input_trans["text"].get<std::string>();
+                    assign_string(input_trans["text"], transcription);
                     return true;
                 }
             }
             
             // AI output transcription (outputTranscription)
             if (server_content.contains("outputTranscription")) {
-                nlohmann::json& output_trans = server_content["outputTranscription"];
+                arena_json& output_trans = server_content["outputTranscription"];
                 if (output_trans.contains("text")) {
-                    transcription = output_trans["text"].get<std::string>();
+                    assign_string(output_trans["text"], transcription);
                     return true;
                 }
             }
             
             // Check text response in modelTurn
             if (server_content.contains("modelTurn")) {
-                nlohmann::json& model_turn = server_content["modelTurn"];
+                arena_json& model_turn = server_content["modelTurn"];
                 
                 if (model_turn.contains("parts")) {
-                    for (nlohmann::json& part : model_turn["parts"]) {
+                    for (arena_json& part : model_turn["parts"]) {
                         // Check for text part
                         if (part.contains("text")) {
-                            transcription = part["text"].get<std::string>();
+                            assign_string(part["text"], transcription);
                             return true;
                         }
                     }
@@ -284,19 +373,21 @@ bool MessageHandler::extract_transcription_from_response(
         
     } catch (const json::exception& e) {
         std::cerr << "JSON Parse Error: " << e.what() << std::endl;
+        count_parse_error();
         return false;
     }
     
     return false;
 }
 
-bool MessageHandler::is_user_input_transcription(const std::string& json_response) {
+bool MessageHandler::is_user_input_transcription(std::string_view json_response) {
     try {
-        json response = json::parse(json_response);
+        JsonArena::Scope arena;
+        arena_json response = arena_json::parse(json_response);
         
         // If inputTranscription field exists in serverContent, it is user input transcription
         if (response.contains("serverContent")) {
-            nlohmann::json& server_content = response["serverContent"];
+            arena_json& server_content = response["serverContent"];
             if (server_content.contains("inputTranscription")) {
                 return true;
             }
@@ -309,12 +400,13 @@ bool MessageHandler::is_user_input_transcription(const std::string& json_respons
     return false;
 }
 
-bool MessageHandler::is_turn_complete(const std::string& json_response) {
+bool MessageHandler::is_turn_complete(std::string_view json_response) {
     try {
-        json response = json::parse(json_response);
+        JsonArena::Scope arena;
+        arena_json response = arena_json::parse(json_response);
         
         if (response.contains("serverContent")) {
-            nlohmann::json& server_content = response["serverContent"];
+            arena_json& server_content = response["serverContent"];
             
             if (server_content.contains("turnComplete")) {
                 return server_content["turnComplete"].get<bool>();
@@ -323,6 +415,42 @@ bool MessageHandler::is_turn_complete(const std::string& json_response) {
         
     } catch (const json::exception& e) {
         std::cerr << "JSON Parse Error: " << e.what() << std::endl;
+        count_parse_error();
+    }
+    
+    return false;
+}
+
+bool MessageHandler::is_interrupted(std::string_view json_response) {
+    try {
+        JsonArena::Scope arena;
+        arena_json response = arena_json::parse(json_response);
+        
+        if (response.contains("serverContent")) {
+            arena_json& server_content = response["serverContent"];
+            
+            if (server_content.contains("interrupted")) {
+                return server_content["interrupted"].get<bool>();
+            }
+        }
+        
+    } catch (const json::exception& e) {
+        std::cerr << "JSON Parse Error: " << e.what() << std::endl;
+        count_parse_error();
+    }
+    
+    return false;
+}
+
+bool MessageHandler::is_setup_complete(std::string_view json_response) {
+    try {
+        JsonArena::Scope arena;
+        arena_json response = arena_json::parse(json_response);
+        return response.contains("setupComplete");
+        
+    } catch (const json::exception& e) {
+        std::cerr << "JSON Parse Error: " << e.what() << std::endl;
+        count_parse_error();
     }
     
     return false;
@@ -0,0 +1,135 @@
+#include "metrics.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+std::size_t Counter::shard_index() noexcept {
+    // Threads are spread over the shards in the order they first touch any counter
+    static std::atomic<std::size_t> next_slot{0};
+    thread_local std::size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return slot;
+}
+
+uint64_t Counter::value() const noexcept {
+    uint64_t total = 0;
+    for (const Shard& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Entry* MetricsRegistry::find(const std::string& name, Type type) {
+    static const char* const TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+    for (Entry& entry : entries_) {
+        if (entry.name == name) {
+            // The entry holds only its own kind of metric; handing out another would be a null reference
+            if (entry.type != type) {
+                throw std::logic_error("metric " + name + " is already registered as a " +
+                                       TYPE_NAMES[static_cast<int>(entry.type)] + ", not a " +
+                                       TYPE_NAMES[static_cast<int>(type)]);
+            }
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* entry = find(name, Type::Counter)) {
+        return *entry->counter;
+    }
+    Entry& entry = entries_.emplace_back();
+    entry.name = name;
+    entry.help = help;
+    entry.type = Type::Counter;
+    entry.counter = std::make_unique<Counter>();
+    return *entry.counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* entry = find(name, Type::Gauge)) {
+        return *entry->gauge;
+    }
+    Entry& entry = entries_.emplace_back();
+    entry.name = name;
+    entry.help = help;
+    entry.type = Type::Gauge;
+    entry.gauge = std::make_unique<Gauge>();
+    return *entry.gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      std::vector<uint64_t> bounds, double scale) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* entry = find(name, Type::Histogram)) {
+        return *entry->histogram;
+    }
+    Entry& entry = entries_.emplace_back();
+    entry.name = name;
+    entry.help = help;
+    entry.type = Type::Histogram;
+    entry.histogram = std::make_unique<Histogram>();
+    std::sort(bounds.begin(), bounds.end());
+    entry.bounds = std::move(bounds);
+    entry.scale = scale;
+    return *entry.histogram;
+}
+
+std::string MetricsRegistry::render_prometheus() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream out;
+
+    for (const Entry& entry : entries_) {
+        out << "# HELP " << entry.name << " " << entry.help << "\n";
+        switch (entry.type) {
+        case Type::Counter:
+            out << "# TYPE " << entry.name << " counter\n";
+            out << entry.name << " " << entry.counter->value() << "\n";
+            break;
+
+        case Type::Gauge:
+            out << "# TYPE " << entry.name << " gauge\n";
+            out << entry.name << " " << entry.gauge->value() << "\n";
+            break;
+
+        case Type::Histogram: {
+            out << "# TYPE " << entry.name << " histogram\n";
+
+            // Fold the log-linear buckets into the fixed exposition bounds
+            std::vector<uint64_t> counts(entry.bounds.size(), 0);
+            uint64_t total = 0;
+            for (int i = 0; i < Histogram::BUCKET_COUNT; i++) {
+                uint64_t n = entry.histogram->bucket_count(i);
+                if (n == 0) {
+                    continue;
+                }
+                total += n;
+                auto it = std::lower_bound(entry.bounds.begin(), entry.bounds.end(),
+                                           Histogram::bucket_lower_bound(i));
+                if (it != entry.bounds.end()) {
+                    counts[it - entry.bounds.begin()] += n;
+                }
+            }
+
+            uint64_t cumulative = 0;
+            for (std::size_t b = 0; b < entry.bounds.size(); b++) {
+                cumulative += counts[b];
+                out << entry.name << "_bucket{le=\"" << entry.bounds[b] * entry.scale << "\"} "
+                    << cumulative << "\n";
+            }
+            out << entry.name << "_bucket{le=\"+Inf\"} " << total << "\n";
+            out << entry.name << "_sum " << entry.histogram->sum() * entry.scale << "\n";
+            out << entry.name << "_count " << total << "\n";
+            break;
+        }
+        }
+    }
+    return out.str();
+}
@@ -0,0 +1,124 @@
+#include "metrics_server.h"
+#include "metrics.h"
+#include <iostream>
+
+// One HTTP connection; serves requests until the client closes it
+class MetricsConnection : public std::enable_shared_from_this<MetricsConnection> {
+public:
+    explicit MetricsConnection(tcp::socket socket)
+        : stream_(std::move(socket)) {
+    }
+
+    void run() {
+        net::dispatch(stream_.get_executor(), [self = shared_from_this()]() {
+            self->do_read();
+        });
+    }
+
+private:
+    void do_read() {
+        request_ = {};
+        stream_.expires_after(std::chrono::seconds(10));
+        http::async_read(stream_, buffer_, request_,
+            [self = shared_from_this()](beast::error_code ec, std::size_t) {
+                if (ec) {
+                    beast::error_code ignored;
+                    self->stream_.socket().shutdown(tcp::socket::shutdown_send, ignored);
+                    return;
+                }
+                self->handle_request();
+            });
+    }
+
+    void handle_request() {
+        response_ = {};
+        response_.version(request_.version());
+        response_.keep_alive(request_.keep_alive());
+        response_.set(http::field::server, "Gemini-CPP-Client/1.0");
+
+        std::string_view target(request_.target().data(), request_.target().size());
+        if (request_.method() != http::verb::get && request_.method() != http::verb::head) {
+            response_.result(http::status::method_not_allowed);
+            response_.set(http::field::content_type, "text/plain");
+            response_.body() = "Method not allowed\n";
+        } else if (target == "/metrics" || target.rfind("/metrics?", 0) == 0) {
+            response_.result(http::status::ok);
+            response_.set(http::field::content_type, "text/plain; version=0.0.4; charset=utf-8");
+            if (request_.method() == http::verb::get) {
+                response_.body() = metrics().render_prometheus();
+            }
+        } else {
+            response_.result(http::status::not_found);
+            response_.set(http::field::content_type, "text/plain");
+            response_.body() = "Not found\n";
+        }
+        response_.prepare_payload();
+
+        http::async_write(stream_, response_,
+            [self = shared_from_this()](beast::error_code ec, std::size_t) {
+                if (ec || !self->response_.keep_alive()) {
+                    beast::error_code ignored;
+                    self->stream_.socket().shutdown(tcp::socket::shutdown_send, ignored);
+                    return;
+                }
+                self->do_read();
+            });
+    }
+
+    beast::tcp_stream stream_;
+    beast::flat_buffer buffer_;
+    http::request<http::string_body> request_;
+    http::response<http::string_body> response_;
+};
+
+MetricsServer::MetricsServer(net::io_context& io_context, unsigned short port, const std::string& address)
+    : io_context_(io_context)
+    , acceptor_(net::make_strand(io_context))
+    , address_(address)
+    , port_(port) {
+}
+
+MetricsServer::~MetricsServer() {
+    // Handlers must not outlive this object; close synchronously
+    beast::error_code ignored;
+    acceptor_.close(ignored);
+}
+
+bool MetricsServer::start() {
+    try {
+        tcp::endpoint endpoint(net::ip::make_address(address_), port_);
+        acceptor_.open(endpoint.protocol());
+        acceptor_.set_option(net::socket_base::reuse_address(true));
+        acceptor_.bind(endpoint);
+        acceptor_.listen(net::socket_base::max_listen_connections);
+    } catch (std::exception const& e) {
+        std::cerr << "Metrics Server Error: " << e.what() << std::endl;
+        return false;
+    }
+
+    do_accept();
+    return true;
+}
+
+void MetricsServer::stop() {
+    net::post(acceptor_.get_executor(), [this]() {
+        beast::error_code ignored;
+        acceptor_.close(ignored);
+    });
+}
+
+unsigned short MetricsServer::port() const {
+    beast::error_code ec;
+    return acceptor_.local_endpoint(ec).port();
+}
+
+void MetricsServer::do_accept() {
+    acceptor_.async_accept(net::make_strand(io_context_),
+        [this](beast::error_code ec, tcp::socket socket) {
+            if (ec) {
+                return;  // Acceptor closed
+            }
+            std::make_shared<MetricsConnection>(std::move(socket))->run();
+            do_accept();
+        });
+}
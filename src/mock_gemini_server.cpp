@@ -0,0 +1,354 @@
+#include "mock_gemini_server.h"
+#include "message_handler.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <sstream>
+
+using json = nlohmann::json;
+
+// One client connection; lives as long as an async operation holds it
+class MockConnection : public std::enable_shared_from_this<MockConnection> {
+public:
+    MockConnection(tcp::socket socket,
+                   std::shared_ptr<const MockServerOptions> options,
+                   std::shared_ptr<MockGeminiServer::Counters> counters)
+        : ws_(std::move(socket))
+        , timer_(ws_.get_executor())
+        , options_(std::move(options))
+        , counters_(std::move(counters)) {
+        
+        chunk_samples_ = std::max<std::size_t>(
+            1, static_cast<std::size_t>(options_->sample_rate) * options_->chunk_duration.count() / 1000);
+        mime_type_ = "audio/pcm;rate=" + std::to_string(options_->sample_rate);
+        
+        std::istringstream words(options_->output_transcript);
+        std::string word;
+        while (words >> word) {
+            words_.push_back(word);
+        }
+    }
+    
+    void run() {
+        net::dispatch(ws_.get_executor(), [self = shared_from_this()]() {
+            self->ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+            self->ws_.async_accept([self](beast::error_code ec) {
+                if (!ec) {
+                    self->do_read();
+                }
+            });
+        });
+    }
+
+private:
+    void do_read() {
+        ws_.async_read(buffer_, [self = shared_from_this()](beast::error_code ec, std::size_t) {
+            self->on_read(ec);
+        });
+    }
+    
+    void on_read(beast::error_code ec) {
+        if (ec) {
+            closed_ = true;
+            timer_.cancel();
+            return;
+        }
+        
+        counters_->messages_received.fetch_add(1, std::memory_order_relaxed);
+        auto data = buffer_.cdata();
+        handle_message(std::string_view(static_cast<const char*>(data.data()), data.size()));
+        buffer_.consume(buffer_.size());
+        
+        do_read();
+    }
+    
+    void handle_message(std::string_view message) {
+        json request = json::parse(message, nullptr, false);
+        if (request.is_discarded()) {
+            std::cerr << "[Mock] Ignoring malformed message" << std::endl;
+            return;
+        }
+        
+        if (!setup_done_) {
+            if (!request.contains("setup")) {
+                std::cerr << "[Mock] First message was not setup" << std::endl;
+                return;
+            }
+            setup_done_ = true;
+            send(R"({"setupComplete":{}})");
+            if (options_->turn_trigger_chunks == 0) {
+                start_turn();
+            }
+            return;
+        }
+        
+        // audioStreamEnd marks the end of the user's speech; it is not an audio chunk
+        if (request.contains("realtimeInput") && !request["realtimeInput"].contains("audioStreamEnd")) {
+            uplink_chunks_++;
+            if (!in_turn_ && options_->turn_trigger_chunks > 0 &&
+                uplink_chunks_ >= options_->turn_trigger_chunks) {
+                start_turn();
+            }
+        }
+    }
+    
+    void start_turn() {
+        in_turn_ = true;
+        uplink_chunks_ = 0;
+        turn_index_++;
+        
+        if (options_->turn_trigger_chunks > 0 && !options_->input_transcript.empty()) {
+            send(json{{"serverContent", {{"inputTranscription", {{"text", options_->input_transcript}}}}}}.dump());
+        }
+        
+        remaining_samples_ = static_cast<std::size_t>(options_->sample_rate) *
+                             options_->turn_duration.count() / 1000;
+        sent_in_turn_ = 0;
+        interrupt_at_ = (options_->interrupt_every > 0 && turn_index_ % options_->interrupt_every == 0)
+                            ? remaining_samples_ / 2 : 0;
+        word_index_ = 0;
+        
+        next_tick_ = std::chrono::steady_clock::now() + options_->response_delay;
+        timer_.expires_at(next_tick_);
+        timer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+            if (!ec) {
+                self->stream_tick();
+            }
+        });
+    }
+    
+    void stream_tick() {
+        if (closed_) {
+            return;
+        }
+        
+        for (int b = 0; b < std::max(1, options_->burst) && remaining_samples_ > 0; b++) {
+            std::size_t n = std::min(chunk_samples_, remaining_samples_);
+            send_audio_chunk(n);
+            remaining_samples_ -= n;
+            sent_in_turn_ += n;
+            
+            // Spread the output transcription over the audio chunks
+            if (word_index_ < words_.size()) {
+                std::string text = words_[word_index_];
+                word_index_++;
+                if (word_index_ < words_.size()) {
+                    text += ' ';
+                }
+                send(json{{"serverContent", {{"outputTranscription", {{"text", text}}}}}}.dump());
+            }
+            
+            if (interrupt_at_ > 0 && sent_in_turn_ >= interrupt_at_) {
+                send(R"({"serverContent":{"interrupted":true}})");
+                end_turn();
+                return;
+            }
+        }
+        
+        if (remaining_samples_ == 0) {
+            end_turn();
+            return;
+        }
+        
+        if (options_->rate <= 0.0) {
+            net::post(ws_.get_executor(), [self = shared_from_this()]() {
+                self->stream_tick();
+            });
+            return;
+        }
+        
+        auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            options_->chunk_duration * std::max(1, options_->burst) / options_->rate);
+        next_tick_ += interval;
+        timer_.expires_at(next_tick_);
+        timer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+            if (!ec) {
+                self->stream_tick();
+            }
+        });
+    }
+    
+    void end_turn() {
+        send(R"({"serverContent":{"turnComplete":true}})");
+        in_turn_ = false;
+        turns_done_++;
+        counters_->turns_completed.fetch_add(1, std::memory_order_relaxed);
+        
+        if (options_->goaway_after_turns > 0 && turns_done_ >= options_->goaway_after_turns) {
+            send(R"({"goAway":{"timeLeft":"1s"}})");
+            timer_.expires_after(std::chrono::seconds(1));
+            timer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+                if (!ec && !self->closed_) {
+                    self->closed_ = true;
+                    self->ws_.async_close(websocket::close_code::going_away,
+                                          [self](beast::error_code) {});
+                }
+            });
+        }
+    }
+    
+    void send_audio_chunk(std::size_t samples) {
+        chunk_.resize(samples);
+        const std::vector<int16_t>& script = options_->script_audio;
+        
+        if (!script.empty()) {
+            for (std::size_t i = 0; i < samples; i++) {
+                chunk_[i] = script[script_pos_];
+                script_pos_ = (script_pos_ + 1) % script.size();
+            }
+        } else {
+            // 220Hz tone
+            const double step = 2.0 * M_PI * 220.0 / options_->sample_rate;
+            for (std::size_t i = 0; i < samples; i++) {
+                chunk_[i] = static_cast<int16_t>(3000.0 * std::sin(phase_));
+                phase_ += step;
+                if (phase_ > 2.0 * M_PI) phase_ -= 2.0 * M_PI;
+            }
+        }
+        
+        std::string encoded = MessageHandler::base64_encode(MessageHandler::int16_to_uint8(chunk_));
+        json message = {
+            {"serverContent", {
+                {"modelTurn", {
+                    {"parts", {{
+                        {"inlineData", {
+                            {"mimeType", mime_type_},
+                            {"data", encoded}
+                        }}
+                    }}}
+                }}
+            }}
+        };
+        send(message.dump());
+    }
+    
+    void send(std::string message) {
+        if (closed_) {
+            return;
+        }
+        write_queue_.push_back(std::move(message));
+        if (write_queue_.size() == 1) {
+            do_write();
+        }
+    }
+    
+    void do_write() {
+        ws_.text(true);
+        ws_.async_write(net::buffer(write_queue_.front()),
+            [self = shared_from_this()](beast::error_code ec, std::size_t bytes) {
+                if (ec) {
+                    self->closed_ = true;
+                    self->write_queue_.clear();
+                    return;
+                }
+                self->counters_->messages_sent.fetch_add(1, std::memory_order_relaxed);
+                self->counters_->bytes_sent.fetch_add(bytes, std::memory_order_relaxed);
+                self->write_queue_.pop_front();
+                if (!self->write_queue_.empty()) {
+                    self->do_write();
+                }
+            });
+    }
+    
+    websocket::stream<beast::tcp_stream> ws_;
+    net::steady_timer timer_;
+    beast::flat_buffer buffer_;
+    std::deque<std::string> write_queue_;
+    std::shared_ptr<const MockServerOptions> options_;
+    std::shared_ptr<MockGeminiServer::Counters> counters_;
+    
+    std::string mime_type_;
+    std::size_t chunk_samples_ = 0;
+    std::vector<int16_t> chunk_;
+    std::vector<std::string> words_;
+    std::size_t word_index_ = 0;
+    double phase_ = 0.0;
+    std::size_t script_pos_ = 0;
+    
+    bool closed_ = false;
+    bool setup_done_ = false;
+    bool in_turn_ = false;
+    int uplink_chunks_ = 0;
+    int turn_index_ = 0;
+    int turns_done_ = 0;
+    std::size_t remaining_samples_ = 0;
+    std::size_t sent_in_turn_ = 0;
+    std::size_t interrupt_at_ = 0;
+    std::chrono::steady_clock::time_point next_tick_;
+};
+
+MockGeminiServer::MockGeminiServer(net::io_context& io_context, const MockServerOptions& options)
+    : io_context_(io_context)
+    , options_(std::make_shared<MockServerOptions>(options))
+    , acceptor_(net::make_strand(io_context))
+    , counters_(std::make_shared<Counters>()) {
+}
+
+MockGeminiServer::~MockGeminiServer() {
+    // Handlers must not outlive this object; close synchronously
+    beast::error_code ignored;
+    acceptor_.close(ignored);
+}
+
+bool MockGeminiServer::start() {
+    try {
+        tcp::endpoint endpoint(net::ip::make_address(options_->address), options_->port);
+        acceptor_.open(endpoint.protocol());
+        acceptor_.set_option(net::socket_base::reuse_address(true));
+        acceptor_.bind(endpoint);
+        acceptor_.listen(net::socket_base::max_listen_connections);
+    } catch (std::exception const& e) {
+        std::cerr << "Mock Server Error: " << e.what() << std::endl;
+        return false;
+    }
+    
+    do_accept();
+    return true;
+}
+
+void MockGeminiServer::stop() {
+    net::post(acceptor_.get_executor(), [this]() {
+        beast::error_code ignored;
+        acceptor_.close(ignored);
+    });
+}
+
+unsigned short MockGeminiServer::port() const {
+    beast::error_code ec;
+    return acceptor_.local_endpoint(ec).port();
+}
+
+WebSocketClient::Endpoint MockGeminiServer::endpoint() const {
+    WebSocketClient::Endpoint endpoint;
+    endpoint.host = options_->address;
+    endpoint.port = std::to_string(port());
+    endpoint.target = "/ws/google.ai.generativelanguage.v1beta.GenerativeService.BidiGenerateContent";
+    endpoint.use_tls = false;
+    return endpoint;
+}
+
+MockGeminiServer::Stats MockGeminiServer::get_stats() const {
+    Stats stats;
+    stats.connections = counters_->connections.load(std::memory_order_relaxed);
+    stats.messages_received = counters_->messages_received.load(std::memory_order_relaxed);
+    stats.messages_sent = counters_->messages_sent.load(std::memory_order_relaxed);
+    stats.bytes_sent = counters_->bytes_sent.load(std::memory_order_relaxed);
+    stats.turns_completed = counters_->turns_completed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void MockGeminiServer::do_accept() {
+    // Each connection gets its own strand
+    acceptor_.async_accept(net::make_strand(io_context_),
+        [this](beast::error_code ec, tcp::socket socket) {
+            if (ec) {
+                return;  // Acceptor closed
+            }
+            counters_->connections.fetch_add(1, std::memory_order_relaxed);
+            socket.set_option(tcp::no_delay(true));
+            std::make_shared<MockConnection>(std::move(socket), options_, counters_)->run();
+            do_accept();
+        });
+}
@@ -0,0 +1,581 @@
+#include "pcm_gateway.h"
+#include "message_handler.h"
+#include "session_pool.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+
+// PCM is read into and written from int16_t buffers without byte swapping
+static_assert(std::endian::native == std::endian::little, "PcmGateway assumes a little-endian host");
+
+namespace {
+
+using Status = gateway_protocol::Status;
+
+// Decoded downlink buffers kept for reuse per call
+constexpr std::size_t MAX_SPARE_BUFFERS = 4;
+
+// How long wait_for_calls() waits for killed calls to finish their handlers
+constexpr auto KILL_TIMEOUT = std::chrono::seconds(1);
+
+uint32_t get_u32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+void put_u32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+}  // namespace
+
+class PcmGateway::Call : public std::enable_shared_from_this<Call> {
+    // Completion handlers for the socket run on the client's strand too
+    template <typename Handler>
+    auto on_strand(Handler&& handler) {
+        return net::bind_executor(client_->get_executor(), std::forward<Handler>(handler));
+    }
+
+public:
+    using Socket = net::local::stream_protocol::socket;
+
+    Call(PcmGateway& gateway, Socket socket)
+        : gateway_(gateway)
+        , client_(std::make_shared<WebSocketClient>(gateway.io_context_, gateway.options_.endpoint))
+        , socket_(std::move(socket))
+        , timer_(gateway.io_context_) {
+        std::lock_guard<std::mutex> lock(gateway.calls_mutex_);
+        gateway.live_calls_++;
+    }
+
+    // The last socket handler is gone; the client lives on until its own handlers drain
+    ~Call() {
+        WebSocketClient::release(std::move(client_));
+        // Nothing touches the gateway after this, so wait_for_calls() may let it go
+        std::lock_guard<std::mutex> lock(gateway_.calls_mutex_);
+        if (--gateway_.live_calls_ == 0) {
+            gateway_.calls_done_.notify_all();
+        }
+    }
+
+    // Read the request header; everything after this runs on the client's strand
+    void start() {
+        install_callbacks();
+        net::async_read(socket_, net::buffer(header_), on_strand(
+            [self = shared_from_this()](beast::error_code ec, std::size_t) {
+                self->on_header(ec);
+            }));
+    }
+
+    // Refuse the call without reading anything
+    void reject(Status status) {
+        net::dispatch(client_->get_executor(), [self = shared_from_this(), status]() {
+            self->fail(status);
+        });
+    }
+
+    // Stop from any thread
+    void close() {
+        std::unique_lock<std::mutex> lock(client_mutex_);
+        auto executor = client_->get_executor();
+        lock.unlock();
+        net::dispatch(executor, [self = shared_from_this()]() {
+            self->finish();
+        });
+    }
+
+    // Drop the call without writing the rest of its audio; from any thread
+    void kill() {
+        std::unique_lock<std::mutex> lock(client_mutex_);
+        auto executor = client_->get_executor();
+        lock.unlock();
+        net::dispatch(executor, [self = shared_from_this()]() {
+            self->abort();
+        });
+    }
+
+private:
+    // Weak, so the client never keeps a finished call alive
+    void install_callbacks() {
+        std::weak_ptr<Call> weak = weak_from_this();
+        client_->set_message_view_callback([weak](std::string_view message) {
+            if (auto self = weak.lock()) {
+                self->on_message(message);
+            }
+        });
+        client_->set_error_callback([weak](const std::string&) {
+            if (auto self = weak.lock()) {
+                self->fail(Status::UpstreamFailed);
+            }
+        });
+        client_->set_close_callback([weak]() {
+            if (auto self = weak.lock()) {
+                self->finish();
+            }
+        });
+    }
+
+    void on_header(beast::error_code ec) {
+        if (ec) {
+            finish();
+            return;
+        }
+
+        input_rate_ = get_u32(header_.data() + 8);
+        uint32_t config_size = get_u32(header_.data() + 12);
+        if (!std::equal(std::begin(gateway_protocol::MAGIC), std::end(gateway_protocol::MAGIC), header_.begin()) ||
+            header_[4] != gateway_protocol::VERSION || input_rate_ < 8000 || input_rate_ > 48000 ||
+            config_size > gateway_protocol::MAX_CONFIG_SIZE) {
+            fail(Status::BadHeader);
+            return;
+        }
+
+        if (config_size == 0) {
+            connect_upstream();
+            return;
+        }
+        config_json_.resize(config_size);
+        net::async_read(socket_, net::buffer(config_json_), on_strand(
+            [self = shared_from_this()](beast::error_code ec, std::size_t) {
+                if (ec) {
+                    self->finish();
+                    return;
+                }
+                self->connect_upstream();
+            }));
+    }
+
+    void connect_upstream() {
+        const PcmGatewayOptions& defaults = gateway_.options_;
+        std::string model = defaults.model_name;
+        std::string instruction = defaults.system_instruction;
+        double temperature = defaults.temperature;
+        double top_p = defaults.top_p;
+        int top_k = defaults.top_k;
+        bool enable_search = defaults.enable_search || (header_[5] & gateway_protocol::FLAG_ENABLE_SEARCH);
+
+        if (!config_json_.empty()) {
+            try {
+                nlohmann::json config = nlohmann::json::parse(config_json_);
+                model = config.value("model", model);
+                instruction = config.value("systemInstruction", instruction);
+                temperature = config.value("temperature", temperature);
+                top_p = config.value("topP", top_p);
+                top_k = config.value("topK", top_k);
+                enable_search = config.value("enableSearch", enable_search);
+            } catch (const std::exception& e) {
+                std::cerr << "Gateway: invalid session config: " << e.what() << std::endl;
+                fail(Status::BadConfig);
+                return;
+            }
+        }
+
+        mime_type_ = "audio/pcm;rate=" + std::to_string(input_rate_);
+        uplink_.resize(static_cast<std::size_t>(input_rate_) * defaults.chunk_duration.count() / 1000);
+        std::string setup = MessageHandler::create_setup_message(model, enable_search, temperature, top_p, top_k, instruction);
+
+        // A warm session set up with the same message skips the handshake and the setup round trip
+        if (gateway_.pool_ && setup == gateway_.pool_->setup_message()) {
+            if (auto warm = gateway_.pool_->acquire()) {
+                {
+                    std::lock_guard<std::mutex> lock(client_mutex_);
+                    client_ = std::move(warm);
+                }
+                net::dispatch(client_->get_executor(), [self = shared_from_this()]() {
+                    self->adopt_warm_client();
+                });
+                return;
+            }
+        }
+
+        // The setup timeout covers the handshakes too; fail() aborts a connect still in progress
+        timer_.expires_after(defaults.setup_timeout);
+        timer_.async_wait(on_strand([self = shared_from_this()](beast::error_code ec) {
+            if (!ec && !self->ready_) {
+                self->fail(Status::SetupTimeout);
+            }
+        }));
+        client_->async_connect([weak = weak_from_this(), setup = std::move(setup)](bool connected) {
+            auto self = weak.lock();
+            if (!self) {
+                return;
+            }
+            if (!connected) {
+                self->fail(Status::UpstreamFailed);
+                return;
+            }
+            self->client_->send(setup);
+            self->client_->async_receive();
+        });
+    }
+
+    // Runs on the warm client's strand, which every later handler binds to
+    void adopt_warm_client() {
+        install_callbacks();
+        if (!client_->is_connected()) {
+            fail(Status::UpstreamFailed);
+            return;
+        }
+        ready_ = true;
+        write_reply(Status::Ok);
+    }
+
+    void on_message(std::string_view message) {
+        if (finished_) {
+            return;
+        }
+
+        if (!ready_) {
+            if (MessageHandler::is_setup_complete(message)) {
+                ready_ = true;
+                timer_.cancel();
+                write_reply(Status::Ok);
+            }
+            return;
+        }
+
+        if (MessageHandler::extract_audio_from_response(message, downlink_)) {
+            queue_downlink();
+            return;
+        }
+
+        if (MessageHandler::is_interrupted(message)) {
+            // Barge-in: drop model audio that has not reached the socket yet
+            while (write_queue_.size() > (writing_ ? 1u : 0u)) {
+                recycle(std::move(write_queue_.back()));
+                write_queue_.pop_back();
+            }
+        }
+        if (input_closed_ && MessageHandler::is_turn_complete(message)) {
+            finish();
+        }
+    }
+
+    void write_reply(Status status) {
+        std::copy(std::begin(gateway_protocol::MAGIC), std::end(gateway_protocol::MAGIC), reply_.begin());
+        reply_[4] = gateway_protocol::VERSION;
+        reply_[5] = static_cast<uint8_t>(status);
+        put_u32(reply_.data() + 8, static_cast<uint32_t>(gateway_.options_.output_sample_rate));
+
+        writing_ = true;
+        net::async_write(socket_, net::buffer(reply_), on_strand(
+            [self = shared_from_this(), status](beast::error_code ec, std::size_t) {
+                self->writing_ = false;
+                if (ec || status != Status::Ok) {
+                    self->abort();
+                    return;
+                }
+                self->read_uplink();
+                self->write_downlink();
+            }));
+    }
+
+    // Read straight into the chunk buffer; a full chunk is encoded in place
+    void read_uplink() {
+        auto* bytes = reinterpret_cast<uint8_t*>(uplink_.data());
+        std::size_t chunk_bytes = uplink_.size() * sizeof(int16_t);
+        net::async_read(socket_, net::buffer(bytes + uplink_fill_, chunk_bytes - uplink_fill_), on_strand(
+            [self = shared_from_this(), chunk_bytes](beast::error_code ec, std::size_t bytes_read) {
+                self->uplink_fill_ += bytes_read;
+                if (self->uplink_fill_ == chunk_bytes || (ec && self->uplink_fill_ >= sizeof(int16_t))) {
+                    self->send_uplink();
+                }
+                if (ec) {
+                    self->on_input_closed(ec);
+                    return;
+                }
+                if (!self->finished_) {
+                    self->read_uplink();
+                }
+            }));
+    }
+
+    void send_uplink() {
+        std::size_t bytes = uplink_fill_ - uplink_fill_ % sizeof(int16_t);
+        uplink_fill_ = 0;
+        if (finished_ || !client_->is_connected()) {
+            return;
+        }
+        std::string message;
+        MessageHandler::build_audio_input_message(
+            reinterpret_cast<const uint8_t*>(uplink_.data()), bytes, mime_type_, message);
+        client_->send(std::move(message));
+        gateway_.uplink_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    // End of input: let the model finish its answer, bounded by drain_timeout
+    void on_input_closed(beast::error_code ec) {
+        if (ec != net::error::eof || finished_) {
+            finish();
+            return;
+        }
+        input_closed_ = true;
+        timer_.expires_after(gateway_.options_.drain_timeout);
+        timer_.async_wait(on_strand([self = shared_from_this()](beast::error_code ec) {
+            if (!ec) {
+                self->finish();
+            }
+        }));
+    }
+
+    void queue_downlink() {
+        if (write_queue_.size() >= gateway_.options_.max_pending_chunks) {
+            // The media server is not reading; keep downlink_ for the next decode
+            gateway_.downlink_dropped_chunks_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        write_queue_.push_back(std::move(downlink_));
+        downlink_.clear();
+        if (!spare_.empty()) {
+            downlink_ = std::move(spare_.back());
+            spare_.pop_back();
+        }
+        write_downlink();
+    }
+
+    // Write the decoded samples as they are; no intermediate byte buffer
+    void write_downlink() {
+        if (writing_ || write_queue_.empty() || !ready_) {
+            if (!writing_ && write_queue_.empty() && closing_) {
+                abort();
+            }
+            return;
+        }
+        writing_ = true;
+        const std::vector<int16_t>& front = write_queue_.front();
+        net::async_write(socket_, net::buffer(front.data(), front.size() * sizeof(int16_t)), on_strand(
+            [self = shared_from_this()](beast::error_code ec, std::size_t bytes_written) {
+                self->writing_ = false;
+                if (ec) {
+                    self->abort();
+                    return;
+                }
+                self->gateway_.downlink_bytes_.fetch_add(bytes_written, std::memory_order_relaxed);
+                self->recycle(std::move(self->write_queue_.front()));
+                self->write_queue_.pop_front();
+                self->write_downlink();
+            }));
+    }
+
+    void recycle(std::vector<int16_t>&& buffer) {
+        if (spare_.size() < MAX_SPARE_BUFFERS) {
+            buffer.clear();
+            spare_.push_back(std::move(buffer));
+        }
+    }
+
+    // Reply with an error status, then close
+    void fail(Status status) {
+        if (finished_) {
+            return;
+        }
+        if (ready_) {
+            finish();
+            return;
+        }
+        finished_ = true;
+        timer_.cancel();
+        client_->close();
+        write_reply(status);
+    }
+
+    // Close upstream now and the socket once queued audio is written
+    void finish() {
+        if (finished_) {
+            return;
+        }
+        finished_ = true;
+        closing_ = true;
+        timer_.cancel();
+        client_->close();
+        write_downlink();
+    }
+
+    void abort() {
+        finished_ = true;
+        timer_.cancel();
+        client_->close();
+        if (socket_.is_open()) {
+            beast::error_code ignored;
+            socket_.shutdown(Socket::shutdown_both, ignored);
+            socket_.close(ignored);
+        }
+        if (!released_) {
+            released_ = true;
+            gateway_.on_call_finished(shared_from_this());
+        }
+    }
+
+    PcmGateway& gateway_;
+    std::shared_ptr<WebSocketClient> client_;   // Replaced by a warm session from the pool when one fits
+    std::mutex client_mutex_;                   // Guards that swap against close() from other threads
+    Socket socket_;
+    net::steady_timer timer_;                   // Setup timeout, then the drain timeout; bound to the client's strand
+
+    std::array<uint8_t, gateway_protocol::HEADER_SIZE> header_{};
+    std::array<uint8_t, gateway_protocol::HEADER_SIZE> reply_{};
+    std::string config_json_;
+    uint32_t input_rate_ = 0;
+    std::string mime_type_;
+
+    std::vector<int16_t> uplink_;               // One chunk; the socket reads into it directly
+    std::size_t uplink_fill_ = 0;               // Bytes of uplink_ filled so far
+    std::vector<int16_t> downlink_;             // Decode target for the next audio message
+    std::deque<std::vector<int16_t>> write_queue_;
+    std::vector<std::vector<int16_t>> spare_;
+
+    bool ready_ = false;
+    bool writing_ = false;
+    bool input_closed_ = false;
+    bool finished_ = false;
+    bool closing_ = false;
+    bool released_ = false;
+};
+
+PcmGateway::PcmGateway(net::io_context& io_context, const PcmGatewayOptions& options)
+    : io_context_(io_context)
+    , options_(options)
+    , acceptor_(io_context) {
+}
+
+PcmGateway::~PcmGateway() {
+    stop();
+    // Calls refer back to the gateway until they are destroyed; a stopped io_context runs nothing
+    if (!io_context_.stopped()) {
+        wait_for_calls(options_.drain_timeout);
+    }
+}
+
+bool PcmGateway::start() {
+    try {
+        // A socket file left by a previous run would make bind() fail
+        std::error_code ignored;
+        if (std::filesystem::is_socket(options_.socket_path, ignored)) {
+            std::filesystem::remove(options_.socket_path, ignored);
+        }
+
+        net::local::stream_protocol::endpoint endpoint(options_.socket_path);
+        acceptor_.open(endpoint.protocol());
+        acceptor_.bind(endpoint);
+        acceptor_.listen(net::socket_base::max_listen_connections);
+    } catch (const std::exception& e) {
+        std::cerr << "Gateway: cannot listen on " << options_.socket_path << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    // Warm sessions only fit calls that keep the default session config
+    if (options_.warm_sessions > 0) {
+        SessionPoolOptions pool_options;
+        pool_options.endpoint = options_.endpoint;
+        pool_options.setup_message = MessageHandler::create_setup_message(
+            options_.model_name, options_.enable_search, options_.temperature, options_.top_p, options_.top_k,
+            options_.system_instruction);
+        pool_options.size = options_.warm_sessions;
+        pool_options.max_idle = options_.warm_max_idle;
+        pool_options.setup_timeout = options_.setup_timeout;
+        pool_ = std::make_unique<SessionPool>(io_context_, pool_options);
+        pool_->start();
+    }
+
+    do_accept();
+    return true;
+}
+
+void PcmGateway::stop() {
+    if (acceptor_.is_open()) {
+        beast::error_code ignored;
+        acceptor_.close(ignored);
+        std::error_code remove_error;
+        std::filesystem::remove(options_.socket_path, remove_error);
+    }
+
+    if (pool_) {
+        pool_->stop();
+    }
+
+    std::vector<std::shared_ptr<Call>> calls;
+    {
+        std::lock_guard<std::mutex> lock(calls_mutex_);
+        calls.assign(calls_.begin(), calls_.end());
+    }
+    for (auto& call : calls) {
+        call->close();
+    }
+}
+
+bool PcmGateway::wait_for_calls(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(calls_mutex_);
+    auto drained = [this]() { return live_calls_ == 0; };
+    if (calls_done_.wait_for(lock, timeout, drained)) {
+        return true;
+    }
+
+    // A media server that stopped reading keeps its call open; cut it off
+    std::vector<std::shared_ptr<Call>> calls(calls_.begin(), calls_.end());
+    lock.unlock();
+    std::cerr << "Gateway: " << calls.size() << " calls still open after " << timeout.count()
+              << " ms, closing them" << std::endl;
+    for (auto& call : calls) {
+        call->kill();
+    }
+    calls.clear();
+    lock.lock();
+    calls_done_.wait_for(lock, KILL_TIMEOUT, drained);
+    return false;
+}
+
+PcmGateway::Stats PcmGateway::get_stats() const {
+    Stats stats;
+    stats.calls_accepted = calls_accepted_.load(std::memory_order_relaxed);
+    stats.calls_rejected = calls_rejected_.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(calls_mutex_);
+        stats.active_calls = calls_.size();
+    }
+    stats.uplink_bytes = uplink_bytes_.load(std::memory_order_relaxed);
+    stats.downlink_bytes = downlink_bytes_.load(std::memory_order_relaxed);
+    stats.downlink_dropped_chunks = downlink_dropped_chunks_.load(std::memory_order_relaxed);
+    if (pool_) {
+        stats.pool = pool_->get_stats();
+    }
+    return stats;
+}
+
+void PcmGateway::do_accept() {
+    acceptor_.async_accept([this](beast::error_code ec, net::local::stream_protocol::socket socket) {
+        if (ec == net::error::operation_aborted || !acceptor_.is_open()) {
+            return;
+        }
+        if (ec) {
+            std::cerr << "Gateway: accept error: " << ec.message() << std::endl;
+        } else {
+            auto call = std::make_shared<Call>(*this, std::move(socket));
+            bool busy;
+            {
+                std::lock_guard<std::mutex> lock(calls_mutex_);
+                busy = options_.max_calls > 0 && calls_.size() >= options_.max_calls;
+                calls_.insert(call);
+            }
+            if (busy) {
+                calls_rejected_.fetch_add(1, std::memory_order_relaxed);
+                call->reject(Status::Busy);
+            } else {
+                calls_accepted_.fetch_add(1, std::memory_order_relaxed);
+                call->start();
+            }
+        }
+        do_accept();
+    });
+}
+
+void PcmGateway::on_call_finished(const std::shared_ptr<Call>& call) {
+    // Pending socket handlers hold the call until they complete
+    std::lock_guard<std::mutex> lock(calls_mutex_);
+    calls_.erase(call);
+}
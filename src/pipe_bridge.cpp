@@ -0,0 +1,379 @@
+#include "pipe_bridge.h"
+#include "message_handler.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// While the unpaced uplink waits for the WebSocket write queue to drain
+constexpr auto BACKPRESSURE_POLL = std::chrono::milliseconds(2);
+
+bool is_regular_file(int fd) {
+    struct stat info;
+    return ::fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+}
+
+}  // namespace
+
+PipeBridge::PipeBridge(net::io_context& io_context, const PipeOptions& options, TranscriptSink* transcripts)
+    : options_(options)
+    , transcripts_(transcripts)
+    , client_(std::make_shared<WebSocketClient>(io_context, options.endpoint))
+    , input_(client_->get_executor())
+    , output_(client_->get_executor())
+    , timer_(client_->get_executor()) {
+
+    // Duplicates, so closing the descriptors does not close stdin/stdout themselves. A duplicate
+    // shares the file status flags, and asio sets O_NONBLOCK on it, so keep the originals
+    input_is_file_ = is_regular_file(options_.input_fd);
+    if (!input_is_file_) {
+        input_flags_ = ::fcntl(options_.input_fd, F_GETFL);
+        input_.assign(::dup(options_.input_fd));
+    }
+    output_is_file_ = is_regular_file(options_.output_fd);
+    if (!output_is_file_) {
+        output_flags_ = ::fcntl(options_.output_fd, F_GETFL);
+        output_.assign(::dup(options_.output_fd));
+    }
+
+    chunk_.resize(static_cast<std::size_t>(options_.input_sample_rate) * options_.chunk_duration.count() / 1000);
+}
+
+PipeBridge::~PipeBridge() {
+    restore_flags();
+    WebSocketClient::release(std::move(client_));
+}
+
+void PipeBridge::start() {
+    // Weak, so the client never keeps a finished bridge alive
+    std::weak_ptr<PipeBridge> weak = weak_from_this();
+    client_->set_message_view_callback([weak](std::string_view message) {
+        if (auto self = weak.lock()) {
+            self->on_message(message);
+        }
+    });
+    client_->set_error_callback([weak](const std::string&) {
+        if (auto self = weak.lock()) {
+            self->finish(false);
+        }
+    });
+    client_->set_close_callback([weak]() {
+        if (auto self = weak.lock()) {
+            self->finish(self->ready_);
+        }
+    });
+
+    net::dispatch(client_->get_executor(), [self = shared_from_this()]() {
+        // Stopped before the connect began
+        if (self->stopping_) {
+            return;
+        }
+        // Covers the handshakes too, so an endpoint that never answers cannot stall the bridge
+        self->timer_.expires_after(self->options_.setup_timeout);
+        self->timer_.async_wait([self](beast::error_code ec) {
+            if (!ec && !self->ready_) {
+                std::cerr << "[Pipe] No setupComplete within " << self->options_.setup_timeout.count() << " ms" << std::endl;
+                self->finish(false);
+            }
+        });
+
+        // stop() and the timeout abort the connect through finish() -> close()
+        self->client_->async_connect([weak = std::weak_ptr<PipeBridge>(self)](bool connected) {
+            auto bridge = weak.lock();
+            if (!bridge || bridge->stopping_) {
+                return;
+            }
+            if (!connected) {
+                bridge->finish(false);
+                return;
+            }
+            bridge->client_->send(bridge->options_.setup_message);
+            bridge->client_->async_receive();
+        });
+    });
+}
+
+void PipeBridge::stop() {
+    net::dispatch(client_->get_executor(), [self = shared_from_this()]() {
+        self->finish(self->ready_);
+    });
+}
+
+PipeBridge::Stats PipeBridge::get_stats() const {
+    Stats stats;
+    stats.uplink_bytes = uplink_bytes_.load(std::memory_order_relaxed);
+    stats.downlink_bytes = downlink_bytes_.load(std::memory_order_relaxed);
+    stats.turns = turns_.load(std::memory_order_relaxed);
+    stats.elapsed_seconds = elapsed_us_.load(std::memory_order_relaxed) / 1e6;
+    stats.first_audio_seconds = first_audio_us_.load(std::memory_order_relaxed) / 1e6;
+    return stats;
+}
+
+void PipeBridge::on_message(std::string_view message) {
+    if (stopping_) {
+        return;
+    }
+
+    if (!ready_) {
+        if (MessageHandler::is_setup_complete(message)) {
+            ready_ = true;
+            timer_.cancel();
+            started_ = std::chrono::steady_clock::now();
+            read_input();
+        }
+        return;
+    }
+
+    if (MessageHandler::extract_audio_from_response(message, downlink_)) {
+        if (downlink_bytes_.load(std::memory_order_relaxed) == 0) {
+            first_audio_us_ = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - started_).count();
+        }
+        downlink_bytes_.fetch_add(downlink_.size() * sizeof(int16_t), std::memory_order_relaxed);
+        write_queue_.push_back(std::move(downlink_));
+        downlink_.clear();
+        write_output();
+        return;
+    }
+
+    std::string transcription;
+    if (transcripts_ && MessageHandler::extract_transcription_from_response(message, transcription)) {
+        transcripts_->append(MessageHandler::is_user_input_transcription(message)
+                                 ? TranscriptEntry::Speaker::User
+                                 : TranscriptEntry::Speaker::Model,
+                             transcription);
+        return;
+    }
+
+    if (MessageHandler::is_turn_complete(message)) {
+        turns_.fetch_add(1, std::memory_order_relaxed);
+        if (transcripts_) {
+            transcripts_->end_turn();
+        }
+        if (input_closed_) {
+            finish(true);
+        }
+    }
+}
+
+void PipeBridge::read_input() {
+    if (stopping_) {
+        return;
+    }
+
+    // Unpaced input must not outrun the network; wait for queued messages to go out
+    if (client_->pending_writes() > options_.max_pending_writes) {
+        timer_.expires_after(BACKPRESSURE_POLL);
+        timer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+            if (!ec) {
+                self->read_input();
+            }
+        });
+        return;
+    }
+
+    char* bytes = reinterpret_cast<char*>(chunk_.data()) + chunk_fill_;
+    std::size_t size = chunk_.size() * sizeof(int16_t) - chunk_fill_;
+    if (options_.input_limit > 0) {
+        if (input_read_ >= options_.input_limit) {
+            net::post(client_->get_executor(), [self = shared_from_this()]() {
+                self->on_input(net::error::eof, 0);
+            });
+            return;
+        }
+        size = static_cast<std::size_t>(std::min<uint64_t>(size, options_.input_limit - input_read_));
+    }
+    if (input_is_file_) {
+        // A file read does not block for long; complete it through the strand like the async path
+        ssize_t n = ::read(options_.input_fd, bytes, size);
+        beast::error_code ec;
+        if (n == 0) {
+            ec = net::error::eof;
+        } else if (n < 0) {
+            ec = beast::error_code(errno, boost::system::system_category());
+        }
+        net::post(client_->get_executor(), [self = shared_from_this(), ec, n]() {
+            self->on_input(ec, n > 0 ? static_cast<std::size_t>(n) : 0);
+        });
+        return;
+    }
+    input_.async_read_some(net::buffer(bytes, size), [self = shared_from_this()](beast::error_code ec, std::size_t n) {
+        self->on_input(ec, n);
+    });
+}
+
+void PipeBridge::on_input(beast::error_code ec, std::size_t bytes) {
+    if (stopping_) {
+        return;
+    }
+    chunk_fill_ += bytes;
+    input_read_ += bytes;
+    bool full = chunk_fill_ == chunk_.size() * sizeof(int16_t);
+    if (full || (ec && chunk_fill_ >= sizeof(int16_t))) {
+        send_chunk();
+    }
+    if (ec) {
+        if (ec != net::error::eof) {
+            std::cerr << "[Pipe] Input error: " << ec.message() << std::endl;
+        }
+        on_input_closed();
+        return;
+    }
+    if (!full || options_.speed <= 0) {
+        read_input();
+        return;
+    }
+
+    // Realtime (or scaled) pacing against absolute deadlines
+    auto deadline = started_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(samples_sent_ / (options_.input_sample_rate * options_.speed)));
+    timer_.expires_at(deadline);
+    timer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+        if (!ec) {
+            self->read_input();
+        }
+    });
+}
+
+void PipeBridge::send_chunk() {
+    std::size_t bytes = chunk_fill_ - chunk_fill_ % sizeof(int16_t);
+    std::string message;
+    MessageHandler::build_audio_input_message(
+        reinterpret_cast<const uint8_t*>(chunk_.data()), bytes, "audio/pcm;rate=" + std::to_string(options_.input_sample_rate),
+        message);
+    client_->send(std::move(message));
+    samples_sent_ += bytes / sizeof(int16_t);
+    uplink_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+
+    // An odd trailing byte starts the next chunk
+    char* data = reinterpret_cast<char*>(chunk_.data());
+    if (chunk_fill_ > bytes) {
+        data[0] = data[bytes];
+    }
+    chunk_fill_ -= bytes;
+}
+
+void PipeBridge::on_input_closed() {
+    input_closed_ = true;
+    client_->send(MessageHandler::create_audio_stream_end_message());
+
+    // Finish at the next turnComplete, or after drain_timeout if the model stays silent
+    timer_.expires_after(options_.drain_timeout);
+    timer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+        if (!ec) {
+            self->finish(true);
+        }
+    });
+}
+
+void PipeBridge::write_output() {
+    if (output_is_file_) {
+        while (!write_queue_.empty()) {
+            const std::vector<int16_t>& front = write_queue_.front();
+            const char* data = reinterpret_cast<const char*>(front.data());
+            std::size_t size = front.size() * sizeof(int16_t);
+            while (write_offset_ < size) {
+                ssize_t n = ::write(options_.output_fd, data + write_offset_, size - write_offset_);
+                if (n < 0) {
+                    std::cerr << "[Pipe] Output error: " << std::strerror(errno) << std::endl;
+                    write_queue_.clear();
+                    write_offset_ = 0;
+                    finish(false);
+                    return;
+                }
+                write_offset_ += static_cast<std::size_t>(n);
+            }
+            write_offset_ = 0;
+            downlink_ = std::move(write_queue_.front());
+            downlink_.clear();
+            write_queue_.pop_front();
+        }
+        if (stopping_) {
+            complete();
+        }
+        return;
+    }
+
+    if (writing_) {
+        return;
+    }
+    if (write_queue_.empty()) {
+        if (stopping_) {
+            complete();
+        }
+        return;
+    }
+
+    writing_ = true;
+    const std::vector<int16_t>& front = write_queue_.front();
+    net::async_write(output_, net::buffer(front.data(), front.size() * sizeof(int16_t)),
+        [self = shared_from_this()](beast::error_code ec, std::size_t) {
+            self->writing_ = false;
+            if (ec) {
+                // The reader went away (e.g. a closed pipe); nothing more can be delivered
+                std::cerr << "[Pipe] Output error: " << ec.message() << std::endl;
+                self->write_queue_.clear();
+                self->finish(false);
+                return;
+            }
+            // Reuse the written buffer as the next decode target
+            self->downlink_ = std::move(self->write_queue_.front());
+            self->downlink_.clear();
+            self->write_queue_.pop_front();
+            self->write_output();
+        });
+}
+
+void PipeBridge::finish(bool ok) {
+    if (stopping_) {
+        return;
+    }
+    stopping_ = true;
+    succeeded_ = ok && ready_;
+    if (ready_) {
+        elapsed_us_ = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - started_).count();
+    }
+
+    timer_.cancel();
+    client_->close();
+    if (input_.is_open()) {
+        beast::error_code ignored;
+        input_.cancel(ignored);
+        input_.close(ignored);
+    }
+    // Model audio already received is still written out
+    write_output();
+}
+
+void PipeBridge::restore_flags() {
+    // Both at once: stdin and stdout are often the same terminal, and clearing O_NONBLOCK
+    // while the other descriptor is still in use would make its async operations block
+    if (input_flags_ != -1) {
+        ::fcntl(options_.input_fd, F_SETFL, input_flags_);
+        input_flags_ = -1;
+    }
+    if (output_flags_ != -1) {
+        ::fcntl(options_.output_fd, F_SETFL, output_flags_);
+        output_flags_ = -1;
+    }
+}
+
+void PipeBridge::complete() {
+    if (finished_) {
+        return;
+    }
+    if (output_.is_open()) {
+        beast::error_code ignored;
+        output_.close(ignored);
+    }
+    restore_flags();
+    finished_ = true;
+    if (finished_callback_) {
+        finished_callback_();
+    }
+}
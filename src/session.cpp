@@ -0,0 +1,233 @@
+#include "session.h"
+#include "message_handler.h"
+#include <iostream>
+
+Session::Session(net::io_context& io_context, int id, const SessionOptions& options)
+    : id_(id)
+    , options_(options)
+    , client_(std::make_shared<WebSocketClient>(io_context, options.endpoint))
+    , uplink_timer_(client_->get_executor())
+    , ready_(false)
+    , stopped_(false)
+    , messages_sent_(0)
+    , bytes_sent_(0)
+    , messages_received_(0)
+    , bytes_received_(0)
+    , audio_samples_received_(0)
+    , errors_(0)
+    , turns_completed_(0)
+    , connected_us_(-1)
+    , ready_us_(-1)
+    , first_audio_us_(-1) {
+    
+    uplink_chunk_.resize(options_.chunk_samples);
+}
+
+Session::~Session() {
+    // Clears the callbacks and closes on the strand; the client lives until its handlers drain
+    WebSocketClient::release(std::move(client_));
+}
+
+void Session::set_audio_source(AudioSource source) {
+    audio_source_ = std::move(source);
+}
+
+void Session::set_audio_sink(AudioSink sink) {
+    audio_sink_ = std::move(sink);
+}
+
+// Microseconds between two time points
+static int64_t elapsed_us(std::chrono::steady_clock::time_point from,
+                          std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+void Session::start() {
+    started_at_ = std::chrono::steady_clock::now();
+    
+    // Weak, so a queued receive never runs on a destroyed session
+    std::weak_ptr<Session> weak = weak_from_this();
+    client_->set_message_view_callback([weak](std::string_view message) {
+        if (auto self = weak.lock()) {
+            self->on_message(message);
+        }
+    });
+    client_->set_error_callback([weak, id = id_](const std::string& error) {
+        if (auto self = weak.lock()) {
+            self->errors_.fetch_add(1, std::memory_order_relaxed);
+        }
+        std::cerr << "[Session " << id << "] " << error << std::endl;
+    });
+    
+    client_->async_connect([weak](bool connected) {
+        auto self = weak.lock();
+        if (!self) {
+            return;
+        }
+        if (!connected) {
+            self->errors_.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "[Session " << self->id_ << "] Connection failed" << std::endl;
+            return;
+        }
+        self->connected_us_ = elapsed_us(self->started_at_, std::chrono::steady_clock::now());
+        
+        self->bytes_sent_.fetch_add(self->options_.setup_message.size(), std::memory_order_relaxed);
+        self->messages_sent_.fetch_add(1, std::memory_order_relaxed);
+        self->client_->send(self->options_.setup_message);
+        self->client_->async_receive();
+    });
+}
+
+std::future<void> Session::stop() {
+    if (stopped_.exchange(true)) {
+        std::promise<void> done;
+        done.set_value();
+        return done.get_future();
+    }
+    
+    net::dispatch(client_->get_executor(), [self = shared_from_this()]() {
+        self->uplink_timer_.cancel();
+    });
+    return client_->begin_close();
+}
+
+Session::Stats Session::get_stats() const {
+    Stats stats;
+    stats.id = id_;
+    stats.connected = client_->is_connected();
+    stats.ready = ready_.load(std::memory_order_relaxed);
+    stats.messages_sent = messages_sent_.load(std::memory_order_relaxed);
+    stats.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+    stats.messages_received = messages_received_.load(std::memory_order_relaxed);
+    stats.bytes_received = bytes_received_.load(std::memory_order_relaxed);
+    stats.audio_samples_received = audio_samples_received_.load(std::memory_order_relaxed);
+    stats.errors = errors_.load(std::memory_order_relaxed);
+    stats.turns_completed = turns_completed_.load(std::memory_order_relaxed);
+    int64_t connected_us = connected_us_.load(std::memory_order_relaxed);
+    int64_t ready_us = ready_us_.load(std::memory_order_relaxed);
+    int64_t first_audio_us = first_audio_us_.load(std::memory_order_relaxed);
+    stats.connect_ms = connected_us < 0 ? -1.0 : connected_us / 1000.0;
+    stats.setup_ms = ready_us < 0 ? -1.0 : ready_us / 1000.0;
+    stats.first_audio_ms = (first_audio_us < 0 || ready_us < 0) ? -1.0 : (first_audio_us - ready_us) / 1000.0;
+    stats.elapsed_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - started_at_).count();
+    return stats;
+}
+
+void Session::on_message(std::string_view message) {
+    messages_received_.fetch_add(1, std::memory_order_relaxed);
+    bytes_received_.fetch_add(message.size(), std::memory_order_relaxed);
+    
+    auto now = std::chrono::steady_clock::now();
+    
+    // Start streaming once the server has accepted the setup
+    if (!ready_ && MessageHandler::is_setup_complete(message)) {
+        ready_ = true;
+        ready_us_ = elapsed_us(started_at_, now);
+        start_user_turn();
+        return;
+    }
+    
+    if (MessageHandler::extract_audio_from_response(message, downlink_audio_)) {
+        if (first_audio_us_ < 0) {
+            first_audio_us_ = elapsed_us(started_at_, now);
+        }
+        
+        // First audio of a turn: measure from the end of the user turn it answers
+        if (!in_turn_) {
+            in_turn_ = true;
+            if (awaiting_response_) {
+                turn_latency_us_.record(elapsed_us(user_turn_end_, now));
+            }
+        } else {
+            downlink_gap_us_.record(elapsed_us(last_audio_received_, now));
+        }
+        last_audio_received_ = now;
+        
+        audio_samples_received_.fetch_add(downlink_audio_.size(), std::memory_order_relaxed);
+        if (audio_sink_) {
+            audio_sink_(downlink_audio_);
+        }
+        return;
+    }
+    
+    if (MessageHandler::is_turn_complete(message) || MessageHandler::is_interrupted(message)) {
+        if (in_turn_) {
+            turns_completed_.fetch_add(1, std::memory_order_relaxed);
+        }
+        in_turn_ = false;
+        
+        // The model has answered; speak again
+        if (awaiting_response_) {
+            awaiting_response_ = false;
+            start_user_turn();
+        }
+    }
+}
+
+void Session::start_user_turn() {
+    turn_chunks_sent_ = 0;
+    next_uplink_ = std::chrono::steady_clock::now();
+    schedule_uplink();
+}
+
+void Session::schedule_uplink() {
+    if (stopped_ || options_.chunk_samples == 0) {
+        return;
+    }
+    
+    // Pace against absolute deadlines so timer latency does not accumulate
+    next_uplink_ += options_.chunk_interval;
+    uplink_timer_.expires_at(next_uplink_);
+    uplink_timer_.async_wait([weak = weak_from_this()](beast::error_code ec) {
+        if (auto self = weak.lock()) {
+            self->on_uplink_timer(ec);
+        }
+    });
+}
+
+void Session::on_uplink_timer(beast::error_code ec) {
+    if (ec || stopped_ || !client_->is_connected()) {
+        return;
+    }
+    // Expired before a turnComplete re-armed the timer; the new deadline has its own handler
+    if (uplink_timer_.expiry() > std::chrono::steady_clock::now()) {
+        return;
+    }
+    
+    // No turnComplete within response_timeout: give up on this answer and speak again
+    if (awaiting_response_) {
+        awaiting_response_ = false;
+        start_user_turn();
+        return;
+    }
+    
+    if (audio_source_) {
+        audio_source_(uplink_chunk_);
+    }
+    
+    std::string message = MessageHandler::create_audio_input_message(uplink_chunk_, options_.mime_type);
+    bytes_sent_.fetch_add(message.size(), std::memory_order_relaxed);
+    messages_sent_.fetch_add(1, std::memory_order_relaxed);
+    client_->send(std::move(message));
+    
+    // End of the user turn: stop sending so the answer's latency is measured from here,
+    // not from whichever chunk of continuous audio happened to precede it
+    if (options_.turn_chunks > 0 && ++turn_chunks_sent_ >= options_.turn_chunks) {
+        std::string stream_end = MessageHandler::create_audio_stream_end_message();
+        bytes_sent_.fetch_add(stream_end.size(), std::memory_order_relaxed);
+        messages_sent_.fetch_add(1, std::memory_order_relaxed);
+        client_->send(std::move(stream_end));
+        user_turn_end_ = std::chrono::steady_clock::now();
+        awaiting_response_ = true;
+        uplink_timer_.expires_after(options_.response_timeout);
+        uplink_timer_.async_wait([weak = weak_from_this()](beast::error_code ec) {
+            if (auto self = weak.lock()) {
+                self->on_uplink_timer(ec);
+            }
+        });
+        return;
+    }
+    
+    schedule_uplink();
+}
@@ -0,0 +1,135 @@
+#include "session_manager.h"
+#include "thread_placement.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+// How long stop() waits for the close handshakes of all sessions together
+static constexpr auto CLOSE_TIMEOUT = std::chrono::seconds(2);
+
+// Size the pool to the available cores
+static std::size_t default_thread_count() {
+    return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+}
+
+SessionManager::SessionManager(std::size_t thread_count)
+    : io_context_(static_cast<int>(thread_count > 0 ? thread_count : default_thread_count()))
+    , work_guard_(net::make_work_guard(io_context_))
+    , thread_count_(thread_count > 0 ? thread_count : default_thread_count()) {
+}
+
+SessionManager::~SessionManager() {
+    stop();
+}
+
+Session& SessionManager::add_session(const SessionOptions& options) {
+    int id = static_cast<int>(sessions_.size());
+    sessions_.push_back(std::make_shared<Session>(io_context_, id, options));
+    return *sessions_.back();
+}
+
+void SessionManager::start() {
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    started_at_ = std::chrono::steady_clock::now();
+    
+    for (std::size_t i = 0; i < thread_count_; i++) {
+        threads_.emplace_back([this]() {
+            thread_placement().apply("io");
+            io_context_.run();
+        });
+    }
+    
+    // Handshakes run asynchronously on the pool, so all sessions connect at once
+    // and established sessions are served while the rest are still connecting
+    for (auto& session : sessions_) {
+        session->start();
+    }
+}
+
+void SessionManager::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+    
+    // Start every close handshake first so they overlap, then wait for all of them
+    std::vector<std::future<void>> closing;
+    closing.reserve(sessions_.size());
+    for (auto& session : sessions_) {
+        closing.push_back(session->stop());
+    }
+    auto deadline = std::chrono::steady_clock::now() + CLOSE_TIMEOUT;
+    for (auto& closed : closing) {
+        if (closed.wait_until(deadline) != std::future_status::ready) {
+            std::cerr << "[SessionManager] Timed out waiting for close handshakes" << std::endl;
+            break;
+        }
+    }
+    
+    work_guard_.reset();
+    io_context_.stop();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+SessionManager::Totals SessionManager::get_totals() const {
+    Totals totals;
+    totals.sessions = sessions_.size();
+    for (const auto& session : sessions_) {
+        Session::Stats stats = session->get_stats();
+        if (stats.connected) totals.connected++;
+        if (stats.ready) totals.ready++;
+        totals.messages_sent += stats.messages_sent;
+        totals.bytes_sent += stats.bytes_sent;
+        totals.messages_received += stats.messages_received;
+        totals.bytes_received += stats.bytes_received;
+        totals.audio_samples_received += stats.audio_samples_received;
+        totals.errors += stats.errors;
+    }
+    return totals;
+}
+
+void SessionManager::print_report(std::ostream& out, bool per_session) const {
+    double elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - started_at_).count();
+    if (elapsed <= 0.0) {
+        elapsed = 1e-9;
+    }
+    
+    std::ios_base::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(1);
+    
+    if (per_session) {
+        out << "  id  state  tx msg/s  rx msg/s  tx KB/s  rx KB/s  errors" << std::endl;
+        for (const auto& session : sessions_) {
+            Session::Stats stats = session->get_stats();
+            double t = stats.elapsed_seconds > 0.0 ? stats.elapsed_seconds : elapsed;
+            out << std::setw(4) << stats.id
+                << std::setw(7) << (stats.ready ? "ready" : (stats.connected ? "conn" : "down"))
+                << std::setw(10) << stats.messages_sent / t
+                << std::setw(10) << stats.messages_received / t
+                << std::setw(9) << stats.bytes_sent / t / 1024.0
+                << std::setw(9) << stats.bytes_received / t / 1024.0
+                << std::setw(8) << stats.errors << std::endl;
+        }
+    }
+    
+    Totals totals = get_totals();
+    out << "Sessions: " << totals.ready << " ready / " << totals.connected << " connected / "
+        << totals.sessions << " total (" << thread_count_ << " threads, " << elapsed << "s)" << std::endl;
+    out << "Aggregate: tx " << totals.messages_sent / elapsed << " msg/s, "
+        << totals.bytes_sent / elapsed / 1024.0 << " KB/s | rx "
+        << totals.messages_received / elapsed << " msg/s, "
+        << totals.bytes_received / elapsed / 1024.0 << " KB/s | audio rx "
+        << totals.audio_samples_received / elapsed << " samples/s | errors "
+        << totals.errors << std::endl;
+    
+    out.flags(flags);
+}
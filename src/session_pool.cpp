@@ -0,0 +1,321 @@
+#include "session_pool.h"
+#include "message_handler.h"
+#include "metrics.h"
+#include <algorithm>
+#include <future>
+#include <vector>
+
+namespace {
+
+constexpr auto SWEEP_INTERVAL = std::chrono::seconds(1);
+
+// Process-wide pool metrics, shared by every pool
+struct PoolMetrics {
+    Counter& hits = metrics().counter("gemini_pool_hits_total", "Calls handed a warm session");
+    Counter& misses = metrics().counter("gemini_pool_misses_total", "Calls that found no warm session");
+    Counter& failures = metrics().counter("gemini_pool_failures_total", "Warm sessions that failed to connect or set up");
+    Counter& retired = metrics().counter("gemini_pool_retired_total", "Idle warm sessions closed before use");
+    Gauge& idle = metrics().gauge("gemini_pool_idle_sessions", "Warm sessions waiting for a call");
+    Histogram& pickup_ns = metrics().histogram("gemini_pool_pickup_seconds", "Time to take a session from the pool",
+        {1000, 10000, 100000, 1000000, 10000000}, 1e-9);
+};
+
+PoolMetrics& pool_metrics() {
+    static PoolMetrics instance;
+    return instance;
+}
+
+// Run f on a strand and wait for it. Runs f directly if nothing else can run the strand:
+// the caller is on it, or the io_context has stopped. From another pool thread it only dispatches
+template <typename Function>
+void run_on_strand(net::io_context& io_context, const WebSocketClient::Executor& strand, Function f) {
+    if (strand.running_in_this_thread() || io_context.stopped()) {
+        f();
+        return;
+    }
+    if (io_context.get_executor().running_in_this_thread()) {
+        net::dispatch(strand, std::move(f));
+        return;
+    }
+    std::promise<void> done;
+    net::dispatch(strand, [&f, &done]() {
+        f();
+        done.set_value();
+    });
+    done.get_future().wait();
+}
+
+// Drop the pool's callbacks, which capture the pool, before a client leaves it
+void clear_pool_callbacks(net::io_context& io_context, const std::shared_ptr<WebSocketClient>& client) {
+    run_on_strand(io_context, client->get_executor(), [client]() {
+        client->set_connect_callback(nullptr);
+        client->set_message_view_callback(nullptr);
+        client->set_error_callback(nullptr);
+        client->set_close_callback(nullptr);
+    });
+}
+
+}  // namespace
+
+SessionPool::SessionPool(net::io_context& io_context, const SessionPoolOptions& options)
+    : io_context_(io_context)
+    , options_(options)
+    , sweep_strand_(net::make_strand(io_context))
+    , sweep_timer_(sweep_strand_) {
+}
+
+SessionPool::~SessionPool() {
+    stop();
+}
+
+void SessionPool::start() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            return;
+        }
+        running_ = true;
+    }
+    refill();
+    net::dispatch(sweep_strand_, [this]() {
+        schedule_sweep();
+    });
+}
+
+void SessionPool::stop() {
+    std::vector<std::shared_ptr<WebSocketClient>> clients;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        for (Warm& warm : idle_) {
+            clients.push_back(std::move(warm.client));
+        }
+        pool_metrics().idle.add(-static_cast<int64_t>(idle_.size()));
+        idle_.clear();
+        for (auto& entry : connecting_) {
+            clients.push_back(entry.first);
+        }
+        connecting_.clear();
+    }
+    // Wait until nothing can call back into this pool, so it may be destroyed right after
+    for (auto& client : clients) {
+        clear_pool_callbacks(io_context_, client);
+        WebSocketClient::release(std::move(client));
+    }
+    run_on_strand(io_context_, sweep_strand_, [this]() {
+        sweep_timer_.cancel();
+    });
+}
+
+std::shared_ptr<WebSocketClient> SessionPool::acquire() {
+    auto begin = std::chrono::steady_clock::now();
+    std::shared_ptr<WebSocketClient> client;
+    std::vector<std::shared_ptr<WebSocketClient>> expired;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!idle_.empty() && !client) {
+            Warm warm = std::move(idle_.front());
+            idle_.pop_front();
+            pool_metrics().idle.add(-1);
+            if (begin - warm.ready_at > options_.max_idle || !warm.client->is_connected()) {
+                expired.push_back(std::move(warm.client));
+            } else {
+                client = std::move(warm.client);
+            }
+        }
+    }
+    auto pickup_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin).count());
+    pickup_ns_.record(pickup_ns);
+    pool_metrics().pickup_ns.record(pickup_ns);
+
+    if (client) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        pool_metrics().hits.inc();
+        // Ahead of anything the new owner queues on the strand, so a close before it installs
+        // its own callbacks never reaches this pool
+        clear_pool_callbacks(io_context_, client);
+    } else {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        pool_metrics().misses.inc();
+    }
+    for (auto& stale : expired) {
+        retired_.fetch_add(1, std::memory_order_relaxed);
+        pool_metrics().retired.inc();
+        clear_pool_callbacks(io_context_, stale);
+        WebSocketClient::release(std::move(stale));
+    }
+    refill();
+    return client;
+}
+
+SessionPool::Stats SessionPool::get_stats() const {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.idle = idle_.size();
+        stats.connecting = connecting_.size() + launching_;
+    }
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.opened = opened_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.retired = retired_.load(std::memory_order_relaxed);
+    if (stats.hits + stats.misses > 0) {
+        stats.hit_rate = static_cast<double>(stats.hits) / (stats.hits + stats.misses);
+    }
+    return stats;
+}
+
+void SessionPool::refill() {
+    std::size_t need = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ || std::chrono::steady_clock::now() < retry_after_) {
+            return;
+        }
+        std::size_t have = idle_.size() + connecting_.size() + launching_;
+        need = options_.size > have ? options_.size - have : 0;
+        launching_ += need;
+    }
+    // Create the clients on the pool threads, off the caller's path; connecting does not block
+    for (std::size_t i = 0; i < need; i++) {
+        net::post(io_context_, [this]() {
+            open_one();
+        });
+    }
+}
+
+void SessionPool::open_one() {
+    auto client = std::make_shared<WebSocketClient>(io_context_, options_.endpoint);
+    WebSocketClient* raw = client.get();
+    client->set_message_view_callback([this, raw](std::string_view message) {
+        if (MessageHandler::is_setup_complete(message)) {
+            on_ready(raw);
+        }
+        // Anything else arriving while idle is dropped
+    });
+    client->set_error_callback([this, raw](const std::string&) {
+        on_failed(raw);
+    });
+    client->set_close_callback([this, raw]() {
+        on_failed(raw);
+    });
+
+    // The handshakes run on the client's strand; no pool thread waits for them. Started under
+    // the lock, so stop() clears the callback only after async_connect() has stored it
+    std::lock_guard<std::mutex> lock(mutex_);
+    launching_--;
+    if (!running_) {
+        return;
+    }
+    connecting_.emplace(client, std::chrono::steady_clock::now());
+    client->async_connect([this, raw](bool connected) {
+        if (!connected) {
+            on_failed(raw);
+            return;
+        }
+        {
+            // The sweep may have given up on this connect; it released the client already
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = std::find_if(connecting_.begin(), connecting_.end(),
+                                   [raw](const auto& entry) { return entry.first.get() == raw; });
+            if (it == connecting_.end()) {
+                return;
+            }
+        }
+        raw->send(options_.setup_message);
+        raw->async_receive();
+    });
+}
+
+void SessionPool::on_ready(WebSocketClient* client) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = connecting_.begin(); it != connecting_.end(); ++it) {
+        if (it->first.get() == client) {
+            idle_.push_back(Warm{it->first, std::chrono::steady_clock::now()});
+            connecting_.erase(it);
+            opened_.fetch_add(1, std::memory_order_relaxed);
+            pool_metrics().idle.add(1);
+            return;
+        }
+    }
+}
+
+void SessionPool::on_failed(WebSocketClient* client) {
+    std::shared_ptr<WebSocketClient> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = connecting_.begin(); it != connecting_.end(); ++it) {
+            if (it->first.get() == client) {
+                removed = it->first;
+                connecting_.erase(it);
+                failed_.fetch_add(1, std::memory_order_relaxed);
+                pool_metrics().failures.inc();
+                // Do not hammer an endpoint that is refusing connections
+                retry_after_ = std::chrono::steady_clock::now() + options_.retry_delay;
+                break;
+            }
+        }
+        for (auto it = idle_.begin(); !removed && it != idle_.end(); ++it) {
+            if (it->client.get() == client) {
+                removed = std::move(it->client);
+                idle_.erase(it);
+                retired_.fetch_add(1, std::memory_order_relaxed);
+                pool_metrics().retired.inc();
+                pool_metrics().idle.add(-1);
+                break;
+            }
+        }
+    }
+    // Already handed to a call, or retired before
+    if (!removed) {
+        return;
+    }
+    WebSocketClient::release(std::move(removed));
+    refill();
+}
+
+void SessionPool::schedule_sweep() {
+    sweep_timer_.expires_after(SWEEP_INTERVAL);
+    sweep_timer_.async_wait([this](beast::error_code ec) {
+        if (ec) {
+            return;
+        }
+
+        // Recycle sessions before the server's connection limit, and give up on stuck setups
+        auto now = std::chrono::steady_clock::now();
+        std::vector<std::shared_ptr<WebSocketClient>> expired;
+        std::vector<WebSocketClient*> stuck;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                return;
+            }
+            while (!idle_.empty() && now - idle_.front().ready_at > options_.max_idle) {
+                expired.push_back(std::move(idle_.front().client));
+                idle_.pop_front();
+                pool_metrics().idle.add(-1);
+            }
+            for (auto& entry : connecting_) {
+                if (now - entry.second > options_.setup_timeout) {
+                    stuck.push_back(entry.first.get());
+                }
+            }
+        }
+        for (auto& client : expired) {
+            retired_.fetch_add(1, std::memory_order_relaxed);
+            pool_metrics().retired.inc();
+            clear_pool_callbacks(io_context_, client);
+            WebSocketClient::release(std::move(client));
+        }
+        for (WebSocketClient* client : stuck) {
+            on_failed(client);
+        }
+        refill();
+        schedule_sweep();
+    });
+}
@@ -0,0 +1,134 @@
+#include "session_recorder.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+const char MAGIC[5] = {'G', 'V', 'R', 'E', 'C'};
+constexpr uint8_t FORMAT_VERSION = 1;
+constexpr std::size_t HEADER_SIZE = 8;
+constexpr std::size_t FRAME_HEADER_SIZE = 8 + 1 + 4;
+
+void put_le(char* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+uint64_t get_le(const char* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+    }
+    return value;
+}
+
+// Long gaps are slept in slices so keep_running is checked regularly
+constexpr auto STOP_POLL_INTERVAL = std::chrono::milliseconds(50);
+
+}  // namespace
+
+bool SessionRecorder::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+        std::cerr << "Recorder: cannot create " << path << std::endl;
+        return false;
+    }
+
+    char header[HEADER_SIZE] = {};
+    std::copy(std::begin(MAGIC), std::end(MAGIC), header);
+    header[5] = static_cast<char>(FORMAT_VERSION);
+    out_.write(header, sizeof(header));
+
+    started_ = Clock::now();
+    frames_.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void SessionRecorder::record(RecordedFrame::Direction direction, std::string_view payload) {
+    uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started_).count();
+
+    char frame_header[FRAME_HEADER_SIZE];
+    put_le(frame_header, elapsed, 8);
+    frame_header[8] = static_cast<char>(direction);
+    put_le(frame_header + 9, payload.size(), 4);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!out_.is_open()) {
+        return;
+    }
+    out_.write(frame_header, sizeof(frame_header));
+    out_.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    frames_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SessionRecorder::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (out_.is_open()) {
+        out_.close();
+    }
+}
+
+bool SessionReplayer::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Replay: cannot open " << path << std::endl;
+        return false;
+    }
+
+    char header[HEADER_SIZE];
+    if (!in.read(header, sizeof(header)) || !std::equal(std::begin(MAGIC), std::end(MAGIC), header) ||
+        static_cast<uint8_t>(header[5]) != FORMAT_VERSION) {
+        std::cerr << "Replay: " << path << " is not a session recording" << std::endl;
+        return false;
+    }
+
+    frames_.clear();
+    char frame_header[FRAME_HEADER_SIZE];
+    while (in.read(frame_header, sizeof(frame_header))) {
+        RecordedFrame frame;
+        frame.timestamp_ns = get_le(frame_header, 8);
+        frame.direction = static_cast<RecordedFrame::Direction>(frame_header[8]);
+        frame.payload.resize(get_le(frame_header + 9, 4));
+        if (!in.read(frame.payload.data(), static_cast<std::streamsize>(frame.payload.size()))) {
+            // A recording cut short by a crash still replays up to the last whole frame
+            std::cerr << "Replay: truncated frame at the end of " << path << std::endl;
+            break;
+        }
+        frames_.push_back(std::move(frame));
+    }
+    return true;
+}
+
+std::size_t SessionReplayer::replay(double speed, const FrameCallback& on_inbound,
+                                    const std::function<bool()>& keep_running) const {
+    auto started = Clock::now();
+    std::size_t replayed = 0;
+
+    for (const RecordedFrame& frame : frames_) {
+        if (frame.direction != RecordedFrame::Direction::Inbound) {
+            continue;
+        }
+
+        if (speed > 0) {
+            // Absolute deadlines so callback time does not accumulate as drift
+            auto deadline = started + std::chrono::nanoseconds(
+                static_cast<int64_t>(static_cast<double>(frame.timestamp_ns) / speed));
+            while (Clock::now() < deadline) {
+                if (keep_running && !keep_running()) {
+                    return replayed;
+                }
+                std::this_thread::sleep_until(std::min(deadline, Clock::now() + STOP_POLL_INTERVAL));
+            }
+        }
+        if (keep_running && !keep_running()) {
+            break;
+        }
+
+        on_inbound(frame.payload);
+        replayed++;
+    }
+    return replayed;
+}
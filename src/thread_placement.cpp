@@ -0,0 +1,318 @@
+#include "thread_placement.h"
+#include "metrics.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+
+// Process-wide scheduling metrics
+struct PlacementMetrics {
+    Counter& fallbacks = metrics().counter("gemini_thread_placement_fallbacks_total",
+        "Threads whose affinity or priority request was refused or reduced");
+    Gauge& locked = metrics().gauge("gemini_memory_locked", "1 if the process memory is locked with mlockall");
+};
+
+PlacementMetrics& placement_metrics() {
+    static PlacementMetrics instance;
+    return instance;
+}
+
+const char* policy_name(int policy) {
+    switch (policy) {
+        case SCHED_FIFO: return "SCHED_FIFO";
+        case SCHED_RR: return "SCHED_RR";
+        case SCHED_OTHER: return "SCHED_OTHER";
+        case SCHED_BATCH: return "SCHED_BATCH";
+        case SCHED_IDLE: return "SCHED_IDLE";
+        default: return "unknown";
+    }
+}
+
+// "0-3,6" style list
+std::string format_cpus(const std::vector<int>& cpus) {
+    std::string text;
+    for (std::size_t i = 0; i < cpus.size(); ) {
+        std::size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+            j++;
+        }
+        if (!text.empty()) {
+            text += ',';
+        }
+        text += std::to_string(cpus[i]);
+        if (j > i) {
+            text += '-' + std::to_string(cpus[j]);
+        }
+        i = j + 1;
+    }
+    return text;
+}
+
+// Fault in the top of the stack now, so a locked realtime thread does not take page faults later
+[[gnu::noinline]] void prefault_stack() {
+    constexpr std::size_t PREFAULT_BYTES = 128 * 1024;
+    unsigned char stack[PREFAULT_BYTES];
+    for (std::size_t i = 0; i < PREFAULT_BYTES; i += 4096) {
+        stack[i] = 0;
+    }
+    // Keeps the stores: the compiler must assume the array is read
+    asm volatile("" : : "r"(stack) : "memory");
+}
+
+// VmLck from /proc/self/status, in KiB
+long locked_kib() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmLck:", 0) == 0) {
+            return std::atol(line.c_str() + 6);
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
+const std::vector<std::string>& thread_roles() {
+    static const std::vector<std::string> roles = {"io", "audio", "playback", "video", "transcript"};
+    return roles;
+}
+
+bool validate_thread_placement(const ThreadPlacementConfig& config, std::string& error) {
+    for (const auto& [role, rule] : config.roles) {
+        if (std::find(thread_roles().begin(), thread_roles().end(), role) == thread_roles().end()) {
+            error = "threads." + role + " is not a thread role (io, audio, playback, video, transcript)";
+            return false;
+        }
+        for (int cpu : rule.cpus) {
+            if (cpu < 0 || cpu >= CPU_SETSIZE) {
+                error = "threads." + role + ".cpus has an invalid CPU number " + std::to_string(cpu);
+                return false;
+            }
+        }
+        if (rule.policy != SchedPolicy::Other && (rule.priority < 1 || rule.priority > 99)) {
+            error = "threads." + role + ".priority must be between 1 and 99 for fifo and rr";
+            return false;
+        }
+        if (rule.nice < -20 || rule.nice > 19) {
+            error = "threads." + role + ".nice must be between -20 and 19";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string AppliedPlacement::describe() const {
+    std::string text = role + " (tid " + std::to_string(tid) + "): cpus " + format_cpus(cpus) + ", " + policy_name(policy);
+    if (policy == SCHED_FIFO || policy == SCHED_RR) {
+        text += " " + std::to_string(priority);
+    } else {
+        text += " nice " + std::to_string(nice);
+    }
+    if (!note.empty()) {
+        text += " [" + note + "]";
+    }
+    return text;
+}
+
+ThreadPlacement& ThreadPlacement::instance() {
+    static ThreadPlacement placement;
+    return placement;
+}
+
+void ThreadPlacement::configure(const ThreadPlacementConfig& config) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_ = config;
+    }
+    configured_.store(!config.roles.empty(), std::memory_order_release);
+}
+
+AppliedPlacement ThreadPlacement::apply_rule(const std::string& role, const ThreadRule& rule) const {
+    KernelPlacement state;
+    apply_kernel(rule, state, true);
+    return describe_kernel(role, rule, state);
+}
+
+void ThreadPlacement::apply_kernel(const ThreadRule& rule, KernelPlacement& state, bool prefault) const {
+    state.tid = static_cast<long>(::gettid());
+    pthread_t self = pthread_self();
+
+    if (!rule.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : rule.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        state.affinity_error = pthread_setaffinity_np(self, sizeof(set), &set);
+    }
+
+    bool realtime = false;
+    if (rule.policy != SchedPolicy::Other) {
+        int policy = rule.policy == SchedPolicy::Fifo ? SCHED_FIFO : SCHED_RR;
+        sched_param param{};
+        param.sched_priority = std::clamp(rule.priority, sched_get_priority_min(policy), sched_get_priority_max(policy));
+        int rc = pthread_setschedparam(self, policy, &param);
+        rlimit limit{};
+        if (rc == EPERM && getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur > 0 &&
+            limit.rlim_cur < static_cast<rlim_t>(param.sched_priority)) {
+            // Unprivileged processes may still use priorities up to RLIMIT_RTPRIO
+            param.sched_priority = static_cast<int>(limit.rlim_cur);
+            rc = pthread_setschedparam(self, policy, &param);
+            if (rc == 0) {
+                state.capped_priority = param.sched_priority;
+            }
+        }
+        state.sched_error = rc;
+        realtime = rc == 0;
+    }
+
+    // Linux keeps nice per thread; it only matters when the thread is not realtime
+    if (!realtime && rule.nice != 0 && ::setpriority(PRIO_PROCESS, static_cast<id_t>(state.tid), rule.nice) != 0) {
+        state.nice_error = errno;
+    }
+
+    if (prefault && rule.policy != SchedPolicy::Other && memory_locked_.load(std::memory_order_relaxed)) {
+        prefault_stack();
+    }
+
+    // Report what the kernel actually applied, not what was asked for
+    CPU_ZERO(&state.cpus);
+    pthread_getaffinity_np(self, sizeof(state.cpus), &state.cpus);
+    sched_param param{};
+    pthread_getschedparam(self, &state.policy, &param);
+    state.priority = param.sched_priority;
+    errno = 0;
+    state.nice = ::getpriority(PRIO_PROCESS, static_cast<id_t>(state.tid));
+}
+
+AppliedPlacement ThreadPlacement::describe_kernel(const std::string& role, const ThreadRule& rule,
+                                                  const KernelPlacement& state) {
+    AppliedPlacement applied;
+    applied.role = role;
+    applied.tid = state.tid;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &state.cpus)) {
+            applied.cpus.push_back(cpu);
+        }
+    }
+    applied.policy = state.policy;
+    applied.priority = state.priority;
+    applied.nice = state.nice;
+
+    std::vector<std::string> notes;
+    if (state.affinity_error != 0) {
+        notes.push_back("cpus " + format_cpus(rule.cpus) + " refused: " + std::strerror(state.affinity_error));
+    }
+    if (state.capped_priority != 0) {
+        notes.push_back("priority " + std::to_string(rule.priority) + " capped by RLIMIT_RTPRIO");
+    }
+    if (state.sched_error != 0) {
+        int policy = rule.policy == SchedPolicy::Fifo ? SCHED_FIFO : SCHED_RR;
+        notes.push_back(std::string(policy_name(policy)) + " " + std::to_string(rule.priority) + " refused: " +
+                        std::strerror(state.sched_error) + "; grant CAP_SYS_NICE or raise RLIMIT_RTPRIO");
+    }
+    if (state.nice_error != 0) {
+        notes.push_back("nice " + std::to_string(rule.nice) + " refused: " + std::strerror(state.nice_error));
+    }
+    for (const std::string& note : notes) {
+        applied.note += (applied.note.empty() ? "" : "; ") + note;
+    }
+    return applied;
+}
+
+void ThreadPlacement::apply_configured(const char* role) {
+    ThreadRule rule;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = config_.roles.find(role);
+        if (it == config_.roles.end()) {
+            return;
+        }
+        rule = it->second;
+    }
+
+    AppliedPlacement applied = apply_rule(role, rule);
+    if (!applied.note.empty()) {
+        placement_metrics().fallbacks.inc();
+    }
+    std::cout << "[Sched] " << applied.describe() << std::endl;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    applied_.push_back(std::move(applied));
+}
+
+void ThreadPlacement::record_configured(const char* role) {
+    // configure() finished before any callback started, so config_ is read without the lock.
+    // Comparing in place avoids building a std::string key
+    const ThreadRule* rule = nullptr;
+    for (const auto& [name, configured] : config_.roles) {
+        if (name == role) {
+            rule = &configured;
+            break;
+        }
+    }
+    if (!rule) {
+        return;
+    }
+
+    // No prefault: device threads start after lock_memory(), and mlockall(MCL_FUTURE) made
+    // their stacks resident already
+    std::size_t slot = pending_claimed_.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= MAX_PENDING) {
+        KernelPlacement state;
+        apply_kernel(*rule, state, false);
+        return;
+    }
+    PendingPlacement& pending = pending_[slot];
+    pending.role = role;
+    pending.rule = rule;
+    apply_kernel(*rule, pending.state, false);
+    pending.ready.store(true, std::memory_order_release);
+}
+
+void ThreadPlacement::report_applied(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t claimed = std::min(pending_claimed_.load(std::memory_order_relaxed), MAX_PENDING);
+    while (pending_reported_ < claimed && pending_[pending_reported_].ready.load(std::memory_order_acquire)) {
+        const PendingPlacement& pending = pending_[pending_reported_++];
+        AppliedPlacement applied = describe_kernel(pending.role, *pending.rule, pending.state);
+        if (!applied.note.empty()) {
+            placement_metrics().fallbacks.inc();
+        }
+        out << "[Sched] " << applied.describe() << std::endl;
+        applied_.push_back(std::move(applied));
+    }
+}
+
+bool ThreadPlacement::lock_memory() {
+    if (::mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        int error = errno;
+        std::cerr << "[Sched] mlockall failed: " << std::strerror(error)
+                  << "; continuing unlocked (raise RLIMIT_MEMLOCK or grant CAP_IPC_LOCK)" << std::endl;
+        return false;
+    }
+    // Keep freed heap in the process; returning it would only fault it back in later
+    ::mallopt(M_TRIM_THRESHOLD, -1);
+    ::mallopt(M_MMAP_MAX, 0);
+    memory_locked_.store(true, std::memory_order_relaxed);
+    placement_metrics().locked.set(1);
+    std::cout << "[Sched] Memory locked (" << locked_kib() / 1024 << " MiB resident)" << std::endl;
+    return true;
+}
+
+std::vector<AppliedPlacement> ThreadPlacement::applied() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return applied_;
+}
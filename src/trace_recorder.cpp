@@ -0,0 +1,177 @@
+#include "trace_recorder.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Copy of one event taken while dumping
+struct Snapshot {
+    int64_t timestamp_ns;
+    const char* name;
+    uint64_t arg;
+    TraceRecorder::EventType type;
+};
+
+}  // namespace
+
+TraceRecorder& TraceRecorder::instance() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+void TraceRecorder::enable(std::size_t events_per_thread) {
+    // Ring indices are masked, so round up to a power of two
+    std::size_t capacity = 16;
+    while (capacity < events_per_thread) {
+        capacity <<= 1;
+    }
+    capacity_.store(capacity, std::memory_order_relaxed);
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::local_buffer() noexcept {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer) {
+        return buffer;
+    }
+
+    // First event on this thread: allocate its ring (never on the hot path again)
+    try {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto created = std::make_shared<ThreadBuffer>(capacity_.load(std::memory_order_relaxed),
+                                                      static_cast<uint32_t>(buffers_.size() + 1));
+        buffers_.push_back(created);
+        buffer = created.get();
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+    return buffer;
+}
+
+void TraceRecorder::set_thread_name(const char* name) {
+    if (!enabled()) {
+        return;
+    }
+    if (ThreadBuffer* buffer = local_buffer()) {
+        buffer->name.store(name, std::memory_order_relaxed);
+    }
+}
+
+std::size_t TraceRecorder::dump_chrome_json(std::ostream& out, double last_seconds) const {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffers = buffers_;
+    }
+
+    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count();
+    int64_t cutoff_ns = last_seconds > 0 ? now_ns - static_cast<int64_t>(last_seconds * 1e9) : 0;
+
+    json events = json::array();
+    for (const auto& buffer : buffers) {
+        const uint64_t capacity = buffer->events.size();
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t first = head > capacity ? head - capacity : 0;
+
+        std::vector<Snapshot> snapshot;
+        snapshot.reserve(head - first);
+        for (uint64_t i = first; i < head; i++) {
+            const Event& event = buffer->events[i & buffer->mask];
+            snapshot.push_back({event.timestamp_ns.load(std::memory_order_relaxed),
+                                event.name.load(std::memory_order_relaxed),
+                                event.arg.load(std::memory_order_relaxed),
+                                event.type.load(std::memory_order_relaxed)});
+        }
+
+        // The writer kept going while we copied; drop slots it may have overwritten
+        uint64_t head_after = buffer->head.load(std::memory_order_acquire);
+        uint64_t valid_from = head_after >= capacity ? head_after - capacity + 1 : 0;
+        std::size_t skip = valid_from > first ? std::min<uint64_t>(valid_from - first, snapshot.size()) : 0;
+
+        const char* thread_name = buffer->name.load(std::memory_order_relaxed);
+        events.push_back({
+            {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", buffer->tid},
+            {"args", {{"name", thread_name ? thread_name : "thread " + std::to_string(buffer->tid)}}}
+        });
+
+        int depth = 0;
+        for (std::size_t i = skip; i < snapshot.size(); i++) {
+            const Snapshot& event = snapshot[i];
+            if (event.timestamp_ns < cutoff_ns || !event.name) {
+                continue;
+            }
+
+            json entry = {
+                {"name", event.name},
+                {"pid", 1},
+                {"tid", buffer->tid},
+                {"ts", event.timestamp_ns / 1000.0}
+            };
+            switch (event.type) {
+            case EventType::Begin:
+                depth++;
+                entry["ph"] = "B";
+                if (event.arg != 0) {
+                    entry["args"] = {{"arg", event.arg}};
+                }
+                break;
+            case EventType::End:
+                // Its Begin fell out of the window
+                if (depth == 0) {
+                    continue;
+                }
+                depth--;
+                entry["ph"] = "E";
+                break;
+            case EventType::Counter:
+                entry["ph"] = "C";
+                entry["args"] = {{"value", static_cast<int64_t>(event.arg)}};
+                break;
+            case EventType::Instant:
+                entry["ph"] = "i";
+                entry["s"] = "t";
+                if (event.arg != 0) {
+                    entry["args"] = {{"arg", event.arg}};
+                }
+                break;
+            case EventType::FlowStart:
+            case EventType::FlowStep:
+            case EventType::FlowEnd:
+                entry["ph"] = event.type == EventType::FlowStart ? "s" :
+                              event.type == EventType::FlowStep ? "t" : "f";
+                entry["cat"] = "flow";
+                entry["id"] = event.arg;
+                if (event.type == EventType::FlowEnd) {
+                    entry["bp"] = "e";
+                }
+                break;
+            }
+            events.push_back(std::move(entry));
+        }
+    }
+
+    std::size_t count = events.size();
+    json trace = {
+        {"traceEvents", std::move(events)},
+        {"displayTimeUnit", "ms"}
+    };
+    out << trace.dump() << std::endl;
+    return count;
+}
+
+bool TraceRecorder::dump_to_file(const std::string& path, double last_seconds) const {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Trace: cannot write " << path << std::endl;
+        return false;
+    }
+    std::size_t count = dump_chrome_json(out, last_seconds);
+    std::cout << "Trace: " << count << " events written to " << path << std::endl;
+    return true;
+}
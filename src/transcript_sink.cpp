@@ -0,0 +1,270 @@
+#include "transcript_sink.h"
+#include "trace_recorder.h"
+#include "thread_placement.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+// Sentence terminators: . ! ? and the full-width 。！？ (U+3002, U+FF01, U+FF1F)
+const char* const TERMINATORS[] = {".", "!", "?", "\xE3\x80\x82", "\xEF\xBC\x81", "\xEF\xBC\x9F"};
+
+// Kept with the sentence they follow: quotes and closing brackets 」』）(U+300D, U+300F, U+FF09)
+const char* const CLOSERS[] = {"\"", "'", ")", "\xE3\x80\x8D", "\xE3\x80\x8F", "\xEF\xBC\x89"};
+
+// Every multi-byte terminator and closer starts with one of these lead bytes
+bool is_candidate_lead(unsigned char byte) {
+    return byte == 0xE3 || byte == 0xEF;
+}
+
+template <std::size_t N>
+std::size_t match_any(const std::string& buffer, std::size_t pos, const char* const (&table)[N]) {
+    std::string_view rest(buffer.data() + pos, buffer.size() - pos);
+    for (const char* entry : table) {
+        std::string_view candidate(entry);
+        if (rest.substr(0, candidate.size()) == candidate) {
+            return candidate.size();
+        }
+    }
+    return 0;
+}
+
+std::string trim(std::string_view text) {
+    const char* SPACES = " \t\r\n";
+    std::size_t begin = text.find_first_not_of(SPACES);
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    std::size_t end = text.find_last_not_of(SPACES);
+    return std::string(text.substr(begin, end - begin + 1));
+}
+
+int64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+void SentenceSegmenter::append(std::string_view text, std::vector<std::string>& sentences) {
+    buffer_.append(text);
+    held_ = false;
+
+    std::size_t pos = scanned_;
+    while (pos < buffer_.size()) {
+        unsigned char byte = static_cast<unsigned char>(buffer_[pos]);
+        if (is_candidate_lead(byte) && pos + 3 > buffer_.size()) {
+            // A 3-byte character split across messages; check it once the rest arrives
+            break;
+        }
+
+        std::size_t length = match_any(buffer_, pos, TERMINATORS);
+        if (length == 0) {
+            pos++;
+            continue;
+        }
+
+        // Absorb trailing terminators and closers ("...", "?!", "。」")
+        std::size_t end = pos + length;
+        bool complete = false;
+        while (end < buffer_.size()) {
+            if (is_candidate_lead(static_cast<unsigned char>(buffer_[end])) && end + 3 > buffer_.size()) {
+                break;
+            }
+            std::size_t extra = match_any(buffer_, end, TERMINATORS);
+            if (extra == 0) {
+                extra = match_any(buffer_, end, CLOSERS);
+            }
+            if (extra == 0) {
+                complete = true;
+                break;
+            }
+            end += extra;
+        }
+        if (!complete) {
+            // A closer may still follow in the next message; rescan from the terminator then
+            held_ = true;
+            break;
+        }
+
+        std::string sentence = trim(std::string_view(buffer_).substr(0, end));
+        if (!sentence.empty()) {
+            sentences.push_back(std::move(sentence));
+        }
+        buffer_.erase(0, end);
+        pos = 0;
+    }
+    scanned_ = pos;
+}
+
+void SentenceSegmenter::release(std::vector<std::string>& sentences) {
+    if (!held_) {
+        return;
+    }
+    std::string sentence = flush();
+    if (!sentence.empty()) {
+        sentences.push_back(std::move(sentence));
+    }
+}
+
+std::string SentenceSegmenter::flush() {
+    std::string rest = trim(buffer_);
+    buffer_.clear();
+    scanned_ = 0;
+    held_ = false;
+    return rest;
+}
+
+void ConsoleTranscriptOutput::write(const TranscriptEntry& entry) {
+    if (entry.speaker == TranscriptEntry::Speaker::User) {
+        out_ << "\n You: " << entry.text << "\n\n";
+    } else {
+        out_ << " AI: " << entry.text << '\n';
+    }
+}
+
+void ConsoleTranscriptOutput::flush() {
+    out_.flush();
+}
+
+bool JsonlTranscriptOutput::open(const std::string& path) {
+    out_.open(path, std::ios::trunc);
+    if (!out_.is_open()) {
+        std::cerr << "Transcript: cannot create " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void JsonlTranscriptOutput::write(const TranscriptEntry& entry) {
+    nlohmann::json line = {
+        {"timestamp_ms", entry.timestamp_ms},
+        {"turn", entry.turn},
+        {"speaker", entry.speaker == TranscriptEntry::Speaker::User ? "user" : "model"},
+        {"text", entry.text}
+    };
+    // Invalid UTF-8 from the server is replaced rather than aborting the writer
+    batch_ += line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    batch_ += '\n';
+}
+
+void JsonlTranscriptOutput::flush() {
+    if (batch_.empty()) {
+        return;
+    }
+    out_.write(batch_.data(), static_cast<std::streamsize>(batch_.size()));
+    out_.flush();
+    batch_.clear();
+}
+
+TranscriptSink::TranscriptSink(std::size_t queue_capacity) : queue_(queue_capacity) {
+}
+
+TranscriptSink::~TranscriptSink() {
+    stop();
+}
+
+void TranscriptSink::add_output(std::unique_ptr<TranscriptOutput> output) {
+    outputs_.push_back(std::move(output));
+}
+
+void TranscriptSink::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    writer_ = std::thread([this]() { run(); });
+}
+
+void TranscriptSink::stop() {
+    if (!running_.load(std::memory_order_acquire)) {
+        return;
+    }
+    // Sentences still waiting for their terminator are written as they are
+    flush_pending();
+    running_.store(false, std::memory_order_release);
+    published_.fetch_add(1, std::memory_order_release);
+    published_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+void TranscriptSink::append(TranscriptEntry::Speaker speaker, std::string_view text) {
+    bool user = speaker == TranscriptEntry::Speaker::User;
+    SentenceSegmenter& segmenter = user ? user_segmenter_ : model_segmenter_;
+    SentenceSegmenter& other = user ? model_segmenter_ : user_segmenter_;
+
+    // The other side has moved on, so its finished sentence will not get a closer
+    sentences_.clear();
+    other.release(sentences_);
+    for (std::string& sentence : sentences_) {
+        publish(user ? TranscriptEntry::Speaker::Model : TranscriptEntry::Speaker::User, std::move(sentence));
+    }
+
+    sentences_.clear();
+    segmenter.append(text, sentences_);
+    for (std::string& sentence : sentences_) {
+        publish(speaker, std::move(sentence));
+    }
+}
+
+void TranscriptSink::end_turn() {
+    flush_pending();
+    turn_++;
+}
+
+void TranscriptSink::flush_pending() {
+    std::string user_rest = user_segmenter_.flush();
+    if (!user_rest.empty()) {
+        publish(TranscriptEntry::Speaker::User, std::move(user_rest));
+    }
+    std::string model_rest = model_segmenter_.flush();
+    if (!model_rest.empty()) {
+        publish(TranscriptEntry::Speaker::Model, std::move(model_rest));
+    }
+}
+
+void TranscriptSink::publish(TranscriptEntry::Speaker speaker, std::string text) {
+    TranscriptEntry entry;
+    entry.speaker = speaker;
+    entry.turn = turn_;
+    entry.timestamp_ms = now_ms();
+    entry.text = std::move(text);
+    if (!queue_.try_push(std::move(entry))) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    published_.fetch_add(1, std::memory_order_release);
+    published_.notify_one();
+}
+
+void TranscriptSink::drain() {
+    TranscriptEntry entry;
+    bool wrote = false;
+    while (queue_.try_pop(entry)) {
+        for (auto& output : outputs_) {
+            output->write(entry);
+        }
+        wrote = true;
+    }
+    if (wrote) {
+        for (auto& output : outputs_) {
+            output->flush();
+        }
+    }
+}
+
+void TranscriptSink::run() {
+    trace_recorder().set_thread_name("transcript");
+    thread_placement().apply("transcript");
+    while (true) {
+        uint32_t seen = published_.load(std::memory_order_acquire);
+        drain();
+        if (!running_.load(std::memory_order_acquire)) {
+            drain();
+            break;
+        }
+        published_.wait(seen, std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,120 @@
+#include "wav_file.h"
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+uint32_t read_u32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t read_u16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+void put_u32(uint8_t* p, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+void put_u16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+bool read_exact(int fd, uint8_t* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t n = ::read(fd, data, size);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+}  // namespace
+
+bool read_wav_header(int fd, WavInfo& info, std::string& error) {
+    uint8_t riff[12];
+    if (!read_exact(fd, riff, sizeof(riff)) || std::memcmp(riff, "RIFF", 4) != 0 ||
+        std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        error = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    info = WavInfo();
+    bool have_format = false;
+    uint64_t offset = sizeof(riff);
+    while (true) {
+        uint8_t chunk[8];
+        if (!read_exact(fd, chunk, sizeof(chunk))) {
+            error = "no data chunk";
+            return false;
+        }
+        offset += sizeof(chunk);
+        uint32_t size = read_u32(chunk + 4);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t format[16];
+            if (size < sizeof(format) || !read_exact(fd, format, sizeof(format))) {
+                error = "truncated fmt chunk";
+                return false;
+            }
+            uint16_t tag = read_u16(format);
+            info.channels = read_u16(format + 2);
+            info.sample_rate = static_cast<int>(read_u32(format + 4));
+            info.bits_per_sample = read_u16(format + 14);
+            // WAVE_FORMAT_EXTENSIBLE carries the same PCM layout for mono 16-bit
+            if ((tag != 1 && tag != 0xFFFE) || info.bits_per_sample != 16 || info.channels != 1) {
+                error = "only 16-bit mono PCM is supported";
+                return false;
+            }
+            have_format = true;
+            offset += sizeof(format);
+            size -= sizeof(format);
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (!have_format) {
+                error = "data chunk before fmt chunk";
+                return false;
+            }
+            info.data_offset = offset;
+            info.data_bytes = size;
+            // Streamed writers leave the size at 0 or 0xFFFFFFFF; read to the end of the file then
+            off_t end = ::lseek(fd, 0, SEEK_END);
+            if (end >= 0 && (size == 0 || size == 0xFFFFFFFF || offset + size > static_cast<uint64_t>(end))) {
+                info.data_bytes = static_cast<uint64_t>(end) - offset;
+            }
+            return ::lseek(fd, static_cast<off_t>(offset), SEEK_SET) >= 0;
+        }
+
+        // Skip the rest of the chunk (chunks are padded to an even size)
+        uint64_t skip = size + (size & 1);
+        if (::lseek(fd, static_cast<off_t>(skip), SEEK_CUR) < 0) {
+            error = "truncated chunk";
+            return false;
+        }
+        offset += skip;
+    }
+}
+
+bool write_wav_header(int fd, int sample_rate, uint64_t data_bytes) {
+    uint32_t size = static_cast<uint32_t>(std::min<uint64_t>(data_bytes, 0xFFFFFFFFu - 36));
+    uint8_t header[WAV_HEADER_SIZE];
+    std::memcpy(header, "RIFF", 4);
+    put_u32(header + 4, 36 + size);
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    put_u32(header + 16, 16);
+    put_u16(header + 20, 1);                                       // PCM
+    put_u16(header + 22, 1);                                       // Mono
+    put_u32(header + 24, static_cast<uint32_t>(sample_rate));
+    put_u32(header + 28, static_cast<uint32_t>(sample_rate) * 2);  // Byte rate
+    put_u16(header + 32, 2);                                       // Block align
+    put_u16(header + 34, 16);
+    std::memcpy(header + 36, "data", 4);
+    put_u32(header + 40, size);
+    return ::pwrite(fd, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+}
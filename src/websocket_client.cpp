@@ -1,8 +1,39 @@
 #include "websocket_client.h"
+#include "metrics.h"
+#include "trace_recorder.h"
 #include <boost/asio/ssl/error.hpp>
 #include <boost/beast/core/error.hpp>
+#include <algorithm>
 #include <iostream>
 
+namespace {
+
+// Process-wide WebSocket metrics, shared by every client
+struct WebSocketMetrics {
+    Counter& connects = metrics().counter("gemini_ws_connects_total", "Successful WebSocket connections");
+    Counter& connect_failures = metrics().counter("gemini_ws_connect_failures_total", "Failed WebSocket connection attempts");
+    Counter& messages_sent = metrics().counter("gemini_ws_messages_sent_total", "WebSocket messages written");
+    Counter& bytes_sent = metrics().counter("gemini_ws_bytes_sent_total", "WebSocket payload bytes written");
+    Counter& messages_received = metrics().counter("gemini_ws_messages_received_total", "WebSocket messages read");
+    Counter& bytes_received = metrics().counter("gemini_ws_bytes_received_total", "WebSocket payload bytes read");
+    Counter& errors = metrics().counter("gemini_ws_errors_total", "WebSocket read, write and ping errors");
+    Counter& keepalive_timeouts = metrics().counter("gemini_ws_keepalive_timeouts_total", "Connections dropped after missed pongs");
+    Gauge& write_queue_depth = metrics().gauge("gemini_ws_write_queue_depth", "Messages queued for writing across all clients");
+    Histogram& rtt_us = metrics().histogram("gemini_ws_rtt_seconds", "Ping/pong round-trip time",
+        {1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000}, 1e-6);
+};
+
+WebSocketMetrics& ws_metrics() {
+    static WebSocketMetrics instance;
+    return instance;
+}
+
+// Bounds the opening and closing WebSocket handshakes; a peer that never answers a close frame
+// would otherwise keep a released client (and its socket) alive
+constexpr auto HANDSHAKE_TIMEOUT = std::chrono::seconds(10);
+
+}  // namespace
+
 // Helper function to load root certificates
 void load_root_certificates(ssl::context& ctx) {
     // Use system default certificate store
@@ -10,20 +41,23 @@ void load_root_certificates(ssl::context& ctx) {
 }
 
 WebSocketClient::WebSocketClient(net::io_context& io_context, const std::string& api_key)
+    : WebSocketClient(io_context, gemini_endpoint(api_key)) {
+}
+
+WebSocketClient::WebSocketClient(net::io_context& io_context, const Endpoint& endpoint)
     : io_context_(io_context)
+    , strand_(net::make_strand(io_context))
     , ssl_ctx_(ssl::context::tlsv12_client)
-    , resolver_(io_context)
-    , api_key_(api_key)
-    , host_("generativelanguage.googleapis.com")
-    , port_("443")
-    , connected_(false) {
+    , resolver_(strand_)
+    , endpoint_(endpoint)
+    , connected_(false)
+    , ping_timer_(strand_)
+    , ping_interval_(std::chrono::seconds(5))
+    , max_missed_pongs_(3) {
     
     // SSL certificate verification settings
     load_root_certificates(ssl_ctx_);
     ssl_ctx_.set_verify_mode(ssl::verify_peer);
-    
-    // WebSocket target path (add API key as query parameter)
-    target_ = "/ws/google.ai.generativelanguage.v1beta.GenerativeService.BidiGenerateContent?key=" + api_key_;
 }
 
 WebSocketClient::~WebSocketClient() {
@@ -32,52 +66,158 @@ WebSocketClient::~WebSocketClient() {
     }
 }
 
+WebSocketClient::Endpoint WebSocketClient::gemini_endpoint(const std::string& api_key) {
+    Endpoint endpoint;
+    // WebSocket target path (add API key as query parameter)
+    endpoint.target = "/ws/google.ai.generativelanguage.v1beta.GenerativeService.BidiGenerateContent?key=" + api_key;
+    return endpoint;
+}
+
+bool WebSocketClient::parse_url(const std::string& url, Endpoint& endpoint) {
+    Endpoint parsed;
+    std::string rest;
+    if (url.rfind("wss://", 0) == 0) {
+        parsed.use_tls = true;
+        parsed.port = "443";
+        rest = url.substr(6);
+    } else if (url.rfind("ws://", 0) == 0) {
+        parsed.use_tls = false;
+        parsed.port = "80";
+        rest = url.substr(5);
+    } else {
+        return false;
+    }
+    
+    std::size_t slash = rest.find('/');
+    std::string authority = rest.substr(0, slash);
+    parsed.target = slash == std::string::npos ? "/" : rest.substr(slash);
+    
+    std::size_t colon = authority.rfind(':');
+    if (colon != std::string::npos) {
+        parsed.port = authority.substr(colon + 1);
+        authority = authority.substr(0, colon);
+    }
+    if (authority.empty() || parsed.port.empty()) {
+        return false;
+    }
+    parsed.host = authority;
+    
+    endpoint = parsed;
+    return true;
+}
+
 void WebSocketClient::set_message_callback(MessageCallback callback) {
     message_callback_ = std::move(callback);
 }
 
+void WebSocketClient::set_message_view_callback(MessageViewCallback callback) {
+    message_view_callback_ = std::move(callback);
+}
+
+void WebSocketClient::set_max_message_size(std::size_t max_bytes) {
+    max_message_size_ = max_bytes;
+}
+
 void WebSocketClient::set_error_callback(ErrorCallback callback) {
     error_callback_ = std::move(callback);
 }
 
+void WebSocketClient::set_close_callback(CloseCallback callback) {
+    close_callback_ = std::move(callback);
+}
+
+void WebSocketClient::set_connect_callback(ConnectCallback callback) {
+    connect_callback_ = std::move(callback);
+}
+
+void WebSocketClient::set_keepalive(std::chrono::milliseconds interval, int max_missed_pongs) {
+    ping_interval_ = interval;
+    max_missed_pongs_ = std::max(1, max_missed_pongs);
+}
+
+template <class Stream>
+void WebSocketClient::configure_stream(Stream& ws) {
+    // Set decorator to add User-Agent
+    ws.set_option(websocket::stream_base::decorator(
+        [](websocket::request_type& req) {
+            req.set(http::field::user_agent, "Gemini-CPP-Client/1.0");
+        }));
+    
+    websocket::stream_base::timeout timeout = websocket::stream_base::timeout::suggested(beast::role_type::client);
+    timeout.handshake_timeout = HANDSHAKE_TIMEOUT;
+    ws.set_option(timeout);
+    
+    if (max_message_size_ > 0) {
+        ws.read_message_max(max_message_size_);
+        buffer_.max_size(max_message_size_);
+    }
+    
+    // Pong frames are delivered here while async_read is pending
+    ws.control_callback(
+        [this](websocket::frame_type kind, beast::string_view payload) {
+            if (kind == websocket::frame_type::pong) {
+                on_pong(payload);
+            }
+        });
+}
+
 bool WebSocketClient::connect() {
     try {
         // Resolve host name
-        boost::asio::ip::tcp::resolver::results_type const results = resolver_.resolve(host_, port_);
-        
-        // Create WebSocket stream
-        ws_ = std::make_unique<websocket::stream<beast::ssl_stream<tcp::socket>>>(
-            io_context_, ssl_ctx_);
+        tcp::resolver::results_type const results = resolver_.resolve(endpoint_.host, endpoint_.port);
         
-        // TCP Connect
-        net::connect(beast::get_lowest_layer(*ws_), results);
-        
-        // Set SNI (Server Name Indication)
-        if (!SSL_set_tlsext_host_name(ws_->next_layer().native_handle(), host_.c_str())) {
-            beast::error_code ec{static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()};
-            throw beast::system_error{ec};
+        if (endpoint_.use_tls) {
+            // Create WebSocket stream
+            tls_ws_ = std::make_unique<TlsStream>(strand_, ssl_ctx_);
+            plain_ws_.reset();
+            
+            // TCP Connect
+            beast::get_lowest_layer(*tls_ws_).connect(results);
+            
+            // Set SNI (Server Name Indication)
+            beast::error_code ec;
+            if (!set_server_name(ec)) {
+                throw beast::system_error{ec};
+            }
+            
+            // SSL Handshake
+            tls_ws_->next_layer().handshake(ssl::stream_base::client);
+        } else {
+            plain_ws_ = std::make_unique<PlainStream>(strand_);
+            tls_ws_.reset();
+            
+            // TCP Connect
+            beast::get_lowest_layer(*plain_ws_).connect(results);
         }
         
-        // SSL Handshake
-        ws_->next_layer().handshake(ssl::stream_base::client);
-        
-        // Set decorator to add User-Agent
-        ws_->set_option(websocket::stream_base::decorator(
-            [](websocket::request_type& req) {
-                req.set(http::field::user_agent, "Gemini-CPP-Client/1.0");
-            }));
-        
         // WebSocket Handshake
-        ws_->handshake(host_, target_);
+        with_stream([this](auto& ws) {
+            beast::get_lowest_layer(ws).socket().set_option(tcp::no_delay(true));
+            configure_stream(ws);
+            ws.handshake(endpoint_.host, endpoint_.target);
+        });
+        
+        {
+            std::lock_guard<std::mutex> lock(rtt_mutex_);
+            rtt_stats_ = RttStats{};
+            rtt_histogram_us_.reset();
+        }
         
         connected_ = true;
+        ws_metrics().connects.inc();
         
-        // std::cout << "WebSocket Connected: " << host_ << std::endl;
+        // std::cout << "WebSocket Connected: " << endpoint_.host << std::endl;
         
-        return true;
+        net::dispatch(strand_, tracked([this]() {
+            ping_outstanding_ = false;
+            schedule_ping();
+        }));
         
+        return true;
+    
     } catch (std::exception const& e) {
         std::cerr << "Connection Error: " << e.what() << std::endl;
+        ws_metrics().connect_failures.inc();
         if (error_callback_) {
             error_callback_(std::string("Connection Error: ") + e.what());
         }
@@ -86,74 +226,491 @@ bool WebSocketClient::connect() {
     }
 }
 
+void WebSocketClient::async_connect(ConnectCallback callback) {
+    connecting_ = true;
+    net::dispatch(strand_, tracked([this, callback = std::move(callback)]() mutable {
+        connect_callback_ = std::move(callback);
+        if (endpoint_.use_tls) {
+            tls_ws_ = std::make_unique<TlsStream>(strand_, ssl_ctx_);
+            plain_ws_.reset();
+        } else {
+            plain_ws_ = std::make_unique<PlainStream>(strand_);
+            tls_ws_.reset();
+        }
+        resolver_.async_resolve(endpoint_.host, endpoint_.port,
+            tracked([this](beast::error_code ec, tcp::resolver::results_type results) {
+                on_resolve(ec, results);
+            }));
+    }));
+}
+
+bool WebSocketClient::set_server_name(beast::error_code& ec) {
+    if (!SSL_set_tlsext_host_name(tls_ws_->next_layer().native_handle(), endpoint_.host.c_str())) {
+        ec = beast::error_code(static_cast<int>(::ERR_get_error()), net::error::get_ssl_category());
+        return false;
+    }
+    return true;
+}
+
+void WebSocketClient::on_resolve(beast::error_code ec, const tcp::resolver::results_type& results) {
+    if (ec || !connecting_) {
+        finish_connect(ec ? ec : net::error::operation_aborted, "resolve");
+        return;
+    }
+    with_stream([this, &results](auto& ws) {
+        beast::get_lowest_layer(ws).async_connect(results,
+            tracked([this](beast::error_code ec, const tcp::endpoint&) {
+                on_tcp_connect(ec);
+            }));
+    });
+}
+
+void WebSocketClient::on_tcp_connect(beast::error_code ec) {
+    if (ec || !connecting_) {
+        finish_connect(ec ? ec : net::error::operation_aborted, "connect");
+        return;
+    }
+    if (!tls_ws_) {
+        start_ws_handshake();
+        return;
+    }
+    if (!set_server_name(ec)) {
+        finish_connect(ec, "SNI");
+        return;
+    }
+    tls_ws_->next_layer().async_handshake(ssl::stream_base::client,
+        tracked([this](beast::error_code ec) {
+            if (ec || !connecting_) {
+                finish_connect(ec ? ec : net::error::operation_aborted, "TLS handshake");
+                return;
+            }
+            start_ws_handshake();
+        }));
+}
+
+void WebSocketClient::start_ws_handshake() {
+    with_stream([this](auto& ws) {
+        beast::get_lowest_layer(ws).socket().set_option(tcp::no_delay(true));
+        configure_stream(ws);
+        ws.async_handshake(endpoint_.host, endpoint_.target,
+            tracked([this](beast::error_code ec) {
+                if (!ec && !connecting_) {
+                    ec = net::error::operation_aborted;
+                }
+                finish_connect(ec, "WebSocket handshake");
+            }));
+    });
+}
+
+void WebSocketClient::finish_connect(beast::error_code ec, const char* step) {
+    connecting_ = false;
+    ConnectCallback callback = std::move(connect_callback_);
+    connect_callback_ = nullptr;
+    
+    if (ec) {
+        // Aborted by close(); the caller asked for it, so it is not an error
+        if (ec != net::error::operation_aborted) {
+            std::cerr << "Connection Error: " << step << ": " << ec.message() << std::endl;
+            ws_metrics().connect_failures.inc();
+        }
+        close_socket();
+        // Drop the failed stream once its handshake op has unwound: a live stream keeps
+        // its handshake timer armed and holds io_context::run() open until it fires
+        net::post(strand_, tracked([this]() {
+            if (!connecting_ && !connected_) {
+                tls_ws_.reset();
+                plain_ws_.reset();
+            }
+        }));
+        if (callback) {
+            callback(false);
+        }
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(rtt_mutex_);
+        rtt_stats_ = RttStats{};
+        rtt_histogram_us_.reset();
+    }
+    connected_ = true;
+    ws_metrics().connects.inc();
+    ping_outstanding_ = false;
+    schedule_ping();
+    if (callback) {
+        callback(true);
+    }
+}
+
 void WebSocketClient::send(const std::string& message) {
-    if (!connected_ || !ws_) {
+    send(std::string(message));
+}
+
+void WebSocketClient::send(std::string&& message) {
+    enqueue(std::move(message), false);
+}
+
+void WebSocketClient::send_bulk(std::string&& message) {
+    enqueue(std::move(message), true);
+}
+
+void WebSocketClient::enqueue(std::string&& message, bool bulk) {
+    if (!connected_ || !has_stream()) {
         std::cerr << "Error: WebSocket is not connected" << std::endl;
         return;
     }
     
-    // Execute send in io_context thread (for thread safety)
-    net::post(io_context_, [this, message]() {
-        if (!connected_ || !ws_) return;
+    pending_writes_.fetch_add(1, std::memory_order_relaxed);
+    if (bulk) {
+        pending_bulk_writes_.fetch_add(1, std::memory_order_relaxed);
+    }
+    ws_metrics().write_queue_depth.add(1);
+    
+    // Queue on the strand; only one async_write may be outstanding at a time
+    net::post(strand_, tracked([this, message = std::move(message), bulk]() mutable {
+        if (!connected_) {
+            pending_writes_.fetch_sub(1, std::memory_order_relaxed);
+            if (bulk) {
+                pending_bulk_writes_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            ws_metrics().write_queue_depth.add(-1);
+            return;
+        }
+        (bulk ? bulk_queue_ : write_queue_).push_back(std::move(message));
+        trace_recorder().counter("ws_write_queue", static_cast<int64_t>(write_queue_.size() + bulk_queue_.size()));
+        if (!writing_) {
+            do_write();
+        }
+    }));
+}
+
+void WebSocketClient::do_write() {
+    writing_ = true;
+    // Regular messages (audio, control) always go before queued bulk ones
+    writing_bulk_ = write_queue_.empty();
+    const std::string& message = writing_bulk_ ? bulk_queue_.front() : write_queue_.front();
+    if (recorder_) {
+        recorder_->record(RecordedFrame::Direction::Outbound, message);
+    }
+    with_stream([this, &message](auto& ws) {
+        ws.text(true);
+        ws.async_write(
+            net::buffer(message),
+            tracked([this](beast::error_code ec, std::size_t bytes_transferred) {
+                if (!ec) {
+                    ws_metrics().messages_sent.inc();
+                    ws_metrics().bytes_sent.inc(bytes_transferred);
+                }
+                on_write(ec);
+            }));
+    });
+}
+
+void WebSocketClient::on_write(beast::error_code ec) {
+    if (ec) {
+        std::size_t dropped = write_queue_.size() + bulk_queue_.size();
+        pending_writes_.fetch_sub(dropped, std::memory_order_relaxed);
+        pending_bulk_writes_.fetch_sub(bulk_queue_.size(), std::memory_order_relaxed);
+        ws_metrics().write_queue_depth.add(-static_cast<int64_t>(dropped));
+        write_queue_.clear();
+        bulk_queue_.clear();
+        writing_ = false;
         
-        try {
-            ws_->write(net::buffer(message));
-        } catch (std::exception const& e) {
-            std::cerr << "Send Error: " << e.what() << std::endl;
+        if (connected_) {
+            ws_metrics().errors.inc();
+            std::cerr << "Send Error: " << ec.message() << std::endl;
             if (error_callback_) {
-                error_callback_(std::string("Send Error: ") + e.what());
+                error_callback_(std::string("Send Error: ") + ec.message());
             }
         }
-    });
+        return;
+    }
+    
+    if (writing_bulk_) {
+        bulk_queue_.pop_front();
+        pending_bulk_writes_.fetch_sub(1, std::memory_order_relaxed);
+    } else {
+        write_queue_.pop_front();
+    }
+    pending_writes_.fetch_sub(1, std::memory_order_relaxed);
+    ws_metrics().write_queue_depth.add(-1);
+    
+    if ((!write_queue_.empty() || !bulk_queue_.empty()) && connected_) {
+        do_write();
+    } else {
+        writing_ = false;
+    }
 }
 
 void WebSocketClient::async_receive() {
-    if (!connected_ || !ws_) {
+    if (!connected_ || !has_stream()) {
         return;
     }
     
-    ws_->async_read(
-        buffer_,
-        [this](beast::error_code ec, std::size_t /* bytes_transferred */) {
-            if (ec) {
-                if (ec != websocket::error::closed) {
-                    std::cerr << "Read Error: " << ec.message() << std::endl;
-                    if (error_callback_) {
-                        error_callback_(std::string("Read Error: ") + ec.message());
+    net::dispatch(strand_, tracked([this]() { do_read(); }));
+}
+
+void WebSocketClient::do_read() {
+    with_stream([this](auto& ws) {
+        ws.async_read(
+            buffer_,
+            tracked([this](beast::error_code ec, std::size_t bytes_transferred) {
+                if (ec) {
+                    // Socket was shut down by close() or the keepalive; already reported
+                    if (!connected_ && (ec == net::error::operation_aborted ||
+                                        ec == websocket::error::closed)) {
+                        return;
                     }
+                    connected_ = false;
+                    ping_timer_.cancel();
+                    if (ec != websocket::error::closed) {
+                        ws_metrics().errors.inc();
+                        std::cerr << "Read Error: " << ec.message() << std::endl;
+                        if (error_callback_) {
+                            error_callback_(std::string("Read Error: ") + ec.message());
+                        }
+                    } else if (close_callback_) {
+                        close_callback_();
+                    }
+                    return;
                 }
-                connected_ = false;
-                return;
+                
+                ws_metrics().messages_received.inc();
+                ws_metrics().bytes_received.inc(bytes_transferred);
+                TraceScope trace_scope("ws_read", bytes_transferred);
+                if (recorder_) {
+                    auto data = buffer_.cdata();
+                    recorder_->record(RecordedFrame::Direction::Inbound, std::string_view(
+                        static_cast<const char*>(data.data()), data.size()));
+                }
+                
+                if (message_view_callback_) {
+                    // Hand out a view over the flat buffer; consume() keeps its capacity
+                    auto data = buffer_.cdata();
+                    message_view_callback_(std::string_view(
+                        static_cast<const char*>(data.data()), data.size()));
+                    buffer_.consume(buffer_.size());
+                } else {
+                    // Convert received data to string
+                    std::string message = beast::buffers_to_string(buffer_.data());
+                    buffer_.consume(buffer_.size());
+                    
+                    // Invoke callback
+                    if (message_callback_) {
+                        message_callback_(message);
+                    }
+                }
+                
+                // Async receive next message
+                if (connected_) {
+                    do_read();
+                }
+            }));
+    });
+}
+
+void WebSocketClient::close() {
+    bool on_strand = strand_.running_in_this_thread();
+    std::future<void> finished = begin_close();
+    
+    // Called from a callback: the close handshake finishes on its own
+    if (!on_strand && finished.wait_for(std::chrono::seconds(2)) != std::future_status::ready) {
+        std::cerr << "Close Error: timed out waiting for close handshake" << std::endl;
+    }
+}
+
+std::future<void> WebSocketClient::begin_close() {
+    auto done = std::make_shared<std::promise<void>>();
+    std::future<void> finished = done->get_future();
+    
+    // Abort a handshake in progress; its callback reports the failure. If it completed
+    // in the meantime, close the new connection instead
+    if (connecting_) {
+        net::dispatch(strand_, tracked([this]() {
+            if (connecting_) {
+                connecting_ = false;
+                resolver_.cancel();
+                close_socket();
+            } else {
+                close();
             }
+        }));
+        done->set_value();
+        return finished;
+    }
+    
+    if (!connected_.exchange(false) || !has_stream()) {
+        done->set_value();
+        return finished;
+    }
+    
+    if (strand_.running_in_this_thread()) {
+        start_close(done);
+        return finished;
+    }
+    
+    // Nothing will run the strand any more; tear the socket down directly
+    if (io_context_.stopped()) {
+        close_socket();
+        done->set_value();
+        return finished;
+    }
+    
+    net::post(strand_, tracked([this, done]() { start_close(done); }));
+    return finished;
+}
+
+void WebSocketClient::start_close(std::shared_ptr<std::promise<void>> done) {
+    ping_timer_.cancel();
+    
+    with_stream([this, done](auto& ws) {
+        ws.async_close(
+            websocket::close_code::normal,
+            tracked([done](beast::error_code ec) {
+                if (ec && ec != net::error::operation_aborted) {
+                    std::cerr << "Close Error: " << ec.message() << std::endl;
+                }
+                if (done) {
+                    done->set_value();
+                }
+            }));
+    });
+    
+    // std::cout << "WebSocket connection closed" << std::endl;
+}
+
+void WebSocketClient::close_socket() {
+    ping_timer_.cancel();
+    with_stream([](auto& ws) {
+        beast::error_code ignored;
+        beast::get_lowest_layer(ws).socket().close(ignored);
+    });
+}
+
+void WebSocketClient::release(std::shared_ptr<WebSocketClient> client) {
+    if (!client) {
+        return;
+    }
+    // Posted even from the strand: the caller may be running inside one of the callbacks cleared here
+    WebSocketClient* raw = client.get();
+    net::post(raw->strand_, raw->tracked([raw, client = std::move(client)]() mutable {
+        raw->connect_callback_ = nullptr;
+        raw->message_callback_ = nullptr;
+        raw->message_view_callback_ = nullptr;
+        raw->error_callback_ = nullptr;
+        raw->close_callback_ = nullptr;
+        raw->close();
+        raw->self_ = std::move(client);
+    }));
+}
+
+void WebSocketClient::handler_done() {
+    // The last pending handler of a released client: nothing refers to it any more
+    if (outstanding_.fetch_sub(1, std::memory_order_acq_rel) == 1 && self_) {
+        net::post(io_context_, [self = std::move(self_)]() {});
+    }
+}
+
+bool WebSocketClient::is_connected() const {
+    return connected_;
+}
+
+WebSocketClient::RttStats WebSocketClient::get_rtt_stats() const {
+    std::lock_guard<std::mutex> lock(rtt_mutex_);
+    RttStats stats = rtt_stats_;
+    stats.p99_ms = rtt_histogram_us_.percentile(99.0) / 1000.0;
+    return stats;
+}
+
+void WebSocketClient::schedule_ping() {
+    if (ping_interval_.count() <= 0) {
+        return;
+    }
+    
+    ping_timer_.expires_after(ping_interval_);
+    ping_timer_.async_wait(tracked([this](beast::error_code ec) {
+        on_ping_timer(ec);
+    }));
+}
+
+void WebSocketClient::on_ping_timer(beast::error_code ec) {
+    if (ec || !connected_ || !has_stream()) {
+        return;
+    }
+    
+    // The previous ping was not answered within one interval
+    if (ping_outstanding_) {
+        int missed;
+        {
+            std::lock_guard<std::mutex> lock(rtt_mutex_);
+            missed = ++rtt_stats_.missed_pongs;
+        }
+        
+        if (missed >= max_missed_pongs_) {
+            std::string error = "Keepalive timeout: " + std::to_string(missed) + " pongs missed";
+            std::cerr << error << std::endl;
+            ws_metrics().keepalive_timeouts.inc();
+            connected_ = false;
             
-            // Convert received data to string
-            std::string message = beast::buffers_to_string(buffer_.data());
-            buffer_.consume(buffer_.size());
+            // Abort the pending read; the peer is not going to answer a close frame
+            close_socket();
             
-            // Invoke callback
-            if (message_callback_) {
-                message_callback_(message);
+            if (error_callback_) {
+                error_callback_(error);
             }
-            
-            // Async receive next message
-            async_receive();
+            return;
+        }
+    }
+    
+    // A ping may overlap the pending read and write, but not another ping
+    if (!ping_in_flight_) {
+        ping_in_flight_ = true;
+        ping_outstanding_ = true;
+        ping_sent_at_ = std::chrono::steady_clock::now();
+        
+        std::string payload = std::to_string(++ping_sequence_);
+        with_stream([this, &payload](auto& ws) {
+            ws.async_ping(
+                websocket::ping_data(payload.c_str()),
+                tracked([this](beast::error_code ec) {
+                    ping_in_flight_ = false;
+                    if (ec && connected_) {
+                        ws_metrics().errors.inc();
+                        std::cerr << "Ping Error: " << ec.message() << std::endl;
+                        if (error_callback_) {
+                            error_callback_(std::string("Ping Error: ") + ec.message());
+                        }
+                    }
+                }));
         });
+    }
+    
+    schedule_ping();
 }
 
-void WebSocketClient::close() {
-    if (!connected_ || !ws_) {
+void WebSocketClient::on_pong(beast::string_view payload) {
+    // Ignore unsolicited or stale pongs
+    if (!ping_outstanding_ || payload != std::to_string(ping_sequence_)) {
         return;
     }
+    ping_outstanding_ = false;
     
-    try {
-        ws_->close(websocket::close_code::normal);
-        connected_ = false;
-        // std::cout << "WebSocket connection closed" << std::endl;
-    } catch (std::exception const& e) {
-        std::cerr << "Close Error: " << e.what() << std::endl;
+    auto rtt = std::chrono::steady_clock::now() - ping_sent_at_;
+    uint64_t rtt_us = std::chrono::duration_cast<std::chrono::microseconds>(rtt).count();
+    double rtt_ms = rtt_us / 1000.0;
+    
+    ws_metrics().rtt_us.record(rtt_us);
+    
+    std::lock_guard<std::mutex> lock(rtt_mutex_);
+    rtt_histogram_us_.record(rtt_us);
+    if (rtt_stats_.samples == 0) {
+        rtt_stats_.min_ms = rtt_ms;
+        rtt_stats_.smoothed_ms = rtt_ms;
+    } else {
+        rtt_stats_.min_ms = std::min(rtt_stats_.min_ms, rtt_ms);
+        rtt_stats_.smoothed_ms += (rtt_ms - rtt_stats_.smoothed_ms) / 8.0;
     }
-}
-
-bool WebSocketClient::is_connected() const {
-    return connected_;
+    rtt_stats_.last_ms = rtt_ms;
+    rtt_stats_.samples++;
+    rtt_stats_.missed_pongs = 0;
 }
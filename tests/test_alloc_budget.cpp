@@ -0,0 +1,202 @@
+#include "alloc_tracker.h"
+#include "audio_buffer.h"
+#include "audio_block_pool.h"
+#include "spsc_queue.h"
+#include "json_arena.h"
+#include "message_handler.h"
+#include "session_recorder.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+using json = nlohmann::json;
+
+// Allocation budgets per unit of work on the hot paths. Zero is the goal;
+// the message budgets cap today's JSON/base64 cost so regressions fail.
+constexpr uint64_t BUDGET_CAPTURE_PERIOD = 0;       // gain + accumulate per device period
+constexpr uint64_t BUDGET_PLAYBACK_PERIOD = 0;      // playback buffer pop per device period
+constexpr uint64_t BUDGET_AUDIO_PUSH = 0;           // pooled blocks -> playback buffer per received chunk
+constexpr uint64_t BUDGET_UPLINK_MESSAGE = 2;       // create_audio_input_message per 100ms chunk
+constexpr uint64_t BUDGET_DOWNLINK_MESSAGE = 64;    // all parsing done for one received message (parser internals)
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+std::vector<int16_t> make_tone(std::size_t samples, int sample_rate) {
+    std::vector<int16_t> audio(samples);
+    for (std::size_t i = 0; i < samples; i++) {
+        audio[i] = static_cast<int16_t>(3000.0 * std::sin(2.0 * M_PI * 440.0 * i / sample_rate));
+    }
+    return audio;
+}
+
+// A recorded turn shaped like Live API traffic: audio chunks with interleaved transcription
+bool write_recording(const std::string& path) {
+    SessionRecorder recorder;
+    if (!recorder.open(path)) {
+        return false;
+    }
+    using Direction = RecordedFrame::Direction;
+    recorder.record(Direction::Inbound, R"({"setupComplete":{}})");
+    std::vector<int16_t> chunk = make_tone(960, 24000);   // 40 ms at 24 kHz
+    std::string encoded = MessageHandler::base64_encode(MessageHandler::int16_to_uint8(chunk));
+    for (int turn = 0; turn < 2; turn++) {
+        recorder.record(Direction::Inbound,
+            R"({"serverContent":{"inputTranscription":{"text":"What is the weather?"}}})");
+        for (int i = 0; i < 50; i++) {
+            json message = {{"serverContent", {{"modelTurn", {{"parts", {{
+                {"inlineData", {{"mimeType", "audio/pcm;rate=24000"}, {"data", encoded}}}
+            }}}}}}}};
+            recorder.record(Direction::Inbound, message.dump());
+            if (i % 10 == 0) {
+                recorder.record(Direction::Inbound,
+                    R"({"serverContent":{"outputTranscription":{"text":"It is sunny today. "}}})");
+            }
+        }
+        recorder.record(Direction::Inbound, R"({"serverContent":{"turnComplete":true}})");
+    }
+    recorder.close();
+    return true;
+}
+
+int main() {
+    std::cout << "=== Allocation Budget Test ===" << std::endl;
+    bool ok = true;
+
+    if (!AllocTracker::installed()) {
+        std::cerr << "Allocation hooks are not linked" << std::endl;
+        return 1;
+    }
+    {
+        AllocScope scope;
+        void* volatile p = ::operator new(16);   // volatile: keep the pair from being elided
+        ::operator delete(p);
+        AllocCounts counts = scope.counts();
+        ok &= expect(counts.allocations == 1 && counts.deallocations == 1, "hooks count new/delete");
+    }
+
+    // --- Uplink: capture periods (10 ms at 16 kHz) accumulated into 100 ms messages ---
+    const std::size_t CAPTURE_PERIOD = 160;
+    const std::size_t CHUNK_SIZE = 1600;
+    std::vector<int16_t> captured = make_tone(CAPTURE_PERIOD, 16000);
+    std::vector<int16_t> accumulated;
+    accumulated.reserve(CHUNK_SIZE);
+    uint64_t worst_capture = 0;
+    uint64_t worst_uplink = 0;
+    for (int period = 0; period < 200; period++) {
+        AllocScope capture_scope;
+        apply_gain(captured, 5, accumulated);
+        worst_capture = std::max(worst_capture, capture_scope.allocations());
+
+        if (accumulated.size() >= CHUNK_SIZE) {
+            AllocScope uplink_scope;
+            std::string message = MessageHandler::create_audio_input_message(accumulated);
+            worst_uplink = std::max(worst_uplink, uplink_scope.allocations());
+            accumulated.clear();
+        }
+    }
+    std::cout << "  capture period: " << worst_capture << " allocs, uplink message: " << worst_uplink << " allocs"
+              << std::endl;
+    ok &= expect(worst_capture <= BUDGET_CAPTURE_PERIOD, "capture period within budget");
+    ok &= expect(worst_uplink <= BUDGET_UPLINK_MESSAGE, "uplink message within budget");
+
+    // --- Downlink: replay a recorded session through parse -> playback buffer -> device periods ---
+    const std::string path = (std::filesystem::temp_directory_path() /
+                              ("gemini_alloc_test_" + std::to_string(::getpid()) + ".rec")).string();
+    SessionReplayer replayer;
+    if (!write_recording(path) || !replayer.load(path)) {
+        return 1;
+    }
+    std::remove(path.c_str());
+
+    const std::size_t PLAYBACK_PERIOD = 240;   // 10 ms at 24 kHz
+    PlaybackBuffer playback;
+    AudioBlockPool pool(2048, 32);
+    SpscQueue<AudioBlock> blocks(32);
+    std::vector<int16_t> device(PLAYBACK_PERIOD);
+    std::vector<int16_t> audio;
+    std::string transcription;
+    uint64_t worst_message = 0, worst_push = 0, worst_period = 0;
+    std::size_t messages = 0;
+
+    auto on_message = [&](std::string_view message) {
+        AllocScope message_scope;
+        bool has_text = MessageHandler::extract_transcription_from_response(message, transcription);
+        if (has_text) {
+            MessageHandler::is_user_input_transcription(message);
+        }
+        bool has_audio = MessageHandler::extract_audio_from_response(message, audio);
+        MessageHandler::is_turn_complete(message);
+        worst_message = std::max(worst_message, message_scope.allocations());
+        messages++;
+
+        if (has_audio) {
+            // Same hand-off as the application: decoded audio crosses to playback in pool blocks
+            AllocScope push_scope;
+            for (std::size_t offset = 0; offset < audio.size(); offset += pool.block_samples()) {
+                AudioBlock block = pool.acquire();
+                block.assign(audio.data() + offset, audio.size() - offset);
+                blocks.try_push(std::move(block));
+            }
+            AudioBlock block;
+            while (blocks.try_pop(block)) {
+                playback.push(block.data(), block.size());
+                block.reset();
+            }
+            worst_push = std::max(worst_push, push_scope.allocations());
+
+            // The device drains what arrived
+            while (playback.size() >= PLAYBACK_PERIOD) {
+                AllocScope period_scope;
+                playback.pop(device.data(), device.size());
+                worst_period = std::max(worst_period, period_scope.allocations());
+            }
+        }
+    };
+
+    // First pass grows buffers to their working size; the second is steady state
+    replayer.replay(0, on_message);
+    worst_message = worst_push = worst_period = 0;
+    messages = 0;
+    replayer.replay(0, on_message);
+
+    std::cout << "  downlink message: " << worst_message << " allocs, playback push: " << worst_push
+              << ", playback period: " << worst_period << " (" << messages << " messages)" << std::endl;
+    ok &= expect(messages == replayer.frames().size(), "replayed every message");
+    ok &= expect(worst_message <= BUDGET_DOWNLINK_MESSAGE, "downlink message within budget");
+    ok &= expect(worst_push <= BUDGET_AUDIO_PUSH, "playback push allocation-free in steady state");
+    ok &= expect(pool.available() == 32 && pool.get_stats().exhausted == 0, "every audio block returned to the pool");
+    ok &= expect(worst_period <= BUDGET_PLAYBACK_PERIOD, "playback period allocation-free");
+
+    // --- Arena: a message larger than the buffer overflows once, then the buffer has grown to fit it ---
+    JsonArena& arena = JsonArena::thread_arena();
+    const std::string large = R"({"serverContent":{"modelTurn":{"parts":[{"inlineData":{"mimeType":"audio/pcm;rate=24000","data":")" +
+                              MessageHandler::base64_encode(MessageHandler::int16_to_uint8(make_tone(96000, 24000))) +
+                              R"("}}]}}})";
+    const std::size_t initial_capacity = arena.capacity();
+    const uint64_t initial_overflows = arena.overflows();
+    uint64_t first_parse = 0, second_parse = 0;
+    {
+        AllocScope scope;
+        MessageHandler::is_turn_complete(large);
+        first_parse = scope.allocations();
+    }
+    const uint64_t grown_overflows = arena.overflows();
+    {
+        AllocScope scope;
+        MessageHandler::is_turn_complete(large);
+        second_parse = scope.allocations();
+    }
+    std::cout << "  large message: " << first_parse << " allocs, then " << second_parse << " (arena "
+              << initial_capacity << " -> " << arena.capacity() << " bytes)" << std::endl;
+    ok &= expect(grown_overflows > initial_overflows && arena.capacity() > large.size(), "arena grows after an overflow");
+    ok &= expect(arena.overflows() == grown_overflows && second_parse < first_parse, "grown arena holds the next message");
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+#include "audio_block_pool.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+int main() {
+    std::cout << "=== Audio Block Pool Test ===" << std::endl;
+    bool ok = true;
+
+    // --- Basic lending: every block once, aligned, then exhaustion ---
+    {
+        AudioBlockPool pool(1000, 4);
+        std::vector<AudioBlock> blocks;
+        std::set<const int16_t*> distinct;
+        bool aligned = true;
+        for (int i = 0; i < 4; i++) {
+            AudioBlock block = pool.acquire();
+            if (!block) {
+                break;
+            }
+            aligned &= reinterpret_cast<uintptr_t>(block.data()) % 64 == 0;
+            distinct.insert(block.data());
+            blocks.push_back(std::move(block));
+        }
+        ok &= expect(blocks.size() == 4 && distinct.size() == 4, "four distinct blocks lent");
+        ok &= expect(aligned, "samples start on a cache line");
+        ok &= expect(blocks[0].capacity() == 1000 && blocks[0].size() == 0, "fresh block is empty with fixed capacity");
+
+        AudioBlock none = pool.acquire();
+        AudioBlockPool::Stats stats = pool.get_stats();
+        ok &= expect(!none && stats.available == 0 && stats.exhausted == 1, "exhausted pool returns an empty block and counts it");
+
+        blocks.pop_back();
+        ok &= expect(pool.available() == 1 && pool.acquire(), "released block is lent again");
+    }
+
+    // --- Copies share the block; the last reference returns it ---
+    {
+        AudioBlockPool pool(256, 1);
+        std::vector<int16_t> samples(300, 7);
+        AudioBlock block = pool.acquire();
+        std::size_t copied = block.assign(samples.data(), samples.size());
+        ok &= expect(copied == 256 && block.size() == 256, "assign stops at capacity");
+
+        AudioBlock shared = block;
+        ok &= expect(shared.use_count() == 2 && shared.data() == block.data(), "copy shares the block");
+        block.reset();
+        ok &= expect(pool.available() == 0 && shared.data()[255] == 7, "block held while a reference remains");
+        AudioBlock moved = std::move(shared);
+        ok &= expect(!shared && moved.use_count() == 1, "move transfers the reference");
+        moved = AudioBlock();
+        ok &= expect(pool.available() == 1, "last reference returns the block");
+    }
+
+    // --- Producer -> SPSC queue -> consumer, as between the decoder and the playback thread ---
+    {
+        const int CHUNKS = 200000;
+        AudioBlockPool pool(64, 16);
+        SpscQueue<AudioBlock> queue(16);
+        std::atomic<bool> corrupted(false);
+        std::atomic<int> received(0);
+        std::thread consumer([&]() {
+            AudioBlock block;
+            int expected = 0;
+            while (expected < CHUNKS) {
+                if (!queue.try_pop(block)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (block.size() != 64 || block.data()[0] != static_cast<int16_t>(expected) ||
+                    block.data()[63] != static_cast<int16_t>(expected)) {
+                    corrupted = true;
+                }
+                block.reset();
+                expected++;
+                received++;
+            }
+        });
+        for (int i = 0; i < CHUNKS; i++) {
+            AudioBlock block;
+            while (!(block = pool.acquire())) {
+                std::this_thread::yield();
+            }
+            std::fill(block.data(), block.data() + 64, static_cast<int16_t>(i));
+            block.resize(64);
+            while (!queue.try_push(std::move(block))) {
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+        ok &= expect(received == CHUNKS && !corrupted, "blocks cross threads intact and in order");
+        ok &= expect(pool.available() == 16, "every block returned after the stream");
+    }
+
+    // --- Several threads acquiring and releasing at once never share a block ---
+    {
+        const int THREADS = 4;
+        const int ROUNDS = 100000;
+        AudioBlockPool pool(32, 8);
+        std::atomic<bool> shared(false);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; t++) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < ROUNDS; i++) {
+                    AudioBlock block = pool.acquire();
+                    if (!block) {
+                        continue;
+                    }
+                    // Stamp the block; another holder would overwrite the stamp
+                    int16_t stamp = static_cast<int16_t>(t * 1000 + i % 1000);
+                    block.data()[0] = stamp;
+                    block.data()[31] = stamp;
+                    if (block.data()[0] != stamp || block.data()[31] != stamp) {
+                        shared = true;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        AudioBlockPool::Stats stats = pool.get_stats();
+        ok &= expect(!shared && stats.available == 8, "concurrent acquire/release keeps blocks exclusive");
+        ok &= expect(stats.acquired + stats.exhausted == static_cast<uint64_t>(THREADS) * ROUNDS,
+                     "every request either lent or counted as exhausted");
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+#include "awaitable_client.h"
+#include "message_handler.h"
+#include "mock_gemini_server.h"
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdlib>
+
+using namespace std::chrono_literals;
+
+std::atomic<int> g_sessions_ok(0);
+
+// One conversation turn written as a straight-line coroutine
+net::awaitable<void> run_session(AwaitableClient& client, int id) {
+    if (!co_await client.connect(5s)) {
+        std::cerr << "Session " << id << ": connect failed: " << client.last_error().message() << std::endl;
+        co_return;
+    }
+
+    std::string setup = MessageHandler::create_setup_message();
+    if (!co_await client.send(setup, 2s)) {
+        std::cerr << "Session " << id << ": setup send failed" << std::endl;
+        co_return;
+    }
+
+    auto reply = co_await client.next_message(2s);
+    if (!reply || !MessageHandler::is_setup_complete(*reply)) {
+        std::cerr << "Session " << id << ": no setupComplete" << std::endl;
+        co_return;
+    }
+
+    // Enough uplink audio to trigger a turn on the mock server
+    std::string chunk = MessageHandler::create_audio_input_message(std::vector<int16_t>(1600, 0));
+    for (int i = 0; i < 3; i++) {
+        if (!co_await client.send(chunk, 2s)) {
+            std::cerr << "Session " << id << ": audio send failed" << std::endl;
+            co_return;
+        }
+    }
+
+    std::size_t audio_samples = 0;
+    std::vector<int16_t> audio;
+    while (auto message = co_await client.next_message(5s)) {
+        if (MessageHandler::extract_audio_from_response(*message, audio)) {
+            audio_samples += audio.size();
+        }
+        if (MessageHandler::is_turn_complete(*message)) {
+            break;
+        }
+    }
+    if (!client.is_connected() || audio_samples == 0) {
+        std::cerr << "Session " << id << ": turn failed: " << client.last_error().message() << std::endl;
+        co_return;
+    }
+
+    co_await client.close();
+    g_sessions_ok++;
+}
+
+// A read with a deadline must fail with a timeout when the server stays silent
+net::awaitable<void> check_timeout(AwaitableClient& client, bool& ok) {
+    if (!co_await client.connect(5s)) {
+        co_return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto message = co_await client.next_message(200ms);
+    auto waited = std::chrono::steady_clock::now() - start;
+    ok = !message && client.last_error() == beast::error::timeout && waited < 2s;
+}
+
+// A deadline that expires while the finished read waits behind other work on the strand
+// must not tear down the connection afterwards
+net::awaitable<void> check_late_deadline(AwaitableClient& client, bool& ok) {
+    if (!co_await client.connect(5s) || !co_await client.send(MessageHandler::create_setup_message(), 2s)) {
+        co_return;
+    }
+    // Runs once the read below is pending: setupComplete arrives, then the deadline expires
+    net::post(client.get_executor(), []() {
+        std::this_thread::sleep_for(300ms);
+    });
+    auto reply = co_await client.next_message(100ms);
+    bool received = reply && MessageHandler::is_setup_complete(*reply);
+    // Let the expired deadline's handler run
+    co_await net::post(client.get_executor(), net::use_awaitable);
+    ok = received && client.is_connected();
+    co_await client.close();
+}
+
+// cancel() from another thread must end a read that has no deadline
+net::awaitable<void> check_cancel(AwaitableClient& client, std::atomic<bool>& waiting, bool& ok) {
+    if (!co_await client.connect(5s)) {
+        co_return;
+    }
+    waiting = true;
+    auto message = co_await client.next_message();
+    ok = !message && client.last_error() == net::error::operation_aborted;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== Awaitable Client Test ===" << std::endl;
+
+    int session_count = argc > 1 ? std::atoi(argv[1]) : 16;
+
+    MockServerOptions server_options;
+    server_options.turn_trigger_chunks = 3;
+    server_options.response_delay = std::chrono::milliseconds(50);
+    server_options.turn_duration = std::chrono::milliseconds(400);
+    server_options.rate = 0.0;
+
+    net::io_context server_io;
+    MockGeminiServer server(server_io, server_options);
+    if (!server.start()) {
+        return 1;
+    }
+    std::thread server_thread([&server_io]() {
+        server_io.run();
+    });
+
+    // Many coroutine sessions on two threads
+    net::io_context io_context;
+    std::vector<std::unique_ptr<AwaitableClient>> clients;
+    for (int i = 0; i < session_count; i++) {
+        clients.push_back(std::make_unique<AwaitableClient>(io_context, server.endpoint()));
+        net::co_spawn(clients.back()->get_executor(), run_session(*clients.back(), i), net::detached);
+    }
+
+    AwaitableClient timeout_client(io_context, server.endpoint());
+    bool timeout_ok = false;
+    net::co_spawn(timeout_client.get_executor(), check_timeout(timeout_client, timeout_ok), net::detached);
+
+    AwaitableClient late_client(io_context, server.endpoint());
+    bool late_ok = false;
+    net::co_spawn(late_client.get_executor(), check_late_deadline(late_client, late_ok), net::detached);
+
+    AwaitableClient cancel_client(io_context, server.endpoint());
+    std::atomic<bool> cancel_waiting(false);
+    bool cancel_ok = false;
+    net::co_spawn(cancel_client.get_executor(),
+                  check_cancel(cancel_client, cancel_waiting, cancel_ok), net::detached);
+
+    std::thread cancel_thread([&]() {
+        auto deadline = std::chrono::steady_clock::now() + 5s;
+        while (!cancel_waiting && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(10ms);
+        }
+        std::this_thread::sleep_for(100ms);
+        cancel_client.cancel();
+    });
+
+    std::thread worker([&io_context]() { io_context.run(); });
+    io_context.run();
+    worker.join();
+    cancel_thread.join();
+
+    server_io.stop();
+    server_thread.join();
+
+    std::cout << "Sessions completed: " << g_sessions_ok << "/" << session_count << std::endl;
+    std::cout << "Read timeout: " << (timeout_ok ? "OK" : "FAILED") << std::endl;
+    std::cout << "Cancel: " << (cancel_ok ? "OK" : "FAILED") << std::endl;
+    std::cout << "Expired deadline after completion: " << (late_ok ? "OK" : "FAILED") << std::endl;
+
+    bool ok = g_sessions_ok == session_count && timeout_ok && cancel_ok && late_ok;
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
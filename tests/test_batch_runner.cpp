@@ -0,0 +1,181 @@
+#include "batch_runner.h"
+#include "mock_gemini_server.h"
+#include "wav_file.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+void append_chunk(std::string& out, const char* id, const std::string& body) {
+    out.append(id, 4);
+    uint32_t size = static_cast<uint32_t>(body.size());
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<char>(size >> (8 * i)));
+    }
+    out += body;
+    if (body.size() & 1) {
+        out.push_back('\0');
+    }
+}
+
+// A 16-bit mono WAV with a LIST chunk before and after the samples
+void write_wav(const fs::path& path, int sample_rate, std::size_t samples) {
+    std::string format(16, '\0');
+    format[0] = 1;
+    format[2] = 1;
+    for (int i = 0; i < 4; i++) {
+        format[4 + i] = static_cast<char>(sample_rate >> (8 * i));
+        format[8 + i] = static_cast<char>((sample_rate * 2) >> (8 * i));
+    }
+    format[12] = 2;
+    format[14] = 16;
+
+    std::string body = "WAVE";
+    append_chunk(body, "fmt ", format);
+    append_chunk(body, "LIST", "INFOcomment");
+    append_chunk(body, "data", std::string(samples * 2, '\x10'));
+    append_chunk(body, "LIST", "INFOtrailing chunk that is not audio");
+
+    std::string file = "RIFF";
+    uint32_t size = static_cast<uint32_t>(body.size());
+    for (int i = 0; i < 4; i++) {
+        file.push_back(static_cast<char>(size >> (8 * i)));
+    }
+    std::ofstream(path, std::ios::binary) << file << body;
+}
+
+std::size_t count_lines(const fs::path& path) {
+    std::ifstream in(path);
+    std::size_t lines = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        lines++;
+    }
+    return lines;
+}
+
+int main() {
+    std::cout << "=== Batch Runner Test ===" << std::endl;
+    bool ok = true;
+
+    fs::path root = fs::temp_directory_path() / ("gemini_batch_test_" + std::to_string(::getpid()));
+    fs::remove_all(root);
+    fs::create_directories(root / "in");
+
+    // WAV header parsing skips unrelated chunks and stops at the end of the samples
+    const std::size_t SAMPLES = 8000;  // 0.5 s at 16 kHz
+    write_wav(root / "probe.wav", 16000, SAMPLES);
+    int fd = ::open((root / "probe.wav").c_str(), O_RDONLY);
+    WavInfo info;
+    std::string error;
+    bool parsed = read_wav_header(fd, info, error);
+    ok &= expect(parsed && info.sample_rate == 16000 && info.data_bytes == SAMPLES * 2 &&
+                 ::lseek(fd, 0, SEEK_CUR) == static_cast<off_t>(info.data_offset),
+                 "WAV header parsed past a LIST chunk");
+    ::close(fd);
+
+    const int FILES = 6;
+    for (int i = 0; i < FILES; i++) {
+        write_wav(root / "in" / ("utt" + std::to_string(i) + ".wav"), 16000, SAMPLES);
+    }
+    std::ofstream(root / "in" / "broken.wav") << "not a wav file";
+
+    MockServerOptions mock_options;
+    mock_options.turn_trigger_chunks = 2;
+    mock_options.response_delay = std::chrono::milliseconds(50);
+    mock_options.turn_duration = std::chrono::milliseconds(300);
+
+    net::io_context server_io;
+    MockGeminiServer mock_server(server_io, mock_options);
+    if (!mock_server.start()) {
+        return 1;
+    }
+    std::thread server_thread([&server_io]() { server_io.run(); });
+
+    BatchOptions options;
+    options.endpoint = mock_server.endpoint();
+    options.setup_message = R"({"setup":{}})";
+    options.output_dir = (root / "out").string();
+    options.concurrency = 3;
+    options.thread_count = 2;
+    options.retries = 1;
+    options.drain_timeout = std::chrono::seconds(5);
+
+    std::vector<std::string> inputs;
+    ok &= expect(BatchRunner::collect_inputs((root / "in").string(), inputs) && inputs.size() == FILES + 1,
+                 "directory scanned for WAV files");
+
+    // First run: the broken file fails twice, every other file gets a response
+    {
+        BatchRunner batch(options);
+        bool all_ok = batch.run(inputs);
+        BatchRunner::Summary summary = batch.get_summary();
+        batch.print_report(std::cout);
+        ok &= expect(!all_ok && summary.succeeded == FILES && summary.failed == 1 && summary.retried == 1,
+                     "failed file retried and reported");
+        ok &= expect(summary.uplink_bytes == FILES * SAMPLES * 2, "only the data chunk is streamed");
+        ok &= expect(summary.files_per_minute > 0.0, "throughput reported");
+    }
+
+    bool outputs_ok = true;
+    for (int i = 0; i < FILES; i++) {
+        fs::path audio = root / "out" / ("utt" + std::to_string(i) + ".wav");
+        int out_fd = ::open(audio.c_str(), O_RDONLY);
+        WavInfo out_info;
+        outputs_ok &= out_fd >= 0 && read_wav_header(out_fd, out_info, error) && out_info.sample_rate == 24000 &&
+                      out_info.data_bytes >= 24000 * 2 * 300 / 1000 * 9 / 10 &&
+                      out_info.data_offset + out_info.data_bytes == fs::file_size(audio) &&
+                      fs::exists(root / "out" / ("utt" + std::to_string(i) + ".jsonl"));
+        if (out_fd >= 0) {
+            ::close(out_fd);
+        }
+    }
+    ok &= expect(outputs_ok, "response WAV and transcript written per input");
+    ok &= expect(!fs::exists(root / "out" / "broken.wav"), "no final output for the failed file");
+    ok &= expect(count_lines(root / "out" / "batch_results.jsonl") == FILES + 2, "one result line per attempt");
+
+    // Second run after fixing the input: finished files are skipped
+    write_wav(root / "in" / "broken.wav", 8000, 4000);
+    {
+        BatchRunner batch(options);
+        bool all_ok = batch.run(inputs);
+        BatchRunner::Summary summary = batch.get_summary();
+        ok &= expect(all_ok && summary.skipped == FILES && summary.succeeded == 1, "rerun resumes with the remaining file");
+    }
+
+    // Nothing listening: every attempt fails once, without hanging on the refused connects
+    {
+        BatchOptions dead_options = options;
+        dead_options.endpoint.port = "1";
+        dead_options.output_dir = (root / "dead").string();
+        BatchRunner batch(dead_options);
+        bool all_ok = batch.run(inputs);
+        BatchRunner::Summary summary = batch.get_summary();
+        ok &= expect(!all_ok && summary.failed == FILES + 1 && summary.retried == FILES + 1 && summary.active == 0,
+                     "refused connections retried and reported once each");
+        ok &= expect(count_lines(root / "dead" / "batch_results.jsonl") == 2 * (FILES + 1), "one result line per refused attempt");
+    }
+
+    // Manifests list paths relative to themselves
+    std::ofstream(root / "list.txt") << "# utterances\nin/utt0.wav\n\n" << (root / "in" / "utt1.wav").string() << "\n";
+    std::vector<std::string> listed;
+    ok &= expect(BatchRunner::collect_inputs((root / "list.txt").string(), listed) && listed.size() == 2 &&
+                 fs::exists(listed[0]) && fs::exists(listed[1]), "manifest read");
+
+    mock_server.stop();
+    server_io.stop();
+    server_thread.join();
+    fs::remove_all(root);
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#include "callback_monitor.h"
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+int main() {
+    std::cout << "=== Callback Monitor Test ===" << std::endl;
+    bool ok = true;
+
+    // 16kHz, 320 frames = 20ms periods; simulate a device thread
+    const int SAMPLE_RATE = 16000;
+    const uint32_t FRAMES = 320;
+    const auto PERIOD = std::chrono::milliseconds(20);
+    CallbackMonitor monitor("test", SAMPLE_RATE, 0.5);
+
+    auto next = CallbackMonitor::Clock::now();
+    auto last_started = next;
+    auto run_callback = [&](std::chrono::milliseconds work, uint32_t zero_filled) {
+        std::this_thread::sleep_until(next);
+        auto started = monitor.begin(FRAMES);
+        last_started = started;
+        std::this_thread::sleep_for(work);
+        monitor.end(started, FRAMES, zero_filled);
+        next += PERIOD;
+    };
+
+    for (int i = 0; i < 5; i++) {
+        run_callback(std::chrono::milliseconds(0), 0);
+    }
+    ok &= expect(monitor.get_stats().callbacks == 5, "callbacks counted");
+    ok &= expect(monitor.get_stats().over_warning == 0, "fast callbacks do not warn");
+
+    // 15ms of work is 75% of the 20ms budget: slow but within the period
+    run_callback(std::chrono::milliseconds(15), 0);
+    CallbackMonitor::Stats stats = monitor.get_stats();
+    ok &= expect(stats.over_warning == 1 && stats.over_budget == 0, "slow callback warns without xrun");
+
+    std::ostringstream warnings;
+    monitor.report_warnings(warnings);
+    ok &= expect(warnings.str().find("1 test callback(s) exceeded 50%") != std::string::npos, "warning reported");
+    std::ostringstream drained;
+    monitor.report_warnings(drained);
+    ok &= expect(drained.str().empty(), "warnings drained after report");
+
+    // Work longer than the period overruns the budget
+    run_callback(std::chrono::milliseconds(25), 0);
+    ok &= expect(monitor.get_stats().over_budget == 1, "overrun detected");
+
+    // Skip three periods entirely: the device dropped them
+    // Measured from the last start so a slow sleep in the overrun above does not add periods
+    next = last_started + PERIOD * 4;
+    run_callback(std::chrono::milliseconds(0), 0);
+    stats = monitor.get_stats();
+    ok &= expect(stats.missed_periods >= 3 && stats.missed_periods <= 4, "missed periods detected");
+
+    // Partially filled playback buffer
+    run_callback(std::chrono::milliseconds(0), 120);
+    stats = monitor.get_stats();
+    ok &= expect(stats.underruns == 1 && stats.underrun_frames == 120, "underrun frames counted");
+    ok &= expect(monitor.duration_us().count() == stats.callbacks, "durations recorded");
+    ok &= expect(monitor.jitter_us().count() == stats.callbacks - 1, "jitter recorded between callbacks");
+
+    std::string text = metrics().render_prometheus();
+    ok &= expect(text.find("gemini_audio_test_callback_over_budget_total 1\n") != std::string::npos,
+                 "metrics exported");
+
+    monitor.print_summary(std::cout);
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include "config_watcher.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+void write_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream out(path, std::ios::trunc);
+    out << content;
+}
+
+std::string audio_config(int gain, int chunk, int buffer, int min_buffer, const std::string& model = "test-model") {
+    return "{\"model\": {\"name\": \"" + model + "\"}, \"audio\": {\"gainFactor\": " + std::to_string(gain) +
+           ", \"chunkSize\": " + std::to_string(chunk) + ", \"bufferSize\": " + std::to_string(buffer) +
+           ", \"minBufferSize\": " + std::to_string(min_buffer) + "}}";
+}
+
+int main() {
+    std::cout << "=== Config Watcher Test ===" << std::endl;
+    bool ok = true;
+    const auto dir = std::filesystem::temp_directory_path() /
+                     ("gemini_config_test_" + std::to_string(::getpid()));
+    std::filesystem::create_directories(dir);
+    const auto path = dir / "config.json";
+
+    // Validation and session-field diffing
+    write_file(path, audio_config(5, 16000, 24000, 7200));
+    Config initial(path.string());
+    std::string error;
+    ok &= expect(initial.validate(error), "initial config is valid");
+    write_file(path, audio_config(5, 16000, 1000, 2000));
+    ok &= expect(!Config(path.string()).validate(error) && !error.empty(), "minBufferSize > bufferSize is invalid");
+    write_file(path, audio_config(5, 0, 24000, 7200));
+    ok &= expect(!Config(path.string()).validate(error), "zero chunkSize is invalid");
+    write_file(path, audio_config(3, 8000, 24000, 7200, "other-model"));
+    std::vector<std::string> fields = Config(path.string()).sessionChangesFrom(initial);
+    ok &= expect(fields == std::vector<std::string>{"model.name"}, "model change needs a new session");
+
+    write_file(path, audio_config(5, 16000, 24000, 7200));
+    net::io_context io_context;
+    ConfigWatcher watcher(io_context, path.string(), initial);
+
+    std::mutex mutex;
+    std::promise<std::vector<std::string>> reloaded;
+    watcher.set_reload_callback([&](const AudioTuning&, const std::vector<std::string>& session_fields) {
+        std::lock_guard<std::mutex> lock(mutex);
+        reloaded.set_value(session_fields);
+    });
+    auto next_reload = [&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        reloaded = std::promise<std::vector<std::string>>();
+        return reloaded.get_future();
+    };
+
+    ok &= expect(watcher.start(), "watcher starts");
+    auto work = net::make_work_guard(io_context);
+    std::thread io_thread([&]() { io_context.run(); });
+
+    // In-place rewrite
+    auto reload = next_reload();
+    write_file(path, audio_config(3, 8000, 12000, 4000));
+    bool fired = reload.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+    ok &= expect(fired && reload.get().empty(), "in-place write reloads without session changes");
+    const AudioTuning& tuning = watcher.tuning();
+    ok &= expect(tuning.gain_factor == 3 && tuning.chunk_size == 8000 && tuning.buffer_size == 12000 &&
+                 tuning.min_buffer_size == 4000, "new audio tuning published");
+
+    // Invalid edits keep the current snapshot
+    reload = next_reload();
+    write_file(path, audio_config(9, 8000, 1000, 4000));
+    ok &= expect(reload.wait_for(std::chrono::milliseconds(500)) == std::future_status::timeout,
+                 "invalid config is not applied");
+    write_file(path, "{ not json");
+    ok &= expect(reload.wait_for(std::chrono::milliseconds(500)) == std::future_status::timeout,
+                 "malformed config is not applied");
+    ok &= expect(watcher.tuning().gain_factor == 3 && watcher.tuning().buffer_size == 12000,
+                 "previous tuning kept after rejection");
+
+    // Atomic save: write a temporary file and rename it over the config
+    reload = next_reload();
+    write_file(dir / "config.json.tmp", audio_config(7, 8000, 12000, 4000, "other-model"));
+    std::filesystem::rename(dir / "config.json.tmp", path);
+    fired = reload.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+    ok &= expect(fired && reload.get() == std::vector<std::string>{"model.name"},
+                 "rename reloads and reports the model change");
+    ok &= expect(watcher.tuning().gain_factor == 7, "renamed config applied");
+    ok &= expect(&tuning != &watcher.tuning() && tuning.gain_factor == 3, "old snapshot stays readable");
+
+    // Other files in the directory are ignored
+    reload = next_reload();
+    write_file(dir / "unrelated.json", "{}");
+    ok &= expect(reload.wait_for(std::chrono::milliseconds(500)) == std::future_status::timeout,
+                 "unrelated file ignored");
+
+    // A watcher destroyed with a reload pending is never called back
+    watcher.stop();
+    std::atomic<bool> late_reload{false};
+    {
+        ConfigWatcher short_lived(io_context, path.string(), initial);
+        short_lived.set_reload_callback([&](const AudioTuning&, const std::vector<std::string>&) {
+            late_reload = true;
+        });
+        short_lived.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        write_file(path, audio_config(4, 8000, 12000, 4000));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    ok &= expect(!late_reload, "watcher destroyed with a reload pending is not called back");
+
+    work.reset();
+    io_thread.join();
+    std::filesystem::remove_all(dir);
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
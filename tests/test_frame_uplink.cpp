@@ -0,0 +1,263 @@
+#include "frame_uplink.h"
+#include "message_handler.h"
+#include "mock_gemini_server.h"
+#include "session_recorder.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+// Smooth gradient with a square whose position moves the content
+ImageFrame make_frame(int width, int height, int square_x) {
+    ImageFrame frame;
+    frame.width = width;
+    frame.height = height;
+    frame.rgb.resize(static_cast<std::size_t>(width) * height * 3);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t* p = frame.rgb.data() + (static_cast<std::size_t>(y) * width + x) * 3;
+            bool square = x >= square_x && x < square_x + width / 8 && y >= height / 4 && y < height / 4 + height / 8;
+            p[0] = square ? 255 : static_cast<uint8_t>(x * 255 / width);
+            p[1] = square ? 0 : static_cast<uint8_t>(y * 255 / height);
+            p[2] = square ? 0 : 128;
+        }
+    }
+    return frame;
+}
+
+std::string to_ppm(const ImageFrame& frame) {
+    std::string ppm = "P6\n# test frame\n" + std::to_string(frame.width) + " " + std::to_string(frame.height) + "\n255\n";
+    ppm.append(reinterpret_cast<const char*>(frame.rgb.data()), frame.rgb.size());
+    return ppm;
+}
+
+bool wait_until(const std::function<bool()>& condition, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+// Occupy the client's strand so writes queue up until the returned promise is set
+std::shared_ptr<std::promise<void>> block_strand(WebSocketClient& client) {
+    auto release = std::make_shared<std::promise<void>>();
+    std::promise<void> entered;
+    auto entered_future = entered.get_future();
+    net::post(client.get_executor(), [release, &entered]() {
+        entered.set_value();
+        release->get_future().wait();
+    });
+    entered_future.wait();
+    return release;
+}
+
+int main() {
+    std::cout << "=== Frame Uplink Test ===" << std::endl;
+    bool ok = true;
+
+    // --- PPM: concatenated stream, comments, errors ---
+    {
+        ImageFrame a = make_frame(40, 30, 0);
+        ImageFrame b = make_frame(17, 9, 3);
+        std::istringstream stream(to_ppm(a) + to_ppm(b) + "P6\n4 4\n255\nshort");
+        ImageFrame frame;
+        std::string error;
+        bool first = read_ppm(stream, frame, error) && frame.width == 40 && frame.rgb == a.rgb;
+        bool second = read_ppm(stream, frame, error) && frame.width == 17 && frame.height == 9 && frame.rgb == b.rgb;
+        ok &= expect(first && second, "concatenated PPM frames read in order");
+        ok &= expect(!read_ppm(stream, frame, error) && !error.empty(), "truncated frame reported");
+        std::istringstream end("");
+        ok &= expect(!read_ppm(end, frame, error) && error.empty(), "end of stream is not an error");
+        std::istringstream ascii("P3\n1 1\n255\n0 0 0\n");
+        ok &= expect(!read_ppm(ascii, frame, error) && !error.empty(), "ASCII PPM rejected");
+        std::istringstream huge("P6\n1000000 1000000\n255\n");
+        ok &= expect(!read_ppm(huge, frame, error) && error.find("exceeds") != std::string::npos,
+                     "oversized frame rejected before allocating");
+    }
+
+    // --- Downscale ---
+    {
+        ImageFrame large = make_frame(1920, 1080, 100);
+        ImageFrame scaled;
+        downscale_frame(large, 768, 768, scaled);
+        ok &= expect(scaled.width == 768 && scaled.height == 432 && scaled.rgb.size() == 768u * 432 * 3,
+                     "1920x1080 fits 768 keeping the aspect ratio");
+        ImageFrame flat;
+        flat.width = 300;
+        flat.height = 200;
+        flat.rgb.assign(300 * 200 * 3, 77);
+        downscale_frame(flat, 64, 64, scaled);
+        bool uniform = std::all_of(scaled.rgb.begin(), scaled.rgb.end(), [](uint8_t v) { return v == 77; });
+        ok &= expect(uniform && scaled.width == 64 && scaled.height == 43, "box filter keeps a flat colour");
+        downscale_frame(flat, 1000, 1000, scaled);
+        ok &= expect(scaled.width == 300 && scaled.rgb == flat.rgb, "small frames are not upscaled");
+    }
+
+    // --- SIMD difference against a scalar reference, including unaligned tails ---
+    {
+        std::mt19937 random(7);
+        std::vector<uint8_t> a(1000), b(1000);
+        for (std::size_t i = 0; i < a.size(); i++) {
+            a[i] = static_cast<uint8_t>(random());
+            b[i] = static_cast<uint8_t>(random());
+        }
+        bool matches = true;
+        for (std::size_t size : {0, 1, 15, 16, 17, 48, 999}) {
+            for (std::size_t offset : {0, 1, 3}) {
+                uint64_t expected = 0;
+                for (std::size_t i = 0; i < size; i++) {
+                    expected += static_cast<uint64_t>(std::abs(a[offset + i] - b[offset + i]));
+                }
+                matches &= sum_abs_diff(a.data() + offset, b.data() + offset, size) == expected;
+            }
+        }
+        ok &= expect(matches, "sum_abs_diff matches the scalar sum");
+
+        ImageFrame frame = make_frame(160, 96, 0);
+        ImageFrame copy = frame;
+        ok &= expect(changed_block_fraction(frame, copy, 4) == 0.0, "identical frames have no changed blocks");
+        copy.rgb[(50 * 160 + 70) * 3] ^= 0xFF;  // One pixel in one block, big enough to cross the threshold
+        double one_block = changed_block_fraction(frame, copy, 0);
+        ok &= expect(one_block > 0.0 && one_block < 0.02, "a single changed block is detected");
+        ok &= expect(changed_block_fraction(frame, make_frame(80, 48, 0), 4) == 1.0, "a size change counts as all changed");
+    }
+
+    // --- JPEG ---
+    std::vector<uint8_t> jpeg;
+    {
+        ImageFrame frame = make_frame(333, 211, 40);
+        encode_jpeg(frame, 70, jpeg);
+        bool markers = jpeg.size() > 4 && jpeg[0] == 0xFF && jpeg[1] == 0xD8 &&
+                       jpeg[jpeg.size() - 2] == 0xFF && jpeg.back() == 0xD9;
+        ok &= expect(markers, "JPEG starts with SOI and ends with EOI");
+        bool size_in_header = false;
+        for (std::size_t i = 0; i + 8 < jpeg.size(); i++) {
+            if (jpeg[i] == 0xFF && jpeg[i + 1] == 0xC0) {
+                size_in_header = (jpeg[i + 5] << 8 | jpeg[i + 6]) == 211 && (jpeg[i + 7] << 8 | jpeg[i + 8]) == 333;
+                break;
+            }
+        }
+        ok &= expect(size_in_header, "SOF0 carries the frame size");
+        ok &= expect(jpeg.size() < frame.rgb.size() / 10, "smooth frame compresses more than 10x");
+        std::vector<uint8_t> again;
+        encode_jpeg(frame, 70, again);
+        ok &= expect(again == jpeg, "encoding is deterministic");
+        std::string message = MessageHandler::create_image_input_message(jpeg);
+        ok &= expect(message.find(R"("mimeType":"image/jpeg")") != std::string::npos &&
+                     message.find(MessageHandler::base64_encode(jpeg)) != std::string::npos,
+                     "image message carries the base64 JPEG");
+    }
+
+    // --- Uplink against the mock server ---
+    MockServerOptions mock_options;
+    mock_options.turn_trigger_chunks = 1000;  // Keep the downlink quiet; only the upload order matters here
+    net::io_context io_context;
+    MockGeminiServer mock_server(io_context, mock_options);
+    if (!mock_server.start()) {
+        return 1;
+    }
+    WebSocketClient client(io_context, mock_server.endpoint());
+    client.set_message_view_callback([](std::string_view) {});
+    const std::string record_path = (std::filesystem::temp_directory_path() /
+                                     ("gemini_frame_test_" + std::to_string(::getpid()) + ".rec")).string();
+    auto recorder = std::make_shared<SessionRecorder>();
+    if (!recorder->open(record_path)) {
+        return 1;
+    }
+    client.set_recorder(recorder);
+    std::thread io_thread([&io_context]() {
+        auto work = net::make_work_guard(io_context);
+        io_context.run();
+    });
+    if (!client.connect()) {
+        return 1;
+    }
+    client.send(MessageHandler::create_setup_message());
+    client.async_receive();
+    auto drained = [&]() { return client.pending_writes() == 0; };
+
+    {
+        FrameUplinkOptions options;
+        options.fps = 2.0;
+        options.max_width = options.max_height = 320;
+        FrameUplink uplink(client, options);
+        auto t0 = std::chrono::steady_clock::now();
+        ImageFrame first = make_frame(640, 360, 0);
+        ImageFrame moved = make_frame(640, 360, 300);
+
+        bool sent_first = uplink.submit(first, t0);
+        wait_until(drained, std::chrono::seconds(2));
+        bool limited = !uplink.submit(moved, t0 + std::chrono::milliseconds(100));
+        bool sent_moved = uplink.submit(moved, t0 + std::chrono::milliseconds(500));
+        wait_until(drained, std::chrono::seconds(2));
+        bool duplicate = !uplink.submit(moved, t0 + std::chrono::milliseconds(1000));
+        bool sent_back = uplink.submit(first, t0 + std::chrono::milliseconds(1001));
+        wait_until(drained, std::chrono::seconds(2));
+
+        FrameUplink::Stats stats = uplink.get_stats();
+        ok &= expect(sent_first && sent_moved && sent_back && stats.sent == 3, "changed frames sent");
+        ok &= expect(limited && stats.rate_limited == 1, "frames above the fps limit dropped");
+        ok &= expect(duplicate && stats.duplicates == 1, "unchanged frame skipped without waiting an interval");
+        ok &= expect(stats.bytes_sent > 0 && stats.bytes_sent < 3 * 320u * 180 * 3 / 5, "downscaled JPEG frames are small");
+
+        // A frame still queued behind the socket blocks the next one
+        auto release = block_strand(client);
+        bool queued = uplink.submit(moved, t0 + std::chrono::seconds(5));
+        bool congested = !uplink.submit(first, t0 + std::chrono::seconds(6));
+        release->set_value();
+        wait_until(drained, std::chrono::seconds(2));
+        ok &= expect(queued && congested && uplink.get_stats().congested == 1, "no second frame queued behind the first");
+    }
+
+    // Audio overtakes queued frames: the frame in flight finishes, then audio, then the next frame
+    {
+        std::string frame_message = MessageHandler::create_image_input_message(jpeg);
+        std::string audio_message = MessageHandler::create_audio_input_message(std::vector<int16_t>(1600, 100));
+        auto release = block_strand(client);
+        client.send_bulk(std::string(frame_message));
+        client.send_bulk(std::string(frame_message));
+        client.send(std::string(audio_message));
+        client.send(std::string(audio_message));
+        ok &= expect(client.pending_bulk_writes() == 2 && client.pending_writes() == 4, "bulk writes counted separately");
+        release->set_value();
+        wait_until(drained, std::chrono::seconds(2));
+    }
+
+    client.close();
+    recorder->close();
+    SessionReplayer replayer;
+    std::vector<bool> is_image;
+    if (replayer.load(record_path)) {
+        for (const RecordedFrame& frame : replayer.frames()) {
+            if (frame.direction == RecordedFrame::Direction::Outbound &&
+                frame.payload.find("realtimeInput") != std::string::npos) {
+                is_image.push_back(frame.payload.find("image/jpeg") != std::string::npos);
+            }
+        }
+    }
+    std::remove(record_path.c_str());
+    // Four frames from the uplink, then: frame, audio, audio, frame
+    bool order = is_image.size() == 8 && is_image[4] && !is_image[5] && !is_image[6] && is_image[7];
+    ok &= expect(order, "audio written ahead of a queued frame");
+
+    mock_server.stop();
+    io_context.stop();
+    io_thread.join();
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
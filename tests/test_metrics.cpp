@@ -0,0 +1,108 @@
+#include "metrics.h"
+#include "metrics_server.h"
+#include <boost/beast/http.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Fetch a path from the metrics server with a blocking HTTP client
+http::response<http::string_body> fetch(unsigned short port, const std::string& target) {
+    net::io_context io_context;
+    beast::tcp_stream stream(io_context);
+    stream.connect(tcp::endpoint(net::ip::make_address("127.0.0.1"), port));
+
+    http::request<http::empty_body> request(http::verb::get, target, 11);
+    request.set(http::field::host, "127.0.0.1");
+    http::write(stream, request);
+
+    beast::flat_buffer buffer;
+    http::response<http::string_body> response;
+    http::read(stream, buffer, response);
+
+    beast::error_code ignored;
+    stream.socket().shutdown(tcp::socket::shutdown_both, ignored);
+    return response;
+}
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+int main() {
+    std::cout << "=== Metrics Test ===" << std::endl;
+    bool ok = true;
+
+    // Sharded counters must not lose increments under contention
+    Counter& counter = metrics().counter("test_events_total", "Events counted by the test");
+    const int THREADS = 8;
+    const int PER_THREAD = 100000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([&counter]() {
+            for (int i = 0; i < PER_THREAD; i++) {
+                counter.inc();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ok &= expect(counter.value() == static_cast<uint64_t>(THREADS) * PER_THREAD, "concurrent counter increments");
+    ok &= expect(&metrics().counter("test_events_total", "") == &counter, "registration returns the same counter");
+
+    Gauge& gauge = metrics().gauge("test_queue_depth", "Queue depth seen by the test");
+    gauge.set(5);
+    gauge.add(-2);
+    ok &= expect(gauge.value() == 3, "gauge set/add");
+
+    std::string type_error;
+    try {
+        metrics().counter("test_queue_depth", "");
+    } catch (const std::logic_error& e) {
+        type_error = e.what();
+    }
+    ok &= expect(type_error.find("already registered as a gauge") != std::string::npos, "same name with another type rejected");
+
+    Histogram& histogram = metrics().histogram("test_latency_seconds", "Latency seen by the test",
+                                               {1000, 10000, 100000}, 1e-6);
+    histogram.record(500);       // <= 1ms
+    histogram.record(5000);      // <= 10ms
+    histogram.record(50000);     // <= 100ms
+    histogram.record(5000000);   // +Inf
+
+    std::string text = metrics().render_prometheus();
+    ok &= expect(text.find("# TYPE test_events_total counter\ntest_events_total 800000\n") != std::string::npos,
+                 "counter exposition");
+    ok &= expect(text.find("test_queue_depth 3\n") != std::string::npos, "gauge exposition");
+    ok &= expect(text.find("test_latency_seconds_bucket{le=\"0.001\"} 1\n") != std::string::npos &&
+                 text.find("test_latency_seconds_bucket{le=\"0.01\"} 2\n") != std::string::npos &&
+                 text.find("test_latency_seconds_bucket{le=\"0.1\"} 3\n") != std::string::npos &&
+                 text.find("test_latency_seconds_bucket{le=\"+Inf\"} 4\n") != std::string::npos &&
+                 text.find("test_latency_seconds_count 4\n") != std::string::npos,
+                 "cumulative histogram buckets");
+
+    // HTTP endpoint on an ephemeral localhost port
+    net::io_context io_context;
+    MetricsServer server(io_context, 0);
+    if (!server.start()) {
+        return 1;
+    }
+    std::thread io_thread([&io_context]() {
+        io_context.run();
+    });
+
+    auto response = fetch(server.port(), "/metrics");
+    ok &= expect(response.result() == http::status::ok &&
+                 response.body().find("test_events_total 800000") != std::string::npos,
+                 "GET /metrics");
+    ok &= expect(fetch(server.port(), "/other").result() == http::status::not_found, "GET /other is 404");
+
+    server.stop();
+    io_context.stop();
+    io_thread.join();
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
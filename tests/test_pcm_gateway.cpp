@@ -0,0 +1,256 @@
+#include "pcm_gateway.h"
+#include "message_handler.h"
+#include "mock_gemini_server.h"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+using local_socket = net::local::stream_protocol::socket;
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+std::string request_header(uint32_t rate, const std::string& config) {
+    std::string header(gateway_protocol::HEADER_SIZE, '\0');
+    std::copy(std::begin(gateway_protocol::MAGIC), std::end(gateway_protocol::MAGIC), header.begin());
+    header[4] = static_cast<char>(gateway_protocol::VERSION);
+    for (int i = 0; i < 4; i++) {
+        header[8 + i] = static_cast<char>((rate >> (8 * i)) & 0xFF);
+        header[12 + i] = static_cast<char>((config.size() >> (8 * i)) & 0xFF);
+    }
+    return header + config;
+}
+
+struct CallResult {
+    bool connected = false;
+    int status = -1;
+    uint32_t output_rate = 0;
+    std::size_t pcm_bytes = 0;
+};
+
+// One synchronous media-server connection: header, PCM, half-close, read until EOF
+CallResult run_call(const std::string& path, const std::string& request, std::size_t pcm_samples) {
+    CallResult result;
+    net::io_context io;
+    local_socket socket(io);
+    beast::error_code ec;
+    socket.connect(net::local::stream_protocol::endpoint(path), ec);
+    if (ec) {
+        return result;
+    }
+    result.connected = true;
+
+    net::write(socket, net::buffer(request), ec);
+    std::vector<int16_t> pcm(pcm_samples, 1000);
+    net::write(socket, net::buffer(pcm.data(), pcm.size() * sizeof(int16_t)), ec);
+    socket.shutdown(local_socket::shutdown_send, ec);
+
+    uint8_t reply[gateway_protocol::HEADER_SIZE];
+    if (net::read(socket, net::buffer(reply), ec) != sizeof(reply)) {
+        return result;
+    }
+    result.status = reply[5];
+    result.output_rate = reply[8] | (reply[9] << 8) | (reply[10] << 16) | (static_cast<uint32_t>(reply[11]) << 24);
+
+    char buffer[8192];
+    while (true) {
+        std::size_t n = socket.read_some(net::buffer(buffer), ec);
+        result.pcm_bytes += n;
+        if (ec) {
+            break;
+        }
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== PCM Gateway Test ===" << std::endl;
+    bool ok = true;
+    int call_count = argc > 1 ? std::atoi(argv[1]) : 8;
+
+    // The direct encoder matches the JSON built through intermediate vectors
+    bool same = true;
+    for (std::size_t samples : {0, 1, 2, 3, 160}) {
+        std::vector<int16_t> audio(samples);
+        for (std::size_t i = 0; i < samples; i++) {
+            audio[i] = static_cast<int16_t>(i * 977 - 30000);
+        }
+        std::string direct;
+        MessageHandler::build_audio_input_message(reinterpret_cast<const uint8_t*>(audio.data()),
+                                                  samples * sizeof(int16_t), "audio/pcm;rate=8000", direct);
+        nlohmann::json tree = {{"realtimeInput", {{"mediaChunks", {{
+            {"data", MessageHandler::base64_encode(MessageHandler::int16_to_uint8(audio))},
+            {"mimeType", "audio/pcm;rate=8000"}
+        }}}}}};
+        same &= direct == tree.dump() && direct == MessageHandler::create_audio_input_message(audio, "audio/pcm;rate=8000");
+    }
+    ok &= expect(same, "direct encoder matches the json dump");
+
+    // The direct decoder matches base64_decode plus little-endian pairing, padded or not;
+    // an odd trailing byte is dropped by both
+    bool decoded_same = true;
+    for (std::size_t bytes : {1, 2, 3, 4, 5, 6, 7, 160, 161}) {
+        std::vector<uint8_t> raw(bytes);
+        for (std::size_t i = 0; i < bytes; i++) {
+            raw[i] = static_cast<uint8_t>(i * 37 + 11);
+        }
+        std::string padded = MessageHandler::base64_encode(raw);
+        std::string unpadded = padded.substr(0, padded.find('='));
+        for (const std::string& encoded : {padded, unpadded}) {
+            std::vector<uint8_t> reference_bytes = MessageHandler::base64_decode(encoded);
+            std::vector<int16_t> reference;
+            for (std::size_t i = 0; i + 1 < reference_bytes.size(); i += 2) {
+                reference.push_back(static_cast<int16_t>(reference_bytes[i] | (reference_bytes[i + 1] << 8)));
+            }
+            std::string message = R"({"serverContent":{"modelTurn":{"parts":[{"inlineData":{"mimeType":"audio/pcm;rate=24000","data":")" +
+                                  encoded + R"("}}]}}})";
+            std::vector<int16_t> samples;
+            bool found = MessageHandler::extract_audio_from_response(message, samples);
+            decoded_same &= found && samples == reference && reference.size() == bytes / 2;
+        }
+    }
+    ok &= expect(decoded_same, "direct decoder matches base64_decode for padded, unpadded and odd-byte payloads");
+
+    MockServerOptions mock_options;
+    mock_options.turn_trigger_chunks = 2;  // Model answers only once uplink audio arrives
+    mock_options.response_delay = std::chrono::milliseconds(50);
+    mock_options.turn_duration = std::chrono::milliseconds(400);
+
+    net::io_context io_context(4);
+    MockGeminiServer mock_server(io_context, mock_options);
+    if (!mock_server.start()) {
+        return 1;
+    }
+
+    const std::string path = (std::filesystem::temp_directory_path() /
+                              ("gemini_gateway_test_" + std::to_string(::getpid()) + ".sock")).string();
+    PcmGatewayOptions options;
+    options.socket_path = path;
+    options.endpoint = mock_server.endpoint();
+    options.drain_timeout = std::chrono::seconds(5);
+    PcmGateway gateway(io_context, options);
+    ok &= expect(gateway.start(), "gateway listening");
+
+    const std::string busy_path = path + ".busy";
+    PcmGatewayOptions busy_options = options;
+    busy_options.socket_path = busy_path;
+    busy_options.max_calls = 1;
+    PcmGateway busy_gateway(io_context, busy_options);
+    busy_gateway.start();
+
+    auto work = net::make_work_guard(io_context);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&io_context]() { io_context.run(); });
+    }
+
+    // Concurrent calls at 8 kHz, 0.5 s of audio each
+    const std::size_t SAMPLES = 4000;
+    std::vector<CallResult> results(call_count);
+    std::vector<std::thread> callers;
+    for (int i = 0; i < call_count; i++) {
+        callers.emplace_back([&, i]() {
+            results[i] = run_call(path, request_header(8000, R"({"systemInstruction": "test"})"), SAMPLES);
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+
+    // 400 ms of 24 kHz model audio per call
+    const std::size_t TURN_BYTES = 24000 * 2 * 400 / 1000;
+    bool all_ok = true;
+    for (const CallResult& result : results) {
+        all_ok &= result.connected && result.status == 0 && result.output_rate == 24000 &&
+                  result.pcm_bytes >= TURN_BYTES * 9 / 10;
+    }
+    ok &= expect(all_ok, std::to_string(call_count) + " calls bridged with model audio");
+
+    PcmGateway::Stats stats = gateway.get_stats();
+    ok &= expect(stats.uplink_bytes == static_cast<uint64_t>(call_count) * SAMPLES * sizeof(int16_t),
+                 "every uplink byte forwarded");
+    ok &= expect(stats.downlink_dropped_chunks == 0, "no downlink audio dropped");
+
+    // Protocol errors are answered with a status before closing
+    CallResult bad = run_call(path, std::string(gateway_protocol::HEADER_SIZE, 'x'), 0);
+    ok &= expect(bad.status == static_cast<int>(gateway_protocol::Status::BadHeader) && bad.pcm_bytes == 0,
+                 "bad header rejected");
+    CallResult bad_config = run_call(path, request_header(16000, "{not json"), 0);
+    ok &= expect(bad_config.status == static_cast<int>(gateway_protocol::Status::BadConfig), "bad config rejected");
+
+    // Upstream that accepts TCP but never answers the handshake: the connects wait on the io
+    // threads without occupying them, so a normal call still goes through, then time out
+    net::ip::tcp::acceptor stalled_upstream(io_context, net::ip::tcp::endpoint(net::ip::make_address("127.0.0.1"), 0));
+    const std::string stalled_path = path + ".stalled";
+    PcmGatewayOptions stalled_options = options;
+    stalled_options.socket_path = stalled_path;
+    stalled_options.endpoint.host = "127.0.0.1";
+    stalled_options.endpoint.port = std::to_string(stalled_upstream.local_endpoint().port());
+    stalled_options.endpoint.use_tls = false;
+    stalled_options.setup_timeout = std::chrono::milliseconds(1500);
+    PcmGateway stalled_gateway(io_context, stalled_options);
+    stalled_gateway.start();
+    std::vector<CallResult> stalled(threads.size() + 1);
+    std::vector<std::thread> stalled_callers;
+    for (std::size_t i = 0; i < stalled.size(); i++) {
+        stalled_callers.emplace_back([&, i]() { stalled[i] = run_call(stalled_path, request_header(16000, ""), 0); });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CallResult during = run_call(path, request_header(8000, ""), SAMPLES);
+    for (auto& caller : stalled_callers) {
+        caller.join();
+    }
+    ok &= expect(during.status == 0 && during.pcm_bytes >= TURN_BYTES * 9 / 10, "call bridged while handshakes stall");
+    bool timed_out = true;
+    for (const CallResult& result : stalled) {
+        timed_out &= result.status == static_cast<int>(gateway_protocol::Status::SetupTimeout);
+    }
+    ok &= expect(timed_out, "stalled handshakes end with a setup timeout");
+
+    // Nothing listening upstream
+    const std::string refused_path = path + ".refused";
+    PcmGatewayOptions refused_options = stalled_options;
+    refused_options.socket_path = refused_path;
+    refused_options.endpoint.port = "1";
+    PcmGateway refused_gateway(io_context, refused_options);
+    refused_gateway.start();
+    CallResult refused = run_call(refused_path, request_header(16000, ""), 0);
+    ok &= expect(refused.status == static_cast<int>(gateway_protocol::Status::UpstreamFailed), "refused upstream reported");
+
+    // A second call beyond max_calls is refused while the first one is open
+    net::io_context client_io;
+    local_socket holder(client_io);
+    holder.connect(net::local::stream_protocol::endpoint(busy_path));
+    net::write(holder, net::buffer(request_header(16000, "")));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CallResult busy = run_call(busy_path, request_header(16000, ""), 0);
+    ok &= expect(busy.status == static_cast<int>(gateway_protocol::Status::Busy), "call over the limit refused");
+    holder.close();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ok &= expect(gateway.get_stats().active_calls == 0, "finished calls released");
+
+    gateway.stop();
+    busy_gateway.stop();
+    stalled_gateway.stop();
+    refused_gateway.stop();
+    ok &= expect(gateway.wait_for_calls(std::chrono::seconds(2)) && busy_gateway.wait_for_calls(std::chrono::seconds(2)) &&
+                 stalled_gateway.wait_for_calls(std::chrono::seconds(2)), "calls drained before the io threads stop");
+    ok &= expect(!std::filesystem::exists(path), "socket file removed on stop");
+
+    work.reset();
+    io_context.stop();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
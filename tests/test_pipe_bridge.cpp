@@ -0,0 +1,183 @@
+#include "pipe_bridge.h"
+#include "mock_gemini_server.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+// Run one bridge to completion on the calling thread, like run_pipe() does
+PipeBridge::Stats run_bridge(const PipeOptions& options, bool& succeeded) {
+    net::io_context io_context;
+    auto bridge = std::make_shared<PipeBridge>(io_context, options, nullptr);
+    bridge->start();
+    while (!bridge->finished() && io_context.run_one()) {
+    }
+    io_context.run();
+    succeeded = bridge->succeeded();
+    return bridge->get_stats();
+}
+
+void write_pcm(int fd, std::size_t samples) {
+    std::vector<int16_t> pcm(samples, 1000);
+    const char* data = reinterpret_cast<const char*>(pcm.data());
+    std::size_t size = pcm.size() * sizeof(int16_t);
+    // Small writes, so the bridge sees partial chunks
+    for (std::size_t offset = 0; offset < size;) {
+        ssize_t n = ::write(fd, data + offset, std::min<std::size_t>(size - offset, 1001));
+        if (n <= 0) {
+            break;
+        }
+        offset += static_cast<std::size_t>(n);
+    }
+}
+
+int main() {
+    std::cout << "=== Pipe Bridge Test ===" << std::endl;
+    bool ok = true;
+
+    MockServerOptions mock_options;
+    mock_options.turn_trigger_chunks = 2;
+    mock_options.response_delay = std::chrono::milliseconds(50);
+    mock_options.turn_duration = std::chrono::milliseconds(400);
+
+    net::io_context server_io;
+    MockGeminiServer mock_server(server_io, mock_options);
+    if (!mock_server.start()) {
+        return 1;
+    }
+    std::thread server_thread([&server_io]() { server_io.run(); });
+
+    PipeOptions options;
+    options.endpoint = mock_server.endpoint();
+    options.setup_message = R"({"setup":{}})";
+    options.speed = 0;
+    options.drain_timeout = std::chrono::seconds(5);
+
+    // 400 ms of 24 kHz model audio
+    const std::size_t TURN_BYTES = 24000 * 2 * 400 / 1000;
+
+    // Pipes: the descriptors are polled asynchronously
+    {
+        int in_pipe[2];
+        int out_pipe[2];
+        if (::pipe(in_pipe) != 0 || ::pipe(out_pipe) != 0) {
+            return 1;
+        }
+        const std::size_t SAMPLES = 16000 + 123;  // Not a whole number of chunks
+        std::thread writer([&]() {
+            write_pcm(in_pipe[1], SAMPLES);
+            ::close(in_pipe[1]);
+        });
+        std::size_t output_bytes = 0;
+        std::thread reader([&]() {
+            char buffer[4096];
+            ssize_t n;
+            while ((n = ::read(out_pipe[0], buffer, sizeof(buffer))) > 0) {
+                output_bytes += static_cast<std::size_t>(n);
+            }
+        });
+
+        PipeOptions pipe_options = options;
+        pipe_options.input_fd = in_pipe[0];
+        pipe_options.output_fd = out_pipe[1];
+        bool succeeded = false;
+        PipeBridge::Stats stats = run_bridge(pipe_options, succeeded);
+        bool blocking = (::fcntl(in_pipe[0], F_GETFL) & O_NONBLOCK) == 0 && (::fcntl(out_pipe[1], F_GETFL) & O_NONBLOCK) == 0;
+        ::close(in_pipe[0]);
+        ::close(out_pipe[1]);
+        writer.join();
+        reader.join();
+        ::close(out_pipe[0]);
+
+        ok &= expect(succeeded, "pipe run succeeded");
+        ok &= expect(stats.uplink_bytes == SAMPLES * sizeof(int16_t), "every input byte sent");
+        ok &= expect(stats.turns >= 1, "model turn completed");
+        ok &= expect(output_bytes >= TURN_BYTES * 9 / 10 && output_bytes == stats.downlink_bytes,
+                     "model audio written to the output pipe");
+        ok &= expect(blocking, "input and output left blocking after the run");
+    }
+
+    // Regular files cannot be polled and fall back to synchronous I/O
+    {
+        auto directory = std::filesystem::temp_directory_path();
+        std::string input_path = (directory / ("gemini_pipe_in_" + std::to_string(::getpid()) + ".raw")).string();
+        std::string output_path = (directory / ("gemini_pipe_out_" + std::to_string(::getpid()) + ".raw")).string();
+        const std::size_t SAMPLES = 16000 * 5;  // 5 s of audio
+        int input_fd = ::open(input_path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0600);
+        write_pcm(input_fd, SAMPLES);
+        ::lseek(input_fd, 0, SEEK_SET);
+        int output_fd = ::open(output_path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0600);
+
+        PipeOptions file_options = options;
+        file_options.input_fd = input_fd;
+        file_options.output_fd = output_fd;
+        bool succeeded = false;
+        PipeBridge::Stats stats = run_bridge(file_options, succeeded);
+        ::close(input_fd);
+        ::close(output_fd);
+
+        ok &= expect(succeeded, "file run succeeded");
+        ok &= expect(stats.uplink_bytes == SAMPLES * sizeof(int16_t), "whole input file sent");
+        ok &= expect(stats.elapsed_seconds < 5.0, "unpaced file input runs faster than realtime");
+        ok &= expect(std::filesystem::file_size(output_path) == stats.downlink_bytes && stats.downlink_bytes > 0,
+                     "model audio written to the output file");
+        std::remove(input_path.c_str());
+        std::remove(output_path.c_str());
+    }
+
+    // Nothing listening: the failed connect ends the run without hanging
+    {
+        PipeOptions dead_options = options;
+        dead_options.endpoint.port = "1";
+        bool succeeded = true;
+        run_bridge(dead_options, succeeded);
+        ok &= expect(!succeeded, "connection failure reported");
+    }
+
+    // Upstream that accepts TCP but never answers the handshake: stop() ends the run at once
+    {
+        net::io_context stalled_io;
+        net::ip::tcp::acceptor stalled_upstream(stalled_io, net::ip::tcp::endpoint(net::ip::make_address("127.0.0.1"), 0));
+        int in_pipe[2];
+        int out_pipe[2];
+        if (::pipe(in_pipe) != 0 || ::pipe(out_pipe) != 0) {
+            return 1;
+        }
+        PipeOptions stalled_options = options;
+        stalled_options.endpoint.host = "127.0.0.1";
+        stalled_options.endpoint.port = std::to_string(stalled_upstream.local_endpoint().port());
+        stalled_options.endpoint.use_tls = false;
+        stalled_options.input_fd = in_pipe[0];
+        stalled_options.output_fd = out_pipe[1];
+
+        net::io_context io_context;
+        auto bridge = std::make_shared<PipeBridge>(io_context, stalled_options, nullptr);
+        auto begin = std::chrono::steady_clock::now();
+        bridge->start();
+        net::steady_timer stop_timer(io_context, std::chrono::milliseconds(200));
+        stop_timer.async_wait([bridge](beast::error_code) { bridge->stop(); });
+        while (!bridge->finished() && io_context.run_one()) {
+        }
+        io_context.run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        for (int fd : {in_pipe[0], in_pipe[1], out_pipe[0], out_pipe[1]}) {
+            ::close(fd);
+        }
+        ok &= expect(!bridge->succeeded() && seconds < 2.0, "stop() ends a stalled handshake");
+    }
+
+    mock_server.stop();
+    server_io.stop();
+    server_thread.join();
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+#include "session_pool.h"
+#include "pcm_gateway.h"
+#include "message_handler.h"
+#include "mock_gemini_server.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+using local_socket = net::local::stream_protocol::socket;
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+bool wait_until(const std::function<bool()>& condition, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+// One gateway call: header, 0.5 s of 16 kHz PCM, half-close, read until EOF
+std::pair<int, std::size_t> gateway_call(const std::string& path, const std::string& config) {
+    net::io_context io;
+    local_socket socket(io);
+    beast::error_code ec;
+    socket.connect(net::local::stream_protocol::endpoint(path), ec);
+    if (ec) {
+        return {-1, 0};
+    }
+    std::string header(gateway_protocol::HEADER_SIZE, '\0');
+    std::copy(std::begin(gateway_protocol::MAGIC), std::end(gateway_protocol::MAGIC), header.begin());
+    header[4] = static_cast<char>(gateway_protocol::VERSION);
+    header[8] = static_cast<char>(16000 & 0xFF);
+    header[9] = static_cast<char>(16000 >> 8);
+    header[12] = static_cast<char>(config.size());
+    net::write(socket, net::buffer(header + config), ec);
+    std::vector<int16_t> pcm(8000, 1000);
+    net::write(socket, net::buffer(pcm.data(), pcm.size() * sizeof(int16_t)), ec);
+    socket.shutdown(local_socket::shutdown_send, ec);
+
+    uint8_t reply[gateway_protocol::HEADER_SIZE];
+    if (net::read(socket, net::buffer(reply), ec) != sizeof(reply)) {
+        return {-1, 0};
+    }
+    std::size_t pcm_bytes = 0;
+    char buffer[8192];
+    while (!ec) {
+        pcm_bytes += socket.read_some(net::buffer(buffer), ec);
+    }
+    return {reply[5], pcm_bytes};
+}
+
+int main() {
+    std::cout << "=== Session Pool Test ===" << std::endl;
+    bool ok = true;
+
+    MockServerOptions mock_options;
+    mock_options.turn_trigger_chunks = 2;
+    mock_options.response_delay = std::chrono::milliseconds(20);
+    mock_options.turn_duration = std::chrono::milliseconds(300);
+
+    net::io_context io_context(4);
+    MockGeminiServer mock_server(io_context, mock_options);
+    if (!mock_server.start()) {
+        return 1;
+    }
+    auto work = net::make_work_guard(io_context);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&io_context]() { io_context.run(); });
+    }
+
+    SessionPoolOptions options;
+    options.endpoint = mock_server.endpoint();
+    options.setup_message = MessageHandler::create_setup_message();
+    options.size = 3;
+
+    std::vector<std::shared_ptr<WebSocketClient>> taken;
+    {
+        SessionPool pool(io_context, options);
+        pool.start();
+        ok &= expect(wait_until([&]() { return pool.get_stats().idle == 3; }, std::chrono::seconds(5)),
+                     "pool filled with set-up sessions");
+
+        // Hits hand over connected sessions without any network round trip
+        for (int i = 0; i < 3; i++) {
+            if (auto client = pool.acquire()) {
+                taken.push_back(client);
+            }
+        }
+        bool connected = taken.size() == 3;
+        for (auto& client : taken) {
+            connected &= client->is_connected();
+        }
+        ok &= expect(connected, "three warm sessions handed out");
+        ok &= expect(pool.pickup_latency().percentile(99) < 1000000, "pickup under 1 ms");
+
+        // The next call finds the pool empty while it refills
+        ok &= expect(!pool.acquire(), "empty pool reports a miss");
+        SessionPool::Stats stats = pool.get_stats();
+        ok &= expect(stats.hits == 3 && stats.misses == 1 && stats.hit_rate == 0.75, "hit rate counted");
+        ok &= expect(wait_until([&]() { return pool.get_stats().idle == 3; }, std::chrono::seconds(5)),
+                     "pool refilled in the background");
+
+        // A taken session is already set up: audio goes straight out and the model answers
+        // Shared, since the callback outlives this block on the still-open client
+        auto answered = std::make_shared<std::promise<void>>();
+        auto answered_once = std::make_shared<std::atomic<bool>>(false);
+        auto client = taken.front();
+        net::dispatch(client->get_executor(), [client, answered, answered_once]() {
+            client->set_message_view_callback([answered, answered_once](std::string_view message) {
+                std::vector<int16_t> audio;
+                if (MessageHandler::extract_audio_from_response(message, audio) && !answered_once->exchange(true)) {
+                    answered->set_value();
+                }
+            });
+            std::vector<int16_t> chunk(1600, 500);
+            for (int i = 0; i < 3; i++) {
+                client->send(MessageHandler::create_audio_input_message(chunk));
+            }
+        });
+        ok &= expect(answered->get_future().wait_for(std::chrono::seconds(3)) == std::future_status::ready,
+                     "warm session streams without a new setup");
+
+        pool.stop();
+        ok &= expect(pool.get_stats().idle == 0, "stop closes idle sessions");
+    }
+
+    // Idle sessions are recycled before max_idle
+    {
+        SessionPoolOptions short_options = options;
+        short_options.size = 1;
+        short_options.max_idle = std::chrono::milliseconds(200);
+        SessionPool pool(io_context, short_options);
+        pool.start();
+        ok &= expect(wait_until([&]() {
+            SessionPool::Stats stats = pool.get_stats();
+            return stats.retired >= 1 && stats.opened >= 2;
+        }, std::chrono::seconds(5)), "expired idle session replaced");
+        pool.stop();
+    }
+
+    // An unreachable endpoint counts failures and never hands anything out
+    {
+        SessionPoolOptions dead_options = options;
+        dead_options.endpoint.port = "1";
+        dead_options.size = 1;
+        SessionPool pool(io_context, dead_options);
+        pool.start();
+        ok &= expect(wait_until([&]() { return pool.get_stats().failed >= 1; }, std::chrono::seconds(5)) &&
+                     !pool.acquire(), "connection failures counted");
+        pool.stop();
+    }
+
+    // The gateway hands warm sessions to calls with the default session config
+    {
+        const std::string path = (std::filesystem::temp_directory_path() /
+                                  ("gemini_pool_test_" + std::to_string(::getpid()) + ".sock")).string();
+        PcmGatewayOptions gateway_options;
+        gateway_options.socket_path = path;
+        gateway_options.endpoint = mock_server.endpoint();
+        gateway_options.warm_sessions = 2;
+        gateway_options.drain_timeout = std::chrono::seconds(5);
+        PcmGateway gateway(io_context, gateway_options);
+        gateway.start();
+        ok &= expect(wait_until([&]() { return gateway.get_stats().pool.idle == 2; }, std::chrono::seconds(5)),
+                     "gateway pool filled");
+
+        auto warm = gateway_call(path, "");
+        ok &= expect(warm.first == 0 && warm.second > 0 && gateway.get_stats().pool.hits == 1,
+                     "call bridged over a warm session");
+        auto custom = gateway_call(path, R"({"temperature": 0.5})");
+        ok &= expect(custom.first == 0 && custom.second > 0 && gateway.get_stats().pool.hits == 1,
+                     "call with its own config connects cold");
+        gateway.stop();
+    }
+
+    for (auto& client : taken) {
+        net::dispatch(client->get_executor(), [client]() { client->close(); });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    mock_server.stop();
+    work.reset();
+    io_context.stop();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include "websocket_client.h"
+#include "message_handler.h"
+#include "mock_gemini_server.h"
+#include "session_recorder.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <thread>
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+int main() {
+    std::cout << "=== Session Record/Replay Test ===" << std::endl;
+    bool ok = true;
+    const std::string path = (std::filesystem::temp_directory_path() /
+                              ("gemini_replay_test_" + std::to_string(::getpid()) + ".rec")).string();
+
+    // Record one short turn against the in-process mock server
+    net::io_context io_context;
+    MockServerOptions mock_options;
+    mock_options.turn_trigger_chunks = 0;
+    mock_options.response_delay = std::chrono::milliseconds(50);
+    mock_options.turn_duration = std::chrono::milliseconds(400);
+    MockGeminiServer mock_server(io_context, mock_options);
+    if (!mock_server.start()) {
+        return 1;
+    }
+
+    auto work = net::make_work_guard(io_context);
+    std::thread io_thread([&]() { io_context.run(); });
+
+    auto recorder = std::make_shared<SessionRecorder>();
+    if (!recorder->open(path)) {
+        return 1;
+    }
+
+    WebSocketClient client(io_context, mock_server.endpoint());
+    client.set_recorder(recorder);
+    std::promise<void> turn_done;
+    std::atomic<bool> done_signalled(false);
+    client.set_message_view_callback([&](std::string_view message) {
+        if (MessageHandler::is_turn_complete(message) && !done_signalled.exchange(true)) {
+            turn_done.set_value();
+        }
+    });
+
+    bool recorded = client.connect();
+    if (recorded) {
+        client.send(MessageHandler::create_setup_message());
+        client.async_receive();
+        recorded = turn_done.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+    }
+    client.close();
+    recorder->close();
+    mock_server.stop();
+    work.reset();
+    io_context.stop();
+    io_thread.join();
+    ok &= expect(recorded, "recorded a full turn from the mock server");
+
+    // The log holds both directions in order
+    SessionReplayer replayer;
+    ok &= expect(replayer.load(path), "log loads");
+    const auto& frames = replayer.frames();
+    std::size_t inbound = 0;
+    bool ordered = true;
+    for (std::size_t i = 0; i < frames.size(); i++) {
+        inbound += frames[i].direction == RecordedFrame::Direction::Inbound;
+        ordered &= i == 0 || frames[i].timestamp_ns >= frames[i - 1].timestamp_ns;
+    }
+    ok &= expect(!frames.empty() && frames[0].direction == RecordedFrame::Direction::Outbound &&
+                 frames[0].payload.find("\"setup\"") != std::string::npos, "first frame is the outbound setup");
+    ok &= expect(inbound > 5 && MessageHandler::is_setup_complete(frames[1].payload), "inbound frames recorded");
+    ok &= expect(ordered, "timestamps are monotonic");
+    ok &= expect(frames.size() == recorder->frame_count(), "frame count matches");
+
+    // Maximum speed delivers every inbound frame unchanged without waiting
+    std::size_t seen = 0;
+    bool identical = true;
+    auto start = std::chrono::steady_clock::now();
+    std::size_t replayed = replayer.replay(0, [&](std::string_view payload) {
+        while (frames[seen].direction != RecordedFrame::Direction::Inbound) {
+            seen++;
+        }
+        identical &= payload == frames[seen++].payload;
+    });
+    double fast_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ok &= expect(replayed == inbound && identical, "max speed replays every inbound frame");
+    ok &= expect(fast_ms < 100.0, "max speed does not wait");
+
+    // Scaled speed follows the recorded timeline
+    double span_ms = frames.back().timestamp_ns / 1e6;
+    start = std::chrono::steady_clock::now();
+    replayer.replay(2.0, [](std::string_view) {});
+    double scaled_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ok &= expect(scaled_ms >= span_ms / 2.0 * 0.9 && scaled_ms < span_ms / 2.0 + 200.0, "2x speed halves the timeline");
+
+    // Stop request interrupts a replay
+    std::size_t stopped = replayer.replay(1.0, [](std::string_view) {}, []() { return false; });
+    ok &= expect(stopped == 0, "keep_running stops the replay");
+
+    // A recording cut short still loads up to the last whole frame
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+    SessionReplayer truncated;
+    ok &= expect(truncated.load(path) && truncated.frames().size() == frames.size() - 1, "truncated log loads");
+
+    {
+        std::ofstream bad(path, std::ios::binary | std::ios::trunc);
+        bad << "not a recording";
+    }
+    SessionReplayer invalid;
+    ok &= expect(!invalid.load(path), "invalid log rejected");
+    std::remove(path.c_str());
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include "session_manager.h"
+#include "message_handler.h"
+#include "mock_gemini_server.h"
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== Multi-Session Soak Test ===" << std::endl;
+    
+    int session_count = argc > 1 ? std::atoi(argv[1]) : 32;
+    int duration_seconds = argc > 2 ? std::atoi(argv[2]) : 5;
+    
+    // Local mock endpoint on its own thread
+    MockServerOptions server_options;
+    server_options.turn_trigger_chunks = 5;
+    server_options.response_delay = std::chrono::milliseconds(100);
+    server_options.turn_duration = std::chrono::milliseconds(1000);
+    
+    net::io_context server_io;
+    MockGeminiServer server(server_io, server_options);
+    if (!server.start()) {
+        return 1;
+    }
+    std::thread server_thread([&server_io]() {
+        server_io.run();
+    });
+    
+    SessionOptions options;
+    options.endpoint = server.endpoint();
+    options.setup_message = MessageHandler::create_setup_message();
+    options.chunk_samples = 1600;
+    options.chunk_interval = std::chrono::milliseconds(100);
+    
+    SessionManager manager;
+    for (int i = 0; i < session_count; i++) {
+        manager.add_session(options);
+    }
+    
+    std::cout << "Running " << session_count << " sessions for " << duration_seconds
+              << "s on " << manager.thread_count() << " threads..." << std::endl;
+    manager.start();
+    
+    for (int i = 0; i < duration_seconds; i++) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        manager.print_report(std::cout, false);
+    }
+    
+    SessionManager::Totals totals = manager.get_totals();
+    manager.print_report(std::cout);
+    manager.stop();
+    server_io.stop();
+    server_thread.join();
+    
+    MockGeminiServer::Stats server_stats = server.get_stats();
+    std::cout << "Server: " << server_stats.connections << " connections, "
+              << server_stats.turns_completed << " turns" << std::endl;
+    
+    // Every session must have completed setup and received model audio
+    bool ok = totals.ready == static_cast<std::size_t>(session_count) && totals.errors == 0;
+    for (const auto& session : manager.sessions()) {
+        if (session->get_stats().audio_samples_received == 0) {
+            std::cerr << "Session " << session->id() << " received no audio" << std::endl;
+            ok = false;
+        }
+    }
+    
+    // Turn latency is measured from the end of each user turn, so a response delay longer
+    // than the chunk interval shows up in full
+    MockServerOptions slow_options;
+    slow_options.turn_trigger_chunks = 3;
+    slow_options.response_delay = std::chrono::milliseconds(400);
+    slow_options.turn_duration = std::chrono::milliseconds(200);
+    
+    net::io_context slow_io;
+    MockGeminiServer slow_server(slow_io, slow_options);
+    if (!slow_server.start()) {
+        return 1;
+    }
+    std::thread slow_thread([&slow_io]() {
+        slow_io.run();
+    });
+    
+    SessionOptions turn_options = options;
+    turn_options.endpoint = slow_server.endpoint();
+    turn_options.turn_chunks = 3;
+    SessionManager turn_manager;
+    for (int i = 0; i < 4; i++) {
+        turn_manager.add_session(turn_options);
+    }
+    turn_manager.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+    turn_manager.stop();
+    slow_io.stop();
+    slow_thread.join();
+    
+    for (const auto& session : turn_manager.sessions()) {
+        const Histogram& latency = session->turn_latency_us();
+        std::cout << "Session " << session->id() << " turn latency: n=" << latency.count()
+                  << " p50=" << static_cast<long>(latency.percentile(50.0) / 1000) << " ms" << std::endl;
+        if (latency.count() < 2 || latency.percentile(50.0) < 400000 || latency.percentile(50.0) > 600000) {
+            std::cerr << "Session " << session->id() << " turn latency does not reflect the 400 ms response delay" << std::endl;
+            ok = false;
+        }
+    }
+    
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+#include "thread_placement.h"
+#include "config.h"
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+// Each rule gets a fresh thread so earlier placements do not leak into later checks
+template <typename F>
+void on_new_thread(F&& f) {
+    std::thread thread(std::forward<F>(f));
+    thread.join();
+}
+
+std::vector<int> allowed_cpus() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    std::vector<int> cpus;
+    pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+int main() {
+    std::cout << "=== Thread Placement Test ===" << std::endl;
+    bool ok = true;
+    ThreadPlacement& placement = thread_placement();
+
+    // --- Validation ---
+    {
+        std::string error;
+        ThreadPlacementConfig config;
+        config.roles["audio"] = ThreadRule{{0}, SchedPolicy::Fifo, 80, 0};
+        ok &= expect(validate_thread_placement(config, error), "valid rule accepted");
+        config.roles["decoder"] = ThreadRule{};
+        ok &= expect(!validate_thread_placement(config, error) && error.find("decoder") != std::string::npos,
+                     "unknown role rejected");
+        config.roles.erase("decoder");
+        config.roles["audio"].priority = 0;
+        ok &= expect(!validate_thread_placement(config, error), "realtime without a priority rejected");
+        config.roles["audio"] = ThreadRule{{-1}, SchedPolicy::Other, 0, 0};
+        ok &= expect(!validate_thread_placement(config, error), "negative CPU rejected");
+        config.roles["audio"] = ThreadRule{{}, SchedPolicy::Other, 0, 25};
+        ok &= expect(!validate_thread_placement(config, error), "nice out of range rejected");
+    }
+
+    // --- Config file ---
+    {
+        const std::string path = (std::filesystem::temp_directory_path() /
+                                  ("gemini_threads_" + std::to_string(::getpid()) + ".json")).string();
+        {
+            std::ofstream file(path);
+            file << R"({"threads": {"lockMemory": true,
+                         "audio": {"cpus": [2, 3], "policy": "fifo", "priority": 80},
+                         "io": {"policy": "rr", "priority": 50},
+                         "video": {"nice": 10}}})";
+        }
+        Config config(path);
+        const ThreadPlacementConfig& threads = config.getThreadPlacement();
+        std::string error;
+        bool parsed = threads.lock_memory && threads.roles.size() == 3 &&
+                      threads.roles.at("audio").cpus == std::vector<int>{2, 3} &&
+                      threads.roles.at("audio").policy == SchedPolicy::Fifo && threads.roles.at("audio").priority == 80 &&
+                      threads.roles.at("io").policy == SchedPolicy::RoundRobin &&
+                      threads.roles.at("video").policy == SchedPolicy::Other && threads.roles.at("video").nice == 10;
+        ok &= expect(parsed && config.validate(error), "threads section parsed");
+
+        {
+            std::ofstream file(path);
+            file << R"({"threads": {"audio": {"policy": "deadline", "priority": 80}}})";
+        }
+        bool rejected = false;
+        try {
+            Config invalid(path);
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        ok &= expect(rejected, "unknown policy rejected");
+        std::filesystem::remove(path);
+        ok &= expect(Config().getThreadPlacement().empty(), "no placement by default");
+    }
+
+    // --- Applying rules; the kernel's answer is reported either way ---
+    const std::vector<int> cpus = allowed_cpus();
+    on_new_thread([&]() {
+        AppliedPlacement applied = placement.apply_rule("video", ThreadRule{{cpus.back()}, SchedPolicy::Other, 0, 5});
+        ok &= expect(applied.cpus == std::vector<int>{cpus.back()} && applied.note.empty(), "thread pinned to one CPU");
+        ok &= expect(applied.policy == SCHED_OTHER && applied.nice == 5, "nice applied to the thread only");
+        ok &= expect(applied.describe().find("video (tid ") == 0 &&
+                     applied.describe().find("SCHED_OTHER nice 5") != std::string::npos, "state described for the log");
+    });
+    ok &= expect(allowed_cpus() == cpus, "other threads keep their CPUs");
+
+    on_new_thread([&]() {
+        AppliedPlacement applied = placement.apply_rule("audio", ThreadRule{{}, SchedPolicy::Fifo, 10, 3});
+        bool realtime = applied.policy == SCHED_FIFO && applied.priority >= 1 && applied.priority <= 10;
+        bool fell_back = applied.policy == SCHED_OTHER && applied.nice == 3 &&
+                         applied.note.find("refused") != std::string::npos;
+        std::cout << "         " << applied.describe() << std::endl;
+        ok &= expect(realtime || fell_back, "SCHED_FIFO applied, or refused with a nice fallback");
+    });
+
+    on_new_thread([&]() {
+        AppliedPlacement applied = placement.apply_rule("io", ThreadRule{{CPU_SETSIZE - 1}, SchedPolicy::Other, 0, 0});
+        ok &= expect(applied.cpus == cpus && applied.note.find("refused") != std::string::npos,
+                     "missing CPU reported and affinity left unchanged");
+    });
+
+    // --- apply() uses the configured role once per thread ---
+    {
+        ThreadPlacementConfig config;
+        config.roles["transcript"] = ThreadRule{{}, SchedPolicy::Other, 0, 2};
+        placement.configure(config);
+        on_new_thread([&]() {
+            placement.apply("transcript");
+            placement.apply("transcript");
+        });
+        on_new_thread([&]() { placement.apply("playback"); });
+        std::vector<AppliedPlacement> applied = placement.applied();
+        ok &= expect(applied.size() == 1 && applied[0].role == "transcript" && applied[0].nice == 2,
+                     "configured role applied once, unconfigured role ignored");
+        placement.configure(ThreadPlacementConfig());
+    }
+
+    // --- apply_in_callback() records; report_applied() logs later from another thread ---
+    {
+        ThreadPlacementConfig config;
+        config.roles["audio"] = ThreadRule{{}, SchedPolicy::Other, 0, 4};
+        placement.configure(config);
+        on_new_thread([&]() {
+            placement.apply_in_callback("audio");
+            placement.apply_in_callback("audio");
+        });
+        bool deferred = placement.applied().size() == 1;
+        std::ostringstream log;
+        placement.report_applied(log);
+        std::vector<AppliedPlacement> applied = placement.applied();
+        ok &= expect(deferred && applied.size() == 2 && applied[1].role == "audio" && applied[1].nice == 4,
+                     "callback placement applied once and recorded until reported");
+        ok &= expect(log.str().find("[Sched] audio (tid ") == 0, "callback placement logged by report_applied");
+        std::ostringstream again;
+        placement.report_applied(again);
+        ok &= expect(again.str().empty(), "callback placement reported once");
+        placement.configure(ThreadPlacementConfig());
+    }
+
+    // --- Memory locking (may be refused without CAP_IPC_LOCK) ---
+    if (placement.lock_memory()) {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        long locked = 0;
+        while (std::getline(status, line)) {
+            if (line.rfind("VmLck:", 0) == 0) {
+                locked = std::atol(line.c_str() + 6);
+            }
+        }
+        ok &= expect(locked > 0, "memory locked");
+        ::munlockall();
+    } else {
+        ok &= expect(true, "mlockall refused, continuing unlocked");
+    }
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
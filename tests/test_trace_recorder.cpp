@@ -0,0 +1,104 @@
+#include "trace_recorder.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+json dump(double last_seconds) {
+    std::ostringstream out;
+    trace_recorder().dump_chrome_json(out, last_seconds);
+    return json::parse(out.str());
+}
+
+int main() {
+    std::cout << "=== Trace Recorder Test ===" << std::endl;
+    bool ok = true;
+
+    // Nothing is recorded while disabled
+    {
+        TraceScope scope("disabled_scope");
+        trace_recorder().counter("disabled_counter", 1);
+    }
+    ok &= expect(dump(0)["traceEvents"].empty(), "disabled recorder records nothing");
+
+    trace_recorder().enable(256);
+
+    // Writers on several threads, each with its own ring
+    const int THREADS = 4;
+    const int SCOPES = 1000;   // Far more than the ring holds
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.emplace_back([t]() {
+            trace_recorder().set_thread_name(t == 0 ? "producer" : "worker");
+            for (int i = 0; i < SCOPES; i++) {
+                TraceScope scope("work", i + 1);
+                trace_recorder().counter("depth", i);
+                if (t == 0) {
+                    trace_recorder().flow_start("chunk", i + 1);
+                }
+                if (t == 1) {
+                    trace_recorder().flow_end("chunk", i + 1);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    json trace = dump(0);
+    const json& events = trace["traceEvents"];
+    std::map<int, int> per_thread;
+    std::map<int, int> depth;
+    std::multiset<std::string> names;
+    bool balanced = true;
+    bool flows_have_ids = true;
+    for (const json& event : events) {
+        std::string ph = event["ph"];
+        int tid = event["tid"];
+        if (ph == "M") {
+            names.insert(event["args"]["name"].get<std::string>());
+            continue;
+        }
+        per_thread[tid]++;
+        if (ph == "B") depth[tid]++;
+        if (ph == "E" && --depth[tid] < 0) balanced = false;
+        if ((ph == "s" || ph == "f") && !event.contains("id")) flows_have_ids = false;
+    }
+
+    ok &= expect(per_thread.size() == THREADS, "one track per thread");
+    bool bounded = true;
+    for (auto& [tid, count] : per_thread) {
+        bounded &= count <= 256;
+    }
+    ok &= expect(bounded, "ring keeps at most its capacity");
+    ok &= expect(balanced, "no End without a Begin after wraparound");
+    ok &= expect(flows_have_ids, "flow events carry ids");
+    ok &= expect(names.count("producer") == 1 && names.count("worker") == 3, "thread names exported");
+
+    // The window drops events older than last_seconds
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    trace_recorder().instant("recent");
+    json recent = dump(0.1);
+    int recent_events = 0;
+    for (const json& event : recent["traceEvents"]) {
+        if (event["ph"] != "M") {
+            recent_events++;
+            ok &= expect(event["name"] == "recent", "only recent events in window");
+        }
+    }
+    ok &= expect(recent_events == 1, "time window applied");
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#include "transcript_sink.h"
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+bool expect(bool condition, const std::string& what) {
+    std::cout << (condition ? "  OK   " : "  FAIL ") << what << std::endl;
+    return condition;
+}
+
+// Collects entries on the writer thread for inspection after stop()
+class CaptureOutput : public TranscriptOutput {
+public:
+    explicit CaptureOutput(std::vector<TranscriptEntry>& entries, int& flushes) : entries_(entries), flushes_(flushes) {}
+    void write(const TranscriptEntry& entry) override { entries_.push_back(entry); }
+    void flush() override { flushes_++; }
+
+private:
+    std::vector<TranscriptEntry>& entries_;
+    int& flushes_;
+};
+
+int main() {
+    std::cout << "=== Transcript Sink Test ===" << std::endl;
+    bool ok = true;
+
+    // Segmenter: sentences, trailing punctuation and closers
+    SentenceSegmenter segmenter;
+    std::vector<std::string> sentences;
+    segmenter.append(" Hello there. How are", sentences);
+    ok &= expect(sentences == std::vector<std::string>{"Hello there."}, "first sentence emitted");
+    ok &= expect(segmenter.pending() == " How are", "rest kept pending");
+    sentences.clear();
+    segmenter.append(" you?! Fine...", sentences);
+    ok &= expect(sentences == std::vector<std::string>{"How are you?!"}, "punctuation runs stay together");
+    ok &= expect(segmenter.pending() == " Fine...", "terminator at the end waits for a possible closer");
+    sentences.clear();
+    segmenter.append(" Bye", sentences);
+    ok &= expect(sentences == std::vector<std::string>{"Fine..."}, "held sentence emitted by the next text");
+
+    sentences.clear();
+    SentenceSegmenter held;
+    held.append("Done!", sentences);
+    held.release(sentences);
+    ok &= expect(sentences == std::vector<std::string>{"Done!"} && held.pending().empty(), "release emits a held sentence");
+    held.append("Not yet", sentences);
+    held.release(sentences);
+    ok &= expect(sentences.size() == 1 && held.pending() == "Not yet", "release keeps unfinished text");
+
+    // Full-width terminators split across messages in the middle of a character
+    const std::string japanese = "こんにちは。「元気？」はい";
+    sentences.clear();
+    SentenceSegmenter split;
+    for (char byte : japanese) {
+        split.append(std::string_view(&byte, 1), sentences);
+    }
+    ok &= expect(sentences.size() == 2 && sentences[0] == "こんにちは。" && sentences[1] == "「元気？」",
+                 "byte-by-byte UTF-8 segmentation");
+    ok &= expect(split.flush() == "はい" && split.pending().empty(), "flush returns the partial sentence");
+
+    // Continuation bytes that resemble ASCII terminators are not split
+    sentences.clear();
+    SentenceSegmenter multibyte;
+    multibyte.append("日本語のテキスト", sentences);
+    ok &= expect(sentences.empty(), "no terminator in plain text");
+
+    // Queue: order preserved across threads, full queue rejects
+    SpscQueue<int> queue(4);
+    ok &= expect(queue.capacity() == 4, "capacity rounded to a power of two");
+    int value = 0;
+    for (int i = 0; i < 4; i++) {
+        int item = i;
+        queue.try_push(std::move(item));
+    }
+    int extra = 99;
+    ok &= expect(!queue.try_push(std::move(extra)), "full queue rejects push");
+    while (queue.try_pop(value)) {
+    }
+
+    const int COUNT = 200000;
+    SpscQueue<int> shared(256);
+    std::thread producer([&]() {
+        for (int i = 0; i < COUNT; i++) {
+            int item = i;
+            while (!shared.try_push(std::move(item))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    bool in_order = true;
+    for (int expected = 0; expected < COUNT;) {
+        if (shared.try_pop(value)) {
+            in_order &= value == expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    ok &= expect(in_order, "cross-thread order preserved");
+
+    // Sink: console and JSONL outputs on the writer thread
+    const std::string path = (std::filesystem::temp_directory_path() /
+                              ("gemini_transcript_test_" + std::to_string(::getpid()) + ".jsonl")).string();
+    std::ostringstream console;
+    std::vector<TranscriptEntry> captured;
+    int flushes = 0;
+    {
+        TranscriptSink sink;
+        sink.add_output(std::make_unique<ConsoleTranscriptOutput>(console));
+        auto jsonl = std::make_unique<JsonlTranscriptOutput>();
+        ok &= expect(jsonl->open(path), "JSONL file created");
+        sink.add_output(std::move(jsonl));
+        sink.add_output(std::make_unique<CaptureOutput>(captured, flushes));
+        sink.start();
+
+        sink.append(TranscriptEntry::Speaker::User, "What time");
+        sink.append(TranscriptEntry::Speaker::User, " is it?");
+        sink.append(TranscriptEntry::Speaker::Model, "It is noon. Anything");
+        sink.end_turn();
+        sink.append(TranscriptEntry::Speaker::Model, "Say \"hi\"\n.");
+        sink.stop();
+        ok &= expect(sink.dropped() == 0 && sink.turn() == 2, "nothing dropped, turn advanced");
+    }
+
+    ok &= expect(captured.size() == 4, "four sentences written");
+    if (captured.size() == 4) {
+        ok &= expect(captured[0].speaker == TranscriptEntry::Speaker::User && captured[0].text == "What time is it?" &&
+                     captured[0].turn == 1, "user sentence in turn 1");
+        ok &= expect(captured[2].text == "Anything" && captured[2].turn == 1, "partial flushed at turn end");
+        ok &= expect(captured[3].turn == 2 && captured[3].timestamp_ms >= captured[0].timestamp_ms,
+                     "next turn numbered and timestamped");
+    }
+    ok &= expect(flushes >= 1, "outputs flushed after draining");
+    ok &= expect(console.str().find("\n You: What time is it?\n") != std::string::npos &&
+                 console.str().find(" AI: It is noon.\n") != std::string::npos, "console format");
+
+    std::ifstream in(path);
+    std::string line;
+    std::vector<nlohmann::json> lines;
+    while (std::getline(in, line)) {
+        lines.push_back(nlohmann::json::parse(line));
+    }
+    ok &= expect(lines.size() == 4 && lines[0]["speaker"] == "user" && lines[1]["speaker"] == "model" &&
+                 lines[3]["text"] == "Say \"hi\"\n." && lines[3]["turn"] == 2, "JSONL lines parse back");
+    std::remove(path.c_str());
+
+    // A full queue drops instead of blocking the caller
+    TranscriptSink unstarted(2);
+    for (int i = 0; i < 5; i++) {
+        unstarted.append(TranscriptEntry::Speaker::Model, "Sentence. ");
+    }
+    ok &= expect(unstarted.dropped() == 3, "overflow counted as dropped");
+
+    std::cout << (ok ? "PASSED" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
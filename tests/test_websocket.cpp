@@ -1,5 +1,6 @@
 #include "websocket_client.h"
 #include "message_handler.h"
+#include "mock_gemini_server.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
@@ -8,14 +9,34 @@
 int main(int argc, char* argv[]) {
     std::cout << "=== WebSocket Communication Test ===" << std::endl;
     
-    const char* env_key = std::getenv("GEMINI_API_KEY");
-    if (!env_key) {
-        std::cerr << "Error: GEMINI_API_KEY environment variable not set" << std::endl;
-        return 1;
-    }
+    // --mock: talk to an in-process mock server instead of the live API
+    bool use_mock = argc > 1 && std::string(argv[1]) == "--mock";
     
     boost::asio::io_context io_context;
-    WebSocketClient ws_client(io_context, env_key);
+    
+    MockServerOptions mock_options;
+    mock_options.turn_trigger_chunks = 0;  // Answer right after setup
+    MockGeminiServer mock_server(io_context, mock_options);
+    
+    WebSocketClient::Endpoint endpoint;
+    if (use_mock) {
+        if (!mock_server.start()) {
+            return 1;
+        }
+        endpoint = mock_server.endpoint();
+        std::cout << "Using mock server on port " << mock_server.port() << std::endl;
+    } else {
+        const char* env_key = std::getenv("GEMINI_API_KEY");
+        if (!env_key) {
+            std::cerr << "Error: GEMINI_API_KEY environment variable not set" << std::endl;
+            std::cerr << "Hint: Run with --mock to use a local mock server" << std::endl;
+            return 1;
+        }
+        endpoint = WebSocketClient::gemini_endpoint(env_key);
+    }
+    
+    WebSocketClient ws_client(io_context, endpoint);
+    bool turn_complete = false;
     
     bool connected = false;
     std::atomic<bool> running(true);
@@ -24,6 +45,7 @@ int main(int argc, char* argv[]) {
         std::cout << "Received: " << message.substr(0, 100) << "..." << std::endl;
         if (MessageHandler::is_turn_complete(message)) {
             std::cout << "Turn Complete received" << std::endl;
+            turn_complete = true;
             running = false;
         }
     });
@@ -34,7 +56,16 @@ int main(int argc, char* argv[]) {
     });
     
     std::cout << "Connecting..." << std::endl;
+    
+    // The mock server needs the io_context running to accept the handshake
+    auto work = boost::asio::make_work_guard(io_context);
+    std::thread io_thread([&]() {
+        io_context.run();
+    });
+    
     if (!ws_client.connect()) {
+        io_context.stop();
+        io_thread.join();
         std::cerr << "Connection failed" << std::endl;
         return 1;
     }
@@ -47,10 +78,6 @@ int main(int argc, char* argv[]) {
     
     ws_client.async_receive();
     
-    std::thread io_thread([&]() {
-        io_context.run();
-    });
-    
     // Wait for 5 seconds or completion
     int timeout = 50;
     while (running && timeout-- > 0) {
@@ -64,5 +91,5 @@ int main(int argc, char* argv[]) {
     io_context.stop();
     if (io_thread.joinable()) io_thread.join();
     
-    return 0;
+    return turn_complete ? 0 : 1;
 }
@@ -0,0 +1,301 @@
+#include "session_manager.h"
+#include "message_handler.h"
+#include "histogram.h"
+#include "config.h"
+#include <nlohmann/json.hpp>
+#include <sys/resource.h>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <csignal>
+#include <cmath>
+#include <cstdlib>
+
+using json = nlohmann::json;
+
+std::atomic<bool> g_running(true);
+
+// Signal handler
+void signal_handler(int signal) {
+    if (signal == SIGINT) {
+        g_running = false;
+    }
+}
+
+// Show help message
+void print_help() {
+    std::cout << "Usage: load-generator [options]\n" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --endpoint URL     ws:// or wss:// endpoint (default: Gemini Live API)" << std::endl;
+    std::cout << "  --api-key KEY      API key for the Gemini endpoint (or GEMINI_API_KEY)" << std::endl;
+    std::cout << "  --config PATH      Config file for the setup message (default: built-in defaults)" << std::endl;
+    std::cout << "  --sessions N       Concurrent sessions (default: 10)" << std::endl;
+    std::cout << "  --duration S       Test duration in seconds (default: 30)" << std::endl;
+    std::cout << "  --speed X          Uplink pace as a multiple of realtime (default: 1.0)" << std::endl;
+    std::cout << "  --chunk-ms MS      Uplink chunk length (default: 100)" << std::endl;
+    std::cout << "  --turn-ms MS       Speech per user turn; the uplink then waits for the answer (default: 1000, 0 streams without turns)" << std::endl;
+    std::cout << "  --input PATH       Raw s16le mono PCM at the config's input rate (default: synthetic tone)" << std::endl;
+    std::cout << "  --threads N        IO threads (default: CPU cores)" << std::endl;
+    std::cout << "  --json PATH        Also write the report as JSON (\"-\" for stdout)" << std::endl;
+    std::cout << "  --help, -h         Show this help message" << std::endl;
+}
+
+// Get option value (returns default_value if not specified)
+std::string get_option(int argc, char* argv[], const std::string& flag, const std::string& default_value) {
+    for (int i = 1; i < argc - 1; i++) {
+        if (argv[i] == flag) {
+            return argv[i + 1];
+        }
+    }
+    return default_value;
+}
+
+// Load raw s16le PCM
+bool load_pcm(const std::string& path, std::vector<int16_t>& samples) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    samples.resize(bytes.size() / 2);
+    for (std::size_t i = 0; i < samples.size(); i++) {
+        samples[i] = static_cast<int16_t>(
+            static_cast<uint8_t>(bytes[2 * i]) | (static_cast<uint8_t>(bytes[2 * i + 1]) << 8));
+    }
+    return !samples.empty();
+}
+
+// Process CPU time (user + system) in seconds
+double process_cpu_seconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+// Percentiles of a microsecond histogram, in milliseconds
+json percentiles_ms(const Histogram& histogram) {
+    return {
+        {"count", histogram.count()},
+        {"mean", histogram.mean() / 1000.0},
+        {"p50", histogram.percentile(50.0) / 1000.0},
+        {"p99", histogram.percentile(99.0) / 1000.0},
+        {"p999", histogram.percentile(99.9) / 1000.0},
+        {"max", histogram.max() / 1000.0}
+    };
+}
+
+void print_percentiles(const std::string& name, const Histogram& histogram) {
+    std::cout << "  " << std::left << std::setw(20) << name << std::right
+              << " n=" << std::setw(6) << histogram.count()
+              << "  p50=" << std::setw(8) << histogram.percentile(50.0) / 1000.0
+              << "  p99=" << std::setw(8) << histogram.percentile(99.0) / 1000.0
+              << "  p999=" << std::setw(8) << histogram.percentile(99.9) / 1000.0
+              << "  max=" << std::setw(8) << histogram.max() / 1000.0 << " ms" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_help();
+            return 0;
+        }
+    }
+
+    std::signal(SIGINT, signal_handler);
+
+    int session_count = std::atoi(get_option(argc, argv, "--sessions", "10").c_str());
+    int duration = std::atoi(get_option(argc, argv, "--duration", "30").c_str());
+    double speed = std::atof(get_option(argc, argv, "--speed", "1.0").c_str());
+    int chunk_ms = std::atoi(get_option(argc, argv, "--chunk-ms", "100").c_str());
+    int turn_ms = std::atoi(get_option(argc, argv, "--turn-ms", "1000").c_str());
+    int threads = std::atoi(get_option(argc, argv, "--threads", "0").c_str());
+    std::string json_path = get_option(argc, argv, "--json", "");
+    if (session_count <= 0 || chunk_ms <= 0 || speed <= 0.0) {
+        std::cerr << "Error: --sessions, --chunk-ms and --speed must be positive" << std::endl;
+        return 1;
+    }
+    if (threads < 0) {
+        std::cerr << "Error: --threads must be 0 (CPU cores) or positive" << std::endl;
+        return 1;
+    }
+    if (turn_ms < 0) {
+        std::cerr << "Error: --turn-ms must be 0 (no turns) or positive" << std::endl;
+        return 1;
+    }
+
+    // Endpoint
+    WebSocketClient::Endpoint endpoint;
+    std::string url = get_option(argc, argv, "--endpoint", "");
+    if (!url.empty()) {
+        if (!WebSocketClient::parse_url(url, endpoint)) {
+            std::cerr << "Error: Invalid endpoint URL: " << url << std::endl;
+            return 1;
+        }
+    } else {
+        const char* env_key = std::getenv("GEMINI_API_KEY");
+        std::string api_key = get_option(argc, argv, "--api-key", env_key ? env_key : "");
+        if (api_key.empty()) {
+            std::cerr << "Error: --endpoint or an API key is required" << std::endl;
+            return 1;
+        }
+        endpoint = WebSocketClient::gemini_endpoint(api_key);
+    }
+
+    // Sample rates and the setup message follow the config
+    std::string config_path = get_option(argc, argv, "--config", "");
+    Config config = config_path.empty() ? Config() : Config(config_path);
+    const int input_rate = config.getInputSampleRate();
+    const int output_rate = config.getOutputSampleRate();
+
+    // Uplink audio shared by all sessions (each keeps its own read position)
+    std::vector<int16_t> input_audio;
+    std::string input_path = get_option(argc, argv, "--input", "");
+    if (!input_path.empty()) {
+        if (!load_pcm(input_path, input_audio)) {
+            std::cerr << "Error: Failed to load PCM input: " << input_path << std::endl;
+            return 1;
+        }
+    } else {
+        input_audio.resize(static_cast<std::size_t>(input_rate));
+        for (std::size_t i = 0; i < input_audio.size(); i++) {
+            input_audio[i] = static_cast<int16_t>(2000.0 * std::sin(2.0 * M_PI * 300.0 * i / input_rate));
+        }
+    }
+
+    SessionOptions options;
+    options.endpoint = endpoint;
+    options.setup_message = MessageHandler::create_setup_message(
+        config.getModelName(),
+        config.isSearchEnabled(),
+        config.getTemperature(),
+        config.getTopP(),
+        config.getTopK(),
+        config.getSystemInstructionText()
+    );
+    options.chunk_samples = static_cast<std::size_t>(input_rate) * chunk_ms / 1000;
+    options.mime_type = "audio/pcm;rate=" + std::to_string(input_rate);
+    options.chunk_interval = std::chrono::milliseconds(
+        std::max<long long>(1, std::llround(chunk_ms / speed)));
+    // Turn response is measured from the last chunk of each user turn
+    options.turn_chunks = turn_ms > 0 ? static_cast<std::size_t>(std::max(1, turn_ms / chunk_ms)) : 0;
+
+    SessionManager manager(static_cast<std::size_t>(threads));
+    for (int i = 0; i < session_count; i++) {
+        Session& session = manager.add_session(options);
+        auto position = std::make_shared<std::size_t>(i * 997 % input_audio.size());
+        session.set_audio_source([&input_audio, position](std::vector<int16_t>& chunk) {
+            for (int16_t& sample : chunk) {
+                sample = input_audio[*position];
+                *position = (*position + 1) % input_audio.size();
+            }
+        });
+    }
+
+    std::cout << "Load test: " << session_count << " sessions, " << duration << "s, uplink "
+              << speed << "x realtime, " << chunk_ms << "ms chunks, "
+              << manager.thread_count() << " IO threads" << std::endl;
+
+    double cpu_start = process_cpu_seconds();
+    auto wall_start = std::chrono::steady_clock::now();
+    manager.start();
+
+    auto deadline = wall_start + std::chrono::seconds(duration);
+    auto next_progress = wall_start + std::chrono::seconds(5);
+    while (g_running && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (std::chrono::steady_clock::now() >= next_progress) {
+            manager.print_report(std::cout, false);
+            next_progress += std::chrono::seconds(5);
+        }
+    }
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    double cpu = process_cpu_seconds() - cpu_start;
+    SessionManager::Totals totals = manager.get_totals();
+
+    // Aggregate latency distributions across sessions
+    Histogram connect_us, setup_us, first_audio_us, turn_latency_us, downlink_gap_us;
+    uint64_t turns = 0;
+    for (const auto& session : manager.sessions()) {
+        Session::Stats stats = session->get_stats();
+        if (stats.connect_ms >= 0) connect_us.record(static_cast<uint64_t>(stats.connect_ms * 1000.0));
+        if (stats.setup_ms >= 0) setup_us.record(static_cast<uint64_t>(stats.setup_ms * 1000.0));
+        if (stats.first_audio_ms >= 0) first_audio_us.record(static_cast<uint64_t>(stats.first_audio_ms * 1000.0));
+        turn_latency_us.merge(session->turn_latency_us());
+        downlink_gap_us.merge(session->downlink_gap_us());
+        turns += stats.turns_completed;
+    }
+
+    manager.stop();
+
+    double downlink_seconds = totals.audio_samples_received / static_cast<double>(output_rate);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\n=== Load Test Report ===" << std::endl;
+    std::cout << "Sessions: " << totals.ready << " ready / " << totals.sessions
+              << " started, errors: " << totals.errors << ", turns: " << turns << std::endl;
+    std::cout << "Latency:" << std::endl;
+    print_percentiles("connect", connect_us);
+    print_percentiles("setup complete", setup_us);
+    print_percentiles("time to first audio", first_audio_us);
+    print_percentiles("turn response", turn_latency_us);
+    print_percentiles("downlink gap", downlink_gap_us);
+    std::cout << "Throughput:" << std::endl;
+    std::cout << "  tx " << totals.messages_sent / wall << " msg/s, "
+              << totals.bytes_sent / wall / 1024.0 << " KB/s" << std::endl;
+    std::cout << "  rx " << totals.messages_received / wall << " msg/s, "
+              << totals.bytes_received / wall / 1024.0 << " KB/s, "
+              << downlink_seconds / wall << "x realtime audio" << std::endl;
+    std::cout << "CPU: " << cpu << "s total, " << 100.0 * cpu / wall / session_count
+              << "% of a core per session" << std::endl;
+
+    if (!json_path.empty()) {
+        json report = {
+            {"sessions", {
+                {"requested", session_count},
+                {"ready", totals.ready},
+                {"errors", totals.errors},
+                {"turns", turns}
+            }},
+            {"config", {
+                {"duration_s", wall},
+                {"speed", speed},
+                {"chunk_ms", chunk_ms},
+                {"turn_ms", turn_ms},
+                {"threads", manager.thread_count()}
+            }},
+            {"latency_ms", {
+                {"connect", percentiles_ms(connect_us)},
+                {"setup_complete", percentiles_ms(setup_us)},
+                {"time_to_first_audio", percentiles_ms(first_audio_us)},
+                {"turn_response", percentiles_ms(turn_latency_us)},
+                {"downlink_gap", percentiles_ms(downlink_gap_us)}
+            }},
+            {"throughput", {
+                {"tx_messages_per_s", totals.messages_sent / wall},
+                {"tx_bytes_per_s", totals.bytes_sent / wall},
+                {"rx_messages_per_s", totals.messages_received / wall},
+                {"rx_bytes_per_s", totals.bytes_received / wall},
+                {"rx_audio_realtime_factor", downlink_seconds / wall}
+            }},
+            {"cpu", {
+                {"total_s", cpu},
+                {"per_session_core_fraction", cpu / wall / session_count}
+            }}
+        };
+
+        if (json_path == "-") {
+            std::cout << report.dump(2) << std::endl;
+        } else {
+            std::ofstream out(json_path);
+            out << report.dump(2) << std::endl;
+            std::cout << "JSON report written to " << json_path << std::endl;
+        }
+    }
+
+    return totals.ready == static_cast<std::size_t>(session_count) ? 0 : 1;
+}
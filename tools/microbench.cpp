@@ -0,0 +1,311 @@
+#include "message_handler.h"
+#include "audio_buffer.h"
+#include "alloc_tracker.h"
+#include "transcript_sink.h"
+#include "json_arena.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Keep the optimizer from discarding a benchmark's result
+template <typename T>
+inline void keep(T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct BenchResult {
+    std::string name;
+    std::size_t payload_bytes = 0;
+    uint64_t iterations = 0;
+    double ns_per_op = 0.0;
+    double bytes_per_sec = 0.0;
+    double allocs_per_op = 0.0;
+};
+
+struct BenchOptions {
+    std::string filter;
+    double min_time_s = 0.2;
+};
+
+// Run body in growing batches until one batch lasts at least min_time_s; report that batch
+template <typename Body>
+bool run_benchmark(const BenchOptions& options, const std::string& name, std::size_t payload_bytes,
+                   Body&& body, std::vector<BenchResult>& results) {
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+        return false;
+    }
+
+    body();  // Warm up caches and lazily initialized state
+
+    uint64_t iterations = 1;
+    while (true) {
+        AllocScope alloc_scope;
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            body();
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t allocations = alloc_scope.allocations();
+
+        if (elapsed >= options.min_time_s || iterations >= (1ull << 32)) {
+            BenchResult result;
+            result.name = name;
+            result.payload_bytes = payload_bytes;
+            result.iterations = iterations;
+            result.ns_per_op = elapsed * 1e9 / iterations;
+            result.bytes_per_sec = payload_bytes * iterations / elapsed;
+            result.allocs_per_op = static_cast<double>(allocations) / iterations;
+            results.push_back(result);
+
+            std::cout << std::left << std::setw(52) << name << std::right
+                      << std::setw(12) << std::fixed << std::setprecision(1) << result.ns_per_op << " ns/op"
+                      << std::setw(10) << std::setprecision(1) << result.bytes_per_sec / (1024.0 * 1024.0) << " MB/s"
+                      << std::setw(8) << std::setprecision(1) << result.allocs_per_op << " allocs/op"
+                      << std::defaultfloat << std::endl;
+            return true;
+        }
+
+        // Aim a little past the target so the next batch is usually the last
+        double scale = elapsed > 0 ? options.min_time_s * 1.4 / elapsed : 100.0;
+        iterations = static_cast<uint64_t>(iterations * std::min(std::max(scale, 2.0), 100.0));
+    }
+}
+
+// Deterministic speech-like test signal: tone plus low-level noise
+std::vector<int16_t> make_audio(std::size_t samples, int sample_rate) {
+    std::vector<int16_t> audio(samples);
+    uint32_t seed = 12345;
+    for (std::size_t i = 0; i < samples; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        double tone = 6000.0 * std::sin(2.0 * M_PI * 220.0 * i / sample_rate);
+        double noise = static_cast<int32_t>(seed >> 16) % 512 - 256;
+        audio[i] = static_cast<int16_t>(tone + noise);
+    }
+    return audio;
+}
+
+// serverContent message carrying one chunk of model audio, as the Live API sends it
+std::string make_audio_response(const std::vector<int16_t>& audio) {
+    json response = {
+        {"serverContent", {
+            {"modelTurn", {
+                {"parts", {{
+                    {"inlineData", {
+                        {"mimeType", "audio/pcm;rate=24000"},
+                        {"data", MessageHandler::base64_encode(MessageHandler::int16_to_uint8(audio))}
+                    }}
+                }}}
+            }}
+        }}
+    };
+    return response.dump();
+}
+
+// Show help message
+void print_help() {
+    std::cout << "Usage: microbench [options]\n" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --filter TEXT      Run only benchmarks whose name contains TEXT" << std::endl;
+    std::cout << "  --min-time MS      Minimum measured time per benchmark (default: 200)" << std::endl;
+    std::cout << "  --json PATH        Also write the results as JSON (\"-\" for stdout)" << std::endl;
+    std::cout << "  --help, -h         Show this help message" << std::endl;
+}
+
+// Get option value (returns default_value if not specified)
+std::string get_option(int argc, char* argv[], const std::string& flag, const std::string& default_value) {
+    for (int i = 1; i < argc - 1; i++) {
+        if (argv[i] == flag) {
+            return argv[i + 1];
+        }
+    }
+    return default_value;
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_help();
+            return 0;
+        }
+    }
+
+    BenchOptions options;
+    options.filter = get_option(argc, argv, "--filter", "");
+    options.min_time_s = std::atof(get_option(argc, argv, "--min-time", "200").c_str()) / 1000.0;
+    std::string json_path = get_option(argc, argv, "--json", "");
+    if (options.min_time_s <= 0) {
+        std::cerr << "Error: --min-time must be positive" << std::endl;
+        return 1;
+    }
+
+#ifndef __OPTIMIZE__
+    std::cerr << "Warning: built without optimization; configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers"
+              << std::endl;
+#endif
+
+    const int INPUT_RATE = 16000;
+    const int OUTPUT_RATE = 24000;
+    const int DURATIONS_MS[] = {20, 100, 1000};
+    const int32_t GAIN_FACTOR = 5;
+    const std::size_t DEVICE_PERIOD = OUTPUT_RATE / 100;  // 10 ms playback callbacks
+
+    std::vector<BenchResult> results;
+
+    for (int ms : DURATIONS_MS) {
+        const std::string suffix = "/" + std::to_string(ms) + "ms";
+
+        // Uplink: 16 kHz microphone audio
+        std::vector<int16_t> uplink = make_audio(INPUT_RATE * ms / 1000, INPUT_RATE);
+        std::vector<uint8_t> uplink_bytes = MessageHandler::int16_to_uint8(uplink);
+        const std::size_t uplink_size = uplink_bytes.size();
+
+        run_benchmark(options, "int16_to_uint8" + suffix, uplink_size, [&]() {
+            std::vector<uint8_t> bytes = MessageHandler::int16_to_uint8(uplink);
+            keep(bytes);
+        }, results);
+
+        run_benchmark(options, "base64_encode" + suffix, uplink_size, [&]() {
+            std::string encoded = MessageHandler::base64_encode(uplink_bytes);
+            keep(encoded);
+        }, results);
+
+        run_benchmark(options, "create_audio_input_message" + suffix, uplink_size, [&]() {
+            std::string message = MessageHandler::create_audio_input_message(uplink);
+            keep(message);
+        }, results);
+
+        run_benchmark(options, "apply_gain" + suffix, uplink_size, [&]() {
+            std::vector<int16_t> amplified;
+            apply_gain(uplink, GAIN_FACTOR, amplified);
+            keep(amplified);
+        }, results);
+
+        // Downlink: 24 kHz model audio
+        std::vector<int16_t> downlink = make_audio(OUTPUT_RATE * ms / 1000, OUTPUT_RATE);
+        const std::string downlink_base64 = MessageHandler::base64_encode(MessageHandler::int16_to_uint8(downlink));
+        const std::string response = make_audio_response(downlink);
+
+        run_benchmark(options, "base64_decode" + suffix, downlink_base64.size(), [&]() {
+            std::vector<uint8_t> decoded = MessageHandler::base64_decode(downlink_base64);
+            keep(decoded);
+        }, results);
+
+        // Parse alone: default heap json against the per-message arena MessageHandler uses
+        run_benchmark(options, "json_parse/heap" + suffix, response.size(), [&]() {
+            json parsed = json::parse(response);
+            keep(parsed);
+        }, results);
+
+        run_benchmark(options, "json_parse/arena" + suffix, response.size(), [&]() {
+            JsonArena::Scope arena;
+            arena_json parsed = arena_json::parse(response);
+            keep(parsed);
+        }, results);
+
+        run_benchmark(options, "extract_audio_from_response" + suffix, response.size(), [&]() {
+            std::vector<int16_t> audio;
+            bool found = MessageHandler::extract_audio_from_response(response, audio);
+            keep(found);
+            keep(audio);
+        }, results);
+
+        // Every downlink message is also checked for text; this is the miss path
+        run_benchmark(options, "extract_transcription_from_response" + suffix, response.size(), [&]() {
+            std::string text;
+            bool found = MessageHandler::extract_transcription_from_response(response, text);
+            keep(found);
+            keep(text);
+        }, results);
+
+        run_benchmark(options, "is_turn_complete" + suffix, response.size(), [&]() {
+            bool complete = MessageHandler::is_turn_complete(response);
+            keep(complete);
+        }, results);
+
+        // Playback: push one received chunk, drain it in device-sized periods
+        PlaybackBuffer playback;
+        std::vector<int16_t> period(DEVICE_PERIOD);
+        run_benchmark(options, "playback_buffer_push_pop" + suffix, downlink.size() * sizeof(int16_t), [&]() {
+            playback.push(downlink);
+            while (playback.pop(period.data(), period.size()) > 0) {
+            }
+            keep(period);
+        }, results);
+    }
+
+    // Transcription hit path on a typical short message
+    const std::string transcription =
+        R"({"serverContent":{"outputTranscription":{"text":"Hello, how can I help you today?"}}})";
+    run_benchmark(options, "json_parse/heap/text", transcription.size(), [&]() {
+        json parsed = json::parse(transcription);
+        keep(parsed);
+    }, results);
+
+    run_benchmark(options, "json_parse/arena/text", transcription.size(), [&]() {
+        JsonArena::Scope arena;
+        arena_json parsed = arena_json::parse(transcription);
+        keep(parsed);
+    }, results);
+
+    run_benchmark(options, "extract_transcription_from_response/text", transcription.size(), [&]() {
+        std::string text;
+        bool found = MessageHandler::extract_transcription_from_response(transcription, text);
+        keep(found);
+        keep(text);
+    }, results);
+
+    // Transcript segmentation over word-sized fragments, as the server streams them
+    const std::vector<std::string> fragments = {"Hello,", " how", " can", " I", " help", " you", " today?",
+                                                " こんにちは", "。", "「元気", "？」", " Sure."};
+    std::size_t fragment_bytes = 0;
+    for (const std::string& fragment : fragments) {
+        fragment_bytes += fragment.size();
+    }
+    SentenceSegmenter segmenter;
+    std::vector<std::string> sentences;
+    run_benchmark(options, "sentence_segmenter/stream", fragment_bytes, [&]() {
+        sentences.clear();
+        for (const std::string& fragment : fragments) {
+            segmenter.append(fragment, sentences);
+        }
+        segmenter.release(sentences);
+        keep(sentences);
+    }, results);
+
+    if (!json_path.empty()) {
+        json report = json::array();
+        for (const BenchResult& result : results) {
+            report.push_back({
+                {"name", result.name},
+                {"payload_bytes", result.payload_bytes},
+                {"iterations", result.iterations},
+                {"ns_per_op", result.ns_per_op},
+                {"bytes_per_sec", result.bytes_per_sec},
+                {"allocs_per_op", result.allocs_per_op}
+            });
+        }
+
+        if (json_path == "-") {
+            std::cout << report.dump(2) << std::endl;
+        } else {
+            std::ofstream out(json_path);
+            if (!out.is_open()) {
+                std::cerr << "Error: cannot write " << json_path << std::endl;
+                return 1;
+            }
+            out << report.dump(2) << std::endl;
+            std::cout << "JSON report written to " << json_path << std::endl;
+        }
+    }
+
+    return results.empty() ? 1 : 0;
+}
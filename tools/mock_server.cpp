@@ -0,0 +1,116 @@
+#include "mock_gemini_server.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+
+// Show help message
+void print_help() {
+    std::cout << "Usage: mock-gemini-server [options]\n" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --address ADDR         Listen address (default: 127.0.0.1)" << std::endl;
+    std::cout << "  --port N               Listen port (default: 8765, 0 = any)" << std::endl;
+    std::cout << "  --threads N            IO threads (default: CPU cores)" << std::endl;
+    std::cout << "  --sample-rate HZ       Output sample rate (default: 24000)" << std::endl;
+    std::cout << "  --chunk-ms MS          Audio per message (default: 40)" << std::endl;
+    std::cout << "  --rate X               Speed multiple of realtime, 0 = unpaced (default: 1.0)" << std::endl;
+    std::cout << "  --burst N              Chunks sent back-to-back per tick (default: 1)" << std::endl;
+    std::cout << "  --trigger-chunks N     Uplink chunks that start a turn, 0 = right after setup (default: 10)" << std::endl;
+    std::cout << "  --delay-ms MS          Response delay after user input (default: 200)" << std::endl;
+    std::cout << "  --turn-ms MS           Model audio per turn (default: 2000)" << std::endl;
+    std::cout << "  --interrupt-every N    Interrupt every Nth turn halfway (default: off)" << std::endl;
+    std::cout << "  --goaway-after N       Send goAway and close after N turns (default: off)" << std::endl;
+    std::cout << "  --script PATH          Stream raw s16le mono PCM from PATH instead of a tone" << std::endl;
+    std::cout << "  --help, -h             Show this help message" << std::endl;
+}
+
+// Get option value (returns default_value if not specified)
+std::string get_option(int argc, char* argv[], const std::string& flag, const std::string& default_value) {
+    for (int i = 1; i < argc - 1; i++) {
+        if (argv[i] == flag) {
+            return argv[i + 1];
+        }
+    }
+    return default_value;
+}
+
+// Load raw s16le PCM
+bool load_pcm(const std::string& path, std::vector<int16_t>& samples) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    samples.resize(bytes.size() / 2);
+    for (std::size_t i = 0; i < samples.size(); i++) {
+        samples[i] = static_cast<int16_t>(
+            static_cast<uint8_t>(bytes[2 * i]) | (static_cast<uint8_t>(bytes[2 * i + 1]) << 8));
+    }
+    return !samples.empty();
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            print_help();
+            return 0;
+        }
+    }
+    
+    MockServerOptions options;
+    options.address = get_option(argc, argv, "--address", options.address);
+    options.port = static_cast<unsigned short>(std::atoi(get_option(argc, argv, "--port", "8765").c_str()));
+    options.sample_rate = std::atoi(get_option(argc, argv, "--sample-rate", "24000").c_str());
+    options.chunk_duration = std::chrono::milliseconds(std::atoi(get_option(argc, argv, "--chunk-ms", "40").c_str()));
+    options.rate = std::atof(get_option(argc, argv, "--rate", "1.0").c_str());
+    options.burst = std::atoi(get_option(argc, argv, "--burst", "1").c_str());
+    options.turn_trigger_chunks = std::atoi(get_option(argc, argv, "--trigger-chunks", "10").c_str());
+    options.response_delay = std::chrono::milliseconds(std::atoi(get_option(argc, argv, "--delay-ms", "200").c_str()));
+    options.turn_duration = std::chrono::milliseconds(std::atoi(get_option(argc, argv, "--turn-ms", "2000").c_str()));
+    options.interrupt_every = std::atoi(get_option(argc, argv, "--interrupt-every", "0").c_str());
+    options.goaway_after_turns = std::atoi(get_option(argc, argv, "--goaway-after", "0").c_str());
+    
+    std::string script = get_option(argc, argv, "--script", "");
+    if (!script.empty() && !load_pcm(script, options.script_audio)) {
+        std::cerr << "Failed to load PCM script: " << script << std::endl;
+        return 1;
+    }
+    
+    int threads = std::atoi(get_option(argc, argv, "--threads", "0").c_str());
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    net::io_context io_context(threads);
+    MockGeminiServer server(io_context, options);
+    if (!server.start()) {
+        return 1;
+    }
+    
+    // Stop cleanly on Ctrl+C
+    net::signal_set signals(io_context, SIGINT, SIGTERM);
+    signals.async_wait([&](beast::error_code, int) {
+        io_context.stop();
+    });
+    
+    std::cout << "Mock Gemini Live server listening on ws://" << options.address << ":" << server.port()
+              << server.endpoint().target << std::endl;
+    
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back([&io_context]() { io_context.run(); });
+    }
+    io_context.run();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    
+    MockGeminiServer::Stats stats = server.get_stats();
+    std::cout << "Connections: " << stats.connections
+              << ", messages rx/tx: " << stats.messages_received << "/" << stats.messages_sent
+              << ", turns: " << stats.turns_completed << std::endl;
+    return 0;
+}